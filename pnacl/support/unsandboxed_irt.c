@@ -326,7 +326,7 @@ static const struct nacl_irt_basic irt_basic = {
 
 DEFINE_STUB(seek)
 DEFINE_STUB(getdents)
-static const struct nacl_irt_fdio irt_fdio = {
+static const struct nacl_irt_fdio_v0_1 irt_fdio = {
   irt_close,
   irt_dup,
   irt_dup2,
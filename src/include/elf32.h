@@ -84,6 +84,17 @@ typedef struct {
   Elf32_Word  sh_entsize;
 } Elf32_Shdr;
 
+typedef struct {
+  Elf32_Word    st_name;
+  Elf32_Addr    st_value;
+  Elf32_Word    st_size;
+  unsigned char st_info;
+  unsigned char st_other;
+  Elf32_Half    st_shndx;
+} Elf32_Sym;
+
+#define ELF32_ST_TYPE(info) ((info) & 0xf)
+
 typedef struct {
   Elf32_Word n_namesz;
   Elf32_Word n_descsz;
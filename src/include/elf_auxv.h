@@ -20,4 +20,12 @@
 #define AT_ENTRY        9   /* Entry point of the executable */
 #define AT_SYSINFO      32  /* System call entry point */
 
+/*
+ * NaCl-specific key, chosen to stay clear of the Linux values: the
+ * untrusted address of the time page (see
+ * service_runtime/include/sys/nacl_time_page.h).  Absent if the
+ * service runtime did not map one.
+ */
+#define AT_NACL_TIME_PAGE 4096
+
 #endif
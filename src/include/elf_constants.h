@@ -123,12 +123,17 @@ EXTERN_C_BEGIN
  */
 #define PF_MASKOS     0x0ff00000  /* os specific */
 
+#define SHT_SYMTAB      2           /* Symbol table */
+#define SHT_STRTAB      3           /* String table */
+
 #define SHF_WRITE       0x1         /* Has writable data */
 #define SHF_ALLOC       0x2         /* Allocated in memory image of program */
 #define SHF_EXECINSTR   0x4         /* Contains executable instructions */
 #define SHF_MASKOS      0x0f000000  /* Environment-specific use */
 #define SHF_MASKPROC    0xf0000000  /* Processor-specific use */
 
+#define STT_FUNC        2           /* Symbol is a function */
+
 #define ELF_NOTE_GNU    "GNU"
 
 /* n_type value for build ID notes generated by "ld --build-id". */
@@ -22,4 +22,17 @@
 #define NACL_SECURE_SERVICE_HARD_SHUTDOWN   "hard_shutdown::"
 /* shutdown module */
 
+#define NACL_SECURE_SERVICE_SYSCALL_PROFILE "syscall_profile::s"
+/* -> JSON syscall profile, or "" if profiling is not enabled */
+
+#define NACL_SECURE_SERVICE_SAMPLING_PROFILE "sampling_profile::s"
+/* -> folded call stacks, or "" if sampling is not enabled */
+
+#define NACL_SECURE_SERVICE_MANIFEST_CACHE_INVALIDATE \
+  "manifest_cache_invalidate:s:"
+/* manifest name to forget cached lookups of, or "" to forget all */
+
+#define NACL_SECURE_SERVICE_MANIFEST_CACHE_STATS "manifest_cache_stats::ll"
+/* -> manifest lookups answered from the cache, and sent to the embedder */
+
 #endif /* NATIVE_CLIENT_SRC_PUBLIC_SECURE_SERVICE_H_ */
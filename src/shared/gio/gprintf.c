@@ -27,37 +27,46 @@
 # endif
 #endif
 
+/*
+ * Most output fits in a stack buffer, so it is formatted there and
+ * written with a single Write, without touching the heap.  This also
+ * keeps gprintf usable when reporting a crash with a damaged heap,
+ * as long as the output is short.
+ */
+#define GVPRINTF_STACK_BUFSZ  1024
+
 size_t gvprintf(struct Gio *gp,
                 char const *fmt,
                 va_list    ap) {
-  size_t    bufsz = 1024;
-  char      *buf = malloc(bufsz);
+  char      stack_buf[GVPRINTF_STACK_BUFSZ];
+  size_t    bufsz = sizeof stack_buf;
+  char      *buf = stack_buf;
   int       rv;
   va_list   ap_copy;
 
-  if (!buf) return -1;
-
   va_copy(ap_copy, ap);
 
   while ((rv = vsnprintf(buf, bufsz, fmt, ap_copy)) < 0 ||
          (unsigned) rv >= bufsz) {
     va_end(ap_copy);
-    free(buf);
+    if (buf != stack_buf) {
+      free(buf);
+    }
     buf = 0;
 
     /**
-     * Since the buffer size wasn't big enough, we want to double it.
+     * On Linux and OSX, vsnprintf returns the number of actual
+     * characters that would have been output (excluding the NUL
+     * byte), so a single resize to exactly that size suffices.  On
+     * Windows, vsnprintf returns -1 if the supplied buffer is not
+     * large enough, so there we double the buffer size instead.
      * Stop doubling when we reach SIZE_MAX / 2, though, otherwise we
      * risk wraparound.
-     *
-     * On Windows, vsnprintf returns -1 if the supplied buffer is not
-     * large enough; on Linux and OSX, it returns the number of actual
-     * characters that would have been output (excluding the NUL
-     * byte), which means a single resize would have been sufficient.
-     * Since buffer size increase should be infrequent, we do doubly
-     * on Linux and OSX as well.
      */
-    if (bufsz < SIZE_MAX / 2) {
+    if (rv >= 0) {
+      bufsz = (size_t) rv + 1;
+      buf = malloc(bufsz);
+    } else if (bufsz < SIZE_MAX / 2) {
       bufsz *= 2;
       buf = malloc(bufsz);
     }
@@ -71,7 +80,9 @@ size_t gvprintf(struct Gio *gp,
   if (rv >= 0) {
     rv = (int) (*gp->vtbl->Write)(gp, buf, rv);
   }
-  free(buf);
+  if (buf != stack_buf) {
+    free(buf);
+  }
 
   return rv;
 }
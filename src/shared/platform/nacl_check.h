@@ -32,33 +32,42 @@ EXTERN_C_BEGIN
  * NB: BEWARE of printf arguments the evaluation of which have
  * side-effects.  Any such will cause the program to behave
  * differently depending on whether debug mode is enabled or not.
+ *
+ * These call the NaClLog function rather than the NaClLog macro,
+ * since the messages cannot be suppressed anyway, and so that code
+ * that supplies its own NaClLog need not provide the rest of the
+ * logging module.
  */
 #define CHECK(bool_expr) do {                                        \
     if (!(bool_expr)) {                                              \
-      NaClLog(LOG_FATAL, "Fatal error in file %s, line %d: !(%s)\n", \
-              __FILE__, __LINE__, #bool_expr);                       \
+      (NaClLog)(LOG_FATAL,                                           \
+                "Fatal error in file %s, line %d: !(%s)\n",          \
+                __FILE__, __LINE__, #bool_expr);                     \
     }                                                                \
   } while (0)
 
 #define DCHECK(bool_expr) do {                                       \
     if (nacl_check_debug_mode && !(bool_expr)) {                     \
-      NaClLog(LOG_FATAL, "Fatal error in file %s, line %d: !(%s)\n", \
-              __FILE__, __LINE__, #bool_expr);                       \
+      (NaClLog)(LOG_FATAL,                                           \
+                "Fatal error in file %s, line %d: !(%s)\n",          \
+                __FILE__, __LINE__, #bool_expr);                     \
     }                                                                \
   } while (0)
 
 #define VCHECK(bool_expr, fn_arg) do {                               \
     if   (!(bool_expr)) {                                            \
-      NaClLog(LOG_ERROR, "Fatal error in file %s, line %d: !(%s)\n", \
-              __FILE__, __LINE__, #bool_expr);                       \
+      (NaClLog)(LOG_ERROR,                                           \
+                "Fatal error in file %s, line %d: !(%s)\n",          \
+                __FILE__, __LINE__, #bool_expr);                     \
       NaClCheckIntern fn_arg;                                        \
     }                                                                \
   } while (0)
 
 #define DVCHECK(bool_expr, fn_arg) do {                              \
     if (nacl_check_debug_mode && !(bool_expr)) {                     \
-      NaClLog(LOG_ERROR, "Fatal error in file %s, line %d: !(%s)\n", \
-              __FILE__, __LINE__, #bool_expr);                       \
+      (NaClLog)(LOG_ERROR,                                           \
+                "Fatal error in file %s, line %d: !(%s)\n",          \
+                __FILE__, __LINE__, #bool_expr);                     \
       NaClCheckIntern fn_arg;                                        \
     }                                                                \
   } while (0)
@@ -281,6 +281,120 @@ extern ssize_t NaClHostDescPWrite(struct NaClHostDesc  *d,
                                   size_t count,
                                   nacl_off64_t offset) NACL_WUR;
 
+/*
+ * A scatter/gather element for the vectored I/O functions below.  It
+ * has the same layout as the POSIX struct iovec.
+ */
+struct NaClHostIoVec {
+  void    *base;
+  size_t  length;
+};
+
+/*
+ * Vectored versions of NaClHostDescRead, NaClHostDescWrite,
+ * NaClHostDescPRead and NaClHostDescPWrite.  The buffers are filled
+ * or drained in order, and the return value is the total number of
+ * bytes transferred, or a negated NaCl ABI errno.  iovcnt must be no
+ * larger than the host's IOV_MAX.
+ *
+ * The iov array and buffers are not validated.
+ *
+ * Underlying host-OS functions: readv / writev / preadv / pwritev
+ * where available, otherwise a sequence of the scalar calls.
+ */
+extern ssize_t NaClHostDescReadv(struct NaClHostDesc        *d,
+                                 struct NaClHostIoVec const *iov,
+                                 size_t                     iovcnt) NACL_WUR;
+
+extern ssize_t NaClHostDescWritev(struct NaClHostDesc         *d,
+                                  struct NaClHostIoVec const  *iov,
+                                  size_t                      iovcnt) NACL_WUR;
+
+extern ssize_t NaClHostDescPReadv(struct NaClHostDesc         *d,
+                                  struct NaClHostIoVec const  *iov,
+                                  size_t                      iovcnt,
+                                  nacl_off64_t                offset) NACL_WUR;
+
+extern ssize_t NaClHostDescPWritev(struct NaClHostDesc        *d,
+                                   struct NaClHostIoVec const *iov,
+                                   size_t                     iovcnt,
+                                   nacl_off64_t               offset)
+    NACL_WUR;
+
+/*
+ * Implements the vectored I/O functions above as a sequence of calls
+ * to the scalar ones, stopping at the first short transfer.  For use
+ * by host implementations that lack a native equivalent.  If
+ * positional is zero, offset is ignored.
+ */
+extern ssize_t NaClHostDescIoVecByParts(struct NaClHostDesc *d,
+                                        struct NaClHostIoVec const *iov,
+                                        size_t iovcnt,
+                                        int is_write,
+                                        int positional,
+                                        nacl_off64_t offset) NACL_WUR;
+
+/*
+ * Copies up to count bytes from in to out without passing them
+ * through untrusted memory.  If offset is non-NULL, in is read
+ * starting at *offset, *offset is advanced by the number of bytes
+ * copied, and the file position of in is not changed; otherwise in is
+ * read from, and advances, its file position.  Returns the number of
+ * bytes copied, or a negated NaCl ABI errno if nothing was copied.
+ *
+ * Underlying host-OS functions: sendfile on Linux, otherwise (or when
+ * the kernel refuses the descriptor pair) read/pread and write through
+ * a trusted buffer.
+ */
+extern ssize_t NaClHostDescSendfile(struct NaClHostDesc *out,
+                                    struct NaClHostDesc *in,
+                                    nacl_off64_t        *offset,
+                                    size_t              count) NACL_WUR;
+
+/*
+ * The buffered-copy implementation of NaClHostDescSendfile, for host
+ * implementations without a suitable kernel primitive.
+ */
+extern ssize_t NaClHostDescSendfileByCopy(struct NaClHostDesc *out,
+                                          struct NaClHostDesc *in,
+                                          nacl_off64_t        *offset,
+                                          size_t              count) NACL_WUR;
+
+/* Size of the bounce buffer used by the buffered-copy sendfile loops. */
+#define NACL_SENDFILE_CHUNK_BYTES (64 << 10)
+
+/*
+ * Reads up to len bytes from source into buf: at *offset, without
+ * advancing it, if offset is non-NULL, otherwise at the file position.
+ */
+typedef ssize_t (*NaClSendfileReadFn)(void          *source,
+                                      void          *buf,
+                                      size_t        len,
+                                      nacl_off64_t  *offset);
+
+/* Writes up to len bytes of buf to sink. */
+typedef ssize_t (*NaClSendfileWriteFn)(void       *sink,
+                                       void const *buf,
+                                       size_t     len);
+
+/*
+ * The copy loop behind every buffered sendfile: copies up to count
+ * bytes from source to sink through buffer, buffer_size bytes at a
+ * time, with the offset semantics of NaClHostDescSendfile.  Short
+ * writes are retried.  Returns the number of bytes copied, or the
+ * first negated NaCl ABI errno if nothing was copied.  Bytes that
+ * were read but could not be written are lost when reading from the
+ * file position, as with an interrupted read/write loop.
+ */
+extern ssize_t NaClSendfileCopyLoop(NaClSendfileReadFn  read_fn,
+                                    void                *source,
+                                    NaClSendfileWriteFn write_fn,
+                                    void                *sink,
+                                    char                *buffer,
+                                    size_t              buffer_size,
+                                    nacl_off64_t        *offset,
+                                    size_t              count) NACL_WUR;
+
 extern nacl_off64_t NaClHostDescSeek(struct NaClHostDesc *d,
                                      nacl_off64_t        offset,
                                      int                 whence);
@@ -9,6 +9,7 @@
  * mapping using descriptors.
  */
 #include <errno.h>
+#include <stdlib.h>
 
 #include "native_client/src/include/nacl_platform.h"
 #include "native_client/src/include/portability.h"
@@ -404,3 +405,121 @@ void NaClHostDescCheckValidity(char const *fn_name,
     NaClLog(LOG_FATAL, "%s: already closed\n", fn_name);
   }
 }
+
+ssize_t NaClHostDescIoVecByParts(struct NaClHostDesc *d,
+                                 struct NaClHostIoVec const *iov,
+                                 size_t iovcnt,
+                                 int is_write,
+                                 int positional,
+                                 nacl_off64_t offset) {
+  size_t total = 0;
+  size_t i;
+  ssize_t result;
+
+  for (i = 0; i < iovcnt; ++i) {
+    if (0 == iov[i].length) {
+      continue;
+    }
+    if (positional) {
+      result = is_write
+          ? NaClHostDescPWrite(d, iov[i].base, iov[i].length,
+                               offset + (nacl_off64_t) total)
+          : NaClHostDescPRead(d, iov[i].base, iov[i].length,
+                              offset + (nacl_off64_t) total);
+    } else {
+      result = is_write
+          ? NaClHostDescWrite(d, iov[i].base, iov[i].length)
+          : NaClHostDescRead(d, iov[i].base, iov[i].length);
+    }
+    if (result < 0) {
+      /* Report the bytes already transferred, if any, as readv does. */
+      return (0 == total) ? result : (ssize_t) total;
+    }
+    total += (size_t) result;
+    if ((size_t) result < iov[i].length) {
+      break;
+    }
+  }
+  return (ssize_t) total;
+}
+
+ssize_t NaClSendfileCopyLoop(NaClSendfileReadFn  read_fn,
+                             void                *source,
+                             NaClSendfileWriteFn write_fn,
+                             void                *sink,
+                             char                *buffer,
+                             size_t              buffer_size,
+                             nacl_off64_t        *offset,
+                             size_t              count) {
+  size_t  total = 0;
+  size_t  chunk;
+  size_t  written;
+  ssize_t nread;
+  ssize_t nwrote = 0;
+
+  while (total < count) {
+    chunk = count - total;
+    if (chunk > buffer_size) {
+      chunk = buffer_size;
+    }
+    nread = (*read_fn)(source, buffer, chunk, offset);
+    if (nread <= 0) {
+      nwrote = nread;
+      break;
+    }
+    for (written = 0; written < (size_t) nread; written += nwrote) {
+      nwrote = (*write_fn)(sink, buffer + written, nread - written);
+      if (nwrote <= 0) {
+        break;
+      }
+    }
+    total += written;
+    if (NULL != offset) {
+      *offset += written;
+    }
+    if (written < (size_t) nread) {
+      break;
+    }
+  }
+  if (0 == total && nwrote < 0) {
+    return nwrote;
+  }
+  return (ssize_t) total;
+}
+
+static ssize_t NaClHostDescSendfileRead(void          *source,
+                                        void          *buf,
+                                        size_t        len,
+                                        nacl_off64_t  *offset) {
+  struct NaClHostDesc *in = (struct NaClHostDesc *) source;
+
+  if (NULL != offset) {
+    return NaClHostDescPRead(in, buf, len, *offset);
+  }
+  return NaClHostDescRead(in, buf, len);
+}
+
+static ssize_t NaClHostDescSendfileWrite(void       *sink,
+                                         void const *buf,
+                                         size_t     len) {
+  return NaClHostDescWrite((struct NaClHostDesc *) sink, buf, len);
+}
+
+ssize_t NaClHostDescSendfileByCopy(struct NaClHostDesc *out,
+                                   struct NaClHostDesc *in,
+                                   nacl_off64_t        *offset,
+                                   size_t              count) {
+  char    *buffer;
+  ssize_t rv;
+
+  buffer = malloc(NACL_SENDFILE_CHUNK_BYTES);
+  if (NULL == buffer) {
+    return -NACL_ABI_ENOMEM;
+  }
+  rv = NaClSendfileCopyLoop(NaClHostDescSendfileRead, in,
+                            NaClHostDescSendfileWrite, out,
+                            buffer, NACL_SENDFILE_CHUNK_BYTES,
+                            offset, count);
+  free(buffer);
+  return rv;
+}
@@ -658,6 +658,122 @@ int PWriteUsesOffsetReadPtrVerification(struct NaClHostDesc *test_file,
   return 1;
 }
 
+/*
+ * Splits |buffer| into three unequal pieces, with an empty element in
+ * the middle, so that element boundaries do not line up with anything.
+ */
+static void SplitIoVec(struct NaClHostIoVec iov[4], char *buffer, size_t len) {
+  CHECK(len >= 7);
+  iov[0].base = buffer;
+  iov[0].length = 3;
+  iov[1].base = buffer + 3;
+  iov[1].length = 0;
+  iov[2].base = buffer + 3;
+  iov[2].length = len / 2;
+  iov[3].base = buffer + 3 + len / 2;
+  iov[3].length = len - 3 - len / 2;
+}
+
+int VectoredReadAndPRead(struct NaClHostDesc *test_file,
+                         struct NaClHostDesc *ro_view,
+                         void const *test_params) {
+  char buffer[512];
+  struct NaClHostIoVec iov[4];
+  ssize_t io_rv;
+  const nacl_off64_t preadv_position = 730;
+
+  UNREFERENCED_PARAMETER(ro_view);
+  UNREFERENCED_PARAMETER(test_params);
+
+  SplitIoVec(iov, buffer, sizeof buffer);
+  memset(buffer, 0, sizeof buffer);
+  io_rv = NaClHostDescReadv(test_file, iov, NACL_ARRAY_SIZE(iov));
+  if (io_rv != sizeof buffer ||
+      0 != memcmp(buffer, quote, sizeof buffer)) {
+    fprintf(stderr, "VectoredReadAndPRead: readv failed, got %"NACL_PRIdS"\n",
+            io_rv);
+    return 0;
+  }
+  memset(buffer, 0, sizeof buffer);
+  io_rv = NaClHostDescPReadv(test_file, iov, NACL_ARRAY_SIZE(iov),
+                             preadv_position);
+  if (io_rv != sizeof buffer ||
+      0 != memcmp(buffer, quote + preadv_position, sizeof buffer)) {
+    fprintf(stderr, "VectoredReadAndPRead: preadv failed, got %"NACL_PRIdS"\n",
+            io_rv);
+    return 0;
+  }
+  /* preadv must not have moved the file pointer. */
+  memset(buffer, 0, sizeof buffer);
+  io_rv = NaClHostDescReadv(test_file, iov, NACL_ARRAY_SIZE(iov));
+  if (io_rv != sizeof buffer ||
+      0 != memcmp(buffer, quote + sizeof buffer, sizeof buffer)) {
+    fprintf(stderr,
+            "VectoredReadAndPRead: 2nd readv failed, got %"NACL_PRIdS"\n",
+            io_rv);
+    return 0;
+  }
+  return 1;
+}
+
+int VectoredPWriteVerification(struct NaClHostDesc *test_file,
+                               struct NaClHostDesc *ro_view,
+                               void const *test_params) {
+  size_t len = strlen(another_quote);
+  char buffer[4096];
+  struct NaClHostIoVec iov[4];
+  ssize_t io_rv;
+  const nacl_off64_t pwritev_position = 4096;
+
+  UNREFERENCED_PARAMETER(test_params);
+
+  CHECK(len <= sizeof buffer);
+  SplitIoVec(iov, (char *) another_quote, len);
+  io_rv = NaClHostDescPWritev(test_file, iov, NACL_ARRAY_SIZE(iov),
+                              pwritev_position);
+  if (io_rv != (ssize_t) len) {
+    fprintf(stderr,
+            "VectoredPWriteVerification: pwritev failed, got %"NACL_PRIdS"\n",
+            io_rv);
+    return 0;
+  }
+  io_rv = NaClHostDescPRead(ro_view, buffer, len, pwritev_position);
+  if (io_rv != (ssize_t) len || 0 != memcmp(buffer, another_quote, len)) {
+    fprintf(stderr,
+            "VectoredPWriteVerification: verification pread failed\n"
+            "Got:\n"
+            "%.*s\n",
+            (int) len, buffer);
+    return 0;
+  }
+  return 1;
+}
+
+int VectoredWriteFailure(struct NaClHostDesc *test_file,
+                         struct NaClHostDesc *ro_view,
+                         void const *test_params) {
+  struct NaClHostIoVec iov[4];
+  ssize_t io_rv;
+
+  UNREFERENCED_PARAMETER(ro_view);
+  UNREFERENCED_PARAMETER(test_params);
+
+  SplitIoVec(iov, (char *) another_quote, strlen(another_quote));
+  io_rv = NaClHostDescWritev(test_file, iov, NACL_ARRAY_SIZE(iov));
+  if (io_rv != -NACL_ABI_EBADF) {
+    fprintf(stderr, "VectoredWriteFailure: writev got %"NACL_PRIdS"\n",
+            io_rv);
+    return 0;
+  }
+  io_rv = NaClHostDescPWritev(test_file, iov, NACL_ARRAY_SIZE(iov), 0);
+  if (io_rv != -NACL_ABI_EBADF) {
+    fprintf(stderr, "VectoredWriteFailure: pwritev got %"NACL_PRIdS"\n",
+            io_rv);
+    return 0;
+  }
+  return 1;
+}
+
 static struct TestParams const tests[] = {
   {
     "O_RDWR, read, pread, read, pwrite",
@@ -715,6 +831,26 @@ static struct TestParams const tests[] = {
     NACL_ABI_O_RDWR | NACL_ABI_O_APPEND, 0666,
     PWriteUsesOffsetReadPtrVerification,
     NULL,
+  }, {
+    "O_RDWR, readv, preadv, readv",
+    NACL_ABI_O_RDWR, 0666,
+    VectoredReadAndPRead,
+    NULL,
+  }, {
+    "O_RDWR, check pwritev shows up w/ pread",
+    NACL_ABI_O_RDWR, 0666,
+    VectoredPWriteVerification,
+    NULL,
+  }, {
+    "O_RDWR | O_APPEND, check pwritev shows up w/ pread",
+    NACL_ABI_O_RDWR | NACL_ABI_O_APPEND, 0666,
+    VectoredPWriteVerification,
+    NULL,
+  }, {
+    "O_RDONLY, writev-fail, pwritev-fail",
+    NACL_ABI_O_RDONLY, 0666,
+    VectoredWriteFailure,
+    NULL,
   },
 };
 
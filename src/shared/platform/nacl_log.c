@@ -87,6 +87,7 @@ static int              g_abort_behavior_active = 0;
 #define NACL_VERBOSITY_UNSET INT_MAX
 
 static int              verbosity = NACL_VERBOSITY_UNSET;
+int                     gNaClLogMaxVerbosity = NACL_VERBOSITY_UNSET;
 static struct Gio       *log_stream = NULL;
 static struct GioFile   log_file_stream;
 static int              timestamp_enabled = 1;
@@ -94,6 +95,10 @@ static int              timestamp_enabled = 1;
 /* global, but explicitly not exposed in non-test header file */
 void (*gNaClLogAbortBehavior)(void) = NaClAbort;
 
+/* Installed by NaClLogAsyncStart(); see nacl_log_intern.h. */
+int (*gNaClLogAsyncWrite)(int detail_level, char const *fmt, va_list ap) = NULL;
+void (*gNaClLogAsyncDrain_mu)(struct Gio *s) = NULL;
+
 /*
  * For now, we use a simple linked list.  New entries are pushed to
  * the front; search starts at front.  So last entry for a particular
@@ -111,6 +116,19 @@ struct NaClLogModuleVerbosity {
 
 static struct NaClLogModuleVerbosity *gNaClLogModuleVerbosity = NULL;
 
+/* Must be called whenever verbosity or a module's verbosity changes. */
+static void NaClLogUpdateMaxVerbosity_mu(void) {
+  struct NaClLogModuleVerbosity *p;
+  int                           max_verbosity = verbosity;
+
+  for (p = gNaClLogModuleVerbosity; NULL != p; p = p->next) {
+    if (p->verbosity > max_verbosity) {
+      max_verbosity = p->verbosity;
+    }
+  }
+  gNaClLogMaxVerbosity = max_verbosity;
+}
+
 static FILE *NaClLogFileIoBufferFromFile(char const *log_file) {
   int   log_desc;
   FILE  *log_iob;
@@ -244,6 +262,7 @@ void NaClLogParseAndSetModuleVerbosityMap(char const *module_verbosity_map) {
     assign = strchr(entry_buf, '=');
     if (NULL == assign && !seen_global) {
       verbosity = strtol(entry_buf, (char **) 0, 0);
+      NaClLogUpdateMaxVerbosity_mu();
       seen_global = 1;
     } else {
       *assign = '\0';
@@ -315,6 +334,7 @@ void NaClLogModuleFini(void) {
     entry = next;
   }
   gNaClLogModuleVerbosity = NULL;
+  NaClLogUpdateMaxVerbosity_mu();
   NaClMutexDtor(&log_mu);
   g_initialized = 0;
 }
@@ -366,7 +386,7 @@ void NaClLogUnlock(void) {
   }
 }
 
-static INLINE struct Gio *NaClLogGetGio_mu(void) {
+struct Gio *NaClLogGetGio_mu(void) {
   if (NULL == log_stream) {
     (void) GioFileRefCtor(&log_file_stream, NaClLogDupFileIo(stderr));
     log_stream = (struct Gio *) &log_file_stream;
@@ -376,6 +396,7 @@ static INLINE struct Gio *NaClLogGetGio_mu(void) {
 
 static void NaClLogSetVerbosity_mu(int verb) {
   verbosity = verb;
+  NaClLogUpdateMaxVerbosity_mu();
 }
 
 void NaClLogPreInitSetVerbosity(int verb) {
@@ -402,6 +423,7 @@ void  NaClLogIncrVerbosity(void) {
     verbosity = 0;
   }
   ++verbosity;
+  NaClLogUpdateMaxVerbosity_mu();
   NaClLogUnlock();
 }
 
@@ -411,6 +433,7 @@ int NaClLogGetVerbosity(void) {
   NaClLogLock();
   if (NACL_VERBOSITY_UNSET == verbosity) {
     verbosity = 0;
+    NaClLogUpdateMaxVerbosity_mu();
   }
   v = verbosity;
   NaClLogUnlock();
@@ -456,6 +479,10 @@ void NaClLogDisableTimestamp(void) {
   timestamp_enabled = 0;
 }
 
+int NaClLogTimestampEnabled(void) {
+  return timestamp_enabled;
+}
+
 static void NaClLogOutputTag_mu(struct Gio *s) {
   char timestamp[128];
   int  pid;
@@ -472,17 +499,12 @@ static void NaClLogOutputTag_mu(struct Gio *s) {
 
 /*
  * Output a printf-style formatted message if the log verbosity level
- * is set higher than the log output's detail level.  Note that since
- * this is not a macro, log message arguments that have side effects
- * will have their side effects regardless of whether the
- * corresponding log message is printed or not.  This is good from a
- * consistency point of view, but it means that should a logging
- * argument be expensive to compute, the log statement needs to be
- * surrounded by something like
- *
- *  if (detail_level <= NaClLogGetVerbosity()) {
- *    NaClLog(detail_level, "format string", expensive_arg(), ...);
- *  }
+ * is set higher than the log output's detail level.  Callers
+ * normally go through the NaClLog macro in nacl_log.h, which skips
+ * the call, and the evaluation of the log message arguments, when no
+ * verbosity level is high enough for the message.  Arguments that
+ * have side effects will therefore only have them when the message
+ * may be printed.
  *
  * The log message, if written, is prepended by a microsecond
  * resolution timestamp on linux and a millisecond resolution
@@ -497,6 +519,10 @@ void NaClLogDoLogV_mu(int         detail_level,
   if (0 == g_abort_count) {
     s = NaClLogGetGio_mu();
 
+    if (LOG_FATAL == detail_level && NULL != gNaClLogAsyncDrain_mu) {
+      /* Queued messages came first, and may explain the failure. */
+      (*gNaClLogAsyncDrain_mu)(s);
+    }
     NaClLogOutputTag_mu(s);
     (void) gvprintf(s, fmt, ap);
     (void) (*s->vtbl->Flush)(s);
@@ -511,11 +537,26 @@ void NaClLogDoLogV_mu(int         detail_level,
   }
 }
 
+/*
+ * Hands the message to the asynchronous backend if it is running.
+ * LOG_FATAL messages are always written synchronously.  Returns 0,
+ * without having used ap, if the message still has to be written.
+ */
+static INLINE int NaClLogAsyncV(int         detail_level,
+                                char const  *fmt,
+                                va_list     ap) {
+  int (*write_fn)(int, char const *, va_list) = gNaClLogAsyncWrite;
+
+  return (LOG_FATAL != detail_level && NULL != write_fn &&
+          (*write_fn)(detail_level, fmt, ap));
+}
+
 void NaClLogV_mu(int        detail_level,
                  char const *fmt,
                  va_list    ap) {
   if (NACL_VERBOSITY_UNSET == verbosity) {
     verbosity = NaClLogDefaultLogVerbosity();
+    NaClLogUpdateMaxVerbosity_mu();
   }
 
   if (detail_level <= verbosity) {
@@ -531,6 +572,9 @@ void NaClLogV(int         detail_level,
     return;
   }
 #endif
+  if (NaClLogAsyncV(detail_level, fmt, ap)) {
+    return;
+  }
   NaClLogLock();
   NaClLogV_mu(detail_level, fmt, ap);
   NaClLogUnlock();
@@ -557,6 +601,7 @@ void NaClLogSetModuleVerbosity_mu(char const  *module_name,
   entry->verbosity = verbosity;
   entry->next = gNaClLogModuleVerbosity;
   gNaClLogModuleVerbosity = entry;
+  NaClLogUpdateMaxVerbosity_mu();
 }
 
 void NaClLogSetModuleVerbosity(char const *module_name,
@@ -603,7 +648,8 @@ static void NaClLogDoLogAndUnsetModuleV(int        detail_level,
   int module_verbosity;
 
   module_verbosity = NaClLogGetModuleVerbosity_mu(gTls_ModuleName);
-  if (detail_level <= module_verbosity) {
+  if (detail_level <= module_verbosity &&
+      !NaClLogAsyncV(detail_level, fmt, ap)) {
     NaClLogLock();
     NaClLogDoLogV_mu(detail_level, fmt, ap);
     NaClLogUnlock();
@@ -624,7 +670,8 @@ static void NaClLogDoLogAndUnsetModuleV(int        detail_level,
   int         module_verbosity;
 
   module_verbosity = NaClLogGetModuleVerbosity_mu(module_name);
-  if (detail_level <= module_verbosity) {
+  if (detail_level <= module_verbosity &&
+      !NaClLogAsyncV(detail_level, fmt, ap)) {
     NaClLogLock();
     NaClLogDoLogV_mu(detail_level, fmt, ap);
     NaClLogUnlock();
@@ -665,9 +712,10 @@ void NaClLogDoLogAndUnsetModule(int        detail_level,
   va_end(ap);
 }
 
-void NaClLog(int         detail_level,
-             char const  *fmt,
-             ...) {
+/* The parentheses keep the NaClLog macro from expanding. */
+void (NaClLog)(int        detail_level,
+               char const *fmt,
+               ...) {
   va_list ap;
 
 #if !THREAD_SAFE_DETAIL_CHECK
@@ -676,11 +724,13 @@ void NaClLog(int         detail_level,
   }
 #endif
 
-  NaClLogLock();
   va_start(ap, fmt);
-  NaClLogV_mu(detail_level, fmt, ap);
+  if (!NaClLogAsyncV(detail_level, fmt, ap)) {
+    NaClLogLock();
+    NaClLogV_mu(detail_level, fmt, ap);
+    NaClLogUnlock();
+  }
   va_end(ap);
-  NaClLogUnlock();
 }
 
 void NaClLog_mu(int         detail_level,
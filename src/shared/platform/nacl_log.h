@@ -64,6 +64,14 @@
  * the application aborts after the log message is generated.
  * Messages at these levels cannot be suppressed.
  *
+ * NaClLog is a macro that only evaluates its arguments and calls the
+ * logging function if the detail level is at most the highest
+ * verbosity level in effect, global or per-module, so disabled
+ * logging statements cost a compare and a branch.  The detail level
+ * may be evaluated more than once.  Building with
+ * NACL_LOG_MAX_DETAIL_LEVEL defined (it must be at least 0) removes
+ * the statements with a higher constant detail level altogether.
+ *
  *
  * The default logging output is standard error.  NB: on Windows, both
  * stdout and stderr are discarded for Windowed applications.
@@ -83,6 +91,7 @@
 #include <stdarg.h>
 
 #include "native_client/src/include/nacl_base.h"
+#include "native_client/src/include/nacl_compiler_annotations.h"
 
 #ifdef __native_client__
 # define ATTRIBUTE_FORMAT_PRINTF(m, n) __attribute__((format(printf, m, n)))
@@ -249,6 +258,12 @@ void NaClLog(int         detail_level,
              char const  *fmt,
              ...) ATTRIBUTE_FORMAT_PRINTF(2, 3);
 
+/*
+ * The highest of the global and per-module verbosity levels, which
+ * the NaClLog macro compares against.  Only nacl_log.c may modify it.
+ */
+extern int gNaClLogMaxVerbosity;
+
 /*
  * A version of NaClLog with an explicit module name parameter.  This
  * is used, for example, by C++ template code that is defined in a
@@ -263,61 +278,56 @@ void NaClLog2(char const *module_name,
 
 /*
  * "Internal" functions.  NaClLogSetModule and
- * NaClLogDoLogAndUnsetModule should only be used by the syntactic
- * macro below.
+ * NaClLogDoLogAndUnsetModule are what NaClLog2 uses to log on behalf
+ * of a module.
  *
- * NaClLogSetModule always return 0.  This means in the macro, its
- * continuation is the else clause.  NaClLogDoLogAndUnsetModule is a
- * "naked" identifier in the macro definition, and so will take on the
- * argument list from the apparent argument list of NaClLog.
+ * NaClLogSetModule always return 0.
  */
 int NaClLogSetModule(char const *module_name);
 void NaClLogDoLogAndUnsetModule(int        detail_level,
                                 char const *fmt,
                                 ...) ATTRIBUTE_FORMAT_PRINTF(2, 3);
+
+#ifdef NACL_LOG_MAX_DETAIL_LEVEL
+# define NACL_LOG_COMPILED_IN(detail_level) \
+  ((detail_level) <= NACL_LOG_MAX_DETAIL_LEVEL)
+#else
+# define NACL_LOG_COMPILED_IN(detail_level) 1
+#endif
+
 /*
- * TODO(bsy): With variadic macro support on the way, the macro below and
- * the comment following it could be improved for readability.
+ * True if a message at detail_level might be written.  With a
+ * constant detail_level above NACL_LOG_MAX_DETAIL_LEVEL, this is a
+ * constant 0 and the compiler drops the statement.
  */
-
-#ifdef NACL_LOG_MODULE_NAME
-# define NaClLog                              \
-  if (NaClLogSetModule(NACL_LOG_MODULE_NAME)) \
-    ;                                         \
-  else                                        \
-    NaClLogDoLogAndUnsetModule
+#define NACL_LOG_IS_ON(detail_level)                  \
+  (NACL_LOG_COMPILED_IN(detail_level) &&              \
+   !NACL_LIKELY((detail_level) > gNaClLogMaxVerbosity))
 
 /*
  * User code has lines of the form
  *
  * NaClLog(detail_level, format_string, ...);
  *
- * We need to be usable without variadic macros.  So, when
- * NACL_LOG_MODULE_NAME is not defined, the NaClLog statement would
- * just invoke the NaClLog function.  When NACL_LOG_MODULE_NAME *is*
- * defined, however, it expands to:
- *
- * if (NaClLogSetModule(NACL_LOG_MODULE_NAME))
- *   ;
- * else
- *   NaClLogDoLogAndUnsetModule(detail_level, format_string, ...);
- *
- * Note that this is a syntactic macro, so that if the original code had
+ * which expand to an expression that calls NaClLog or, when
+ * NACL_LOG_MODULE_NAME is defined, NaClLog2 with the module name, so
+ * that the module's verbosity level applies.  Since the expansion is
+ * an expression, an "else" following the statement binds as it would
+ * for a function call.
  *
- * if (foo)
- *   if (bar)
- *     NaClLog(LOG_WARNING, "EEeeep!\n");
- *   else
- *     printf("!bar\n");
- *
- * the macro expansion for NaClLog would not cause the "else" clauses
- * to mis-bind.
- *
- * Also note that the compiler may generate a warning/suggestion to
- * use braces.  This doesn't occur in the NaCl code base (esp w/
- * -Werror), but may have an impact on untrusted code that use this
- * module.
+ * To call the function itself, e.g. when defining it, write
+ * (NaClLog)(...).
  */
+#ifdef NACL_LOG_MODULE_NAME
+# define NaClLog(detail_level, ...)                                     \
+  (NACL_LOG_IS_ON(detail_level)                                         \
+   ? NaClLog2(NACL_LOG_MODULE_NAME, detail_level, __VA_ARGS__)          \
+   : (void) 0)
+#else
+# define NaClLog(detail_level, ...)                                     \
+  (NACL_LOG_IS_ON(detail_level)                                         \
+   ? NaClLog(detail_level, __VA_ARGS__)                                 \
+   : (void) 0)
 #endif
 
 #define LOG_INFO    (-1)
@@ -0,0 +1,469 @@
+/*
+ * Copyright (c) 2013 The Native Client Authors. All rights reserved.
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+/*
+ * Asynchronous NaClLog output.  See nacl_log_async.h.
+ *
+ * Each ring has a single producer, the thread that owns it, and a
+ * single consumer, whichever thread holds the log lock -- normally the
+ * drain thread, but also a thread writing a LOG_FATAL message.  The
+ * producer fills in a record and then publishes it by setting its
+ * full flag; the consumer writes the record out and then hands it back
+ * by clearing the flag.  The flag updates are full barriers, so
+ * neither side sees a partly written record.
+ *
+ * Rings are never freed.  When a thread exits its ring is marked
+ * unused, and is given to the next thread that needs one.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "native_client/src/shared/platform/nacl_log_async.h"
+
+#include "native_client/src/include/atomic_ops.h"
+#include "native_client/src/include/nacl_macros.h"
+#include "native_client/src/include/portability_io.h"
+#include "native_client/src/include/portability_process.h"
+#include "native_client/src/shared/gio/gio.h"
+#include "native_client/src/shared/platform/nacl_log.h"
+#include "native_client/src/shared/platform/nacl_log_intern.h"
+#include "native_client/src/shared/platform/nacl_sync.h"
+#include "native_client/src/shared/platform/nacl_sync_checked.h"
+#include "native_client/src/shared/platform/nacl_threads.h"
+#include "native_client/src/shared/platform/nacl_time.h"
+
+#if NACL_PLATFORM_HAS_TSD
+# include <pthread.h>
+#endif
+
+#define NACL_LOG_ASYNC_RING_RECORDS   256
+#define NACL_LOG_ASYNC_DRAIN_NANOS    5000000
+#define NACL_LOG_ASYNC_STACK_SIZE     (64 << 10)
+
+static char const kTruncated[] = "...\n";
+
+struct NaClLogAsyncRecord {
+  volatile Atomic32               full;
+  struct NaClLogAsyncRecordHeader hdr;
+  char                            text[NACL_LOG_ASYNC_TEXT_MAX];
+};
+
+struct NaClLogAsyncRing {
+  struct NaClLogAsyncRing   *next;
+  volatile Atomic32         in_use;
+  volatile Atomic32         dropped;
+  uint32_t                  write_index;  /* owner only */
+  uint32_t                  read_index;   /* log lock holder only */
+  struct NaClLogAsyncRecord records[NACL_LOG_ASYNC_RING_RECORDS];
+};
+
+/*
+ * Formats the "[pid,tid:time] " tag that nacl_log.c puts in front of
+ * each message, using the time that the message was logged.
+ */
+static void NaClLogAsyncFormatTag(char                                  *buf,
+                                  size_t                                size,
+                                  struct NaClLogAsyncRecordHeader const *hdr) {
+  time_t    secs = (time_t) (hdr->timestamp_us / NACL_MICROS_PER_UNIT);
+  int       usecs = (int) (hdr->timestamp_us % NACL_MICROS_PER_UNIT);
+  struct tm bdt;
+
+#if NACL_WINDOWS
+  (void) localtime_s(&bdt, &secs);
+#else
+  (void) localtime_r(&secs, &bdt);
+#endif
+  SNPRINTF(buf, size, "[%u,%u:%02d:%02d:%02d.%06d] ",
+           hdr->pid, hdr->thread_id,
+           bdt.tm_hour, bdt.tm_min, bdt.tm_sec, usecs);
+}
+
+static int NaClLogAsyncReadFully(struct Gio *in, void *buf, size_t count) {
+  char    *p = (char *) buf;
+  ssize_t got;
+
+  while (count > 0) {
+    got = (*in->vtbl->Read)(in, p, count);
+    if (got <= 0) {
+      return 0;
+    }
+    p += got;
+    count -= got;
+  }
+  return 1;
+}
+
+int NaClLogAsyncDecode(struct Gio *in, struct Gio *out) {
+  char                            magic[NACL_LOG_ASYNC_MAGIC_LEN];
+  struct NaClLogAsyncRecordHeader hdr;
+  char                            text[NACL_LOG_ASYNC_TEXT_MAX];
+  char                            tag[128];
+  ssize_t                         got;
+
+  if (!NaClLogAsyncReadFully(in, magic, sizeof magic) ||
+      0 != memcmp(magic, NACL_LOG_ASYNC_MAGIC, sizeof magic)) {
+    return -1;
+  }
+  for (;;) {
+    got = (*in->vtbl->Read)(in, &hdr, sizeof hdr);
+    if (0 == got) {
+      break;
+    }
+    if (got < 0 ||
+        !NaClLogAsyncReadFully(in, (char *) &hdr + got, sizeof hdr - got) ||
+        hdr.length > sizeof text ||
+        !NaClLogAsyncReadFully(in, text, hdr.length)) {
+      return -1;
+    }
+    if (0 == (hdr.flags & NACL_LOG_ASYNC_CONTINUED)) {
+      NaClLogAsyncFormatTag(tag, sizeof tag, &hdr);
+      (void) gprintf(out, "%s", tag);
+    }
+    (void) (*out->vtbl->Write)(out, text, hdr.length);
+  }
+  (void) (*out->vtbl->Flush)(out);
+  return 0;
+}
+
+#if NACL_PLATFORM_HAS_TSD
+
+static struct Gio               *g_async_binary_out = NULL;
+static int                      g_async_key_created = 0;
+static pthread_key_t            g_async_ring_key;
+
+/* g_rings_mu protects the list head; the next links never change. */
+static struct NaClMutex         g_rings_mu;
+static struct NaClLogAsyncRing  *g_rings = NULL;
+
+/* g_drain_mu and g_drain_cv are used to wake or stop the drain thread. */
+static struct NaClMutex         g_drain_mu;
+static struct NaClCondVar       g_drain_cv;
+static int                      g_drain_stop = 0;
+static struct NaClThread        g_drain_thread;
+
+static void NaClLogAsyncReleaseRing(void *state) {
+  struct NaClLogAsyncRing *ring = (struct NaClLogAsyncRing *) state;
+
+  (void) CompareAndSwap(&ring->in_use, 1, 0);
+}
+
+static struct NaClLogAsyncRing *NaClLogAsyncThreadRing(void) {
+  struct NaClLogAsyncRing *ring;
+
+  ring = (struct NaClLogAsyncRing *) pthread_getspecific(g_async_ring_key);
+  if (NULL != ring) {
+    return ring;
+  }
+  NaClXMutexLock(&g_rings_mu);
+  for (ring = g_rings; NULL != ring; ring = ring->next) {
+    if (0 == CompareAndSwap(&ring->in_use, 0, 1)) {
+      break;
+    }
+  }
+  if (NULL == ring) {
+    ring = (struct NaClLogAsyncRing *) calloc(1, sizeof *ring);
+    if (NULL != ring) {
+      ring->in_use = 1;
+      ring->next = g_rings;
+      g_rings = ring;
+    }
+  }
+  NaClXMutexUnlock(&g_rings_mu);
+  if (NULL != ring &&
+      0 != pthread_setspecific(g_async_ring_key, (void const *) ring)) {
+    NaClLogAsyncReleaseRing(ring);
+    ring = NULL;
+  }
+  return ring;
+}
+
+/*
+ * Formats a message that does not fit in one record into a heap
+ * buffer, cut off at NACL_LOG_ASYNC_SPILL_MAX bytes.  Returns NULL if
+ * out of memory.
+ */
+static char *NaClLogAsyncFormatLong(size_t      len,
+                                    char const  *fmt,
+                                    va_list     ap,
+                                    size_t      *out_len) {
+  char *text = (char *) malloc(len + 1);
+
+  if (NULL == text) {
+    return NULL;
+  }
+  (void) VSNPRINTF(text, len + 1, fmt, ap);
+  if (len > NACL_LOG_ASYNC_SPILL_MAX) {
+    len = NACL_LOG_ASYNC_SPILL_MAX;
+    memcpy(text + len - (sizeof kTruncated - 1),
+           kTruncated, sizeof kTruncated - 1);
+  }
+  *out_len = len;
+  return text;
+}
+
+static int NaClLogAsyncWrite(int detail_level, char const *fmt, va_list ap) {
+  struct NaClLogAsyncRing         *ring = NaClLogAsyncThreadRing();
+  struct NaClLogAsyncRecord       *rec;
+  struct NaClLogAsyncRecordHeader hdr;
+  va_list                         ap_copy;
+  int                             rv;
+  size_t                          len;
+  char                            *spill = NULL;
+  size_t                          num_records = 1;
+  size_t                          i;
+
+  if (NULL == ring) {
+    return 0;
+  }
+  rec = &ring->records[ring->write_index % NACL_LOG_ASYNC_RING_RECORDS];
+  if (rec->full) {
+    (void) AtomicIncrement(&ring->dropped, 1);
+    (void) NaClCondVarSignal(&g_drain_cv);
+    return 1;
+  }
+  hdr.timestamp_us = NaClGetTimeOfDayMicroseconds();
+  hdr.detail_level = detail_level;
+  hdr.pid = (uint32_t) GETPID();
+  hdr.thread_id = NaClThreadId();
+  hdr.flags = 0;
+
+  va_copy(ap_copy, ap);
+  rv = VSNPRINTF(rec->text, sizeof rec->text, fmt, ap);
+  len = rv < 0 ? 0 : (size_t) rv;
+  if (len >= sizeof rec->text) {
+    spill = NaClLogAsyncFormatLong(len, fmt, ap_copy, &len);
+    if (NULL == spill) {
+      len = sizeof rec->text;
+      memcpy(rec->text + len - (sizeof kTruncated - 1),
+             kTruncated, sizeof kTruncated - 1);
+    } else {
+      num_records = (len + NACL_LOG_ASYNC_TEXT_MAX - 1) /
+          NACL_LOG_ASYNC_TEXT_MAX;
+    }
+  }
+  va_end(ap_copy);
+
+  /*
+   * The consumer frees records in order, so if the last record the
+   * message needs is free, so are all of the ones before it.
+   */
+  if (num_records > 1 &&
+      ring->records[(ring->write_index + num_records - 1) %
+                    NACL_LOG_ASYNC_RING_RECORDS].full) {
+    free(spill);
+    (void) AtomicIncrement(&ring->dropped, 1);
+    (void) NaClCondVarSignal(&g_drain_cv);
+    return 1;
+  }
+  for (i = 0; i < num_records; ++i) {
+    rec = &ring->records[(ring->write_index + i) %
+                         NACL_LOG_ASYNC_RING_RECORDS];
+    rec->hdr = hdr;
+    if (NULL == spill) {
+      rec->hdr.length = (uint32_t) len;
+    } else {
+      rec->hdr.length = (uint32_t) (i + 1 < num_records
+                                    ? NACL_LOG_ASYNC_TEXT_MAX
+                                    : len - i * NACL_LOG_ASYNC_TEXT_MAX);
+      memcpy(rec->text, spill + i * NACL_LOG_ASYNC_TEXT_MAX,
+             rec->hdr.length);
+    }
+    if (0 != i) {
+      rec->hdr.flags = NACL_LOG_ASYNC_CONTINUED;
+    }
+  }
+  free(spill);
+
+  /*
+   * Publish the first record last, so that the consumer, which stops at
+   * the first record that is not full, never writes out part of a
+   * message.
+   */
+  for (i = num_records; i-- > 0; ) {
+    rec = &ring->records[(ring->write_index + i) %
+                         NACL_LOG_ASYNC_RING_RECORDS];
+    (void) CompareAndSwap(&rec->full, 0, 1);
+  }
+  ring->write_index += (uint32_t) num_records;
+  return 1;
+}
+
+static void NaClLogAsyncOutput_mu(struct Gio                            *s,
+                                  struct NaClLogAsyncRecordHeader const *hdr,
+                                  char const                            *text) {
+  char tag[128];
+
+  if (NULL != g_async_binary_out) {
+    (void) (*s->vtbl->Write)(s, hdr, sizeof *hdr);
+  } else if (NaClLogTimestampEnabled() &&
+             0 == (hdr->flags & NACL_LOG_ASYNC_CONTINUED)) {
+    NaClLogAsyncFormatTag(tag, sizeof tag, hdr);
+    (void) gprintf(s, "%s", tag);
+  }
+  (void) (*s->vtbl->Write)(s, text, hdr->length);
+}
+
+/* Returns the number of records written. */
+static uint32_t NaClLogAsyncDrainRings_mu(struct Gio *s) {
+  struct NaClLogAsyncRing         *ring;
+  struct NaClLogAsyncRecord       *rec;
+  struct NaClLogAsyncRecordHeader hdr;
+  char                            text[64];
+  Atomic32                        dropped;
+  uint32_t                        count = 0;
+
+  NaClXMutexLock(&g_rings_mu);
+  ring = g_rings;
+  NaClXMutexUnlock(&g_rings_mu);
+
+  for (; NULL != ring; ring = ring->next) {
+    for (;;) {
+      rec = &ring->records[ring->read_index % NACL_LOG_ASYNC_RING_RECORDS];
+      /* A full barrier read, so that the record is read after the flag. */
+      if (0 == AtomicIncrement(&rec->full, 0)) {
+        break;
+      }
+      NaClLogAsyncOutput_mu(s, &rec->hdr, rec->text);
+      ++ring->read_index;
+      ++count;
+      (void) CompareAndSwap(&rec->full, 1, 0);
+    }
+    dropped = AtomicExchange(&ring->dropped, 0);
+    if (0 != dropped) {
+      hdr.timestamp_us = NaClGetTimeOfDayMicroseconds();
+      hdr.detail_level = LOG_WARNING;
+      hdr.pid = (uint32_t) GETPID();
+      hdr.thread_id = NaClThreadId();
+      hdr.flags = 0;
+      hdr.length = (uint32_t) SNPRINTF(text, sizeof text,
+                                       "NaClLogAsync: dropped %d messages\n",
+                                       (int) dropped);
+      NaClLogAsyncOutput_mu(s, &hdr, text);
+      ++count;
+    }
+  }
+  return count;
+}
+
+/*
+ * s is the log Gio, which is only used for text output.  Returns the
+ * number of records written.
+ */
+static uint32_t NaClLogAsyncFlush_mu(struct Gio *s) {
+  uint32_t count;
+
+  if (NULL != g_async_binary_out) {
+    s = g_async_binary_out;
+  }
+  count = NaClLogAsyncDrainRings_mu(s);
+  if (0 != count) {
+    (void) (*s->vtbl->Flush)(s);
+  }
+  return count;
+}
+
+static void NaClLogAsyncDrain_mu(struct Gio *s) {
+  (void) NaClLogAsyncFlush_mu(s);
+}
+
+static void WINAPI NaClLogAsyncDrainThread(void *state) {
+  NACL_TIMESPEC_T interval;
+  int             stop = 0;
+  uint32_t        count;
+
+  UNREFERENCED_PARAMETER(state);
+  interval.tv_sec = 0;
+  interval.tv_nsec = NACL_LOG_ASYNC_DRAIN_NANOS;
+  while (!stop) {
+    NaClLogLock();
+    count = NaClLogAsyncFlush_mu(NaClLogGetGio_mu());
+    NaClLogUnlock();
+
+    NaClXMutexLock(&g_drain_mu);
+    if (!g_drain_stop && 0 == count) {
+      (void) NaClCondVarTimedWaitRelative(&g_drain_cv, &g_drain_mu, &interval);
+    }
+    stop = g_drain_stop;
+    NaClXMutexUnlock(&g_drain_mu);
+  }
+}
+
+int NaClLogAsyncStart(struct Gio *binary_out) {
+  if (!g_async_key_created) {
+    if (0 != pthread_key_create(&g_async_ring_key, NaClLogAsyncReleaseRing)) {
+      return 0;
+    }
+    /*
+     * These are never destroyed, since a thread that is still in
+     * NaClLogAsyncWrite() after NaClLogAsyncStop() may use them.
+     */
+    NaClXMutexCtor(&g_rings_mu);
+    NaClXMutexCtor(&g_drain_mu);
+    NaClXCondVarCtor(&g_drain_cv);
+    g_async_key_created = 1;
+  }
+  g_drain_stop = 0;
+
+  NaClLogLock();
+  g_async_binary_out = binary_out;
+  if (NULL != binary_out) {
+    (void) (*binary_out->vtbl->Write)(binary_out, NACL_LOG_ASYNC_MAGIC,
+                                      NACL_LOG_ASYNC_MAGIC_LEN);
+  }
+  gNaClLogAsyncDrain_mu = NaClLogAsyncDrain_mu;
+  gNaClLogAsyncWrite = NaClLogAsyncWrite;
+  NaClLogUnlock();
+
+  if (!NaClThreadCreateJoinable(&g_drain_thread, NaClLogAsyncDrainThread,
+                                NULL, NACL_LOG_ASYNC_STACK_SIZE)) {
+    NaClLogLock();
+    gNaClLogAsyncWrite = NULL;
+    NaClLogAsyncDrain_mu(NaClLogGetGio_mu());
+    gNaClLogAsyncDrain_mu = NULL;
+    g_async_binary_out = NULL;
+    NaClLogUnlock();
+    return 0;
+  }
+  return 1;
+}
+
+void NaClLogAsyncStop(void) {
+  NaClLogLock();
+  gNaClLogAsyncWrite = NULL;
+  NaClLogUnlock();
+
+  NaClXMutexLock(&g_drain_mu);
+  g_drain_stop = 1;
+  NaClXCondVarSignal(&g_drain_cv);
+  NaClXMutexUnlock(&g_drain_mu);
+  NaClThreadJoin(&g_drain_thread);
+
+  /*
+   * A thread that was already in NaClLogAsyncWrite() may still queue a
+   * message after this; it stays queued until the next
+   * NaClLogAsyncStart().
+   */
+  NaClLogLock();
+  NaClLogAsyncDrain_mu(NaClLogGetGio_mu());
+  gNaClLogAsyncDrain_mu = NULL;
+  g_async_binary_out = NULL;
+  NaClLogUnlock();
+}
+
+#else  /* NACL_PLATFORM_HAS_TSD */
+
+int NaClLogAsyncStart(struct Gio *binary_out) {
+  UNREFERENCED_PARAMETER(binary_out);
+  return 0;
+}
+
+void NaClLogAsyncStop(void) {
+}
+
+#endif  /* NACL_PLATFORM_HAS_TSD */
@@ -0,0 +1,102 @@
+/*
+ * Copyright (c) 2013 The Native Client Authors. All rights reserved.
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+/*
+ * Asynchronous output for NaClLog.
+ *
+ * Normally each NaClLog call takes the log lock, writes to the log
+ * Gio and flushes it.  Once NaClLogAsyncStart() has been called, a
+ * message is instead formatted into a ring buffer that belongs to the
+ * logging thread, without taking any lock or doing any I/O, and a
+ * background thread drains all of the rings to the log Gio, flushing
+ * once per pass.  Messages from one thread stay in order, but
+ * messages from different threads may be interleaved differently
+ * than they were logged; each carries the time at which it was
+ * logged.
+ *
+ * A record holds NACL_LOG_ASYNC_TEXT_MAX bytes of message text.
+ * Longer messages are spilled into consecutive records of the same
+ * ring, up to NACL_LOG_ASYNC_SPILL_MAX bytes in all; beyond that the
+ * text is cut off and ends in "...\n".  If a thread logs faster than
+ * the rings are drained, the messages that do not fit are dropped,
+ * and the number dropped is reported in the output.  LOG_FATAL
+ * messages are written synchronously, after everything that has been
+ * queued.
+ *
+ * In binary mode the drain thread writes the raw records to a Gio of
+ * their own, which is cheaper than formatting their tags, and
+ * NaClLogAsyncDecode() and the nacl_log_decode tool turn the stream
+ * back into text later.  The stream is NACL_LOG_ASYNC_MAGIC followed
+ * by records, each of which is a NaClLogAsyncRecordHeader in host
+ * byte order and length bytes of message text.  A record with
+ * NACL_LOG_ASYNC_CONTINUED set continues the message of the record
+ * before it.  Synchronous output, including LOG_FATAL messages, still
+ * goes to the log Gio as text.
+ *
+ * sel_ldr starts the backend in text mode when the NACLLOG_ASYNC
+ * environment variable is set, and stops it before exiting normally.
+ * Messages still queued when the process exits some other way are
+ * lost.
+ *
+ * The backend needs thread-specific data to give each thread its
+ * ring, so it is not available on Windows.
+ */
+
+#ifndef NATIVE_CLIENT_SRC_SHARED_PLATFORM_NACL_LOG_ASYNC_H_
+#define NATIVE_CLIENT_SRC_SHARED_PLATFORM_NACL_LOG_ASYNC_H_
+
+#include "native_client/src/include/nacl_base.h"
+#include "native_client/src/include/nacl_compiler_annotations.h"
+#include "native_client/src/include/portability.h"
+
+EXTERN_C_BEGIN
+
+struct Gio;
+
+#define NACL_LOG_ASYNC_MAGIC      "NaClLogA"
+#define NACL_LOG_ASYNC_MAGIC_LEN  8
+
+#define NACL_LOG_ASYNC_TEXT_MAX   224
+#define NACL_LOG_ASYNC_SPILL_MAX  (16 * NACL_LOG_ASYNC_TEXT_MAX)
+
+/* NaClLogAsyncRecordHeader flags. */
+#define NACL_LOG_ASYNC_CONTINUED  0x1
+
+struct NaClLogAsyncRecordHeader {
+  /* Microseconds since the epoch. */
+  int64_t   timestamp_us;
+  int32_t   detail_level;
+  uint32_t  pid;
+  uint32_t  thread_id;
+  uint32_t  length;
+  uint32_t  flags;
+};
+
+/*
+ * Starts queuing messages, and starts the thread that writes them
+ * out: as text to the log Gio if binary_out is NULL, or else as
+ * records to binary_out.  Must be called after NaClLogModuleInit().
+ * Returns 0 if the backend is not available or could not be started,
+ * in which case logging stays synchronous.
+ */
+int NaClLogAsyncStart(struct Gio *binary_out) NACL_WUR;
+
+/*
+ * Writes out everything queued, stops the drain thread and returns
+ * to synchronous logging.  Must be called before
+ * NaClLogModuleFini(), and before binary_out is closed.
+ */
+void NaClLogAsyncStop(void);
+
+/*
+ * Converts a binary stream read from in into text written to out.
+ * Returns 0 on success, or -1 if in is not a well-formed stream.
+ */
+int NaClLogAsyncDecode(struct Gio *in, struct Gio *out);
+
+EXTERN_C_END
+
+#endif  /* NATIVE_CLIENT_SRC_SHARED_PLATFORM_NACL_LOG_ASYNC_H_ */
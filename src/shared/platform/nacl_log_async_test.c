@@ -0,0 +1,202 @@
+/*
+ * Copyright (c) 2013 The Native Client Authors. All rights reserved.
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+/*
+ * Logs from several threads through the asynchronous NaClLog backend,
+ * in text and binary mode, and checks that every message comes out
+ * once and that each thread's messages stay in order.  Also checks
+ * that messages too long for one record come out whole.
+ */
+
+#include <stdio.h>
+#include <string.h>
+
+#include "native_client/src/include/nacl_macros.h"
+#include "native_client/src/include/portability.h"
+
+#include "native_client/src/shared/gio/gio.h"
+#include "native_client/src/shared/platform/nacl_check.h"
+#include "native_client/src/shared/platform/nacl_log.h"
+#include "native_client/src/shared/platform/nacl_log_async.h"
+#include "native_client/src/shared/platform/nacl_threads.h"
+#include "native_client/src/shared/platform/platform_init.h"
+
+#define kNumThreads 4
+/*
+ * A thread that exits hands its ring to the next thread, so this is
+ * small enough that all of the messages fit in one ring, even if the
+ * drain thread does not run until they have all been logged.
+ */
+#define kMessagesPerThread 50
+#define kThreadStackSize (64 << 10)
+#define kLongMessageLen 1000
+#define kTooLongMessageLen (2 * NACL_LOG_ASYNC_SPILL_MAX)
+
+static char g_log_buffer[1 << 20];
+static char g_binary_buffer[1 << 20];
+static char g_decoded_buffer[1 << 20];
+static char g_long_text[kTooLongMessageLen + 1];
+
+static void WINAPI LogThread(void *state) {
+  int thread_num = (int) (uintptr_t) state;
+  int i;
+
+  for (i = 0; i < kMessagesPerThread; ++i) {
+    NaClLog(1, "thread %d message %d\n", thread_num, i);
+  }
+}
+
+static void LogFromThreads(void) {
+  struct NaClThread threads[kNumThreads];
+  int               i;
+
+  for (i = 0; i < kNumThreads; ++i) {
+    CHECK(NaClThreadCreateJoinable(&threads[i], LogThread,
+                                   (void *) (uintptr_t) i, kThreadStackSize));
+  }
+  for (i = 0; i < kNumThreads; ++i) {
+    NaClThreadJoin(&threads[i]);
+  }
+}
+
+/* Returns the number of errors found in text, which is len bytes. */
+static int CheckOutput(char const *name, char *text, size_t len) {
+  int   next[kNumThreads];
+  int   thread_num;
+  int   message_num;
+  int   errors = 0;
+  int   i;
+  char  *line;
+  char  *end;
+
+  memset(next, 0, sizeof next);
+  for (line = text; line < text + len; line = end + 1) {
+    end = memchr(line, '\n', text + len - line);
+    if (NULL == end) {
+      printf("%s: unterminated line\n", name);
+      return errors + 1;
+    }
+    *end = '\0';
+    line = strstr(line, "thread ");
+    if (NULL == line) {
+      continue;
+    }
+    if (2 != sscanf(line, "thread %d message %d", &thread_num, &message_num) ||
+        thread_num < 0 || thread_num >= kNumThreads ||
+        message_num != next[thread_num]) {
+      printf("%s: unexpected line: %s\n", name, line);
+      ++errors;
+      continue;
+    }
+    ++next[thread_num];
+  }
+  for (i = 0; i < kNumThreads; ++i) {
+    if (kMessagesPerThread != next[i]) {
+      printf("%s: thread %d: got %d messages, expected %d\n",
+             name, i, next[i], kMessagesPerThread);
+      ++errors;
+    }
+  }
+  return errors;
+}
+
+/*
+ * Returns the number of errors.  A message spilled over several
+ * records must come out as one line with one tag, and one longer than
+ * NACL_LOG_ASYNC_SPILL_MAX must be cut off there.
+ */
+static int TestLongMessages(void) {
+  struct GioMemoryFile  binary_gio;
+  struct GioMemoryFile  binary_in;
+  struct GioMemoryFile  decoded_gio;
+  char                  *line;
+  char                  *end;
+  int                   errors = 0;
+
+  memset(g_long_text, 'x', kTooLongMessageLen);
+  CHECK(GioMemoryFileCtor(&binary_gio, g_binary_buffer,
+                          sizeof g_binary_buffer));
+  CHECK(NaClLogAsyncStart((struct Gio *) &binary_gio));
+  NaClLog(1, "long %.*s\n", kLongMessageLen, g_long_text);
+  NaClLog(1, "too long %s\n", g_long_text);
+  NaClLogAsyncStop();
+
+  CHECK(GioMemoryFileCtor(&binary_in, g_binary_buffer, binary_gio.curpos));
+  CHECK(GioMemoryFileCtor(&decoded_gio, g_decoded_buffer,
+                          sizeof g_decoded_buffer - 1));
+  CHECK(0 == NaClLogAsyncDecode((struct Gio *) &binary_in,
+                                (struct Gio *) &decoded_gio));
+  g_decoded_buffer[decoded_gio.curpos] = '\0';
+
+  if (NULL != strstr(g_decoded_buffer, "] x")) {
+    printf("long: continuation record got a tag of its own\n");
+    ++errors;
+  }
+  line = strstr(g_decoded_buffer, "] long ");
+  if (NULL == line ||
+      kLongMessageLen != strspn(line + 7, "x") ||
+      '\n' != line[7 + kLongMessageLen]) {
+    printf("long: message did not come out whole\n");
+    ++errors;
+  }
+  line = strstr(g_decoded_buffer, "] too long ");
+  end = NULL == line ? NULL : strchr(line, '\n');
+  if (NULL == end ||
+      NACL_LOG_ASYNC_SPILL_MAX != end + 1 - (line + 2) ||
+      0 != strncmp(end - 3, "...", 3)) {
+    printf("too long: message was not cut off at %d bytes\n",
+           NACL_LOG_ASYNC_SPILL_MAX);
+    ++errors;
+  }
+  return errors;
+}
+
+int main(void) {
+  struct GioMemoryFile  log_gio;
+  struct GioMemoryFile  binary_gio;
+  struct GioMemoryFile  binary_in;
+  struct GioMemoryFile  decoded_gio;
+  int                   errors = 0;
+
+  NaClPlatformInit();
+  CHECK(GioMemoryFileCtor(&log_gio, g_log_buffer, sizeof g_log_buffer));
+  NaClLogSetGio((struct Gio *) &log_gio);
+  NaClLogSetVerbosity(1);
+  NaClLogDisableTimestamp();
+
+  if (!NaClLogAsyncStart(NULL)) {
+    printf("asynchronous logging is not available; skipping\n");
+    NaClPlatformFini();
+    return 0;
+  }
+  LogFromThreads();
+  NaClLogAsyncStop();
+  errors += CheckOutput("text", g_log_buffer, log_gio.curpos);
+
+  CHECK(GioMemoryFileCtor(&binary_gio, g_binary_buffer,
+                          sizeof g_binary_buffer));
+  CHECK(NaClLogAsyncStart((struct Gio *) &binary_gio));
+  LogFromThreads();
+  NaClLogAsyncStop();
+
+  CHECK(GioMemoryFileCtor(&binary_in, g_binary_buffer, binary_gio.curpos));
+  CHECK(GioMemoryFileCtor(&decoded_gio, g_decoded_buffer,
+                          sizeof g_decoded_buffer));
+  if (0 != NaClLogAsyncDecode((struct Gio *) &binary_in,
+                              (struct Gio *) &decoded_gio)) {
+    printf("binary: could not decode the log\n");
+    ++errors;
+  } else {
+    errors += CheckOutput("binary", g_decoded_buffer, decoded_gio.curpos);
+  }
+
+  errors += TestLongMessages();
+
+  NaClLogSetGio(NULL);
+  NaClPlatformFini();
+  printf("%s\n", 0 == errors ? "PASSED" : "FAILED");
+  return 0 != errors;
+}
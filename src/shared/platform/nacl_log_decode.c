@@ -0,0 +1,42 @@
+/*
+ * Copyright (c) 2013 The Native Client Authors. All rights reserved.
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+/*
+ * Converts a binary log written by the asynchronous NaClLog backend
+ * (see nacl_log_async.h) to text on stdout.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "native_client/src/shared/gio/gio.h"
+#include "native_client/src/shared/platform/nacl_log_async.h"
+
+int main(int argc, char **argv) {
+  struct GioFile  in;
+  struct GioFile  out;
+  int             rv;
+
+  if (2 != argc) {
+    fprintf(stderr, "Usage: %s binary-log-file\n", argv[0]);
+    return 1;
+  }
+  if (!GioFileCtor(&in, argv[1], "rb")) {
+    perror(argv[1]);
+    return 1;
+  }
+  if (!GioFileRefCtor(&out, stdout)) {
+    fprintf(stderr, "%s: could not wrap stdout\n", argv[0]);
+    return 1;
+  }
+  rv = NaClLogAsyncDecode((struct Gio *) &in, (struct Gio *) &out);
+  if (0 != rv) {
+    fprintf(stderr, "%s: %s is not a well-formed binary log\n",
+            argv[0], argv[1]);
+  }
+  (*in.base.vtbl->Dtor)((struct Gio *) &in);
+  return 0 != rv;
+}
@@ -11,10 +11,14 @@
 #ifndef NATIVE_CLIENT_SRC_TRUSTED_PLATFORM_NACL_LOG_INTERN_H__
 #define NATIVE_CLIENT_SRC_TRUSTED_PLATFORM_NACL_LOG_INTERN_H__
 
+#include <stdarg.h>
+
 #include "native_client/src/include/nacl_base.h"
 
 EXTERN_C_BEGIN
 
+struct Gio;
+
 /*
  * The global variable gNaClLogAbortBehavior should only be modified
  * by test code after NaClLogModuleInit() has been called.
@@ -35,6 +39,22 @@ EXTERN_C_BEGIN
  */
 extern void (*gNaClLogAbortBehavior)(void);
 
+/*
+ * Hooks for the asynchronous backend in nacl_log_async.c, which are
+ * NULL unless it is running.  gNaClLogAsyncWrite is called without
+ * the log lock held and returns non-zero if it queued the message; if
+ * it returns 0 it must not have used ap, and the message is written
+ * synchronously.  gNaClLogAsyncDrain_mu writes out everything queued
+ * so far, and is called with the log lock held before a LOG_FATAL
+ * message is written.
+ */
+extern int (*gNaClLogAsyncWrite)(int detail_level, char const *fmt, va_list ap);
+extern void (*gNaClLogAsyncDrain_mu)(struct Gio *s);
+
+struct Gio *NaClLogGetGio_mu(void);
+
+int NaClLogTimestampEnabled(void);
+
 EXTERN_C_END
 
 #endif  /* NATIVE_CLIENT_SRC_TRUSTED_PLATFORM_NACL_LOG_INTERN_H__ */
@@ -0,0 +1,71 @@
+/*
+ * Copyright (c) 2013 The Native Client Authors. All rights reserved.
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+/*
+ * Checks that the NaClLog macro skips disabled messages without
+ * evaluating their arguments, and that a module's verbosity level
+ * still applies when it is higher than the global one.
+ */
+
+#define NACL_LOG_MODULE_NAME "nacl_log_test"
+
+#include <stdio.h>
+#include <string.h>
+
+#include "native_client/src/shared/gio/gio.h"
+#include "native_client/src/shared/platform/nacl_check.h"
+#include "native_client/src/shared/platform/nacl_log.h"
+#include "native_client/src/shared/platform/platform_init.h"
+
+static char g_log_buffer[4096];
+static int g_evaluations = 0;
+
+static int Evaluate(void) {
+  return ++g_evaluations;
+}
+
+static int Expect(char const *what, int condition) {
+  if (!condition) {
+    printf("FAILED: %s\n", what);
+    return 1;
+  }
+  return 0;
+}
+
+int main(void) {
+  struct GioMemoryFile  log_gio;
+  int                   errors = 0;
+
+  NaClPlatformInit();
+  CHECK(GioMemoryFileCtor(&log_gio, g_log_buffer, sizeof g_log_buffer - 1));
+  NaClLogSetGio((struct Gio *) &log_gio);
+  NaClLogDisableTimestamp();
+  NaClLogSetVerbosity(1);
+  NaClLogSetModuleVerbosity(NACL_LOG_MODULE_NAME, 3);
+
+  NaClLog(3, "module message %d\n", Evaluate());
+  NaClLog(4, "suppressed message %d\n", Evaluate());
+  (NaClLog)(3, "global message\n");
+  NaClLog(LOG_INFO, "info message\n");
+
+  errors += Expect("disabled message arguments not evaluated",
+                   1 == g_evaluations);
+  errors += Expect("module message written",
+                   NULL != strstr(g_log_buffer, "module message 1\n"));
+  errors += Expect("suppressed message not written",
+                   NULL == strstr(g_log_buffer, "suppressed"));
+  errors += Expect("global verbosity applies outside the module",
+                   NULL == strstr(g_log_buffer, "global message"));
+  errors += Expect("LOG_INFO message written",
+                   NULL != strstr(g_log_buffer, "info message\n"));
+
+  NaClLogSetGio(NULL);
+  NaClPlatformFini();
+  if (0 == errors) {
+    printf("PASSED\n");
+  }
+  return 0 != errors;
+}
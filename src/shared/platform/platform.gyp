@@ -21,6 +21,8 @@
       'nacl_interruptible_mutex.h',
       'nacl_log.c',
       'nacl_log.h',
+      'nacl_log_async.c',
+      'nacl_log_async.h',
       'nacl_secure_random.h',
       'nacl_secure_random_base.h',
       'nacl_secure_random_common.c',
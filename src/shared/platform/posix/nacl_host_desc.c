@@ -19,7 +19,11 @@
 #include <fcntl.h>
 #include <errno.h>
 #include <sys/mman.h>
+#include <sys/uio.h>
 #include <unistd.h>
+#if NACL_LINUX
+# include <sys/sendfile.h>
+#endif
 
 #if NACL_LINUX
 # include <pthread.h>
@@ -54,6 +58,18 @@
 # error "Which POSIX OS?"
 #endif
 
+/*
+ * OSX and older Android do not have preadv/pwritev; there they are
+ * emulated with a sequence of pread/pwrite calls.
+ */
+#if NACL_LINUX && !NACL_ANDROID
+# define NACL_HAVE_PREADV 1
+# define PREADV preadv64
+# define PWRITEV pwritev64
+#else
+# define NACL_HAVE_PREADV 0
+#endif
+
 /*
  * Map our ABI to the host OS's ABI.  On linux, this should be a big no-op.
  */
@@ -574,6 +590,146 @@ ssize_t NaClHostDescPWrite(struct NaClHostDesc *d,
           ? -NaClXlateErrno(errno) : retval);
 }
 
+/*
+ * BEWARE: struct NaClHostIoVec has the same layout as struct iovec, so
+ * the vectored I/O functions pass the former where the latter is
+ * expected, rather than copying.
+ */
+
+ssize_t NaClHostDescReadv(struct NaClHostDesc         *d,
+                          struct NaClHostIoVec const  *iov,
+                          size_t                      iovcnt) {
+  ssize_t retval;
+
+  NaClHostDescCheckValidity("NaClHostDescReadv", d);
+  if (NACL_ABI_O_WRONLY == (d->flags & NACL_ABI_O_ACCMODE)) {
+    NaClLog(3, "NaClHostDescReadv: WRONLY file\n");
+    return -NACL_ABI_EBADF;
+  }
+  return ((-1 == (retval = readv(d->d, (struct iovec const *) iov,
+                                 (int) iovcnt)))
+          ? -NaClXlateErrno(errno) : retval);
+}
+
+ssize_t NaClHostDescWritev(struct NaClHostDesc        *d,
+                           struct NaClHostIoVec const *iov,
+                           size_t                     iovcnt) {
+  /*
+   * See NaClHostDescPWrite for details for why need_lock is required.
+   */
+  int need_lock;
+  ssize_t retval;
+
+  NaClHostDescCheckValidity("NaClHostDescWritev", d);
+  if (NACL_ABI_O_RDONLY == (d->flags & NACL_ABI_O_ACCMODE)) {
+    NaClLog(3, "NaClHostDescWritev: RDONLY file\n");
+    return -NACL_ABI_EBADF;
+  }
+
+  need_lock = NACL_LINUX && (0 != (d->flags & NACL_ABI_O_APPEND));
+  if (need_lock) {
+    NaClHostDescExclusiveLock(d->d);
+  }
+  retval = writev(d->d, (struct iovec const *) iov, (int) iovcnt);
+  if (need_lock) {
+    NaClHostDescExclusiveUnlock(d->d);
+  }
+  if (-1 == retval) {
+    retval = -NaClXlateErrno(errno);
+  }
+  return retval;
+}
+
+ssize_t NaClHostDescPReadv(struct NaClHostDesc        *d,
+                           struct NaClHostIoVec const *iov,
+                           size_t                     iovcnt,
+                           nacl_off64_t               offset) {
+#if NACL_HAVE_PREADV
+  ssize_t retval;
+
+  NaClHostDescCheckValidity("NaClHostDescPReadv", d);
+  if (NACL_ABI_O_WRONLY == (d->flags & NACL_ABI_O_ACCMODE)) {
+    NaClLog(3, "NaClHostDescPReadv: WRONLY file\n");
+    return -NACL_ABI_EBADF;
+  }
+  return ((-1 == (retval = PREADV(d->d, (struct iovec const *) iov,
+                                  (int) iovcnt, offset)))
+          ? -NaClXlateErrno(errno) : retval);
+#else
+  return NaClHostDescIoVecByParts(d, iov, iovcnt, 0, 1, offset);
+#endif
+}
+
+ssize_t NaClHostDescPWritev(struct NaClHostDesc         *d,
+                            struct NaClHostIoVec const  *iov,
+                            size_t                      iovcnt,
+                            nacl_off64_t                offset) {
+#if NACL_HAVE_PREADV
+  ssize_t retval;
+
+  NaClHostDescCheckValidity("NaClHostDescPWritev", d);
+  if (NACL_ABI_O_RDONLY == (d->flags & NACL_ABI_O_ACCMODE)) {
+    NaClLog(3, "NaClHostDescPWritev: RDONLY file\n");
+    return -NACL_ABI_EBADF;
+  }
+  if (0 != (d->flags & NACL_ABI_O_APPEND)) {
+    /*
+     * pwritev on an O_APPEND descriptor appends on Linux, like pwrite;
+     * NaClHostDescPWrite has the workaround, so go through it.
+     */
+    return NaClHostDescIoVecByParts(d, iov, iovcnt, 1, 1, offset);
+  }
+  return ((-1 == (retval = PWRITEV(d->d, (struct iovec const *) iov,
+                                   (int) iovcnt, offset)))
+          ? -NaClXlateErrno(errno) : retval);
+#else
+  return NaClHostDescIoVecByParts(d, iov, iovcnt, 1, 1, offset);
+#endif
+}
+
+ssize_t NaClHostDescSendfile(struct NaClHostDesc *out,
+                             struct NaClHostDesc *in,
+                             nacl_off64_t        *offset,
+                             size_t              count) {
+#if NACL_LINUX
+  off64_t pos;
+  ssize_t retval;
+#endif
+
+  NaClHostDescCheckValidity("NaClHostDescSendfile", out);
+  NaClHostDescCheckValidity("NaClHostDescSendfile", in);
+  if (NACL_ABI_O_RDONLY == (out->flags & NACL_ABI_O_ACCMODE) ||
+      NACL_ABI_O_WRONLY == (in->flags & NACL_ABI_O_ACCMODE)) {
+    NaClLog(3, "NaClHostDescSendfile: bad access mode\n");
+    return -NACL_ABI_EBADF;
+  }
+#if NACL_LINUX
+  /*
+   * sendfile refuses O_APPEND outputs and some input types (e.g.,
+   * sockets, and pipes on older kernels) with EINVAL; those are handled
+   * by copying.  See NaClHostDescPWrite for why O_APPEND also needs
+   * the write lock, which NaClHostDescWrite takes.
+   */
+  if (0 == (out->flags & NACL_ABI_O_APPEND)) {
+    if (NULL != offset) {
+      pos = *offset;
+      retval = sendfile64(out->d, in->d, &pos, count);
+    } else {
+      retval = sendfile64(out->d, in->d, NULL, count);
+    }
+    if (retval >= 0) {
+      if (NULL != offset) {
+        *offset = pos;
+      }
+      return retval;
+    }
+    if (EINVAL != errno && ENOSYS != errno) {
+      return -NaClXlateErrno(errno);
+    }
+  }
+#endif
+  return NaClHostDescSendfileByCopy(out, in, offset, count);
+}
 
 int NaClHostDescIoctl(struct NaClHostDesc *d,
                       int                 request,
@@ -1324,6 +1324,56 @@ ssize_t NaClHostDescPWrite(struct NaClHostDesc *d,
   return bytes_sent;
 }
 
+/*
+ * Windows has no scatter/gather file I/O that works with arbitrary
+ * buffers (ReadFileScatter requires page-sized, page-aligned buffers on
+ * unbuffered handles), so the vectored operations are done by parts.
+ */
+
+ssize_t NaClHostDescReadv(struct NaClHostDesc         *d,
+                          struct NaClHostIoVec const  *iov,
+                          size_t                      iovcnt) {
+  return NaClHostDescIoVecByParts(d, iov, iovcnt, 0, 0, 0);
+}
+
+ssize_t NaClHostDescWritev(struct NaClHostDesc        *d,
+                           struct NaClHostIoVec const *iov,
+                           size_t                     iovcnt) {
+  return NaClHostDescIoVecByParts(d, iov, iovcnt, 1, 0, 0);
+}
+
+ssize_t NaClHostDescPReadv(struct NaClHostDesc        *d,
+                           struct NaClHostIoVec const *iov,
+                           size_t                     iovcnt,
+                           nacl_off64_t               offset) {
+  return NaClHostDescIoVecByParts(d, iov, iovcnt, 0, 1, offset);
+}
+
+ssize_t NaClHostDescPWritev(struct NaClHostDesc         *d,
+                            struct NaClHostIoVec const  *iov,
+                            size_t                      iovcnt,
+                            nacl_off64_t                offset) {
+  return NaClHostDescIoVecByParts(d, iov, iovcnt, 1, 1, offset);
+}
+
+/*
+ * TransmitFile only writes to sockets, and NaCl sinks are usually
+ * files or named pipes, so always copy.
+ */
+ssize_t NaClHostDescSendfile(struct NaClHostDesc *out,
+                             struct NaClHostDesc *in,
+                             nacl_off64_t        *offset,
+                             size_t              count) {
+  NaClHostDescCheckValidity("NaClHostDescSendfile", out);
+  NaClHostDescCheckValidity("NaClHostDescSendfile", in);
+  if (NACL_ABI_O_RDONLY == (out->flags & NACL_ABI_O_ACCMODE) ||
+      NACL_ABI_O_WRONLY == (in->flags & NACL_ABI_O_ACCMODE)) {
+    NaClLog(3, "NaClHostDescSendfile: bad access mode\n");
+    return -NACL_ABI_EBADF;
+  }
+  return NaClHostDescSendfileByCopy(out, in, offset, count);
+}
+
 int NaClHostDescIoctl(struct NaClHostDesc *d,
                       int                 request,
                       void                *arg) {
@@ -24,45 +24,23 @@
 
 
 /*
- * Utility method for type checking argument lists.
+ * Utility methods for type checking argument lists against a method's
+ * signature, which was precompiled when the service was constructed.
  */
-static int TypeCheckArgs(const char* arg_types, NaClSrpcArg** alist) {
-  const char* p;
+static int TypeCheckArgs(const NaClSrpcMethodDesc* method_desc,
+                         NaClSrpcArg** alist) {
+  return method_desc->input_types_valid &&
+      NaClSrpcTypesConform(method_desc->input_types,
+                           method_desc->input_count,
+                           alist);
+}
 
-  for (p = arg_types; '\0' != *p && ':' != *p; ++p, ++alist) {
-    if (NULL == *alist) {
-      /* Too few arguments */
-      return 0;
-    }
-    /* This code could be more compact by using a 256 entry table. */
-    switch (*p) {
-      case NACL_SRPC_ARG_TYPE_BOOL:
-      case NACL_SRPC_ARG_TYPE_CHAR_ARRAY:
-      case NACL_SRPC_ARG_TYPE_DOUBLE:
-      case NACL_SRPC_ARG_TYPE_DOUBLE_ARRAY:
-      case NACL_SRPC_ARG_TYPE_HANDLE:
-      case NACL_SRPC_ARG_TYPE_INT:
-      case NACL_SRPC_ARG_TYPE_INT_ARRAY:
-      case NACL_SRPC_ARG_TYPE_LONG:
-      case NACL_SRPC_ARG_TYPE_LONG_ARRAY:
-      case NACL_SRPC_ARG_TYPE_STRING:
-        if ((*alist)->tag != (enum NaClSrpcArgType) *p) {
-          return 0;
-        }
-        break;
-      /* These cases are added to avoid warnings.  */
-      case NACL_SRPC_ARG_TYPE_OBJECT:
-      case NACL_SRPC_ARG_TYPE_VARIANT_ARRAY:
-      case NACL_SRPC_ARG_TYPE_INVALID:
-      default:
-        return 0;
-    }
-  }
-  if (NULL != *alist) {
-    /* Too many arguments */
-    return 0;
-  }
-  return 1;
+static int TypeCheckRets(const NaClSrpcMethodDesc* method_desc,
+                         NaClSrpcArg** alist) {
+  return method_desc->output_types_valid &&
+      NaClSrpcTypesConform(method_desc->output_types,
+                           method_desc->output_count,
+                           alist);
 }
 
 /*
@@ -75,8 +53,8 @@ NaClSrpcError NaClSrpcInvokeV(NaClSrpcChannel* channel,
   int i;
   NaClSrpcRpc        rpc;
   NaClSrpcError      retval;
+  const NaClSrpcMethodDesc* method_desc;
   const char*        rpc_name;
-  const char*        arg_types;
   const char*        ret_types;
 
   if (NULL == channel) {
@@ -84,20 +62,19 @@ NaClSrpcError NaClSrpcInvokeV(NaClSrpcChannel* channel,
                 "NaClSrpcInvokeV: channel == NULL\n");
     return NACL_SRPC_RESULT_INTERNAL;
   }
-  if (NaClSrpcServiceMethodNameAndTypes(channel->client,
-                                        rpc_number,
-                                        &rpc_name,
-                                        &arg_types,
-                                        &ret_types)) {
+  method_desc = NaClSrpcServiceMethodDesc(channel->client, rpc_number);
+  if (NULL != method_desc) {
+    rpc_name = method_desc->name;
+    ret_types = method_desc->output_types;
     /* Check input parameters for type conformance */
-    if (!TypeCheckArgs(arg_types, args)) {
+    if (!TypeCheckArgs(method_desc, args)) {
       NaClSrpcLog(NACL_SRPC_LOG_ERROR,
                   "NaClSrpcInvokeV(channel=%p): input arg mismatch\n",
                   (void*) channel);
       return NACL_SRPC_RESULT_IN_ARG_TYPE_MISMATCH;
     }
     /* Check return values for type conformance */
-    if (!TypeCheckArgs(ret_types, rets)) {
+    if (!TypeCheckRets(method_desc, rets)) {
       NaClSrpcLog(NACL_SRPC_LOG_ERROR,
                   "NaClSrpcInvokeV(channel=%p): output arg mismatch\n",
                   (void*) channel);
@@ -136,8 +113,19 @@ NaClSrpcError NaClSrpcInvokeV(NaClSrpcChannel* channel,
   rpc.result = NACL_SRPC_RESULT_OK;
   rpc.rets = rets;
   rpc.ret_types = ret_types;
+  /*
+   * Take the receive role before sending, so that no async waiter on
+   * another thread can read the response meant for this call.
+   */
+  if (!NaClSrpcChannelReceiveLock(channel, 0)) {
+    NaClSrpcLog(NACL_SRPC_LOG_ERROR,
+                "NaClSrpcInvokeV(channel=%p): a server loop is receiving\n",
+                (void*) channel);
+    return NACL_SRPC_RESULT_INTERNAL;
+  }
   retval = NaClSrpcRequestWrite(channel, &rpc, args, rets);
   if (!retval) {
+    NaClSrpcChannelReceiveUnlock(channel, 0);
     NaClSrpcLog(NACL_SRPC_LOG_ERROR,
                 "NaClSrpcInvokeV(channel=%p): rpc request send failed\n",
                 (void*) channel);
@@ -146,6 +134,7 @@ NaClSrpcError NaClSrpcInvokeV(NaClSrpcChannel* channel,
 
   /* Then we wait for the response. */
   NaClSrpcRpcWait(channel, &rpc);
+  NaClSrpcChannelReceiveUnlock(channel, 0);
   NaClSrpcLog(1,
               "NaClSrpcInvokeV: response(channel=%p, rpc_number=%"NACL_PRIu32
               ", rpc_name=\"%s\", result=%d, string=\"%s\")\n",
@@ -168,6 +157,70 @@ NaClSrpcError NaClSrpcInvokeV(NaClSrpcChannel* channel,
   return rpc.result;
 }
 
+NaClSrpcError NaClSrpcInvokeAsyncV(NaClSrpcChannel* channel,
+                                   uint32_t rpc_number,
+                                   NaClSrpcArg* args[],
+                                   NaClSrpcArg* rets[],
+                                   NaClSrpcAsyncCallback callback,
+                                   void* tag,
+                                   NaClSrpcAsyncRpc** handle) {
+  NaClSrpcRpc*       rpc;
+  const NaClSrpcMethodDesc* method_desc;
+
+  if (NULL == channel) {
+    NaClSrpcLog(NACL_SRPC_LOG_ERROR,
+                "NaClSrpcInvokeAsyncV: channel == NULL\n");
+    return NACL_SRPC_RESULT_INTERNAL;
+  }
+  method_desc = NaClSrpcServiceMethodDesc(channel->client, rpc_number);
+  if (NULL == method_desc) {
+    NaClSrpcLog(NACL_SRPC_LOG_ERROR,
+                "NaClSrpcInvokeAsyncV(channel=%p): bad rpc number\n",
+                (void*) channel);
+    return NACL_SRPC_RESULT_BAD_RPC_NUMBER;
+  }
+  if (!TypeCheckArgs(method_desc, args)) {
+    NaClSrpcLog(NACL_SRPC_LOG_ERROR,
+                "NaClSrpcInvokeAsyncV(channel=%p): input arg mismatch\n",
+                (void*) channel);
+    return NACL_SRPC_RESULT_IN_ARG_TYPE_MISMATCH;
+  }
+  if (!TypeCheckRets(method_desc, rets)) {
+    NaClSrpcLog(NACL_SRPC_LOG_ERROR,
+                "NaClSrpcInvokeAsyncV(channel=%p): output arg mismatch\n",
+                (void*) channel);
+    return NACL_SRPC_RESULT_OUT_ARG_TYPE_MISMATCH;
+  }
+  rpc = NaClSrpcAsyncRpcRegister(channel, rpc_number,
+                                 method_desc->output_types, rets,
+                                 callback, tag);
+  if (NULL == rpc) {
+    NaClSrpcLog(NACL_SRPC_LOG_ERROR,
+                "NaClSrpcInvokeAsyncV(channel=%p): register failed\n",
+                (void*) channel);
+    return NACL_SRPC_RESULT_INTERNAL;
+  }
+  NaClSrpcLog(1,
+              "NaClSrpcInvokeAsyncV: request(channel=%p, rpc_number=%"
+              NACL_PRIu32", rpc_name=\"%s\", request_id=%"NACL_PRIu32")\n",
+              (void*) channel,
+              rpc_number,
+              method_desc->name,
+              rpc->request_id);
+  if (!NaClSrpcRequestWrite(channel, rpc, args, rets)) {
+    NaClSrpcLog(NACL_SRPC_LOG_ERROR,
+                "NaClSrpcInvokeAsyncV(channel=%p): rpc request send failed\n",
+                (void*) channel);
+    NaClSrpcAsyncRpcAbandon(channel, rpc);
+    return NACL_SRPC_RESULT_INTERNAL;
+  }
+  if (NULL != handle) {
+    *handle = (NULL == callback) ? (NaClSrpcAsyncRpc*) rpc : NULL;
+  }
+  NaClSrpcAsyncRpcSent(channel, rpc);
+  return NACL_SRPC_RESULT_OK;
+}
+
 /*
  * Parameter passing and return involves a significant amount of replication
  * that could be handled through templates.  What follows is a set of
@@ -313,7 +366,7 @@ NaClSrpcError NaClSrpcInvokeVaList(NaClSrpcChannel  *channel,
                                    uint32_t         rpc_num,
                                    va_list          in_va,
                                    va_list          out_va) {
-  char const        *rpc_name;
+  const NaClSrpcMethodDesc *method_desc;
   char const        *arg_types;
   char const        *ret_types;
   size_t            num_in;
@@ -330,11 +383,8 @@ NaClSrpcError NaClSrpcInvokeVaList(NaClSrpcChannel  *channel,
     return NACL_SRPC_RESULT_INTERNAL;
   }
 
-  if (!NaClSrpcServiceMethodNameAndTypes(channel->client,
-                                         rpc_num,
-                                         &rpc_name,
-                                         &arg_types,
-                                         &ret_types)) {
+  method_desc = NaClSrpcServiceMethodDesc(channel->client, rpc_num);
+  if (NULL == method_desc) {
     /*
      * If rpc_number is out of range, this will return an error before
      * communicating with the server.
@@ -342,8 +392,10 @@ NaClSrpcError NaClSrpcInvokeVaList(NaClSrpcChannel  *channel,
     return NACL_SRPC_RESULT_BAD_RPC_NUMBER;
   }
 
-  num_in = strlen(arg_types);
-  num_out = strlen(ret_types);
+  arg_types = method_desc->input_types;
+  ret_types = method_desc->output_types;
+  num_in = method_desc->input_count;
+  num_out = method_desc->output_count;
 
   if (NACL_SRPC_MAX_ARGS < num_in || NACL_SRPC_MAX_ARGS < num_out) {
     return NACL_SRPC_RESULT_APP_ERROR;
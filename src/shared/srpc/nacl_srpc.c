@@ -147,12 +147,23 @@ static int NaClSrpcChannelCtorHelper(NaClSrpcChannel* channel,
                 (void*) channel);
     return 0;
   }
+  /* Create the state used to track asynchronous requests. */
+  if (!NaClSrpcAsyncStateCtor(channel)) {
+    NaClSrpcLog(NACL_SRPC_LOG_ERROR,
+                "NaClSrpcChannelCtorHelper(channel=%p):"
+                " NaClSrpcAsyncStateCtor failed\n",
+                (void*) channel);
+    NaClSrpcMessageChannelDelete(channel->message_channel);
+    channel->message_channel = NULL;
+    return 0;
+  }
   return 1;
 }
 
 static void NaClSrpcChannelDtorHelper(NaClSrpcChannel* channel) {
   NaClSrpcLog(1, "NaClSrpcChannelDtorHelper(channel=%p)\n", (void*) channel);
   channel->server_instance_data = NULL;
+  NaClSrpcAsyncStateDtor(channel);
   NaClSrpcMessageChannelDelete(channel->message_channel);
   channel->message_channel = NULL;
 }
@@ -217,6 +228,8 @@ void NaClSrpcDtor(NaClSrpcChannel* channel) {
   if (NULL == channel) {
     return;
   }
+  /* Workers may still be running methods that refer to the services. */
+  NaClSrpcWorkersStop(channel);
   channel->server_instance_data = NULL;
   NaClSrpcServiceDtor(channel->client);
   free(channel->client);
@@ -487,6 +487,32 @@ int NaClSrpcServerLoop(NaClSrpcImcDescType              imc_socket_desc,
                        const struct NaClSrpcHandlerDesc methods[],
                        void                             *instance_data);
 
+/**
+ *  Runs an SRPC receive-dispatch-respond loop on the specified
+ *  NaClSrpcImcDescType object, handing each received request to one of a
+ *  pool of worker threads so that independent requests may be processed
+ *  concurrently.  Responses may therefore be sent in a different order than
+ *  requests were received.
+ *  @param imc_socket_desc A NaClSrpcImcDescType object that RPCs will
+ *  communicate over.
+ *  @param methods An array of NaClSrpcHandlerDesc structures
+ *  describing the set of services handled by this server.
+ *  @param instance_data A value to be stored on the channel
+ *  descriptor for conveying data specific to this particular server
+ *  instance.
+ *  @param num_workers The number of worker threads.  If zero, requests are
+ *  processed on the receiving thread as in NaClSrpcServerLoop.  Methods
+ *  run by workers may invoke asynchronous RPCs on the channel, but a
+ *  synchronous invocation fails with NACL_SRPC_RESULT_INTERNAL, as the
+ *  loop's thread holds the channel's receive role.
+ *  @return On success, 1; on failure, 0.
+ */
+int NaClSrpcServerLoopConcurrent(
+    NaClSrpcImcDescType              imc_socket_desc,
+    const struct NaClSrpcHandlerDesc methods[],
+    void                             *instance_data,
+    uint32_t                         num_workers);
+
 /**
  *  Initializes the SRPC module.
  *  @return Returns one on success, zero otherwise.
@@ -573,6 +599,73 @@ extern NaClSrpcError NaClSrpcInvokeVaList(NaClSrpcChannel *channel,
                                         va_list           in_va,
                                         va_list           out_va);
 
+/**
+ * An opaque handle describing an asynchronous RPC that has been sent but
+ * whose completion has not yet been reaped.
+ */
+typedef struct NaClSrpcAsyncRpc NaClSrpcAsyncRpc;
+
+/**
+ * Completion callbacks for asynchronous RPCs have this type signature.
+ * The callback runs on whichever thread received the response, and must
+ * not wait on the channel the RPC was issued on.
+ */
+typedef void (*NaClSrpcAsyncCallback)(NaClSrpcError result, void* tag);
+
+/**
+ *  @clientSrpc Sends a request for the specified RPC on the given channel
+ *  without waiting for the response.  Any number of requests may be
+ *  outstanding on a channel at once; responses are matched to requests by
+ *  request_id, and the server may complete them in any order.  Parameters
+ *  are type-checked as for NaClSrpcInvokeV.  The args vector may be reused
+ *  as soon as this returns; the rets vector must remain valid until the
+ *  RPC completes.
+ *  @param channel The channel descriptor to use to invoke the RPC.
+ *  @param rpc_num The index of the RPC to be invoked.
+ *  @param args The array of parameter pointers to arguments to be passed in.
+ *  @param rets The array of parameter pointers to arguments to be returned.
+ *  @param callback If non-NULL, called with the result when the RPC
+ *  completes, after which the RPC is reaped automatically.
+ *  @param tag A value passed to callback and returned by
+ *  NaClSrpcAsyncWaitAny to identify the RPC.
+ *  @param handle If non-NULL and callback is NULL, receives a handle that
+ *  must eventually be reaped by NaClSrpcAsyncWait or NaClSrpcAsyncWaitAny.
+ *  @return NACL_SRPC_RESULT_OK if the request was sent, otherwise an error
+ *  (in which case no callback is made and no handle is returned).
+ */
+extern NaClSrpcError NaClSrpcInvokeAsyncV(NaClSrpcChannel       *channel,
+                                          uint32_t              rpc_num,
+                                          NaClSrpcArg           *args[],
+                                          NaClSrpcArg           *rets[],
+                                          NaClSrpcAsyncCallback callback,
+                                          void                  *tag,
+                                          NaClSrpcAsyncRpc      **handle);
+
+/**
+ *  @clientSrpc Waits for the asynchronous RPC described by handle to
+ *  complete and reaps it.  While waiting, the calling thread may receive
+ *  responses for other outstanding RPCs on the channel and run their
+ *  callbacks.
+ *  @param channel The channel the RPC was invoked on.
+ *  @param handle A handle returned by NaClSrpcInvokeAsyncV.
+ *  @return The result of the RPC.
+ */
+extern NaClSrpcError NaClSrpcAsyncWait(NaClSrpcChannel   *channel,
+                                       NaClSrpcAsyncRpc  *handle);
+
+/**
+ *  @clientSrpc Waits for any handle-mode asynchronous RPC on the channel to
+ *  complete and reaps it.  Callbacks of other RPCs are run as their
+ *  responses arrive.
+ *  @param channel The channel to wait on.
+ *  @param tag Receives the tag of the completed RPC.
+ *  @param result Receives the result of the completed RPC.
+ *  @return 1 if an RPC was reaped, or 0 if no RPCs remain outstanding.
+ */
+extern int NaClSrpcAsyncWaitAny(NaClSrpcChannel  *channel,
+                                void             **tag,
+                                NaClSrpcError    *result);
+
 /**
  * The current protocol (version) number used to send and receive RPCs.
  */
@@ -78,11 +78,169 @@ void NaClSrpcFormatArg(int detail_level,
 # define UNREFERENCED_PARAMETER(P) do { (void) P; } while (0)
 #endif
 
+/*
+ * The struct used to describe methods within services.  The signature
+ * fields are precompiled when the service is constructed so that lookup
+ * and type checking on each call do not need to parse strings.
+ */
+struct NaClSrpcMethodDesc {
+  char const  *name;
+  char const  *input_types;
+  char const  *output_types;
+  /**
+   * function pointer used to process calls to the named method
+   */
+  NaClSrpcMethod handler;
+  /* The full "name:input_types:output_types" signature. */
+  char const  *signature;
+  uint32_t    input_count;
+  uint32_t    output_count;
+  /*
+   * Nonzero if every type in the list may be sent in a message, and there
+   * are at most NACL_SRPC_MAX_ARGS of them.
+   */
+  int         input_types_valid;
+  int         output_types_valid;
+  /*
+   * Only set in the service's first method description: a hash table
+   * mapping method signatures to indices in rpc_descr, built when the
+   * service is constructed.  The seed is chosen so that the hash is perfect
+   * for this set of methods.  hash_table is NULL if no such seed was
+   * found, in which case lookups search linearly.  This is kept here rather
+   * than in NaClSrpcService so that the public struct's layout is unchanged.
+   */
+  uint32_t    *hash_table;
+  /* The number of entries in hash_table, minus one. */
+  uint32_t    hash_mask;
+  uint32_t    hash_seed;
+};
+typedef struct NaClSrpcMethodDesc NaClSrpcMethodDesc;
+
+/*
+ * Returns the precompiled description of method rpc_number, or NULL if
+ * rpc_number is out of range.
+ */
+const NaClSrpcMethodDesc* NaClSrpcServiceMethodDesc(
+    const NaClSrpcService* service,
+    uint32_t rpc_number);
+
+/*
+ * Checks that the NULL-terminated vector alist has exactly count entries
+ * whose tags match types.  Returns 1 if so, 0 otherwise.
+ */
+int NaClSrpcTypesConform(const char* types,
+                         uint32_t count,
+                         NaClSrpcArg** alist);
+
 /*
  * Maximum sendmsg buffer size.
  */
 extern nacl_abi_size_t NaClSrpcMaxImcSendmsgSize;
 
+/*
+ * Support for asynchronous requests and concurrent dispatch (rpc_async.c).
+ * The async state is created for every channel by the channel constructors.
+ */
+int NaClSrpcAsyncStateCtor(NaClSrpcChannel* channel);
+
+void NaClSrpcAsyncStateDtor(NaClSrpcChannel* channel);
+
+/*
+ * Returns the channel's async state, or NULL if it has none.  The state
+ * hangs off the private message channel so that NaClSrpcChannel keeps its
+ * public layout.
+ */
+struct NaClSrpcAsyncState* NaClSrpcChannelAsyncState(
+    NaClSrpcChannel* channel);
+
+/*
+ * Message sends on a channel may come from several threads at once (async
+ * callers, or worker threads sending responses), so they are serialized.
+ */
+void NaClSrpcChannelSendLock(NaClSrpcChannel* channel);
+
+void NaClSrpcChannelSendUnlock(NaClSrpcChannel* channel);
+
+/*
+ * Only one thread at a time may receive messages on a channel.  Async
+ * waiters take turns receiving on each other's behalf; a synchronous
+ * invocation or a server loop holds the receive role until it has its
+ * response or exits.  The role is reentrant, so a method dispatched by the
+ * receiver may itself invoke on the channel.  A server loop passes serve.
+ * Returns 0, rather than blocking forever, if a server loop on another
+ * thread holds the role.
+ */
+int NaClSrpcChannelReceiveLock(NaClSrpcChannel* channel, int serve);
+
+void NaClSrpcChannelReceiveUnlock(NaClSrpcChannel* channel, int serve);
+
+/*
+ * Registers a new asynchronous request on the channel, assigning it a
+ * request_id.  Returns the rpc to be sent, or NULL on failure.
+ */
+NaClSrpcRpc* NaClSrpcAsyncRpcRegister(NaClSrpcChannel* channel,
+                                      uint32_t rpc_number,
+                                      const char* ret_types,
+                                      NaClSrpcArg** rets,
+                                      NaClSrpcAsyncCallback callback,
+                                      void* tag);
+
+/*
+ * Drops the sending thread's reference to an rpc whose request was sent.
+ * The rpc must not be used afterwards.
+ */
+void NaClSrpcAsyncRpcSent(NaClSrpcChannel* channel, NaClSrpcRpc* rpc);
+
+/*
+ * Unregisters an rpc whose request could not be sent, dropping the
+ * sending thread's reference.  If a receiver has already taken it, waits
+ * for the receiver to finish writing the response; its callback is not
+ * run unless the response had already been handed to it.
+ */
+void NaClSrpcAsyncRpcAbandon(NaClSrpcChannel* channel, NaClSrpcRpc* rpc);
+
+/*
+ * Removes and returns the outstanding asynchronous request with the given
+ * request_id, or returns NULL if there is none.  Called by the receiver.
+ */
+NaClSrpcRpc* NaClSrpcAsyncRpcTake(NaClSrpcChannel* channel,
+                                  uint32_t request_id);
+
+/*
+ * Records the response to a request returned by NaClSrpcAsyncRpcTake,
+ * running its callback if it has one.
+ */
+void NaClSrpcAsyncRpcComplete(NaClSrpcChannel* channel, NaClSrpcRpc* rpc);
+
+/*
+ * Receives and processes one message on behalf of asynchronous waiters.
+ * Returns 1 if the channel may still deliver messages, or 0 on EOF or a
+ * protocol error.
+ */
+int NaClSrpcAsyncReceiveOne(NaClSrpcChannel* channel);
+
+/*
+ * Starts and stops the worker pool used for concurrent dispatch.
+ */
+int NaClSrpcWorkersStart(NaClSrpcChannel* channel, uint32_t num_workers);
+
+void NaClSrpcWorkersStop(NaClSrpcChannel* channel);
+
+/*
+ * Queues fn(arg) to be run by a worker thread.  Returns 0 (without running
+ * fn) if the channel has no workers.
+ */
+int NaClSrpcWorkersEnqueue(NaClSrpcChannel* channel,
+                           void (*fn)(void* arg),
+                           void* arg);
+
+/*
+ * A worker records that a method requested the dispatch loop to exit.
+ */
+void NaClSrpcWorkersRequestBreak(NaClSrpcChannel* channel);
+
+int NaClSrpcWorkersBreakRequested(NaClSrpcChannel* channel);
+
 
 EXTERN_C_END
 
@@ -167,6 +167,8 @@ struct NaClSrpcMessageChannel {
   size_t byte_count;
   NaClSrpcMessageDesc descs[NACL_ABI_IMC_USER_DESC_MAX];
   size_t desc_count;
+  /* Owned by the NaClSrpcChannel; see NaClSrpcAsyncStateCtor. */
+  struct NaClSrpcAsyncState* async_state;
 };
 
 struct NaClSrpcMessageChannel* NaClSrpcMessageChannelNew(
@@ -183,6 +185,7 @@ struct NaClSrpcMessageChannel* NaClSrpcMessageChannelNew(
   }
   channel->byte_count = 0;
   channel->desc_count = 0;
+  channel->async_state = NULL;
   return channel;
 }
 
@@ -193,6 +196,17 @@ void NaClSrpcMessageChannelDelete(struct NaClSrpcMessageChannel* channel) {
   }
 }
 
+struct NaClSrpcAsyncState* NaClSrpcMessageChannelAsyncState(
+    struct NaClSrpcMessageChannel* channel) {
+  return channel->async_state;
+}
+
+void NaClSrpcMessageChannelSetAsyncState(
+    struct NaClSrpcMessageChannel* channel,
+    struct NaClSrpcAsyncState* async_state) {
+  channel->async_state = async_state;
+}
+
 /*
  * Read the next fragment of a message into channel's buffer.
  */
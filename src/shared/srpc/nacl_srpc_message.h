@@ -43,6 +43,21 @@ struct NaClSrpcMessageChannel* NaClSrpcMessageChannelNew(
  */
 void NaClSrpcMessageChannelDelete(struct NaClSrpcMessageChannel* channel);
 
+/*
+ * The state used by rpc_async.c to track asynchronous requests on the
+ * channel.  It is kept here, rather than in the public NaClSrpcChannel,
+ * so that the layout of NaClSrpcChannel stays unchanged.  The message
+ * channel does not own it.
+ */
+struct NaClSrpcAsyncState;
+
+struct NaClSrpcAsyncState* NaClSrpcMessageChannelAsyncState(
+    struct NaClSrpcMessageChannel* channel);
+
+void NaClSrpcMessageChannelSetAsyncState(
+    struct NaClSrpcMessageChannel* channel,
+    struct NaClSrpcAsyncState* async_state);
+
 /*
  * Messages to be sent or received are described by a message header.
  */
@@ -0,0 +1,682 @@
+/*
+ * Copyright (c) 2012 The Native Client Authors. All rights reserved.
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+/*
+ * NaCl SRPC library.  Support for multiple outstanding requests per
+ * channel, and for dispatching received requests to a pool of workers.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "native_client/src/include/portability.h"
+#include "native_client/src/include/nacl_macros.h"
+#include "native_client/src/shared/platform/nacl_check.h"
+#include "native_client/src/shared/platform/nacl_sync.h"
+#include "native_client/src/shared/platform/nacl_sync_checked.h"
+#include "native_client/src/shared/platform/nacl_threads.h"
+#include "native_client/src/shared/srpc/nacl_srpc.h"
+#include "native_client/src/shared/srpc/nacl_srpc_internal.h"
+#include "native_client/src/shared/srpc/nacl_srpc_message.h"
+
+/*
+ * Outstanding requests are kept in a small hash table keyed by request_id.
+ * Request ids are allocated sequentially, so the low bits spread well.
+ */
+#define NACL_SRPC_ASYNC_BUCKETS 64
+
+#define NACL_SRPC_WORKER_STACK_SIZE (128 << 10)
+
+/*
+ * An asynchronous invocation.  rpc must be the first member, as the
+ * receive path only knows about NaClSrpcRpc.
+ *
+ * The sending thread and the completion path each hold a reference,
+ * counted in refs under mu; whichever drops the last one frees the rpc.
+ * The completion reference belongs to the pending table until a
+ * receiver takes the rpc, then to the receiver, and for handle-mode
+ * rpcs to the completed list until the rpc is reaped.
+ */
+struct NaClSrpcAsyncRpc {
+  NaClSrpcRpc               rpc;
+  NaClSrpcAsyncCallback     callback;
+  void                      *tag;
+  uint32_t                  refs;
+  /* Set once the receiver has finished writing the response. */
+  int                       completed;
+  /*
+   * Set when the request could not be sent but a receiver had already
+   * taken the rpc.  The receiver completes it without running the
+   * callback or queueing it for a reap.
+   */
+  int                       abandoned;
+  struct NaClSrpcAsyncRpc   *next;
+};
+
+struct NaClSrpcWork {
+  void                      (*fn)(void* arg);
+  void                      *arg;
+  struct NaClSrpcWork       *next;
+};
+
+struct NaClSrpcAsyncState {
+  /* Serializes sends on the message channel. */
+  struct NaClMutex          send_mu;
+
+  /* mu protects everything below. */
+  struct NaClMutex          mu;
+  struct NaClCondVar        cv;
+  uint32_t                  next_request_id;
+  /*
+   * Nonzero while some thread is receiving, either on behalf of async
+   * waiters or for its own synchronous invocation; the count is the
+   * receiver's nesting depth.  Only one thread receives at a time; the
+   * others wait on cv.
+   */
+  uint32_t                  receiving;
+  uint32_t                  receiver;
+  /* Set while a server loop holds the receive role until it exits. */
+  int                       serving;
+  /* Set once the channel has failed; no more responses will arrive. */
+  int                       failed;
+  uint32_t                  outstanding;
+  struct NaClSrpcAsyncRpc   *pending[NACL_SRPC_ASYNC_BUCKETS];
+  /* Completed handle-mode rpcs, oldest first, awaiting a reap. */
+  struct NaClSrpcAsyncRpc   *completed;
+  struct NaClSrpcAsyncRpc   **completed_tail;
+
+  /* The worker pool, if NaClSrpcWorkersStart was called. */
+  struct NaClCondVar        work_cv;
+  struct NaClThread         *workers;
+  uint32_t                  num_workers;
+  int                       workers_should_exit;
+  int                       break_requested;
+  struct NaClSrpcWork       *work_head;
+  struct NaClSrpcWork       **work_tail;
+};
+
+struct NaClSrpcAsyncState* NaClSrpcChannelAsyncState(
+    NaClSrpcChannel* channel) {
+  if (NULL == channel->message_channel) {
+    return NULL;
+  }
+  return NaClSrpcMessageChannelAsyncState(channel->message_channel);
+}
+
+int NaClSrpcAsyncStateCtor(NaClSrpcChannel* channel) {
+  struct NaClSrpcAsyncState* state;
+
+  state = (struct NaClSrpcAsyncState*) malloc(sizeof *state);
+  if (NULL == state) {
+    return 0;
+  }
+  memset(state, 0, sizeof *state);
+  NaClXMutexCtor(&state->send_mu);
+  NaClXMutexCtor(&state->mu);
+  NaClXCondVarCtor(&state->cv);
+  NaClXCondVarCtor(&state->work_cv);
+  /* Request id zero is reserved for synchronous invocations. */
+  state->next_request_id = 1;
+  state->completed_tail = &state->completed;
+  state->work_tail = &state->work_head;
+  NaClSrpcMessageChannelSetAsyncState(channel->message_channel, state);
+  return 1;
+}
+
+static void FreeRpcList(struct NaClSrpcAsyncRpc* list) {
+  while (NULL != list) {
+    struct NaClSrpcAsyncRpc* next = list->next;
+    free(list);
+    list = next;
+  }
+}
+
+void NaClSrpcAsyncStateDtor(NaClSrpcChannel* channel) {
+  struct NaClSrpcAsyncState* state = NaClSrpcChannelAsyncState(channel);
+  size_t i;
+
+  if (NULL == state) {
+    return;
+  }
+  NaClSrpcWorkersStop(channel);
+  for (i = 0; i < NACL_ARRAY_SIZE(state->pending); ++i) {
+    FreeRpcList(state->pending[i]);
+  }
+  FreeRpcList(state->completed);
+  NaClCondVarDtor(&state->work_cv);
+  NaClCondVarDtor(&state->cv);
+  NaClMutexDtor(&state->mu);
+  NaClMutexDtor(&state->send_mu);
+  NaClSrpcMessageChannelSetAsyncState(channel->message_channel, NULL);
+  free(state);
+}
+
+void NaClSrpcChannelSendLock(NaClSrpcChannel* channel) {
+  struct NaClSrpcAsyncState* state = NaClSrpcChannelAsyncState(channel);
+
+  if (NULL != state) {
+    NaClXMutexLock(&state->send_mu);
+  }
+}
+
+void NaClSrpcChannelSendUnlock(NaClSrpcChannel* channel) {
+  struct NaClSrpcAsyncState* state = NaClSrpcChannelAsyncState(channel);
+
+  if (NULL != state) {
+    NaClXMutexUnlock(&state->send_mu);
+  }
+}
+
+/*
+ * Drops a reference to arpc.  Called with mu held; returns nonzero if
+ * that was the last one, in which case the caller frees arpc once it
+ * has dropped mu.
+ */
+static int ReleaseLocked(struct NaClSrpcAsyncRpc* arpc) {
+  CHECK(0 != arpc->refs);
+  return 0 == --arpc->refs;
+}
+
+static struct NaClSrpcAsyncRpc** Bucket(struct NaClSrpcAsyncState* state,
+                                        uint32_t request_id) {
+  return &state->pending[request_id % NACL_SRPC_ASYNC_BUCKETS];
+}
+
+/* Unlinks the pending rpc with the given id.  Called with mu held. */
+static struct NaClSrpcAsyncRpc* UnlinkPending(struct NaClSrpcAsyncState* state,
+                                              uint32_t request_id) {
+  struct NaClSrpcAsyncRpc** link;
+
+  for (link = Bucket(state, request_id); NULL != *link; link = &(*link)->next) {
+    struct NaClSrpcAsyncRpc* arpc = *link;
+    if (arpc->rpc.request_id == request_id) {
+      *link = arpc->next;
+      arpc->next = NULL;
+      return arpc;
+    }
+  }
+  return NULL;
+}
+
+NaClSrpcRpc* NaClSrpcAsyncRpcRegister(NaClSrpcChannel* channel,
+                                      uint32_t rpc_number,
+                                      const char* ret_types,
+                                      NaClSrpcArg** rets,
+                                      NaClSrpcAsyncCallback callback,
+                                      void* tag) {
+  struct NaClSrpcAsyncState* state = NaClSrpcChannelAsyncState(channel);
+  struct NaClSrpcAsyncRpc* arpc;
+  struct NaClSrpcAsyncRpc** bucket;
+
+  if (NULL == state) {
+    return NULL;
+  }
+  arpc = (struct NaClSrpcAsyncRpc*) malloc(sizeof *arpc);
+  if (NULL == arpc) {
+    return NULL;
+  }
+  memset(arpc, 0, sizeof *arpc);
+  arpc->rpc.protocol_version = kNaClSrpcProtocolVersion;
+  arpc->rpc.rpc_number = rpc_number;
+  arpc->rpc.result = NACL_SRPC_RESULT_OK;
+  arpc->rpc.channel = channel;
+  arpc->rpc.ret_types = ret_types;
+  arpc->rpc.rets = rets;
+  arpc->callback = callback;
+  arpc->tag = tag;
+  /* One for the sending thread, one for the completion path. */
+  arpc->refs = 2;
+
+  NaClXMutexLock(&state->mu);
+  if (state->failed) {
+    NaClXMutexUnlock(&state->mu);
+    free(arpc);
+    return NULL;
+  }
+  /*
+   * The request is registered before it is sent, as another thread may be
+   * receiving and could see the response before the send returns.
+   */
+  do {
+    arpc->rpc.request_id = state->next_request_id++;
+  } while (0 == arpc->rpc.request_id);
+  bucket = Bucket(state, arpc->rpc.request_id);
+  arpc->next = *bucket;
+  *bucket = arpc;
+  ++state->outstanding;
+  NaClXMutexUnlock(&state->mu);
+  return &arpc->rpc;
+}
+
+void NaClSrpcAsyncRpcSent(NaClSrpcChannel* channel, NaClSrpcRpc* rpc) {
+  struct NaClSrpcAsyncState* state = NaClSrpcChannelAsyncState(channel);
+  struct NaClSrpcAsyncRpc* arpc = (struct NaClSrpcAsyncRpc*) rpc;
+  int free_it;
+
+  NaClXMutexLock(&state->mu);
+  free_it = ReleaseLocked(arpc);
+  NaClXMutexUnlock(&state->mu);
+  if (free_it) {
+    free(arpc);
+  }
+}
+
+/*
+ * Removes arpc from the completed list.  Called with mu held; returns
+ * nonzero if it was there.
+ */
+static int UnlinkCompleted(struct NaClSrpcAsyncState* state,
+                           struct NaClSrpcAsyncRpc* arpc) {
+  struct NaClSrpcAsyncRpc** link;
+
+  for (link = &state->completed; NULL != *link; link = &(*link)->next) {
+    if (*link == arpc) {
+      *link = arpc->next;
+      if (NULL == *link) {
+        state->completed_tail = link;
+      }
+      arpc->next = NULL;
+      return 1;
+    }
+  }
+  return 0;
+}
+
+void NaClSrpcAsyncRpcAbandon(NaClSrpcChannel* channel, NaClSrpcRpc* rpc) {
+  struct NaClSrpcAsyncState* state = NaClSrpcChannelAsyncState(channel);
+  struct NaClSrpcAsyncRpc* arpc = (struct NaClSrpcAsyncRpc*) rpc;
+  int free_it;
+
+  NaClXMutexLock(&state->mu);
+  if (NULL != UnlinkPending(state, rpc->request_id)) {
+    --state->outstanding;
+    /* The completion reference, which the pending table held. */
+    (void) ReleaseLocked(arpc);
+  } else if (!arpc->completed) {
+    /*
+     * Part of the request reached the server and a receiver has already
+     * taken the rpc to complete it.  The receiver is writing into the
+     * caller's rets, so wait for it to finish rather than return while
+     * it may still do so.  It drops its own reference.
+     */
+    arpc->abandoned = 1;
+    while (!arpc->completed) {
+      NaClXCondVarWait(&state->cv, &state->mu);
+    }
+  } else if (UnlinkCompleted(state, arpc)) {
+    /*
+     * The response arrived before the send reported failure.  The
+     * caller gets no handle to reap it with, so drop it here.
+     */
+    (void) ReleaseLocked(arpc);
+  }
+  /*
+   * Otherwise the response is being, or has been, delivered to the
+   * callback, whose thread drops the completion reference.
+   */
+  free_it = ReleaseLocked(arpc);
+  NaClXCondVarBroadcast(&state->cv);
+  NaClXMutexUnlock(&state->mu);
+  if (free_it) {
+    free(arpc);
+  }
+}
+
+NaClSrpcRpc* NaClSrpcAsyncRpcTake(NaClSrpcChannel* channel,
+                                  uint32_t request_id) {
+  struct NaClSrpcAsyncState* state = NaClSrpcChannelAsyncState(channel);
+  struct NaClSrpcAsyncRpc* arpc;
+
+  if (NULL == state || 0 == request_id) {
+    return NULL;
+  }
+  NaClXMutexLock(&state->mu);
+  arpc = UnlinkPending(state, request_id);
+  NaClXMutexUnlock(&state->mu);
+  if (NULL == arpc) {
+    return NULL;
+  }
+  return &arpc->rpc;
+}
+
+void NaClSrpcAsyncRpcComplete(NaClSrpcChannel* channel, NaClSrpcRpc* rpc) {
+  struct NaClSrpcAsyncState* state = NaClSrpcChannelAsyncState(channel);
+  struct NaClSrpcAsyncRpc* arpc = (struct NaClSrpcAsyncRpc*) rpc;
+  int free_it;
+
+  /*
+   * Whether the rpc was abandoned is decided in the same critical
+   * section that hands it on, so NaClSrpcAsyncRpcAbandon either sees it
+   * still in the receiver's hands or already handed on.
+   */
+  NaClXMutexLock(&state->mu);
+  arpc->completed = 1;
+  --state->outstanding;
+  if (arpc->abandoned) {
+    /* NaClSrpcAsyncRpcAbandon is waiting for this. */
+    free_it = ReleaseLocked(arpc);
+  } else if (NULL == arpc->callback) {
+    /* The completed list takes over the completion reference. */
+    *state->completed_tail = arpc;
+    state->completed_tail = &arpc->next;
+    free_it = 0;
+  } else {
+    NaClXMutexUnlock(&state->mu);
+    (*arpc->callback)(arpc->rpc.result, arpc->tag);
+    NaClXMutexLock(&state->mu);
+    free_it = ReleaseLocked(arpc);
+  }
+  NaClXCondVarBroadcast(&state->cv);
+  NaClXMutexUnlock(&state->mu);
+  if (free_it) {
+    free(arpc);
+  }
+}
+
+/*
+ * Fails every outstanding request after the channel has hit EOF or a
+ * protocol error.  Called with mu held; drops it to run callbacks.
+ */
+static void FailAllPendingLocked(NaClSrpcChannel* channel) {
+  struct NaClSrpcAsyncState* state = NaClSrpcChannelAsyncState(channel);
+  struct NaClSrpcAsyncRpc* failed = NULL;
+  size_t i;
+
+  state->failed = 1;
+  for (i = 0; i < NACL_ARRAY_SIZE(state->pending); ++i) {
+    while (NULL != state->pending[i]) {
+      struct NaClSrpcAsyncRpc* arpc = state->pending[i];
+      state->pending[i] = arpc->next;
+      arpc->next = failed;
+      failed = arpc;
+    }
+  }
+  NaClXMutexUnlock(&state->mu);
+  while (NULL != failed) {
+    struct NaClSrpcAsyncRpc* arpc = failed;
+    failed = arpc->next;
+    arpc->next = NULL;
+    arpc->rpc.result = NACL_SRPC_RESULT_INTERNAL;
+    NaClSrpcAsyncRpcComplete(channel, &arpc->rpc);
+  }
+  NaClXMutexLock(&state->mu);
+}
+
+/*
+ * Returns nonzero if a thread other than the caller is receiving.  Called
+ * with mu held.
+ */
+static int OtherThreadReceivingLocked(struct NaClSrpcAsyncState* state) {
+  return 0 != state->receiving && NaClThreadId() != state->receiver;
+}
+
+int NaClSrpcChannelReceiveLock(NaClSrpcChannel* channel, int serve) {
+  struct NaClSrpcAsyncState* state = NaClSrpcChannelAsyncState(channel);
+
+  if (NULL == state) {
+    return 1;
+  }
+  NaClXMutexLock(&state->mu);
+  while (OtherThreadReceivingLocked(state)) {
+    if (state->serving) {
+      /*
+       * A server loop receives until it exits, so waiting for it would
+       * block forever.
+       */
+      NaClXMutexUnlock(&state->mu);
+      return 0;
+    }
+    NaClXCondVarWait(&state->cv, &state->mu);
+  }
+  state->receiver = NaClThreadId();
+  ++state->receiving;
+  if (serve) {
+    state->serving = 1;
+  }
+  NaClXMutexUnlock(&state->mu);
+  return 1;
+}
+
+void NaClSrpcChannelReceiveUnlock(NaClSrpcChannel* channel, int serve) {
+  struct NaClSrpcAsyncState* state = NaClSrpcChannelAsyncState(channel);
+
+  if (NULL == state) {
+    return;
+  }
+  NaClXMutexLock(&state->mu);
+  CHECK(0 != state->receiving && NaClThreadId() == state->receiver);
+  --state->receiving;
+  if (serve) {
+    state->serving = 0;
+  }
+  NaClXCondVarBroadcast(&state->cv);
+  NaClXMutexUnlock(&state->mu);
+}
+
+/*
+ * Makes progress on the channel: if no other thread is receiving, this one
+ * receives and processes one message; otherwise it waits for the receiver
+ * to report progress.  Called with mu held.
+ */
+static void MakeProgressLocked(NaClSrpcChannel* channel) {
+  struct NaClSrpcAsyncState* state = NaClSrpcChannelAsyncState(channel);
+  int alive;
+
+  if (OtherThreadReceivingLocked(state)) {
+    NaClXCondVarWait(&state->cv, &state->mu);
+    return;
+  }
+  state->receiver = NaClThreadId();
+  ++state->receiving;
+  NaClXMutexUnlock(&state->mu);
+  alive = NaClSrpcAsyncReceiveOne(channel);
+  NaClXMutexLock(&state->mu);
+  --state->receiving;
+  if (!alive) {
+    NaClSrpcLog(NACL_SRPC_LOG_ERROR,
+                "MakeProgressLocked(channel=%p): channel failed with %"
+                NACL_PRIu32" requests outstanding\n",
+                (void*) channel,
+                state->outstanding);
+    FailAllPendingLocked(channel);
+  }
+  /* Let another waiter take over receiving if this one is done. */
+  NaClXCondVarBroadcast(&state->cv);
+}
+
+NaClSrpcError NaClSrpcAsyncWait(NaClSrpcChannel* channel,
+                                NaClSrpcAsyncRpc* handle) {
+  struct NaClSrpcAsyncState* state;
+  NaClSrpcError result;
+  int free_it;
+
+  if (NULL == channel || NULL == handle) {
+    NaClSrpcLog(NACL_SRPC_LOG_ERROR,
+                "NaClSrpcAsyncWait: bad channel or handle\n");
+    return NACL_SRPC_RESULT_INTERNAL;
+  }
+  state = NaClSrpcChannelAsyncState(channel);
+  if (NULL == state) {
+    NaClSrpcLog(NACL_SRPC_LOG_ERROR,
+                "NaClSrpcAsyncWait: bad channel or handle\n");
+    return NACL_SRPC_RESULT_INTERNAL;
+  }
+  NaClXMutexLock(&state->mu);
+  while (!handle->completed) {
+    MakeProgressLocked(channel);
+  }
+  (void) UnlinkCompleted(state, handle);
+  result = handle->rpc.result;
+  free_it = ReleaseLocked(handle);
+  NaClXMutexUnlock(&state->mu);
+  if (free_it) {
+    free(handle);
+  }
+  return result;
+}
+
+int NaClSrpcAsyncWaitAny(NaClSrpcChannel* channel,
+                         void** tag,
+                         NaClSrpcError* result) {
+  struct NaClSrpcAsyncState* state;
+  struct NaClSrpcAsyncRpc* arpc;
+  int free_it;
+
+  if (NULL == channel) {
+    return 0;
+  }
+  state = NaClSrpcChannelAsyncState(channel);
+  if (NULL == state) {
+    return 0;
+  }
+  NaClXMutexLock(&state->mu);
+  while (NULL == state->completed && 0 != state->outstanding) {
+    MakeProgressLocked(channel);
+  }
+  arpc = state->completed;
+  if (NULL == arpc) {
+    NaClXMutexUnlock(&state->mu);
+    return 0;
+  }
+  (void) UnlinkCompleted(state, arpc);
+  *tag = arpc->tag;
+  *result = arpc->rpc.result;
+  free_it = ReleaseLocked(arpc);
+  NaClXMutexUnlock(&state->mu);
+  if (free_it) {
+    free(arpc);
+  }
+  return 1;
+}
+
+/*
+ * The worker pool.
+ */
+static void WINAPI WorkerThread(void* arg) {
+  NaClSrpcChannel* channel = (NaClSrpcChannel*) arg;
+  struct NaClSrpcAsyncState* state = NaClSrpcChannelAsyncState(channel);
+
+  NaClXMutexLock(&state->mu);
+  for (;;) {
+    struct NaClSrpcWork* work;
+
+    while (NULL == state->work_head && !state->workers_should_exit) {
+      NaClXCondVarWait(&state->work_cv, &state->mu);
+    }
+    work = state->work_head;
+    if (NULL == work) {
+      /* Exit only once the queue has drained. */
+      break;
+    }
+    state->work_head = work->next;
+    if (NULL == state->work_head) {
+      state->work_tail = &state->work_head;
+    }
+    NaClXMutexUnlock(&state->mu);
+    (*work->fn)(work->arg);
+    free(work);
+    NaClXMutexLock(&state->mu);
+  }
+  NaClXMutexUnlock(&state->mu);
+}
+
+int NaClSrpcWorkersStart(NaClSrpcChannel* channel, uint32_t num_workers) {
+  struct NaClSrpcAsyncState* state = NaClSrpcChannelAsyncState(channel);
+  uint32_t i;
+
+  CHECK(NULL != state);
+  CHECK(NULL == state->workers);
+  if (0 == num_workers) {
+    return 1;
+  }
+  state->workers = (struct NaClThread*) calloc(num_workers,
+                                               sizeof *state->workers);
+  if (NULL == state->workers) {
+    return 0;
+  }
+  for (i = 0; i < num_workers; ++i) {
+    if (!NaClThreadCreateJoinable(&state->workers[i], WorkerThread, channel,
+                                  NACL_SRPC_WORKER_STACK_SIZE)) {
+      NaClSrpcLog(NACL_SRPC_LOG_ERROR,
+                  "NaClSrpcWorkersStart(channel=%p): thread %"NACL_PRIu32
+                  " creation failed\n",
+                  (void*) channel,
+                  i);
+      break;
+    }
+    state->num_workers = i + 1;
+  }
+  if (state->num_workers < num_workers) {
+    NaClSrpcWorkersStop(channel);
+    return 0;
+  }
+  return 1;
+}
+
+void NaClSrpcWorkersStop(NaClSrpcChannel* channel) {
+  struct NaClSrpcAsyncState* state = NaClSrpcChannelAsyncState(channel);
+  uint32_t i;
+
+  if (NULL == state || NULL == state->workers) {
+    return;
+  }
+  NaClXMutexLock(&state->mu);
+  state->workers_should_exit = 1;
+  NaClXCondVarBroadcast(&state->work_cv);
+  NaClXMutexUnlock(&state->mu);
+  for (i = 0; i < state->num_workers; ++i) {
+    NaClThreadJoin(&state->workers[i]);
+  }
+  free(state->workers);
+  state->workers = NULL;
+  state->num_workers = 0;
+  state->workers_should_exit = 0;
+}
+
+int NaClSrpcWorkersEnqueue(NaClSrpcChannel* channel,
+                           void (*fn)(void* arg),
+                           void* arg) {
+  struct NaClSrpcAsyncState* state = NaClSrpcChannelAsyncState(channel);
+  struct NaClSrpcWork* work;
+
+  if (NULL == state || NULL == state->workers) {
+    return 0;
+  }
+  work = (struct NaClSrpcWork*) malloc(sizeof *work);
+  if (NULL == work) {
+    return 0;
+  }
+  work->fn = fn;
+  work->arg = arg;
+  work->next = NULL;
+  NaClXMutexLock(&state->mu);
+  *state->work_tail = work;
+  state->work_tail = &work->next;
+  NaClXCondVarSignal(&state->work_cv);
+  NaClXMutexUnlock(&state->mu);
+  return 1;
+}
+
+void NaClSrpcWorkersRequestBreak(NaClSrpcChannel* channel) {
+  struct NaClSrpcAsyncState* state = NaClSrpcChannelAsyncState(channel);
+
+  NaClXMutexLock(&state->mu);
+  state->break_requested = 1;
+  NaClXMutexUnlock(&state->mu);
+}
+
+int NaClSrpcWorkersBreakRequested(NaClSrpcChannel* channel) {
+  struct NaClSrpcAsyncState* state = NaClSrpcChannelAsyncState(channel);
+  int break_requested;
+
+  if (NULL == state) {
+    return 0;
+  }
+  NaClXMutexLock(&state->mu);
+  break_requested = state->break_requested;
+  NaClXMutexUnlock(&state->mu);
+  return break_requested;
+}
@@ -904,7 +904,9 @@ static void RpcCheckingClosureRun(NaClSrpcClosure* self) {
     rpc->result = NACL_SRPC_RESULT_OK;
     rpc->dispatch_loop_should_continue = 0;
   }
+  NaClSrpcChannelSendLock(rpc->channel);
   retval = SrpcSendMessage(rpc, NULL, rpc->rets, rpc->channel->message_channel);
+  NaClSrpcChannelSendUnlock(rpc->channel);
   if (retval < 0) {
     /* If the response write failed, drop request and continue. */
     NaClSrpcLog(NACL_SRPC_LOG_ERROR,
@@ -925,52 +927,85 @@ static BoolValue RequestVectorTypesConform(NaClSrpcChannel* channel,
                                            NaClSrpcRpc* rpc,
                                            NaClSrpcArg** args,
                                            NaClSrpcArg** rets) {
-  const char* rpc_name;
-  const char* arg_types;
-  const char* ret_types;
-  ssize_t retval;
-  size_t i;
+  const NaClSrpcMethodDesc* method_desc;
 
   if (rpc->value_len > NACL_SRPC_MAX_ARGS ||
       rpc->template_len > NACL_SRPC_MAX_ARGS) {
     return BoolFalse;
   }
-  /* Get service discovery's remembered types for args and rets */
-  retval = NaClSrpcServiceMethodNameAndTypes(channel->server,
-                                             rpc->rpc_number,
-                                             &rpc_name,
-                                             &arg_types,
-                                             &ret_types);
-  if (!retval) {
+  /* Get the signature precompiled when the service was constructed. */
+  method_desc = NaClSrpcServiceMethodDesc(channel->server, rpc->rpc_number);
+  if (NULL == method_desc) {
     return BoolFalse;
   }
   /* Check that lengths match. */
-  if (rpc->value_len != strlen(arg_types) ||
-      rpc->template_len != strlen(ret_types)) {
+  if (rpc->value_len != method_desc->input_count ||
+      rpc->template_len != method_desc->output_count) {
     return BoolFalse;
   }
-  /* Check args for type conformance. */
-  for (i = 0; i < rpc->value_len; ++i) {
-    if (args[i] == NULL) {
-      return BoolFalse;
-    }
-    if (args[i]->tag != (unsigned char) arg_types[i]) {
-      return BoolFalse;
-    }
+  /* Check args and rets for type conformance. */
+  if (!NaClSrpcTypesConform(method_desc->input_types,
+                            method_desc->input_count,
+                            args) ||
+      !NaClSrpcTypesConform(method_desc->output_types,
+                            method_desc->output_count,
+                            rets)) {
+    return BoolFalse;
   }
-  if (args[rpc->value_len] != NULL) {
+  return BoolTrue;
+}
+
+/*
+ * A request handed off to a worker thread by a concurrent server.  The
+ * worker owns the copied rpc, the argument vectors, and the closure.
+ */
+typedef struct DispatchWork {
+  NaClSrpcRpc rpc;
+  NaClSrpcMethod method;
+  NaClSrpcArg* args[NACL_SRPC_MAX_ARGS + 1];
+  NaClSrpcArg* rets[NACL_SRPC_MAX_ARGS + 1];
+  RpcCheckingClosure* closure;
+} DispatchWork;
+
+static void RunDispatchWork(void* arg) {
+  DispatchWork* work = (DispatchWork*) arg;
+  NaClSrpcChannel* channel = work->rpc.channel;
+
+  (*work->method)(&work->rpc, work->args, work->rets,
+                  (NaClSrpcClosure*) work->closure);
+  if (!work->rpc.dispatch_loop_should_continue) {
+    NaClSrpcWorkersRequestBreak(channel);
+  }
+  FreeArgs(work->args);
+  FreeArgs(work->rets);
+  free(work);
+}
+
+static BoolValue DispatchToWorker(NaClSrpcChannel* channel,
+                                  NaClSrpcRpc* rpc,
+                                  NaClSrpcMethod method,
+                                  NaClSrpcArg** args,
+                                  NaClSrpcArg** rets,
+                                  RpcCheckingClosure* closure) {
+  DispatchWork* work;
+
+  if (NULL == NaClSrpcChannelAsyncState(channel)) {
     return BoolFalse;
   }
-  /* Check rets for type conformance. */
-  for (i = 0; i < rpc->template_len; ++i) {
-    if (rets[i] == NULL) {
-      return BoolFalse;
-    }
-    if (rets[i]->tag != (unsigned char) ret_types[i]) {
-      return BoolFalse;
-    }
+  work = (DispatchWork*) malloc(sizeof *work);
+  if (NULL == work) {
+    return BoolFalse;
   }
-  if (rets[rpc->template_len] != NULL) {
+  work->rpc = *rpc;
+  work->rpc.rets = work->rets;
+  work->method = method;
+  memcpy(work->args, args, sizeof work->args);
+  memcpy(work->rets, rets, sizeof work->rets);
+  work->closure = closure;
+  closure->rpc = &work->rpc;
+  if (!NaClSrpcWorkersEnqueue(channel, RunDispatchWork, work)) {
+    closure->rpc = rpc;
+    free(work);
     return BoolFalse;
   }
   return BoolTrue;
@@ -1001,6 +1036,9 @@ static DispatchReturn NaClSrpcReceiveAndDispatch(NaClSrpcChannel* channel,
   NaClSrpcArgVectorInit(args);
   NaClSrpcArgVectorInit(rets);
 
+  if (NaClSrpcWorkersBreakRequested(channel)) {
+    return DISPATCH_BREAK;
+  }
   closure = (RpcCheckingClosure*) malloc(sizeof *closure);
   if (NULL == closure) {
     NaClSrpcLog(NACL_SRPC_LOG_ERROR,
@@ -1044,6 +1082,31 @@ static DispatchReturn NaClSrpcReceiveAndDispatch(NaClSrpcChannel* channel,
     /* Fall through to request handling below. */
   } else {
     /* This is a response to a pending request. */
+    NaClSrpcRpc* async_rpc = NaClSrpcAsyncRpcTake(channel, rpc.request_id);
+    if (NULL != async_rpc) {
+      /*
+       * The response is for an asynchronous request.  Receive it into the
+       * caller's rets and continue waiting for our own response, if any.
+       */
+      memcpy(async_rpc, &rpc, kRpcSize);
+      bytes_read = RecvResponse(channel->message_channel,
+                                async_rpc,
+                                async_rpc->rets);
+      if (bytes_read < 0) {
+        NaClSrpcLog(NACL_SRPC_LOG_ERROR,
+                    "NaClSrpcReceiveAndDispatch(channel=%p):"
+                    " async response receive failed (%"NACL_PRIdS")\n",
+                    (void*) channel,
+                    bytes_read);
+        async_rpc->result = NACL_SRPC_RESULT_INTERNAL;
+        NaClSrpcAsyncRpcComplete(channel, async_rpc);
+        dispatch_return = DISPATCH_EOF;
+        goto done;
+      }
+      NaClSrpcAsyncRpcComplete(channel, async_rpc);
+      dispatch_return = DISPATCH_CONTINUE;
+      goto done;
+    }
     if (NULL == rpc_stack_top) {
       NaClSrpcLog(NACL_SRPC_LOG_ERROR,
                   "NaClSrpcReceiveAndDispatch(channel=%p):"
@@ -1124,6 +1187,15 @@ static DispatchReturn NaClSrpcReceiveAndDispatch(NaClSrpcChannel* channel,
                   buffer);
     }
   } while(0);
+  if (DispatchToWorker(channel, &rpc, method, args, rets, closure)) {
+    /*
+     * A worker owns the arguments and closure now.  A break requested by the
+     * method is noticed on a later pass through the loop.
+     */
+    closure = NULL;
+    dispatch_return = DISPATCH_CONTINUE;
+    goto done;
+  }
   (*method)(&rpc, args, rets, (NaClSrpcClosure*) closure);
   FreeArgs(args);
   FreeArgs(rets);
@@ -1199,13 +1271,23 @@ void NaClSrpcRpcWait(NaClSrpcChannel* channel,
   }
 }
 
+int NaClSrpcAsyncReceiveOne(NaClSrpcChannel* channel) {
+  /*
+   * Asynchronous waiters have no synchronous rpc of their own, so a response
+   * that does not match an outstanding asynchronous request is an error.
+   */
+  return DISPATCH_CONTINUE == NaClSrpcReceiveAndDispatch(channel, NULL);
+}
+
 int NaClSrpcRequestWrite(NaClSrpcChannel* channel,
                          NaClSrpcRpc* rpc,
                          NaClSrpcArg** args,
                          NaClSrpcArg** rets) {
   ssize_t retval;
   rpc->is_request = 1;
+  NaClSrpcChannelSendLock(channel);
   retval = SrpcSendMessage(rpc, args, rets, channel->message_channel);
+  NaClSrpcChannelSendUnlock(channel);
   if (retval < 0) {
     /* Requests with bad handles could fail.  Report to the caller. */
     NaClSrpcLog(1,
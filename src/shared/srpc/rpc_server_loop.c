@@ -16,7 +16,8 @@
  */
 static int ServerLoop(NaClSrpcService* service,
                       NaClSrpcImcDescType socket_desc,
-                      void* instance_data) {
+                      void* instance_data,
+                      uint32_t num_workers) {
   NaClSrpcChannel* channel = NULL;
   int retval = 0;
 
@@ -40,12 +41,27 @@ static int ServerLoop(NaClSrpcService* service,
                 "ServerLoop: NaClSrpcServerCtor failed\n");
     goto cleanup;
   }
+  /* Start the workers, if any, that will run the methods. */
+  if (!NaClSrpcWorkersStart(channel, num_workers)) {
+    NaClSrpcLog(NACL_SRPC_LOG_ERROR,
+                "ServerLoop: NaClSrpcWorkersStart failed\n");
+    goto cleanup;
+  }
   /*
    * Loop receiving RPCs and processing them.
    * The loop stops when a method requests a break out of the loop
    * or the IMC layer is unable to satisfy a request.
    */
+  if (!NaClSrpcChannelReceiveLock(channel, 1)) {
+    NaClSrpcLog(NACL_SRPC_LOG_ERROR,
+                "ServerLoop: another server loop is receiving\n");
+    NaClSrpcWorkersStop(channel);
+    goto cleanup;
+  }
   NaClSrpcRpcWait(channel, NULL);
+  NaClSrpcChannelReceiveUnlock(channel, 1);
+  /* Let the workers finish the requests already received. */
+  NaClSrpcWorkersStop(channel);
   retval = 1;
   NaClSrpcLog(2,
               "ServerLoop(service=%p, socket_desc=%p, instance_data=%p) done\n",
@@ -59,9 +75,10 @@ static int ServerLoop(NaClSrpcService* service,
   return retval;
 }
 
-int NaClSrpcServerLoop(NaClSrpcImcDescType imc_socket_desc,
-                       const NaClSrpcHandlerDesc methods[],
-                       void* instance_data) {
+int NaClSrpcServerLoopConcurrent(NaClSrpcImcDescType imc_socket_desc,
+                                 const NaClSrpcHandlerDesc methods[],
+                                 void* instance_data,
+                                 uint32_t num_workers) {
   NaClSrpcService* service;
 
   /* Ensure we are passed a valid socket descriptor. */
@@ -85,5 +102,12 @@ int NaClSrpcServerLoop(NaClSrpcImcDescType imc_socket_desc,
     return 0;
   }
   /* Process the RPCs.  ServerLoop takes ownership of service. */
-  return ServerLoop(service, imc_socket_desc, instance_data);
+  return ServerLoop(service, imc_socket_desc, instance_data, num_workers);
+}
+
+int NaClSrpcServerLoop(NaClSrpcImcDescType imc_socket_desc,
+                       const NaClSrpcHandlerDesc methods[],
+                       void* instance_data) {
+  return NaClSrpcServerLoopConcurrent(imc_socket_desc, methods,
+                                      instance_data, 0);
 }
@@ -21,18 +21,12 @@
 
 
 /*
- * The struct used to describe methods within services.
+ * The number of seeds tried for each table size when looking for a
+ * perfect hash of a service's method signatures.
  */
-struct NaClSrpcMethodDesc {
-  char const  *name;
-  char const  *input_types;
-  char const  *output_types;
-  /**
-   * function pointer used to process calls to the named method
-   */
-  NaClSrpcMethod handler;
-};
-typedef struct NaClSrpcMethodDesc NaClSrpcMethodDesc;
+#define kHashSeedAttempts 64
+/* The hash table is at most this many times larger than the method count. */
+#define kHashMaxLoadInverse 16
 
 /*
  * Forward declarations for static "built-in" methods.
@@ -120,12 +114,143 @@ static const char* ParseOneEntry(const char* entry_fmt,
   return NULL;
 }
 
+/*
+ * Returns whether every type in types is one that may be sent in a message.
+ */
+static int TypesAreValid(const char* types) {
+  const char* p;
+
+  for (p = types; '\0' != *p; ++p) {
+    switch (*p) {
+      case NACL_SRPC_ARG_TYPE_BOOL:
+      case NACL_SRPC_ARG_TYPE_CHAR_ARRAY:
+      case NACL_SRPC_ARG_TYPE_DOUBLE:
+      case NACL_SRPC_ARG_TYPE_DOUBLE_ARRAY:
+      case NACL_SRPC_ARG_TYPE_HANDLE:
+      case NACL_SRPC_ARG_TYPE_INT:
+      case NACL_SRPC_ARG_TYPE_INT_ARRAY:
+      case NACL_SRPC_ARG_TYPE_LONG:
+      case NACL_SRPC_ARG_TYPE_LONG_ARRAY:
+      case NACL_SRPC_ARG_TYPE_STRING:
+        break;
+      default:
+        return 0;
+    }
+  }
+  return 1;
+}
+
+/*
+ * Computes the fields of a method description that are derived from its
+ * name and types.  Returns 1 on success, 0 on failure.  A method with more
+ * than NACL_SRPC_MAX_ARGS types is kept, so that a peer's service string
+ * cannot make construction fail, but its types are marked invalid so that
+ * it can never be invoked.
+ */
+static int PrecompileMethod(NaClSrpcMethodDesc* method) {
+  size_t name_len = strlen(method->name);
+  size_t ins_len = strlen(method->input_types);
+  size_t outs_len = strlen(method->output_types);
+  char* signature;
+
+  signature = (char*) malloc(name_len + 1 + ins_len + 1 + outs_len + 1);
+  if (NULL == signature) {
+    return 0;
+  }
+  memcpy(signature, method->name, name_len);
+  signature[name_len] = ':';
+  memcpy(signature + name_len + 1, method->input_types, ins_len);
+  signature[name_len + 1 + ins_len] = ':';
+  memcpy(signature + name_len + 1 + ins_len + 1, method->output_types,
+         outs_len + 1);
+  method->signature = signature;
+  method->input_count = (uint32_t) ins_len;
+  method->output_count = (uint32_t) outs_len;
+  method->input_types_valid = ins_len <= NACL_SRPC_MAX_ARGS &&
+      TypesAreValid(method->input_types);
+  method->output_types_valid = outs_len <= NACL_SRPC_MAX_ARGS &&
+      TypesAreValid(method->output_types);
+  return 1;
+}
+
+/*
+ * FNV-1a, with the seed mixed into the offset basis.
+ */
+static uint32_t HashSignature(const char* signature, uint32_t seed) {
+  uint32_t hash = 2166136261U ^ seed;
+  const unsigned char* p;
+
+  for (p = (const unsigned char*) signature; '\0' != *p; ++p) {
+    hash ^= *p;
+    hash *= 16777619U;
+  }
+  return hash;
+}
+
+/*
+ * Builds a collision-free hash table from signatures to method indices.
+ * Leaves the table NULL (so that lookups search linearly) if no seed that
+ * gives a perfect hash is found within the size limit.
+ */
+static void BuildHashTable(NaClSrpcService* service) {
+  uint32_t size;
+  uint32_t* table;
+
+  if (0 == service->rpc_count ||
+      service->rpc_count > UINT32_MAX / kHashMaxLoadInverse) {
+    return;
+  }
+  /* Start with a load factor of at most one half. */
+  size = 1;
+  while (size < 2 * service->rpc_count) {
+    size <<= 1;
+  }
+  table = (uint32_t*) malloc(kHashMaxLoadInverse * service->rpc_count *
+                             sizeof *table);
+  if (NULL == table) {
+    return;
+  }
+  for (; size <= kHashMaxLoadInverse * service->rpc_count; size <<= 1) {
+    uint32_t seed;
+    for (seed = 0; seed < kHashSeedAttempts; ++seed) {
+      uint32_t i;
+      int collision = 0;
+      memset(table, 0xff, size * sizeof *table);
+      for (i = 0; i < service->rpc_count && !collision; ++i) {
+        const char* signature = service->rpc_descr[i].signature;
+        uint32_t slot = HashSignature(signature, seed) & (size - 1);
+        if (kNaClSrpcInvalidMethodIndex == table[slot]) {
+          table[slot] = i;
+        } else if (0 != strcmp(service->rpc_descr[table[slot]].signature,
+                               signature)) {
+          collision = 1;
+        }
+        /* Duplicate signatures keep the first index, as a search would. */
+      }
+      if (!collision) {
+        uint32_t* shrunk = (uint32_t*) realloc(table, size * sizeof *table);
+        if (NULL != shrunk) {
+          table = shrunk;
+        }
+        service->rpc_descr[0].hash_table = table;
+        service->rpc_descr[0].hash_mask = size - 1;
+        service->rpc_descr[0].hash_seed = seed;
+        return;
+      }
+    }
+  }
+  free(table);
+}
+
 static void FreeMethods(NaClSrpcMethodDesc* methods, uint32_t method_count) {
   uint32_t i;
 
   if (NULL == methods) {
     return;
   }
+  if (0 < method_count) {
+    free(methods[0].hash_table);
+  }
   for (i = 0; i < method_count; ++i) {
     if (NULL == methods[i].name) {
       /* We have reached the end of the portion set by ParseOneEntry calls. */
@@ -134,6 +259,7 @@ static void FreeMethods(NaClSrpcMethodDesc* methods, uint32_t method_count) {
     free((char*) methods[i].name);
     free((char*) methods[i].input_types);
     free((char*) methods[i].output_types);
+    free((char*) methods[i].signature);
   }
   free(methods);
 }
@@ -168,7 +294,7 @@ static NaClSrpcMethodDesc* BuildMethods(
                           (char**) &complete_methods[0].name,
                           (char**) &complete_methods[0].input_types,
                           (char**) &complete_methods[0].output_types);
-  if (nul_loc == NULL) {
+  if (nul_loc == NULL || !PrecompileMethod(&complete_methods[0])) {
     goto cleanup;
   }
   complete_methods[0].handler = ServiceDiscovery;
@@ -177,7 +303,7 @@ static NaClSrpcMethodDesc* BuildMethods(
                             (char**) &complete_methods[i + 1].name,
                             (char**) &complete_methods[i + 1].input_types,
                             (char**) &complete_methods[i + 1].output_types);
-    if (nul_loc == NULL) {
+    if (nul_loc == NULL || !PrecompileMethod(&complete_methods[i + 1])) {
       goto cleanup;
     }
     complete_methods[i + 1].handler = methods[i].handler;
@@ -187,6 +313,7 @@ static NaClSrpcMethodDesc* BuildMethods(
   complete_methods[*method_count].input_types = NULL;
   complete_methods[*method_count].output_types = NULL;
   complete_methods[*method_count].handler = NULL;
+  complete_methods[*method_count].signature = NULL;
   /* Return the array */
   return complete_methods;
 
@@ -268,6 +395,7 @@ int NaClSrpcServiceHandlerCtor(NaClSrpcService* service,
   service->service_string_length = str_length;
   service->rpc_descr = methods;
   service->rpc_count = method_count;
+  BuildHashTable(service);
   return 1;
  cleanup:
   FreeMethods(methods, method_count);
@@ -326,7 +454,8 @@ int NaClSrpcServiceStringCtor(NaClSrpcService* service, const char* str) {
                                 (char**) &methods[i].name,
                                 (char**) &methods[i].input_types,
                                 (char**) &methods[i].output_types);
-    if (NULL == newline_loc || '\n' != *newline_loc) {
+    if (NULL == newline_loc || '\n' != *newline_loc ||
+        !PrecompileMethod(&methods[i])) {
       goto cleanup;
     }
     p = newline_loc + 1;
@@ -337,6 +466,7 @@ int NaClSrpcServiceStringCtor(NaClSrpcService* service, const char* str) {
   service->service_string_length = nacl_abi_size_t_saturate(strlen(str));
   service->rpc_descr = methods;
   service->rpc_count = rpc_count;
+  BuildHashTable(service);
   return 1;
 
  cleanup:
@@ -381,41 +511,27 @@ uint32_t NaClSrpcServiceMethodCount(const NaClSrpcService *service) {
   return service->rpc_count;
 }
 
-static int SignatureMatches(NaClSrpcMethodDesc* method_desc,
-                            char const* signature) {
-  struct {
-    char const* field;
-    char terminator;
-  } matcher[3];
-  size_t ix;
-
-  matcher[0].field = method_desc->name;
-  matcher[0].terminator = ':';
-  matcher[1].field = method_desc->input_types;
-  matcher[1].terminator = ':';
-  matcher[2].field = method_desc->output_types;
-  matcher[2].terminator = '\0';
-
-  for (ix = 0; ix < sizeof(matcher) / sizeof(matcher[0]); ++ix) {
-    size_t length = strlen(matcher[ix].field);
-    if (strncmp(matcher[ix].field, signature, length) ||
-        matcher[ix].terminator != signature[length]) {
-      return 0;
-    }
-    signature += length + 1;
-  }
-  return 1;
-}
-
 uint32_t NaClSrpcServiceMethodIndex(const NaClSrpcService* service,
                                     char const* signature) {
+  const NaClSrpcMethodDesc* first;
   uint32_t i;
 
-  if (NULL == service) {
+  if (NULL == service || 0 == service->rpc_count) {
+    return kNaClSrpcInvalidMethodIndex;
+  }
+  first = &service->rpc_descr[0];
+  if (NULL != first->hash_table) {
+    /* The hash is perfect, so only one candidate needs comparing. */
+    i = first->hash_table[HashSignature(signature, first->hash_seed) &
+                          first->hash_mask];
+    if (kNaClSrpcInvalidMethodIndex != i &&
+        0 == strcmp(service->rpc_descr[i].signature, signature)) {
+      return i;
+    }
     return kNaClSrpcInvalidMethodIndex;
   }
   for (i = 0; i < service->rpc_count;  ++i) {
-    if (SignatureMatches(&(service->rpc_descr[i]), signature)) {
+    if (0 == strcmp(service->rpc_descr[i].signature, signature)) {
       return i;
     }
   }
@@ -438,6 +554,29 @@ int NaClSrpcServiceMethodNameAndTypes(const NaClSrpcService* service,
   return 1;
 }
 
+const NaClSrpcMethodDesc* NaClSrpcServiceMethodDesc(
+    const NaClSrpcService* service,
+    uint32_t rpc_number) {
+  if (NULL == service || rpc_number >= service->rpc_count) {
+    return NULL;
+  }
+  return &service->rpc_descr[rpc_number];
+}
+
+int NaClSrpcTypesConform(const char* types,
+                         uint32_t count,
+                         NaClSrpcArg** alist) {
+  uint32_t i;
+
+  for (i = 0; i < count; ++i) {
+    if (NULL == alist[i] ||
+        alist[i]->tag != (enum NaClSrpcArgType) (unsigned char) types[i]) {
+      return 0;
+    }
+  }
+  return NULL == alist[count];
+}
+
 NaClSrpcMethod NaClSrpcServiceMethod(const NaClSrpcService* service,
                                      uint32_t rpc_number) {
   if (NULL == service || rpc_number >= service->rpc_count) {
@@ -19,6 +19,7 @@
           'nacl_srpc.h',
           'nacl_srpc_internal.h',
           'nacl_srpc_message.c',
+          'rpc_async.c',
           'rpc_log.c',
           'rpc_serialize.c',
           'rpc_service.c',
@@ -60,6 +61,7 @@
           'module_init_fini.c',
           'nacl_srpc.c',
           'nacl_srpc_message.c',
+          'rpc_async.c',
           'rpc_log.c',
           'rpc_serialize.c',
           'rpc_service.c',
@@ -9,6 +9,7 @@
 #include <string.h>
 #include <stdlib.h>
 
+#include <algorithm>
 #include <string>
 
 #include "native_client/src/shared/platform/nacl_log.h"
@@ -47,12 +48,18 @@ bool Packet::EndOfPacket() const {
   return (read_index_ >= write_index_);
 }
 
-void Packet::AddRawChar(char ch) {
-  // Grow by a fixed amount whenever we are within the pad boundry.
-  // The pad boundry allows for the addition of NUL termination.
-  if (data_.size() <= (write_index_ + MIN_PAD)) {
-    data_.resize(data_.size() + GROW_SIZE);
+void Packet::Reserve(size_t len) {
+  // Grow whenever we are within the pad boundry, which allows for the
+  // addition of NUL termination.  Doubling keeps large replies, such
+  // as memory reads, linear in their size.
+  size_t needed = write_index_ + len + MIN_PAD;
+  if (data_.size() < needed) {
+    data_.resize(std::max(needed, data_.size() * 2));
   }
+}
+
+void Packet::AddRawChar(char ch) {
+  Reserve(1);
 
   // Add character and always null terminate.
   data_[write_index_++] = ch;
@@ -72,10 +79,31 @@ void Packet::AddWord8(uint8_t ch) {
 void Packet::AddBlock(const void *ptr, uint32_t len) {
   assert(ptr);
 
-  const char *p = (const char *) ptr;
+  const uint8_t *p = reinterpret_cast<const uint8_t *>(ptr);
+
+  Reserve(len * 2);
+  for (uint32_t offs = 0; offs < len; offs++) {
+    IntToNibble(p[offs] >> 4, &data_[write_index_++]);
+    IntToNibble(p[offs] & 0xF, &data_[write_index_++]);
+  }
+  data_[write_index_] = 0;
+}
+
+void Packet::AddEscapedBlock(const void *ptr, uint32_t len) {
+  assert(ptr);
+
+  const char *p = reinterpret_cast<const char *>(ptr);
 
+  // Reserve for the common case of few special characters, the rest
+  // grow as needed.
+  Reserve(len);
   for (uint32_t offs = 0; offs < len; offs++) {
-    AddWord8(p[offs]);
+    char ch = p[offs];
+    if (ch == '#' || ch == '$' || ch == '}' || ch == '*') {
+      AddRawChar('}');
+      ch ^= 0x20;
+    }
+    AddRawChar(ch);
   }
 }
 
@@ -289,6 +317,24 @@ bool Packet::GetBlock(void *ptr, uint32_t len) {
   return res;
 }
 
+bool Packet::GetEscapedBlock(void *ptr, uint32_t len) {
+  assert(ptr);
+
+  char *p = reinterpret_cast<char *>(ptr);
+  char ch;
+
+  for (uint32_t offs = 0; offs < len; offs++) {
+    if (!GetRawChar(&ch)) return false;
+    if (ch == '}') {
+      if (!GetRawChar(&ch)) return false;
+      ch ^= 0x20;
+    }
+    p[offs] = ch;
+  }
+
+  return true;
+}
+
 bool Packet::GetWord16(uint16_t *ptr) {
   assert(ptr);
   return GetBlock(ptr, sizeof(*ptr));
@@ -374,6 +420,10 @@ const char *Packet::GetPayload() const {
   return &data_[0];
 }
 
+size_t Packet::GetPayloadSize() const {
+  return write_index_;
+}
+
 bool Packet::GetSequence(int32_t *ch) const {
   assert(ch);
 
@@ -53,6 +53,14 @@ class Packet {
   // Store a block of data as hex pairs per byte
   void AddBlock(const void *ptr, uint32_t len);
 
+  // Store a block of binary data, as used by the 'X' and qXfer packets.
+  // Bytes are stored raw except for the characters special to the
+  // protocol ("#$}*"), which are stored as '}' followed by the byte
+  // XORed with 0x20.  Unlike hex pairs this only grows the data by the
+  // number of special characters, but the payload may contain NULs, so
+  // GetPayloadSize must be used to find its end.
+  void AddEscapedBlock(const void *ptr, uint32_t len);
+
   // Store an 8, 16, 32, or 64 bit word as a block without removing preceeding
   // zeros.  This is used for fixed sized fields.
   void AddWord8(uint8_t val);
@@ -80,6 +88,9 @@ class Packet {
   // Retrieve "len" ASCII character pairs.
   bool GetBlock(void *ptr, uint32_t len);
 
+  // Retrieve "len" bytes stored by AddEscapedBlock.
+  bool GetEscapedBlock(void *ptr, uint32_t len);
+
   // Retrieve a 8, 16, 32, or 64 bit word as pairs of hex digits.  These
   // functions will always consume bits/4 characters from the stream.
   bool GetWord8(uint8_t *val);
@@ -103,6 +114,9 @@ class Packet {
   // Return a pointer to the entire packet payload
   const char *GetPayload() const;
 
+  // Return the length of the payload, not counting the NUL terminator.
+  size_t GetPayloadSize() const;
+
   // Returns true and the sequence number, or false if it is unset.
   bool GetSequence(int32_t *seq) const;
 
@@ -113,6 +127,9 @@ class Packet {
   void SetSequence(int32_t seq);
 
  private:
+  // Make room for "len" more characters and the NUL terminator.
+  void Reserve(size_t len);
+
   int32_t seq_;
   std::vector<char> data_;
   size_t read_index_;
@@ -91,6 +91,25 @@ int VerifyPacket(Packet *wr, Packet *rd, void *ctx, PacketFunc_t tx) {
     printf("Failed to decompress as expected.\n");
   }
 
+  // Check that binary data survives escaping, including NULs and the
+  // characters that frame packets.
+  const char binary[] = { 'a', 0, '#', '$', '}', '*', 'z', 0 };
+  char binary_out[sizeof(binary)];
+
+  wr->Clear();
+  wr->AddRawChar('X');
+  wr->AddEscapedBlock(binary, sizeof(binary));
+  if (wr->GetPayloadSize() != 1 + sizeof(binary) + 4) errs++;
+  if (tx) tx(ctx, wr, rd);
+  rd->GetRawChar(&ch);
+  if (ch != 'X') errs++;
+  if (!rd->GetEscapedBlock(binary_out, sizeof(binary_out)) ||
+      memcmp(binary, binary_out, sizeof(binary))) {
+    errs++;
+    printf("Failed to unescape binary data.\n");
+  }
+  if (!rd->EndOfPacket()) errs++;
+
   if (errs)
     printf("FAILED PACKET TEST\n");
 
@@ -12,6 +12,7 @@
 #include <sys/syscall.h>
 #include <pthread.h>
 
+#include <algorithm>
 #include <map>
 #include <vector>
 
@@ -37,22 +38,31 @@ namespace port {
 // trick of getting the kernel to do it on our behalf.
 static bool SafeMemoryCopy(void *dest, void *src, size_t len) {
   // The trick only works if we are copying less than the buffer size
-  // of a pipe.  For now, return an error on larger sizes.
-  // TODO(mseaborn): If we need to copy more, we would have to break
-  // it up into smaller parts.
+  // of a pipe, so larger copies are broken up into parts of that size
+  // which share one pipe.
   const size_t kPipeBufferBound = 0x1000;
-  if (len > kPipeBufferBound)
-    return false;
+  char *dest_ptr = reinterpret_cast<char*>(dest);
+  char *src_ptr = reinterpret_cast<char*>(src);
 
-  bool success = false;
+  bool success = true;
   int pipe_fds[2];
   if (pipe(pipe_fds) != 0)
     return false;
-  ssize_t sent = write(pipe_fds[1], src, len);
-  if (sent == static_cast<ssize_t>(len)) {
-    ssize_t got = read(pipe_fds[0], dest, len);
-    if (got == static_cast<ssize_t>(len))
-      success = true;
+  while (len > 0) {
+    size_t chunk = std::min(len, kPipeBufferBound);
+    ssize_t sent = write(pipe_fds[1], src_ptr, chunk);
+    if (sent != static_cast<ssize_t>(chunk)) {
+      success = false;
+      break;
+    }
+    ssize_t got = read(pipe_fds[0], dest_ptr, chunk);
+    if (got != static_cast<ssize_t>(chunk)) {
+      success = false;
+      break;
+    }
+    dest_ptr += chunk;
+    src_ptr += chunk;
+    len -= chunk;
   }
   CHECK(close(pipe_fds[0]) == 0);
   CHECK(close(pipe_fds[1]) == 0);
@@ -9,7 +9,6 @@
 #include <stdlib.h>
 
 #include <string>
-#include <sstream>
 
 #include "native_client/src/shared/platform/nacl_log.h"
 #include "native_client/src/trusted/debug_stub/packet.h"
@@ -89,56 +88,61 @@ bool Session::SendPacket(Packet *pkt) {
 
 bool Session::SendPacketOnly(Packet *pkt) {
   const char *ptr;
+  size_t size;
   char ch;
-  std::stringstream outstr;
+  std::string outstr;
 
   char run_xsum = 0;
   int32_t seq;
 
   ptr = pkt->GetPayload();
+  size = pkt->GetPayloadSize();
 
   if (!pkt->GetSequence(&seq) && (GetFlags() & USE_SEQ)) {
     pkt->SetSequence(seq_++);
   }
 
+  // Leave room for '$', the sequence and the XSUM, so that large
+  // payloads such as memory reads are copied once.
+  outstr.reserve(size + 8);
+
   // Signal start of response
-  outstr << '$';
+  outstr += '$';
 
   // If there is a sequence, send as two nibble 8bit value + ':'
   if (pkt->GetSequence(&seq)) {
     IntToNibble((seq & 0xFF) >> 4, &ch);
-    outstr << ch;
+    outstr += ch;
     run_xsum += ch;
 
     IntToNibble(seq & 0xF, &ch);
-    outstr << ch;
+    outstr += ch;
     run_xsum += ch;
 
     ch = ':';
-    outstr << ch;
+    outstr += ch;
     run_xsum += ch;
   }
 
-  // Send the main payload
-  int offs = 0;
-  while ((ch = ptr[offs++]) != 0) {
-    outstr << ch;
-    run_xsum += ch;
+  // Send the main payload.  Binary payloads may contain NULs, so this
+  // goes by size rather than stopping at the terminator.
+  outstr.append(ptr, size);
+  for (size_t offs = 0; offs < size; offs++) {
+    run_xsum += ptr[offs];
   }
 
   if (GetFlags() & DEBUG_SEND) {
-    NaClLog(1, "TX %s\n", outstr.str().c_str());
+    NaClLog(1, "TX %s\n", outstr.c_str());
   }
 
   // Send XSUM as two nible 8bit value preceeded by '#'
-  outstr << '#';
+  outstr += '#';
   IntToNibble((run_xsum >> 4) & 0xF, &ch);
-  outstr << ch;
+  outstr += ch;
   IntToNibble(run_xsum & 0xF, &ch);
-  outstr << ch;
+  outstr += ch;
 
-  return io_->Write(outstr.str().data(),
-                    static_cast<int32_t>(outstr.str().length()));
+  return io_->Write(outstr.data(), static_cast<int32_t>(outstr.length()));
 }
 
 // Attempt to receive a packet
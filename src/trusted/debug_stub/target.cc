@@ -58,8 +58,27 @@ Target::~Target() {
   Destroy();
 }
 
+// Adds the requested chunk of an object to a qXfer reply, prefixed by
+// 'l' if it is the last one or 'm' if there is more to read.
+static void AddXferChunk(Packet *pktOut, const string &data,
+                         uint64_t offs, uint64_t len) {
+  if (offs >= data.length()) {
+    pktOut->AddRawChar('l');
+    return;
+  }
+
+  uint64_t avail = data.length() - offs;
+  if (len >= avail) {
+    pktOut->AddRawChar('l');
+    len = avail;
+  } else {
+    pktOut->AddRawChar('m');
+  }
+  pktOut->AddEscapedBlock(data.data() + offs, static_cast<uint32_t>(len));
+}
+
 bool Target::Init() {
-  string targ_xml = "l<target><architecture>";
+  string targ_xml = "<target><architecture>";
 
   targ_xml += abi_->GetName();
   targ_xml += "</architecture><osabi>NaCl</osabi>";
@@ -68,8 +87,11 @@ bool Target::Init() {
 
   // Set a more specific result which won't change.
   properties_["target.xml"] = targ_xml;
+  // PacketSize is in hex.  128k lets GDB move memory in large blocks;
+  // the reply to an 'm' read of N bytes takes 2N characters.
   properties_["Supported"] =
-    "PacketSize=1000;qXfer:features:read+";
+    "PacketSize=20000;qXfer:features:read+;qXfer:memory-map:read+;"
+    "qXfer:libraries:read+";
 
   NaClXMutexCtor(&mutex_);
   ctx_ = new uint8_t[abi_->GetContextSize()];
@@ -405,7 +427,69 @@ void Target::SetStopReply(Packet *pktOut) const {
     // Add 'thread:<tid>;' pair. Note terminating ';' is required.
     pktOut->AddString("thread:");
     pktOut->AddNumberSep(sig_thread_, ';');
+
+    // Add 'nn:xx..xx;' pairs for every register of the thread, so that
+    // GDB does not need to follow each stop with a 'g' request.
+    ThreadMap_t::const_iterator itr = threads_.find(sig_thread_);
+    if (itr != threads_.end()) {
+      IThread *thread = itr->second;
+      for (uint32_t a = 0; a < abi_->GetRegisterCount(); a++) {
+        const Abi::RegDef *def = abi_->GetRegisterDef(a);
+        thread->GetRegister(a, &ctx_[def->offset_], def->bytes_);
+        pktOut->AddNumberSep(a, ':');
+        pktOut->AddBlock(&ctx_[def->offset_], def->bytes_);
+        pktOut->AddRawChar(';');
+      }
+    }
+  }
+}
+
+string Target::GetMemoryMapXml() const {
+  char region[128];
+  uint64_t size = static_cast<uint64_t>(1) << nap_->addr_bits;
+  string xml = "<memory-map>";
+
+  // All of untrusted memory is described as RAM, even the code area
+  // that the debugger may not modify, because GDB uses hardware
+  // breakpoints in read-only regions.  Accesses to unmapped pages
+  // within the region simply fail.
+  snprintf(region, sizeof(region),
+           "<memory type=\"ram\" start=\"0x0\" length=\"0x%"
+           NACL_PRIx64 "\"/>", size);
+  xml += region;
+
+  // Also describe the sandbox-based addresses GDB may use on x86-64
+  // (see AdjustUserAddr).
+  if (NACL_ARCH(NACL_BUILD_ARCH) == NACL_x86 && NACL_BUILD_SUBARCH == 64 &&
+      nap_->mem_start >= size) {
+    snprintf(region, sizeof(region),
+             "<memory type=\"ram\" start=\"0x%" NACL_PRIx64
+             "\" length=\"0x%" NACL_PRIx64 "\"/>",
+             static_cast<uint64_t>(nap_->mem_start), size);
+    xml += region;
+  }
+
+  xml += "</memory-map>";
+  return xml;
+}
+
+string Target::GetLibrariesXml() const {
+  char library[128];
+  string xml = "<library-list>";
+
+  // The IRT is the only library loaded by the service runtime.  Its
+  // file is not known here, so GDB looks for it by the name "irt" in
+  // its solib-search-path.  Libraries loaded by the untrusted dynamic
+  // loader are found by GDB through the loader itself.
+  if (nap_->irt_loaded) {
+    snprintf(library, sizeof(library),
+             "<library name=\"irt\"><segment address=\"0x%" NACL_PRIxPTR
+             "\"/></library>", nap_->irt_load_addr);
+    xml += library;
   }
+
+  xml += "</library-list>";
+  return xml;
 }
 
 
@@ -595,8 +679,10 @@ bool Target::ProcessPacket(Packet* pktIn, Packet* pktOut) {
       }
 
     // IN : $Maaaa,llll:xx..xx
+    // IN : $Xaaaa,llll:bb..bb
     // OUT: $OK
-    case 'M':  {
+    case 'M':
+    case 'X': {
         uint64_t user_addr;
         uint64_t wlen;
         uint32_t len;
@@ -623,8 +709,19 @@ bool Target::ProcessPacket(Packet* pktIn, Packet* pktOut) {
           break;
         }
 
+        // 'X' carries the data as escaped binary rather than hex pairs,
+        // halving the size of large writes.
         nacl::scoped_array<uint8_t> block(new uint8_t[len]);
-        pktIn->GetBlock(block.get(), len);
+        bool ok;
+        if (cmd == 'X') {
+          ok = pktIn->GetEscapedBlock(block.get(), len);
+        } else {
+          ok = pktIn->GetBlock(block.get(), len);
+        }
+        if (!ok) {
+          err = BAD_FORMAT;
+          break;
+        }
 
         if (!port::IPlatform::SetMemory(nap_, sys_addr, len, block.get())) {
           err = FAILED;
@@ -660,23 +757,34 @@ bool Target::ProcessPacket(Packet* pktIn, Packet* pktOut) {
         break;
       }
 
-      // Check for architecture query
-      tmp = "Xfer:features:read:target.xml";
+      // Check for object transfers, which all take "offs,len".
+      string xfer_object;
+      const char *xfer_args = NULL;
+      tmp = "Xfer:features:read:target.xml:";
       if (!strncmp(str, tmp.data(), tmp.length())) {
-        stringvec args = StringSplit(&str[tmp.length()+1], ",");
-        if (args.size() != 2) break;
-
-        const char *out = properties_["target.xml"].data();
-        int offs = strtol(args[0].data(), NULL, 16);
-        int max  = strtol(args[1].data(), NULL, 16) + offs;
-        int len  = static_cast<int>(strlen(out));
-
-        if (max >= len) max = len;
-
-        while (offs < max) {
-          pktOut->AddRawChar(out[offs]);
-          offs++;
+        xfer_object = properties_["target.xml"];
+        xfer_args = &str[tmp.length()];
+      }
+      tmp = "Xfer:memory-map:read::";
+      if (!strncmp(str, tmp.data(), tmp.length())) {
+        xfer_object = GetMemoryMapXml();
+        xfer_args = &str[tmp.length()];
+      }
+      tmp = "Xfer:libraries:read::";
+      if (!strncmp(str, tmp.data(), tmp.length())) {
+        xfer_object = GetLibrariesXml();
+        xfer_args = &str[tmp.length()];
+      }
+      if (NULL != xfer_args) {
+        stringvec args = StringSplit(xfer_args, ",");
+        if (args.size() != 2) {
+          err = BAD_FORMAT;
+          break;
         }
+
+        AddXferChunk(pktOut, xfer_object,
+                     strtoul(args[0].data(), NULL, 16),
+                     strtoul(args[1].data(), NULL, 16));
         break;
       }
 
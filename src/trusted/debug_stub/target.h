@@ -92,6 +92,10 @@ class Target {
 
   void SetStopReply(Packet *pktOut) const;
 
+  // Return the objects read through qXfer.
+  std::string GetMemoryMapXml() const;
+  std::string GetLibrariesXml() const;
+
   void Destroy();
   void Detach();
   void Kill();
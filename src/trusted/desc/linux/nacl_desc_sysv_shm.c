@@ -351,6 +351,11 @@ struct NaClDescVtbl const kNaClDescSysvShmVtbl = {
   NaClDescSeekNotImplemented,
   NaClDescPReadNotImplemented,
   NaClDescPWriteNotImplemented,
+  NaClDescReadVByParts,
+  NaClDescWriteVByParts,
+  NaClDescPReadVByParts,
+  NaClDescPWriteVByParts,
+  NaClDescSendFileNotImplemented,
   NaClDescIoctlNotImplemented,
   NaClDescSysvShmFstat,
   NaClDescGetdentsNotImplemented,
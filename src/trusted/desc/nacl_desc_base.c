@@ -365,6 +365,128 @@ ssize_t NaClDescPWriteNotImplemented(struct NaClDesc *vself,
   return -NACL_ABI_EINVAL;
 }
 
+/*
+ * Common implementation of the NaClDesc*VByParts functions.  Like
+ * readv, a failure after some bytes have been transferred is reported
+ * as a short transfer, and a short transfer ends the operation.
+ */
+static ssize_t NaClDescIoVecByParts(struct NaClDesc             *vself,
+                                    struct NaClHostIoVec const  *iov,
+                                    size_t                      iovcnt,
+                                    int                         is_write,
+                                    int                         positional,
+                                    nacl_off64_t                offset) {
+  struct NaClDescVtbl const *vtbl = (struct NaClDescVtbl const *)
+      vself->base.vtbl;
+  size_t total = 0;
+  size_t i;
+  ssize_t result;
+
+  for (i = 0; i < iovcnt; ++i) {
+    if (0 == iov[i].length) {
+      continue;
+    }
+    if (positional) {
+      nacl_off64_t pos = offset + (nacl_off64_t) total;
+      result = is_write
+          ? (*vtbl->PWrite)(vself, iov[i].base, iov[i].length, pos)
+          : (*vtbl->PRead)(vself, iov[i].base, iov[i].length, pos);
+    } else {
+      result = is_write
+          ? (*vtbl->Write)(vself, iov[i].base, iov[i].length)
+          : (*vtbl->Read)(vself, iov[i].base, iov[i].length);
+    }
+    if (result < 0) {
+      return (0 == total) ? result : (ssize_t) total;
+    }
+    total += (size_t) result;
+    if ((size_t) result < iov[i].length) {
+      break;
+    }
+  }
+  return (ssize_t) total;
+}
+
+ssize_t NaClDescReadVByParts(struct NaClDesc            *vself,
+                             struct NaClHostIoVec const *iov,
+                             size_t                     iovcnt) {
+  return NaClDescIoVecByParts(vself, iov, iovcnt, 0, 0, 0);
+}
+
+ssize_t NaClDescWriteVByParts(struct NaClDesc             *vself,
+                              struct NaClHostIoVec const  *iov,
+                              size_t                      iovcnt) {
+  return NaClDescIoVecByParts(vself, iov, iovcnt, 1, 0, 0);
+}
+
+ssize_t NaClDescPReadVByParts(struct NaClDesc             *vself,
+                              struct NaClHostIoVec const  *iov,
+                              size_t                      iovcnt,
+                              nacl_off64_t                offset) {
+  return NaClDescIoVecByParts(vself, iov, iovcnt, 0, 1, offset);
+}
+
+ssize_t NaClDescPWriteVByParts(struct NaClDesc            *vself,
+                               struct NaClHostIoVec const *iov,
+                               size_t                     iovcnt,
+                               nacl_off64_t               offset) {
+  return NaClDescIoVecByParts(vself, iov, iovcnt, 1, 1, offset);
+}
+
+ssize_t NaClDescSendFileNotImplemented(struct NaClDesc  *vself,
+                                       struct NaClDesc  *source,
+                                       nacl_off64_t     *offset,
+                                       size_t           count) {
+  UNREFERENCED_PARAMETER(source);
+  UNREFERENCED_PARAMETER(offset);
+  UNREFERENCED_PARAMETER(count);
+
+  NaClLog(LOG_ERROR,
+          "SendFile method is not implemented for object of type %s\n",
+          NaClDescTypeString(((struct NaClDescVtbl const *)
+                              vself->base.vtbl)->typeTag));
+  return -NACL_ABI_EINVAL;
+}
+
+ssize_t NaClDescSendFileReadSource(void          *source,
+                                   void          *buf,
+                                   size_t        len,
+                                   nacl_off64_t  *offset) {
+  struct NaClDesc *desc = (struct NaClDesc *) source;
+
+  if (NULL != offset) {
+    return (*NACL_VTBL(NaClDesc, desc)->PRead)(desc, buf, len, *offset);
+  }
+  return (*NACL_VTBL(NaClDesc, desc)->Read)(desc, buf, len);
+}
+
+static ssize_t NaClDescSendFileWriteSink(void       *sink,
+                                         void const *buf,
+                                         size_t     len) {
+  struct NaClDesc *desc = (struct NaClDesc *) sink;
+
+  return (*NACL_VTBL(NaClDesc, desc)->Write)(desc, buf, len);
+}
+
+ssize_t NaClDescSendFileByCopy(struct NaClDesc  *vself,
+                               struct NaClDesc  *source,
+                               nacl_off64_t     *offset,
+                               size_t           count) {
+  char    *buffer;
+  ssize_t rv;
+
+  buffer = malloc(NACL_SENDFILE_CHUNK_BYTES);
+  if (NULL == buffer) {
+    return -NACL_ABI_ENOMEM;
+  }
+  rv = NaClSendfileCopyLoop(NaClDescSendFileReadSource, source,
+                            NaClDescSendFileWriteSink, vself,
+                            buffer, NACL_SENDFILE_CHUNK_BYTES,
+                            offset, count);
+  free(buffer);
+  return rv;
+}
+
 int NaClDescIoctlNotImplemented(struct NaClDesc         *vself,
                                 int                     request,
                                 void                    *arg) {
@@ -725,6 +847,11 @@ struct NaClDescVtbl const kNaClDescVtbl = {
   NaClDescSeekNotImplemented,
   NaClDescPReadNotImplemented,
   NaClDescPWriteNotImplemented,
+  NaClDescReadVByParts,
+  NaClDescWriteVByParts,
+  NaClDescPReadVByParts,
+  NaClDescPWriteVByParts,
+  NaClDescSendFileNotImplemented,
   NaClDescIoctlNotImplemented,
   NaClDescFstatNotImplemented,
   NaClDescGetdentsNotImplemented,
@@ -219,6 +219,44 @@ struct NaClDescVtbl {
                     size_t len,
                     nacl_off64_t offset) NACL_WUR;
 
+  /*
+   * Vectored versions of Read, Write, PRead and PWrite.  The iov array
+   * and the buffers it describes have already been validated.
+   * Subclasses without a native scatter/gather primitive use the
+   * NaClDesc*VByParts functions, which make one scalar call per element.
+   */
+  ssize_t (*ReadV)(struct NaClDesc            *vself,
+                   struct NaClHostIoVec const *iov,
+                   size_t                     iovcnt) NACL_WUR;
+
+  ssize_t (*WriteV)(struct NaClDesc             *vself,
+                    struct NaClHostIoVec const  *iov,
+                    size_t                      iovcnt) NACL_WUR;
+
+  ssize_t (*PReadV)(struct NaClDesc             *vself,
+                    struct NaClHostIoVec const  *iov,
+                    size_t                      iovcnt,
+                    nacl_off64_t                offset) NACL_WUR;
+
+  ssize_t (*PWriteV)(struct NaClDesc            *vself,
+                     struct NaClHostIoVec const *iov,
+                     size_t                     iovcnt,
+                     nacl_off64_t               offset) NACL_WUR;
+
+  /*
+   * Copies up to count bytes from source into this descriptor without
+   * passing them through untrusted memory, as sendfile(2).  If offset
+   * is non-NULL, source is read at *offset, which is advanced, and its
+   * file position is unchanged; otherwise source is read from its file
+   * position.  Returns the number of bytes copied, or a negated NaCl
+   * ABI errno if none were.  Descriptors with a Write method but no
+   * kernel-level transfer use NaClDescSendFileByCopy.
+   */
+  ssize_t (*SendFile)(struct NaClDesc *vself,
+                      struct NaClDesc *source,
+                      nacl_off64_t    *offset,
+                      size_t          count) NACL_WUR;
+
   /*
    * TODO(bsy): Need to figure out which requests we support, if any.
    * Also, request determines arg size and whether it is an input or
@@ -598,6 +636,45 @@ ssize_t NaClDescPWriteNotImplemented(struct NaClDesc *vself,
                                      size_t len,
                                      nacl_off64_t offset);
 
+ssize_t NaClDescReadVByParts(struct NaClDesc            *vself,
+                             struct NaClHostIoVec const *iov,
+                             size_t                     iovcnt);
+
+ssize_t NaClDescWriteVByParts(struct NaClDesc             *vself,
+                              struct NaClHostIoVec const  *iov,
+                              size_t                      iovcnt);
+
+ssize_t NaClDescPReadVByParts(struct NaClDesc             *vself,
+                              struct NaClHostIoVec const  *iov,
+                              size_t                      iovcnt,
+                              nacl_off64_t                offset);
+
+ssize_t NaClDescPWriteVByParts(struct NaClDesc            *vself,
+                               struct NaClHostIoVec const *iov,
+                               size_t                     iovcnt,
+                               nacl_off64_t               offset);
+
+ssize_t NaClDescSendFileNotImplemented(struct NaClDesc  *vself,
+                                       struct NaClDesc  *source,
+                                       nacl_off64_t     *offset,
+                                       size_t           count);
+
+ssize_t NaClDescSendFileByCopy(struct NaClDesc  *vself,
+                               struct NaClDesc  *source,
+                               nacl_off64_t     *offset,
+                               size_t           count);
+
+/*
+ * Reads from source, a struct NaClDesc, as the SendFile method does:
+ * at *offset (without advancing it) if offset is non-NULL, otherwise
+ * at the file position.  This is a NaClSendfileReadFn, for copying
+ * SendFile methods that use NaClSendfileCopyLoop.
+ */
+ssize_t NaClDescSendFileReadSource(void         *source,
+                                   void         *buf,
+                                   size_t       len,
+                                   nacl_off64_t *offset);
+
 int NaClDescIoctlNotImplemented(struct NaClDesc *vself,
                                 int             request,
                                 void            *arg);
@@ -135,6 +135,11 @@ static struct NaClDescVtbl const kNaClDescCondVarVtbl = {
   NaClDescSeekNotImplemented,
   NaClDescPReadNotImplemented,
   NaClDescPWriteNotImplemented,
+  NaClDescReadVByParts,
+  NaClDescWriteVByParts,
+  NaClDescPReadVByParts,
+  NaClDescPWriteVByParts,
+  NaClDescSendFileNotImplemented,
   NaClDescIoctlNotImplemented,
   NaClDescCondVarFstat,
   NaClDescGetdentsNotImplemented,
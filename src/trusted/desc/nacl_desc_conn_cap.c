@@ -202,6 +202,11 @@ static struct NaClDescVtbl const kNaClDescConnCapVtbl = {
   NaClDescSeekNotImplemented,
   NaClDescPReadNotImplemented,
   NaClDescPWriteNotImplemented,
+  NaClDescReadVByParts,
+  NaClDescWriteVByParts,
+  NaClDescPReadVByParts,
+  NaClDescPWriteVByParts,
+  NaClDescSendFileNotImplemented,
   NaClDescIoctlNotImplemented,
   NaClDescConnCapFstat,
   NaClDescGetdentsNotImplemented,
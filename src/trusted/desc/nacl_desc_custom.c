@@ -76,6 +76,11 @@ static const struct NaClDescVtbl kNaClDescCustomVtbl = {
   NaClDescSeekNotImplemented,
   NaClDescPReadNotImplemented,
   NaClDescPWriteNotImplemented,
+  NaClDescReadVByParts,
+  NaClDescWriteVByParts,
+  NaClDescPReadVByParts,
+  NaClDescPWriteVByParts,
+  NaClDescSendFileNotImplemented,
   NaClDescIoctlNotImplemented,
   NaClDescFstatNotImplemented,
   NaClDescGetdentsNotImplemented,
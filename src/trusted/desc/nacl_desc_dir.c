@@ -168,6 +168,11 @@ static struct NaClDescVtbl const kNaClDescDirDescVtbl = {
   NaClDescDirDescSeek,
   NaClDescPReadNotImplemented,
   NaClDescPWriteNotImplemented,
+  NaClDescReadVByParts,
+  NaClDescWriteVByParts,
+  NaClDescPReadVByParts,
+  NaClDescPWriteVByParts,
+  NaClDescSendFileNotImplemented,
   NaClDescIoctlNotImplemented,
   NaClDescDirDescFstat,
   NaClDescDirDescGetdents,
@@ -13,11 +13,14 @@
 #include <errno.h>
 
 #include "native_client/src/include/portability.h"
+#include "native_client/src/include/nacl_macros.h"
 
 #include "native_client/src/trusted/desc/nacl_desc_base.h"
 #include "native_client/src/trusted/desc/nacl_desc_imc.h"
 #include "native_client/src/trusted/desc/nrd_xfer.h"
 
+#include "native_client/src/public/imc_types.h"
+
 #include "native_client/src/shared/platform/nacl_log.h"
 #include "native_client/src/shared/platform/nacl_sync.h"
 #include "native_client/src/shared/platform/nacl_sync_checked.h"
@@ -41,11 +44,70 @@ static struct NaClDescVtbl const kNaClDescImcConnectedDescVtbl;
 static struct NaClDescVtbl const kNaClDescImcDescVtbl;
 static struct NaClDescVtbl const kNaClDescXferableDataDescVtbl;
 
+/*
+ * Guards the count of idle transfer buffers held by all sockets'
+ * pools, which is kept at most NACL_DESC_IMC_XFER_BUFFER_GLOBAL_MAX.
+ * Always taken after a socket's xfer_buffer_mu.  NULL before
+ * NaClDescImcInit, in which case no buffers are pooled.
+ */
+static struct NaClMutex *xfer_pool_mu = NULL;
+static size_t num_pooled_xfer_buffers = 0;
+
+void NaClDescImcInit(void) {
+  xfer_pool_mu = (struct NaClMutex *) malloc(sizeof(*xfer_pool_mu));
+  if (NULL == xfer_pool_mu) {
+    NaClLog(LOG_FATAL, "Cannot allocate NaClDescImc transfer pool mutex\n");
+  }
+  if (!NaClMutexCtor(xfer_pool_mu)) {
+    free(xfer_pool_mu);
+    xfer_pool_mu = NULL;
+    NaClLog(LOG_FATAL, "Cannot construct NaClDescImc transfer pool mutex\n");
+  }
+  num_pooled_xfer_buffers = 0;
+}
+
+void NaClDescImcFini(void) {
+  if (NULL != xfer_pool_mu) {
+    NaClMutexDtor(xfer_pool_mu);
+    free(xfer_pool_mu);
+    xfer_pool_mu = NULL;
+  }
+}
+
+size_t NaClDescImcPooledXferBufferCount(void) {
+  size_t count = 0;
+
+  if (NULL != xfer_pool_mu) {
+    NaClXMutexLock(xfer_pool_mu);
+    count = num_pooled_xfer_buffers;
+    NaClXMutexUnlock(xfer_pool_mu);
+  }
+  return count;
+}
+
+/*
+ * Accounts for count buffers leaving the pools.  Buffers pooled before
+ * NaClDescImcFini are no longer counted, so there is nothing to do.
+ */
+static void NaClDescImcUnpoolXferBuffers(size_t count) {
+  if (0 == count || NULL == xfer_pool_mu) {
+    return;
+  }
+  NaClXMutexLock(xfer_pool_mu);
+  num_pooled_xfer_buffers -= (count < num_pooled_xfer_buffers)
+      ? count : num_pooled_xfer_buffers;
+  NaClXMutexUnlock(xfer_pool_mu);
+}
+
 static int NaClDescImcConnectedDescSubclassCtor(
     struct NaClDescImcConnectedDesc  *self,
     NaClHandle                       h) {
   struct NaClDesc *basep = (struct NaClDesc *) self;
 
+  if (!NaClMutexCtor(&self->xfer_buffer_mu)) {
+    return 0;
+  }
+  self->num_xfer_buffers = 0;
   self->h = h;
   basep->base.vtbl = (struct NaClRefCountVtbl const *)
       &kNaClDescImcConnectedDescVtbl;
@@ -78,10 +140,98 @@ static void NaClDescImcConnectedDescDtor(struct NaClRefCount *vself) {
     (void) NaClClose(self->h);
   }
   self->h = NACL_INVALID_HANDLE;
+  NaClDescImcUnpoolXferBuffers(self->num_xfer_buffers);
+  while (self->num_xfer_buffers > 0) {
+    free(self->xfer_buffer[--self->num_xfer_buffers]);
+  }
+  NaClMutexDtor(&self->xfer_buffer_mu);
   vself->vtbl = (struct NaClRefCountVtbl const *) &kNaClDescVtbl;
   (*vself->vtbl->Dtor)(vself);
 }
 
+void *NaClDescImcConnectedDescGetXferBuffer(
+    struct NaClDescImcConnectedDesc *self) {
+  void *buffer = NULL;
+
+  NaClXMutexLock(&self->xfer_buffer_mu);
+  if (self->num_xfer_buffers > 0) {
+    buffer = self->xfer_buffer[--self->num_xfer_buffers];
+    NaClDescImcUnpoolXferBuffers(1);
+  }
+  NaClXMutexUnlock(&self->xfer_buffer_mu);
+  if (NULL == buffer) {
+    buffer = malloc(NACL_ABI_IMC_BYTES_MAX);
+  }
+  return buffer;
+}
+
+void NaClDescImcConnectedDescPutXferBuffer(
+    struct NaClDescImcConnectedDesc *self,
+    void                            *buffer) {
+  if (NULL == buffer) {
+    return;
+  }
+  NaClXMutexLock(&self->xfer_buffer_mu);
+  if (self->num_xfer_buffers < NACL_ARRAY_SIZE(self->xfer_buffer) &&
+      NULL != xfer_pool_mu) {
+    NaClXMutexLock(xfer_pool_mu);
+    if (num_pooled_xfer_buffers < NACL_DESC_IMC_XFER_BUFFER_GLOBAL_MAX) {
+      ++num_pooled_xfer_buffers;
+      self->xfer_buffer[self->num_xfer_buffers++] = buffer;
+      buffer = NULL;
+    }
+    NaClXMutexUnlock(xfer_pool_mu);
+  }
+  NaClXMutexUnlock(&self->xfer_buffer_mu);
+  free(buffer);
+}
+
+/*
+ * IMC sockets carry framed messages, so the host kernel cannot splice
+ * file data into them directly.  Instead the data is read into a
+ * pooled transfer buffer and sent as a sequence of descriptor-free
+ * messages of up to NACL_ABI_IMC_USER_BYTES_MAX bytes each; the
+ * receiver sees exactly what it would from the equivalent sequence of
+ * imc_sendmsg calls, without the data visiting untrusted memory.
+ */
+static ssize_t NaClDescImcConnectedDescSendChunk(void       *sink,
+                                                 void const *buf,
+                                                 size_t     len) {
+  struct NaClImcMsgIoVec    iov;
+  struct NaClImcTypedMsgHdr hdr;
+
+  iov.base = (void *) buf;
+  iov.length = len;
+  hdr.iov = &iov;
+  hdr.iov_length = 1;
+  hdr.ndescv = NULL;
+  hdr.ndesc_length = 0;
+  hdr.flags = 0;
+  /* A message is sent whole or not at all. */
+  return NaClImcSendTypedMessage((struct NaClDesc *) sink, &hdr, 0);
+}
+
+static ssize_t NaClDescImcConnectedDescSendFile(struct NaClDesc *vself,
+                                                struct NaClDesc *source,
+                                                nacl_off64_t    *offset,
+                                                size_t          count) {
+  struct NaClDescImcConnectedDesc *self =
+      (struct NaClDescImcConnectedDesc *) vself;
+  char                            *buffer;
+  ssize_t                         rv;
+
+  buffer = NaClDescImcConnectedDescGetXferBuffer(self);
+  if (NULL == buffer) {
+    return -NACL_ABI_ENOMEM;
+  }
+  rv = NaClSendfileCopyLoop(NaClDescSendFileReadSource, source,
+                            NaClDescImcConnectedDescSendChunk, vself,
+                            buffer, NACL_ABI_IMC_USER_BYTES_MAX,
+                            offset, count);
+  NaClDescImcConnectedDescPutXferBuffer(self, buffer);
+  return rv;
+}
+
 int NaClDescImcDescCtor(struct NaClDescImcDesc  *self,
                         NaClHandle              h) {
   int retval;
@@ -386,6 +536,11 @@ static struct NaClDescVtbl const kNaClDescImcConnectedDescVtbl = {
   NaClDescSeekNotImplemented,
   NaClDescPReadNotImplemented,
   NaClDescPWriteNotImplemented,
+  NaClDescReadVByParts,
+  NaClDescWriteVByParts,
+  NaClDescPReadVByParts,
+  NaClDescPWriteVByParts,
+  NaClDescImcConnectedDescSendFile,
   NaClDescIoctlNotImplemented,
   NaClDescFstatNotImplemented,
   NaClDescGetdentsNotImplemented,
@@ -426,6 +581,11 @@ static struct NaClDescVtbl const kNaClDescImcDescVtbl = {
   NaClDescSeekNotImplemented,
   NaClDescPReadNotImplemented,
   NaClDescPWriteNotImplemented,
+  NaClDescReadVByParts,
+  NaClDescWriteVByParts,
+  NaClDescPReadVByParts,
+  NaClDescPWriteVByParts,
+  NaClDescImcConnectedDescSendFile,
   NaClDescIoctlNotImplemented,
   NaClDescImcDescFstat,  /* diff */
   NaClDescGetdentsNotImplemented,
@@ -466,6 +626,11 @@ static struct NaClDescVtbl const kNaClDescXferableDataDescVtbl = {
   NaClDescSeekNotImplemented,
   NaClDescPReadNotImplemented,
   NaClDescPWriteNotImplemented,
+  NaClDescReadVByParts,
+  NaClDescWriteVByParts,
+  NaClDescPReadVByParts,
+  NaClDescPWriteVByParts,
+  NaClDescImcConnectedDescSendFile,
   NaClDescIoctlNotImplemented,
   NaClDescXferableDataDescFstat,  /* diff */
   NaClDescGetdentsNotImplemented,
@@ -37,9 +37,30 @@ struct NaClMessageHeader;
  * NaClDescXferableDataDescCtor to set the xferable flag which sets
  * the base class to the appropriate subclass behavior.
  */
+/*
+ * Number of message transfer buffers each connected socket keeps for
+ * reuse.  One each for a concurrent sender and receiver.
+ */
+#define NACL_DESC_IMC_XFER_BUFFER_POOL_SIZE 2
+
+/*
+ * Upper bound on idle transfer buffers pooled across all sockets, so
+ * that many mostly idle sockets do not pin NACL_ABI_IMC_BYTES_MAX
+ * bytes each.  Beyond this, returned buffers are freed.
+ */
+#define NACL_DESC_IMC_XFER_BUFFER_GLOBAL_MAX 32
+
 struct NaClDescImcConnectedDesc {
   struct NaClDesc           base NACL_IS_REFCOUNT_SUBCLASS;
   NaClHandle                h;
+  /*
+   * Buffers of NACL_ABI_IMC_BYTES_MAX bytes, used by the typed message
+   * send and receive code to marshal messages, kept so that steady
+   * state messaging does not allocate.
+   */
+  struct NaClMutex          xfer_buffer_mu;
+  size_t                    num_xfer_buffers;
+  void                      *xfer_buffer[NACL_DESC_IMC_XFER_BUFFER_POOL_SIZE];
 };
 
 struct NaClDescImcDesc {
@@ -65,6 +86,32 @@ int NaClDescImcConnectedDescCtor(struct NaClDescImcConnectedDesc  *self,
                                  NaClHandle                       h)
     NACL_WUR;
 
+/*
+ * Returns a transfer buffer of NACL_ABI_IMC_BYTES_MAX bytes, reusing
+ * one from the pool if possible.  Returns NULL if out of memory.
+ */
+void *NaClDescImcConnectedDescGetXferBuffer(
+    struct NaClDescImcConnectedDesc *self);
+
+/*
+ * Returns a buffer obtained from NaClDescImcConnectedDescGetXferBuffer
+ * to the pool, or frees it if the socket's pool is full, the global
+ * limit is reached, or NaClDescImcInit has not been called.
+ */
+void NaClDescImcConnectedDescPutXferBuffer(
+    struct NaClDescImcConnectedDesc *self,
+    void                            *buffer);
+
+/*
+ * Initialize and tear down the global transfer buffer pool limit;
+ * called from NaClNrdAllModulesInit and NaClNrdAllModulesFini.
+ */
+void NaClDescImcInit(void);
+void NaClDescImcFini(void);
+
+/* Number of idle transfer buffers currently pooled by all sockets. */
+size_t NaClDescImcPooledXferBufferCount(void);
+
 int NaClDescImcDescCtor(struct NaClDescImcDesc  *self,
                         NaClHandle              d)
     NACL_WUR;
@@ -290,6 +290,58 @@ static ssize_t NaClDescIoDescPWrite(struct NaClDesc *vself,
   return NaClHostDescPWrite(self->hd, buf, len, offset);
 }
 
+static ssize_t NaClDescIoDescReadV(struct NaClDesc            *vself,
+                                   struct NaClHostIoVec const *iov,
+                                   size_t                     iovcnt) {
+  struct NaClDescIoDesc *self = (struct NaClDescIoDesc *) vself;
+
+  return NaClHostDescReadv(self->hd, iov, iovcnt);
+}
+
+static ssize_t NaClDescIoDescWriteV(struct NaClDesc             *vself,
+                                    struct NaClHostIoVec const  *iov,
+                                    size_t                      iovcnt) {
+  struct NaClDescIoDesc *self = (struct NaClDescIoDesc *) vself;
+
+  return NaClHostDescWritev(self->hd, iov, iovcnt);
+}
+
+static ssize_t NaClDescIoDescPReadV(struct NaClDesc             *vself,
+                                    struct NaClHostIoVec const  *iov,
+                                    size_t                      iovcnt,
+                                    nacl_off64_t                offset) {
+  struct NaClDescIoDesc *self = (struct NaClDescIoDesc *) vself;
+
+  return NaClHostDescPReadv(self->hd, iov, iovcnt, offset);
+}
+
+static ssize_t NaClDescIoDescPWriteV(struct NaClDesc            *vself,
+                                     struct NaClHostIoVec const *iov,
+                                     size_t                     iovcnt,
+                                     nacl_off64_t               offset) {
+  struct NaClDescIoDesc *self = (struct NaClDescIoDesc *) vself;
+
+  return NaClHostDescPWritev(self->hd, iov, iovcnt, offset);
+}
+
+static ssize_t NaClDescIoDescSendFile(struct NaClDesc *vself,
+                                      struct NaClDesc *source,
+                                      nacl_off64_t    *offset,
+                                      size_t          count) {
+  struct NaClDescIoDesc *self = (struct NaClDescIoDesc *) vself;
+
+  /*
+   * Only a pair of host descriptors can be handed to the host kernel;
+   * anything else is copied through a trusted buffer.
+   */
+  if (NACL_DESC_HOST_IO != NACL_VTBL(NaClDesc, source)->typeTag) {
+    return NaClDescSendFileByCopy(vself, source, offset, count);
+  }
+  return NaClHostDescSendfile(self->hd,
+                              ((struct NaClDescIoDesc *) source)->hd,
+                              offset, count);
+}
+
 static int NaClDescIoDescIoctl(struct NaClDesc         *vself,
                                int                     request,
                                void                    *arg) {
@@ -366,6 +418,11 @@ static struct NaClDescVtbl const kNaClDescIoDescVtbl = {
   NaClDescIoDescSeek,
   NaClDescIoDescPRead,
   NaClDescIoDescPWrite,
+  NaClDescIoDescReadV,
+  NaClDescIoDescWriteV,
+  NaClDescIoDescPReadV,
+  NaClDescIoDescPWriteV,
+  NaClDescIoDescSendFile,
   NaClDescIoDescIoctl,
   NaClDescIoDescFstat,
   NaClDescGetdentsNotImplemented,
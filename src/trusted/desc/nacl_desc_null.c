@@ -145,6 +145,11 @@ static struct NaClDescVtbl const kNaClDescNullVtbl = {
   NaClDescSeekNotImplemented,
   NaClDescNullPRead,
   NaClDescNullPWrite,
+  NaClDescReadVByParts,
+  NaClDescWriteVByParts,
+  NaClDescPReadVByParts,
+  NaClDescPWriteVByParts,
+  NaClDescSendFileByCopy,
   NaClDescIoctlNotImplemented,
   NaClDescNullFstat,
   NaClDescGetdentsNotImplemented,
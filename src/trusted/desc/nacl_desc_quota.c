@@ -245,6 +245,91 @@ abort:
   return rv;
 }
 
+ssize_t NaClDescQuotaSendFile(struct NaClDesc *vself,
+                              struct NaClDesc *source,
+                              nacl_off64_t    *offset,
+                              size_t          count) {
+  struct NaClDescQuota  *self = (struct NaClDescQuota *) vself;
+  nacl_off64_t          file_offset;
+  uint64_t              count_u64;
+  int64_t               allowed;
+
+  /*
+   * Quota is requested for the whole transfer up front, exactly as for
+   * NaClDescQuotaWrite, and the wrapped descriptor's SendFile is then
+   * limited to the amount granted.  Unlike Write, mu is only held for
+   * the quota request: a transfer can be long, and holding mu for it
+   * would stall every other writer.  A concurrent Write may then move
+   * the file position between the request and the transfer, so the
+   * quota is charged at a stale offset, as it is for a racing PWrite;
+   * the amount charged is still the amount that can be written.
+   */
+  if (0 == count) {
+    allowed = 0;
+  } else {
+    NaClXMutexLock(&self->mu);
+    file_offset = (*NACL_VTBL(NaClDesc, self->desc)->Seek)(self->desc,
+                                                           0,
+                                                           SEEK_CUR);
+    if (file_offset < 0) {
+      NaClXMutexUnlock(&self->mu);
+      return (ssize_t) file_offset;
+    }
+
+    count_u64 = (uint64_t) count;
+    /* get rid of the always-true/always-false comparison warning */
+    if (count_u64 > NACL_MAX_VAL(int64_t)) {
+      count = (size_t) NACL_MAX_VAL(int64_t);
+    }
+
+    if (NULL == self->quota_interface) {
+      /* If there is no quota_interface, do not allow writes. */
+      allowed = 0;
+    } else {
+      allowed = (*NACL_VTBL(NaClDescQuotaInterface, self->quota_interface)->
+                 WriteRequest)(self->quota_interface,
+                               self->file_id, file_offset, count);
+    }
+    NaClXMutexUnlock(&self->mu);
+    if (allowed <= 0) {
+      return -NACL_ABI_EDQUOT;
+    }
+    if ((uint64_t) allowed > count) {
+      NaClLog(LOG_WARNING,
+              ("NaClDescQuotaSendFile: WriteRequest returned an allowed quota"
+               " that is larger than that requested; reducing to original"
+               " request amount.\n"));
+      allowed = count;
+    }
+  }
+
+  /*
+   * As with Write, quota for a short transfer leaks.
+   * TODO(sehr,bsy): eliminate quota leakage.
+   */
+  return (*NACL_VTBL(NaClDesc, self->desc)->SendFile)(self->desc, source,
+                                                      offset,
+                                                      (size_t) allowed);
+}
+
+ssize_t NaClDescQuotaReadV(struct NaClDesc            *vself,
+                           struct NaClHostIoVec const *iov,
+                           size_t                     iovcnt) {
+  struct NaClDescQuota  *self = (struct NaClDescQuota *) vself;
+
+  return (*NACL_VTBL(NaClDesc, self->desc)->ReadV)(self->desc, iov, iovcnt);
+}
+
+ssize_t NaClDescQuotaPReadV(struct NaClDesc             *vself,
+                            struct NaClHostIoVec const  *iov,
+                            size_t                      iovcnt,
+                            nacl_off64_t                offset) {
+  struct NaClDescQuota  *self = (struct NaClDescQuota *) vself;
+
+  return (*NACL_VTBL(NaClDesc, self->desc)->PReadV)(self->desc, iov, iovcnt,
+                                                    offset);
+}
+
 nacl_off64_t NaClDescQuotaSeek(struct NaClDesc  *vself,
                                nacl_off64_t     offset,
                                int              whence) {
@@ -525,6 +610,11 @@ static struct NaClDescVtbl const kNaClDescQuotaVtbl = {
   NaClDescQuotaSeek,
   NaClDescQuotaPRead,
   NaClDescQuotaPWrite,
+  NaClDescQuotaReadV,
+  NaClDescWriteVByParts,  /* quota is requested per element */
+  NaClDescQuotaPReadV,
+  NaClDescPWriteVByParts,
+  NaClDescQuotaSendFile,
   NaClDescQuotaIoctl,
   NaClDescQuotaFstat,
   NaClDescQuotaGetdents,
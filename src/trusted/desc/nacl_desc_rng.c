@@ -143,6 +143,11 @@ static struct NaClDescVtbl const kNaClDescRngVtbl = {
   NaClDescSeekNotImplemented,
   NaClDescPReadNotImplemented,
   NaClDescPWriteNotImplemented,
+  NaClDescReadVByParts,
+  NaClDescWriteVByParts,
+  NaClDescPReadVByParts,
+  NaClDescPWriteVByParts,
+  NaClDescSendFileByCopy,
   NaClDescIoctlNotImplemented,
   NaClDescRngFstat,
   NaClDescGetdentsNotImplemented,
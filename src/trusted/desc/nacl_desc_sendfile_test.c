@@ -0,0 +1,403 @@
+/*
+ * Copyright (c) 2013 The Native Client Authors. All rights reserved.
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+/*
+ * Tests the SendFile descriptor method for file and IMC sinks and for
+ * quota-limited sinks, and compares its throughput with a read/write
+ * loop through a buffer, which is what untrusted code has to do
+ * without it.  The default transfer size is small enough for the
+ * small_tests suite; "-m 1024" gives the 1GB transfer used for
+ * measurements.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "native_client/src/include/nacl_macros.h"
+#include "native_client/src/include/portability.h"
+#include "native_client/src/include/portability_io.h"
+#include "native_client/src/include/portability_string.h"
+#include "native_client/src/public/imc_types.h"
+#include "native_client/src/shared/platform/nacl_check.h"
+#include "native_client/src/shared/platform/nacl_host_desc.h"
+#include "native_client/src/shared/platform/nacl_log.h"
+#include "native_client/src/shared/platform/nacl_threads.h"
+#include "native_client/src/shared/platform/nacl_time.h"
+#include "native_client/src/trusted/desc/nacl_desc_base.h"
+#include "native_client/src/trusted/desc/nacl_desc_io.h"
+#include "native_client/src/trusted/desc/nacl_desc_quota.h"
+#include "native_client/src/trusted/desc/nacl_desc_quota_interface.h"
+#include "native_client/src/trusted/desc/nrd_all_modules.h"
+#include "native_client/src/trusted/desc/nrd_xfer.h"
+#include "native_client/src/trusted/service_runtime/include/sys/errno.h"
+#include "native_client/src/trusted/service_runtime/include/sys/fcntl.h"
+
+#define kBounceBufferBytes (64 << 10)
+
+static char const *gTestDir = "/tmp";
+static int gFileCount = 0;
+
+static struct NaClDesc *OpenTestFile(int flags) {
+  char path[1024];
+  struct NaClDescIoDesc *desc;
+
+  SNPRINTF(path, sizeof path, "%s/sendfile%d", gTestDir, gFileCount++);
+  desc = NaClDescIoDescOpen(path,
+                            flags | NACL_ABI_O_CREAT | NACL_ABI_O_TRUNC,
+                            0666);
+  CHECK(NULL != desc);
+  return (struct NaClDesc *) desc;
+}
+
+static unsigned char PatternByte(uint64_t offset) {
+  return (unsigned char) ((offset * 7) ^ (offset >> 9));
+}
+
+static struct NaClDesc *MakeSourceFile(uint64_t num_bytes) {
+  struct NaClDesc *desc = OpenTestFile(NACL_ABI_O_RDWR);
+  unsigned char *buffer = malloc(kBounceBufferBytes);
+  uint64_t written = 0;
+  size_t chunk;
+  size_t i;
+
+  CHECK(NULL != buffer);
+  while (written < num_bytes) {
+    chunk = kBounceBufferBytes;
+    if (chunk > num_bytes - written) {
+      chunk = (size_t) (num_bytes - written);
+    }
+    for (i = 0; i < chunk; ++i) {
+      buffer[i] = PatternByte(written + i);
+    }
+    CHECK((ssize_t) chunk ==
+          (*NACL_VTBL(NaClDesc, desc)->Write)(desc, buffer, chunk));
+    written += chunk;
+  }
+  free(buffer);
+  CHECK(0 == (*NACL_VTBL(NaClDesc, desc)->Seek)(desc, 0, SEEK_SET));
+  return desc;
+}
+
+static void CheckPattern(struct NaClDesc *desc, uint64_t start,
+                         size_t num_bytes) {
+  unsigned char *buffer = malloc(num_bytes);
+  size_t i;
+
+  CHECK(NULL != buffer);
+  CHECK((ssize_t) num_bytes ==
+        (*NACL_VTBL(NaClDesc, desc)->PRead)(desc, buffer, num_bytes, 0));
+  for (i = 0; i < num_bytes; ++i) {
+    CHECK(buffer[i] == PatternByte(start + i));
+  }
+  free(buffer);
+}
+
+static void TestFileToFile(void) {
+  static const size_t kFileBytes = (1 << 20) + 123;
+  struct NaClDesc *source = MakeSourceFile(kFileBytes);
+  struct NaClDesc *sink = OpenTestFile(NACL_ABI_O_RDWR);
+  nacl_off64_t offset = 100;
+  ssize_t rv;
+
+  /* With an offset, the source's file position is left alone. */
+  rv = (*NACL_VTBL(NaClDesc, sink)->SendFile)(sink, source, &offset,
+                                              kFileBytes);
+  CHECK(rv == (ssize_t) (kFileBytes - 100));
+  CHECK(offset == (nacl_off64_t) kFileBytes);
+  CHECK(0 == (*NACL_VTBL(NaClDesc, source)->Seek)(source, 0, SEEK_CUR));
+  CheckPattern(sink, 100, kFileBytes - 100);
+
+  /* Without one, the source's file position is used and advanced. */
+  rv = (*NACL_VTBL(NaClDesc, sink)->SendFile)(sink, source, NULL, 50);
+  CHECK(50 == rv);
+  CHECK(50 == (*NACL_VTBL(NaClDesc, source)->Seek)(source, 0, SEEK_CUR));
+
+  /* At end of file, nothing is transferred. */
+  offset = kFileBytes;
+  rv = (*NACL_VTBL(NaClDesc, sink)->SendFile)(sink, source, &offset, 10);
+  CHECK(0 == rv);
+
+  NaClDescUnref(sink);
+  NaClDescUnref(source);
+  printf("TestFileToFile passed\n");
+}
+
+/*
+ * A quota interface that grants a fixed total.
+ */
+static int64_t gQuotaBytes;
+
+static void FakeDtor(struct NaClRefCount *nrcp) {
+  nrcp->vtbl = (struct NaClRefCountVtbl *)(&kNaClDescQuotaInterfaceVtbl);
+  (*nrcp->vtbl->Dtor)(nrcp);
+}
+
+static int64_t FakeWriteRequest(struct NaClDescQuotaInterface *quota_interface,
+                                uint8_t const                 *file_id,
+                                int64_t                       offset,
+                                int64_t                       length) {
+  UNREFERENCED_PARAMETER(quota_interface);
+  UNREFERENCED_PARAMETER(file_id);
+  UNREFERENCED_PARAMETER(offset);
+
+  if (length > gQuotaBytes) {
+    length = gQuotaBytes;
+  }
+  gQuotaBytes -= length;
+  return length;
+}
+
+static int64_t FakeFtruncateRequest(
+    struct NaClDescQuotaInterface *quota_interface,
+    uint8_t const                 *file_id,
+    int64_t                       length) {
+  UNREFERENCED_PARAMETER(quota_interface);
+  UNREFERENCED_PARAMETER(file_id);
+
+  NaClLog(LOG_FATAL, "FtruncateRequest invoked!?!\n");
+  return length;
+}
+
+static struct NaClDescQuotaInterfaceVtbl const kFakeQuotaInterfaceVtbl = {
+  {
+    FakeDtor
+  },
+  FakeWriteRequest,
+  FakeFtruncateRequest
+};
+
+static void TestQuotaSink(void) {
+  static uint8_t file_id[NACL_DESC_QUOTA_FILE_ID_LEN];
+  struct NaClDesc *source = MakeSourceFile(4096);
+  struct NaClDescQuotaInterface *quota_interface;
+  struct NaClDescQuota *sink;
+  nacl_off64_t offset = 0;
+  ssize_t rv;
+
+  quota_interface = malloc(sizeof *quota_interface);
+  CHECK(NULL != quota_interface);
+  CHECK(NaClDescQuotaInterfaceCtor(quota_interface));
+  ((struct NaClRefCount *) quota_interface)->vtbl =
+      (struct NaClRefCountVtbl *) &kFakeQuotaInterfaceVtbl;
+  sink = malloc(sizeof *sink);
+  CHECK(NULL != sink);
+  CHECK(NaClDescQuotaCtor(sink, OpenTestFile(NACL_ABI_O_RDWR), file_id,
+                          quota_interface));
+
+  gQuotaBytes = 1000;
+  rv = (*NACL_VTBL(NaClDesc, sink)->SendFile)((struct NaClDesc *) sink,
+                                              source, &offset, 4096);
+  CHECK(1000 == rv);
+  CHECK(1000 == offset);
+  CHECK(0 == gQuotaBytes);
+  rv = (*NACL_VTBL(NaClDesc, sink)->SendFile)((struct NaClDesc *) sink,
+                                              source, &offset, 4096);
+  CHECK(-NACL_ABI_EDQUOT == rv);
+  CheckPattern((struct NaClDesc *) sink, 0, 1000);
+
+  NaClDescUnref((struct NaClDesc *) sink);
+  NaClDescQuotaInterfaceUnref(quota_interface);
+  NaClDescUnref(source);
+  printf("TestQuotaSink passed\n");
+}
+
+/*
+ * Receives messages from an IMC socket until the expected number of
+ * bytes has arrived, optionally checking them against the pattern.
+ */
+struct DrainState {
+  struct NaClDesc *receiver;
+  uint64_t expected_bytes;
+  int check_pattern;
+  uint64_t received_bytes;
+  int pattern_ok;
+};
+
+static void WINAPI DrainThread(void *arg) {
+  struct DrainState *state = (struct DrainState *) arg;
+  unsigned char *buffer = malloc(NACL_ABI_IMC_USER_BYTES_MAX);
+  struct NaClImcMsgIoVec iov;
+  struct NaClImcTypedMsgHdr hdr;
+  ssize_t rv;
+  ssize_t i;
+
+  CHECK(NULL != buffer);
+  state->received_bytes = 0;
+  state->pattern_ok = 1;
+  while (state->received_bytes < state->expected_bytes) {
+    iov.base = buffer;
+    iov.length = NACL_ABI_IMC_USER_BYTES_MAX;
+    hdr.iov = &iov;
+    hdr.iov_length = 1;
+    hdr.ndescv = NULL;
+    hdr.ndesc_length = 0;
+    hdr.flags = 0;
+    rv = NaClImcRecvTypedMessage(state->receiver, &hdr, 0, NULL);
+    CHECK(rv > 0);
+    if (state->check_pattern) {
+      for (i = 0; i < rv; ++i) {
+        if (buffer[i] != PatternByte(state->received_bytes + i)) {
+          state->pattern_ok = 0;
+        }
+      }
+    }
+    state->received_bytes += rv;
+  }
+  free(buffer);
+}
+
+static void StartDrain(struct NaClThread *thread, struct DrainState *state,
+                       struct NaClDesc *receiver, uint64_t expected_bytes,
+                       int check_pattern) {
+  state->receiver = receiver;
+  state->expected_bytes = expected_bytes;
+  state->check_pattern = check_pattern;
+  CHECK(NaClThreadCreateJoinable(thread, DrainThread, state, 128 << 10));
+}
+
+static void TestFileToImc(void) {
+  static const size_t kFileBytes = (1 << 20) + 4567;
+  struct NaClDesc *source = MakeSourceFile(kFileBytes);
+  struct NaClDesc *pair[2];
+  struct NaClThread thread;
+  struct DrainState state;
+  nacl_off64_t offset = 0;
+  ssize_t rv;
+
+  CHECK(0 == NaClCommonDescSocketPair(pair));
+  StartDrain(&thread, &state, pair[1], kFileBytes, 1);
+  rv = (*NACL_VTBL(NaClDesc, pair[0])->SendFile)(pair[0], source, &offset,
+                                                 kFileBytes);
+  CHECK(rv == (ssize_t) kFileBytes);
+  NaClThreadJoin(&thread);
+  CHECK(state.received_bytes == kFileBytes);
+  CHECK(state.pattern_ok);
+
+  NaClDescUnref(pair[0]);
+  NaClDescUnref(pair[1]);
+  NaClDescUnref(source);
+  printf("TestFileToImc passed\n");
+}
+
+/*
+ * The copy loop that SendFile replaces: each chunk is read into a
+ * buffer and then written or sent from it.
+ */
+static uint64_t CopyLoop(struct NaClDesc *sink, struct NaClDesc *source,
+                         int sink_is_imc) {
+  char *buffer = malloc(kBounceBufferBytes);
+  struct NaClImcMsgIoVec iov;
+  struct NaClImcTypedMsgHdr hdr;
+  uint64_t total = 0;
+  ssize_t nread;
+
+  CHECK(NULL != buffer);
+  hdr.iov = &iov;
+  hdr.iov_length = 1;
+  hdr.ndescv = NULL;
+  hdr.ndesc_length = 0;
+  hdr.flags = 0;
+  while (0 < (nread = (*NACL_VTBL(NaClDesc, source)->
+                       PRead)(source, buffer, kBounceBufferBytes, total))) {
+    if (sink_is_imc) {
+      iov.base = buffer;
+      iov.length = (size_t) nread;
+      CHECK(nread == NaClImcSendTypedMessage(sink, &hdr, 0));
+    } else {
+      CHECK(nread == (*NACL_VTBL(NaClDesc, sink)->Write)(sink, buffer,
+                                                         (size_t) nread));
+    }
+    total += nread;
+  }
+  free(buffer);
+  return total;
+}
+
+static uint64_t SendFileLoop(struct NaClDesc *sink, struct NaClDesc *source) {
+  nacl_off64_t offset = 0;
+  ssize_t rv;
+
+  while (0 < (rv = (*NACL_VTBL(NaClDesc, sink)->
+                    SendFile)(sink, source, &offset, INT32_MAX))) {
+  }
+  CHECK(0 == rv);
+  return (uint64_t) offset;
+}
+
+static void ReportThroughput(char const *name, uint64_t num_bytes,
+                             int64_t start_usec) {
+  double seconds = (NaClGetTimeOfDayMicroseconds() - start_usec) / 1e6;
+
+  printf("%-24s %8.1f MB/s\n", name, num_bytes / seconds / (1 << 20));
+}
+
+static void MeasureThroughput(uint64_t num_bytes) {
+  struct NaClDesc *source = MakeSourceFile(num_bytes);
+  struct NaClDesc *sink;
+  struct NaClDesc *pair[2];
+  struct NaClThread thread;
+  struct DrainState state;
+  int64_t start;
+  int use_sendfile;
+
+  printf("Transferring %"NACL_PRIu64" MB\n", num_bytes >> 20);
+  for (use_sendfile = 0; use_sendfile < 2; ++use_sendfile) {
+    sink = OpenTestFile(NACL_ABI_O_WRONLY);
+    start = NaClGetTimeOfDayMicroseconds();
+    CHECK(num_bytes == (use_sendfile ? SendFileLoop(sink, source)
+                                     : CopyLoop(sink, source, 0)));
+    ReportThroughput(use_sendfile ? "file to file, sendfile"
+                                  : "file to file, copy",
+                     num_bytes, start);
+    NaClDescUnref(sink);
+
+    CHECK(0 == NaClCommonDescSocketPair(pair));
+    StartDrain(&thread, &state, pair[1], num_bytes, 0);
+    start = NaClGetTimeOfDayMicroseconds();
+    CHECK(num_bytes == (use_sendfile ? SendFileLoop(pair[0], source)
+                                     : CopyLoop(pair[0], source, 1)));
+    NaClThreadJoin(&thread);
+    ReportThroughput(use_sendfile ? "file to IMC, sendfile"
+                                  : "file to IMC, copy",
+                     num_bytes, start);
+    NaClDescUnref(pair[0]);
+    NaClDescUnref(pair[1]);
+  }
+  NaClDescUnref(source);
+}
+
+int main(int ac, char **av) {
+  uint64_t megabytes = 16;
+  int opt;
+
+  while (EOF != (opt = getopt(ac, av, "m:t:"))) {
+    switch (opt) {
+      case 'm':
+        megabytes = STRTOULL(optarg, (char **) NULL, 0);
+        break;
+      case 't':
+        gTestDir = optarg;
+        break;
+      default:
+        fprintf(stderr,
+                "Usage: nacl_desc_sendfile_test [-m megabytes]"
+                " [-t test_temp_dir]\n");
+        return 1;
+    }
+  }
+
+  NaClNrdAllModulesInit();
+
+  TestFileToFile();
+  TestQuotaSink();
+  TestFileToImc();
+  MeasureThroughput(megabytes << 20);
+
+  NaClNrdAllModulesFini();
+  printf("PASSED\n");
+  return 0;
+}
@@ -144,6 +144,11 @@ static struct NaClDescVtbl const kNaClDescSyncSocketVtbl = {
   NaClDescSeekNotImplemented,
   NaClDescPReadNotImplemented,
   NaClDescPWriteNotImplemented,
+  NaClDescReadVByParts,
+  NaClDescWriteVByParts,
+  NaClDescPReadVByParts,
+  NaClDescPWriteVByParts,
+  NaClDescSendFileByCopy,
   NaClDescIoctlNotImplemented,
   NaClDescSyncSocketFstat,
   NaClDescGetdentsNotImplemented,
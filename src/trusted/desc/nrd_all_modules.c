@@ -10,6 +10,7 @@
  */
 
 #include "native_client/src/trusted/desc/nrd_all_modules.h"
+#include "native_client/src/trusted/desc/nacl_desc_imc.h"
 #include "native_client/src/trusted/desc/nacl_desc_invalid.h"
 #include "native_client/src/shared/platform/platform_init.h"
 
@@ -20,9 +21,11 @@ void NaClNrdAllModulesInit(void) {
    */
   NaClPlatformInit();
   NaClDescInvalidInit();
+  NaClDescImcInit();
 }
 
 void NaClNrdAllModulesFini(void) {
+  NaClDescImcFini();
   NaClDescInvalidFini();
   NaClPlatformFini();
 }
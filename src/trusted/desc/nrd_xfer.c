@@ -114,6 +114,37 @@ int NaClDescInternalizeFromXferBuffer(
   return 0 == xfer_status;
 }
 
+/*
+ * Connected IMC sockets keep a pool of transfer buffers, so that
+ * steady-state messaging on them does not allocate.  Other channel
+ * types get a fresh buffer each time.  Buffers are
+ * NACL_ABI_IMC_BYTES_MAX bytes long.
+ */
+static int NaClNrdXferChannelHasBufferPool(struct NaClDesc *channel) {
+  enum NaClDescTypeTag type_tag = NACL_VTBL(NaClDesc, channel)->typeTag;
+
+  return (NACL_DESC_IMC_SOCKET == type_tag ||
+          NACL_DESC_TRANSFERABLE_DATA_SOCKET == type_tag);
+}
+
+static char *NaClNrdXferGetBuffer(struct NaClDesc *channel) {
+  if (NaClNrdXferChannelHasBufferPool(channel)) {
+    return (char *) NaClDescImcConnectedDescGetXferBuffer(
+        (struct NaClDescImcConnectedDesc *) channel);
+  }
+  return (char *) malloc(NACL_ABI_IMC_BYTES_MAX);
+}
+
+static void NaClNrdXferPutBuffer(struct NaClDesc  *channel,
+                                 char             *buffer) {
+  if (NaClNrdXferChannelHasBufferPool(channel)) {
+    NaClDescImcConnectedDescPutXferBuffer(
+        (struct NaClDescImcConnectedDesc *) channel, buffer);
+  } else {
+    free(buffer);
+  }
+}
+
 int NaClDescExternalizeToXferBuffer(struct NaClDescXferState  *xferp,
                                     struct NaClDesc           *out) {
   /*
@@ -153,6 +184,7 @@ ssize_t NaClImcSendTypedMessage(struct NaClDesc                 *channel,
   size_t                    desc_handles;
   struct NaClInternalHeader *hdr;
   char                      *hdr_buf;
+  int                       hdr_buf_pooled;
   struct NaClDescXferState  xfer_state;
 
   static struct NaClInternalHeader const kNoHandles = {
@@ -225,6 +257,7 @@ ssize_t NaClImcSendTypedMessage(struct NaClDesc                 *channel,
 
   kern_desc = nitmhp->ndescv;
   hdr_buf = NULL;
+  hdr_buf_pooled = 0;
 
   /*
    * NOTE: type punning w/ NaClImcMsgIoVec and NaClIOVec.
@@ -235,6 +268,10 @@ ssize_t NaClImcSendTypedMessage(struct NaClDesc                 *channel,
   kern_msg_hdr.iov_length = nitmhp->iov_length + 1;  /* header */
 
   if (0 == nitmhp->ndesc_length) {
+    /*
+     * Fast path: with no descriptors to externalize, the header is a
+     * constant and nothing needs to be sized, allocated or written.
+     */
     kern_msg_hdr.handles = NULL;
     kern_msg_hdr.handle_count = 0;
     kern_iov[0].base = (void *) &kNoHandles;
@@ -297,7 +334,12 @@ ssize_t NaClImcSendTypedMessage(struct NaClDesc                 *channel,
       retval = -NACL_ABI_EOVERFLOW;
       goto cleanup;
     }
-    hdr_buf = malloc(sys_bytes + sizeof *hdr);
+    if (sys_bytes + sizeof *hdr <= NACL_ABI_IMC_BYTES_MAX) {
+      hdr_buf = NaClNrdXferGetBuffer(channel);
+      hdr_buf_pooled = 1;
+    } else {
+      hdr_buf = malloc(sys_bytes + sizeof *hdr);
+    }
     if (NULL == hdr_buf) {
       NaClLog(4, "NaClImcSendTypedMessage: out of memory for iov");
       retval = -NACL_ABI_ENOMEM;
@@ -403,7 +445,11 @@ ssize_t NaClImcSendTypedMessage(struct NaClDesc                 *channel,
 
 cleanup:
 
-  free(hdr_buf);
+  if (hdr_buf_pooled) {
+    NaClNrdXferPutBuffer(channel, hdr_buf);
+  } else {
+    free(hdr_buf);
+  }
 
   NaClLog(4, "NaClImcSendTypedMessage: returning %"NACL_PRIdS"\n", retval);
 
@@ -411,6 +457,72 @@ cleanup:
 }
 
 
+/*
+ * Receives a message on a channel that cannot transfer access rights.
+ * The internal header is received separately and the user data lands
+ * directly in nitmhp's buffers.  The caller has validated nitmhp.
+ */
+static ssize_t NaClImcRecvDataOnlyMessage(
+    struct NaClDesc               *channel,
+    struct NaClImcTypedMsgHdr     *nitmhp,
+    int                           flags) {
+  ssize_t                   total_recv_bytes;
+  struct NaClInternalHeader intern_hdr;
+  /*
+   * BEWARE: type punning between NaClImcMsgIoVec and NaClIOVec, as in
+   * NaClImcSendTypedMessage.
+   */
+  struct NaClImcMsgIoVec    recv_iov[NACL_ABI_IMC_IOVEC_MAX + 1];
+  struct NaClMessageHeader  recv_hdr;
+
+  NaClLog(4, "Transferable Data Only socket\n");
+
+  recv_iov[0].base = (void *) &intern_hdr;
+  recv_iov[0].length = sizeof intern_hdr;
+  memcpy(recv_iov + 1, (void *) nitmhp->iov,
+         nitmhp->iov_length * sizeof *nitmhp->iov);
+
+  recv_hdr.iov = (struct NaClIOVec *) recv_iov;
+  recv_hdr.iov_length = nitmhp->iov_length + 1;
+  recv_hdr.handles = (NaClHandle *) NULL;
+  recv_hdr.handle_count = 0;
+  recv_hdr.flags = 0;
+
+  total_recv_bytes = (*((struct NaClDescVtbl const *) channel->base.vtbl)->
+                      LowLevelRecvMsg)(channel,
+                                       &recv_hdr,
+                                       flags);
+  if (NaClSSizeIsNegErrno(&total_recv_bytes)) {
+    NaClLog(1, "LowLevelRecvMsg failed, returned %"NACL_PRIdS"\n",
+            total_recv_bytes);
+    return total_recv_bytes;
+  }
+  if ((size_t) total_recv_bytes < sizeof intern_hdr) {
+    NaClLog(4, ("only received %"NACL_PRIdS" bytes,"
+                " but internal header is %"NACL_PRIdS" bytes\n"),
+            total_recv_bytes, sizeof intern_hdr);
+    return -NACL_ABI_EIO;
+  }
+  if (NACL_HANDLE_TRANSFER_PROTOCOL != intern_hdr.h.xfer_protocol_version) {
+    NaClLog(4, ("protocol version mismatch:"
+                " got %x, but can only handle %x\n"),
+            intern_hdr.h.xfer_protocol_version, NACL_HANDLE_TRANSFER_PROTOCOL);
+    return -NACL_ABI_EIO;
+  }
+  if (0 != intern_hdr.h.descriptor_data_bytes) {
+    /*
+     * The descriptor data, if any, has already been scattered into the
+     * user's buffers; but no peer may send it on this kind of channel.
+     */
+    NaClLog(4, ("internal header says there are %d NRD xfer descriptor"
+                " bytes on a data only channel\n"),
+            intern_hdr.h.descriptor_data_bytes);
+    return -NACL_ABI_EIO;
+  }
+  nitmhp->ndesc_length = 0;
+  return total_recv_bytes - sizeof intern_hdr;
+}
+
 ssize_t NaClImcRecvTypedMessage(
     struct NaClDesc               *channel,
     struct NaClImcTypedMsgHdr     *nitmhp,
@@ -475,13 +587,25 @@ ssize_t NaClImcRecvTypedMessage(
    *                   NACL_ABI_IMC_USER_BYTES_MAX)
    */
 
+  if (NACL_DESC_IMC_SOCKET != ((struct NaClDescVtbl const *)
+                               channel->base.vtbl)->typeTag) {
+    /*
+     * Fast path: a channel that cannot transfer access rights never
+     * carries descriptor data, so the message can be scattered directly
+     * into the caller's buffers without staging it.
+     */
+    retval = NaClImcRecvDataOnlyMessage(channel, nitmhp, flags);
+    NaClLog(3, "NaClImcRecvTypedMsg: returning %"NACL_PRIdS"\n", retval);
+    return retval;
+  }
+
   recv_buf = NULL;
   memset(new_desc, 0, sizeof new_desc);
   /*
    * from here on, set retval and jump to cleanup code.
    */
 
-  recv_buf = malloc(NACL_ABI_IMC_BYTES_MAX);
+  recv_buf = NaClNrdXferGetBuffer(channel);
   if (NULL == recv_buf) {
     NaClLog(4, "no memory for receive buffer\n");
     retval = -NACL_ABI_ENOMEM;
@@ -498,25 +622,12 @@ ssize_t NaClImcRecvTypedMessage(
     kern_handle[i] = NACL_INVALID_HANDLE;
   }
 
-  if (NACL_DESC_IMC_SOCKET == ((struct NaClDescVtbl const *)
-                               channel->base.vtbl)->typeTag) {
-    /*
-     * Channel can transfer access rights.
-     */
-
-    recv_hdr.handles = kern_handle;
-    recv_hdr.handle_count = NACL_ARRAY_SIZE(kern_handle);
-    NaClLog(4, "Connected socket, may transfer descriptors\n");
-  } else {
-    /*
-     * Channel cannot transfer access rights.  The syscall would fail
-     * if recv_iov.length is non-zero.
-     */
-
-    recv_hdr.handles = (NaClHandle *) NULL;
-    recv_hdr.handle_count = 0;
-    NaClLog(4, "Transferable Data Only socket\n");
-  }
+  /*
+   * Channel can transfer access rights.
+   */
+  recv_hdr.handles = kern_handle;
+  recv_hdr.handle_count = NACL_ARRAY_SIZE(kern_handle);
+  NaClLog(4, "Connected socket, may transfer descriptors\n");
 
   recv_hdr.flags = 0;  /* just to make it obvious; IMC will clear it for us */
 
@@ -694,7 +805,9 @@ ssize_t NaClImcRecvTypedMessage(
   /* retval is number of bytes received */
 
 cleanup:
-  free(recv_buf);
+  if (NULL != recv_buf) {
+    NaClNrdXferPutBuffer(channel, recv_buf);
+  }
 
   /*
    * Note that we must exercise discipline when constructing NaClDesc
@@ -26,9 +26,10 @@
 /*
  * This code maps in GIO_SHM_WINDOWSIZE bytes at a time for doing
  * "I/O" from/to the shared memory object.  This value must be an
- * integer multiple of NACL_MAP_PAGESIZE.
+ * integer multiple of NACL_MAP_PAGESIZE.  It is large so that
+ * streaming megabytes of data, e.g. a crash dump, remaps rarely.
  */
-#define GIO_SHM_WINDOWSIZE  (16 * NACL_MAP_PAGESIZE)
+#define GIO_SHM_WINDOWSIZE  NACL_GIO_SHM_WINDOW_SIZE
 
 /*
  * Release current window if it exists, then map in window at the
@@ -265,6 +266,52 @@ static off_t NaClGioShmSeek(struct Gio  *vself,
   return (off_t) self->io_offset;
 }
 
+char *NaClGioShmGetWriteBuffer(struct NaClGioShm  *self,
+                               size_t             min_bytes,
+                               size_t             *avail) {
+  size_t  window_end;
+
+  if (min_bytes > NACL_GIO_SHM_MAX_BUFFER) {
+    errno = EINVAL;
+    return NULL;
+  }
+  if (self->io_offset >= self->shm_sz
+      || self->shm_sz - self->io_offset < min_bytes) {
+    errno = ENOSPC;
+    return NULL;
+  }
+  if (NULL == self->cur_window
+      || self->io_offset < self->window_offset
+      || self->window_offset + self->window_size <= self->io_offset
+      || (self->window_offset + self->window_size - self->io_offset
+          < min_bytes)) {
+    /*
+     * The new window starts at the page holding io_offset, so it has
+     * at least NACL_GIO_SHM_MAX_BUFFER bytes past io_offset, or all
+     * that remain in the object.
+     */
+    if (!NaClGioShmSetWindow(self,
+                             (self->io_offset
+                              & ~(((size_t) NACL_MAP_PAGESIZE) - 1)))) {
+      errno = EIO;
+      return NULL;
+    }
+  }
+  window_end = self->window_offset + self->window_size;
+  CHECK(window_end - self->io_offset >= min_bytes);
+  *avail = window_end - self->io_offset;
+  return self->cur_window + (self->io_offset - self->window_offset);
+}
+
+void NaClGioShmCommitWrite(struct NaClGioShm  *self,
+                           size_t             nbytes) {
+  CHECK(NULL != self->cur_window);
+  CHECK(self->window_offset <= self->io_offset);
+  CHECK(nbytes <= (self->window_offset + self->window_size
+                   - self->io_offset));
+  self->io_offset += nbytes;
+}
+
 static int NaClGioShmFlush(struct Gio *vself) {
   UNREFERENCED_PARAMETER(vself);
   return 0;
@@ -275,7 +322,7 @@ static int NaClGioShmClose(struct Gio *vself) {
 
   if (NULL != self->cur_window) {
     NaClDescUnmapUnsafe(self->shmp, (void *) self->cur_window,
-                        NACL_MAP_PAGESIZE);
+                        self->window_size);
   }
   self->cur_window = NULL;
 
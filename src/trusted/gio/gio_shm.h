@@ -16,10 +16,21 @@
 
 #include "native_client/src/shared/gio/gio.h"
 
+#include "native_client/src/trusted/service_runtime/nacl_config.h"
+
 EXTERN_C_BEGIN
 
 struct NaClDesc;
 
+/*
+ * The shm object is mapped in NACL_GIO_SHM_WINDOW_SIZE bytes at a
+ * time, starting at the page holding the I/O offset, so a window
+ * always has at least NACL_GIO_SHM_MAX_BUFFER contiguous bytes past
+ * the I/O offset (short of the end of the object).
+ */
+#define NACL_GIO_SHM_WINDOW_SIZE  (64 * NACL_MAP_PAGESIZE)
+#define NACL_GIO_SHM_MAX_BUFFER   (NACL_GIO_SHM_WINDOW_SIZE - NACL_MAP_PAGESIZE)
+
 struct NaClGioShm {
   /* public */
   struct Gio                        base;
@@ -54,6 +65,29 @@ int NaClGioShmCtor(struct NaClGioShm  *self,
 int NaClGioShmAllocCtor(struct NaClGioShm *self,
                         size_t            shm_size);
 
+/*
+ * Zero-copy writes, for producers that format directly into the shm
+ * object rather than into a buffer that Write would then copy.
+ *
+ * NaClGioShmGetWriteBuffer maps the window at the I/O offset and
+ * returns a pointer to the I/O offset within it, setting *avail to
+ * the number of contiguous bytes that may be written there, which is
+ * at least min_bytes.  min_bytes may be at most
+ * NACL_GIO_SHM_MAX_BUFFER.  Returns NULL and sets errno if fewer than
+ * min_bytes remain before the end of the object, or if the window
+ * cannot be mapped.  The pointer is valid until the next operation on
+ * the object.
+ *
+ * NaClGioShmCommitWrite advances the I/O offset past the nbytes, at
+ * most *avail, that the producer filled in.
+ */
+char *NaClGioShmGetWriteBuffer(struct NaClGioShm  *self,
+                               size_t             min_bytes,
+                               size_t             *avail);
+
+void NaClGioShmCommitWrite(struct NaClGioShm  *self,
+                           size_t             nbytes);
+
 /* Dtor is a virtual function */
 
 EXTERN_C_END
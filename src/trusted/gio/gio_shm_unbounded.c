@@ -13,7 +13,8 @@
  * Also, we maintain the following invariant: all I/O operations are
  * done once, rather than split.  So if a write would grow a shm
  * object, we grow before doing the write.  This leads to more
- * copying, but makes the I/O operations simpler.
+ * copying, but makes the I/O operations simpler.  Only the bytes
+ * written so far are copied when growing.
  */
 
 #include <errno.h>
@@ -65,18 +66,22 @@ static ssize_t NaClGioShmUnboundedRead(struct Gio  *vself,
   return got;
 }
 
-static void GioCopy(struct Gio  *dst,
-                    struct Gio  *src,
-                    size_t      nbytes) {
-  uint8_t buf[4096];
-  uint8_t *bufp;
+/*
+ * Copies the first nbytes of src into dst, a window at a time: src
+ * is read straight into dst's mapped window, so each byte is copied
+ * once, without a bounce buffer.  Leaves dst's I/O offset where src's
+ * was.
+ */
+static void GioShmCopy(struct NaClGioShm  *dst,
+                       struct Gio         *src,
+                       size_t             nbytes) {
+  char    *window;
+  size_t  avail;
   ssize_t got;
-  ssize_t this_copy;
-  size_t  ask;
   off_t   cur_offset;
 
   NaClLog(3,
-          ("GioCopy: dst 0x%"NACL_PRIxPTR
+          ("GioShmCopy: dst 0x%"NACL_PRIxPTR
            ", src 0x%"NACL_PRIxPTR", nbytes 0x%"NACL_PRIxS"\n"),
           (uintptr_t) dst,
           (uintptr_t) src,
@@ -84,88 +89,65 @@ static void GioCopy(struct Gio  *dst,
   cur_offset = (*src->vtbl->Seek)(src, 0, SEEK_CUR);
   if (-1 == cur_offset) {
     NaClLog(LOG_FATAL,
-            "NaClGioShmUnbounded::GioCopy: could not find source ptr\n");
+            "NaClGioShmUnbounded::GioShmCopy: could not find source ptr\n");
   }
   if (-1 == (*src->vtbl->Seek)(src, 0, SEEK_SET)) {
     NaClLog(LOG_FATAL,
-            "NaClGioShmUnbounded::GioCopy: could not rewind source\n");
+            "NaClGioShmUnbounded::GioShmCopy: could not rewind source\n");
   }
-  if (-1 == (*dst->vtbl->Seek)(dst, 0, SEEK_SET)) {
+  if (-1 == (*dst->base.vtbl->Seek)(&dst->base, 0, SEEK_SET)) {
     NaClLog(LOG_FATAL,
-            "NaClGioShmUnbounded::GioCopy: could not rewind destination\n");
+            "NaClGioShmUnbounded::GioShmCopy: could not rewind destination\n");
   }
   /*
-   * This copy process will dirty every page.  An optimization for
-   * sparse data would check the result of a Read for all-zeros and
-   * Seek the corresponding number of bytes forward.  This is,
-   * however, unlikely to be a common enough case in our projected use
-   * cases.
+   * This copy process will dirty every page written so far.  Bytes
+   * past that were never written, and are already zero in dst.
    */
   while (nbytes > 0) {
-    ask = sizeof buf;
-    if (ask > nbytes) {
-      ask = nbytes;
+    window = NaClGioShmGetWriteBuffer(dst, 1, &avail);
+    if (NULL == window) {
+      NaClLog(LOG_FATAL,
+              "NaClGioShmUnbounded::GioShmCopy: could not map destination\n");
+    }
+    if (avail > nbytes) {
+      avail = nbytes;
     }
     NaClLog(5,
-            "GioCopy: copying 0x%"NACL_PRIxS" bytes, 0x%"NACL_PRIxS" remains\n",
-            ask,
+            ("GioShmCopy: copying 0x%"NACL_PRIxS" bytes,"
+             " 0x%"NACL_PRIxS" remains\n"),
+            avail,
             nbytes);
-    got = (*src->vtbl->Read)(src, buf, ask);
-    if (got <= 0 || (size_t) got > ask) {
+    got = (*src->vtbl->Read)(src, window, avail);
+    if (got <= 0 || (size_t) got > avail) {
       NaClLog(LOG_FATAL,
-              "NaClGioShmUnbounded::GioCopy: read failed, %"NACL_PRIdS"\n",
+              "NaClGioShmUnbounded::GioShmCopy: read failed, %"NACL_PRIdS"\n",
               got);
     }
-    this_copy = got;
-
-    for (ask = (size_t) got, bufp = buf;
-         ask > 0;
-         bufp += got, ask -= got) {
-      got = (*dst->vtbl->Write)(dst, buf, ask);
-      if (got <= 0 || (size_t) got > ask) {
-        NaClLog(LOG_FATAL,
-                "NaClGioShmUnbounded::GioCopy: write failed, %"NACL_PRIdS"\n",
-                got);
-      }
-    }
-    nbytes -= this_copy;
+    NaClGioShmCommitWrite(dst, (size_t) got);
+    nbytes -= (size_t) got;
   }
-  if (-1 == (*dst->vtbl->Seek)(dst, cur_offset, SEEK_SET)) {
+  if (-1 == (*dst->base.vtbl->Seek)(&dst->base, cur_offset, SEEK_SET)) {
     NaClLog(LOG_FATAL,
-            "NaClGioShmUnbounded::GioCopy: could not seek dst ptr\n");
+            "NaClGioShmUnbounded::GioShmCopy: could not seek dst ptr\n");
   }
 }
 
-static ssize_t NaClGioShmUnboundedWrite(struct Gio  *vself,
-                                        void const   *buf,
-                                        size_t       count) {
-  struct NaClGioShmUnbounded  *self = (struct NaClGioShmUnbounded *) vself;
-  size_t                      io_offset;
-  ssize_t                     retval;
-  size_t                      new_avail_sz;
-  size_t                      new_size;
-  struct NaClGioShm           *ngsp;
-
-  NaClLog(4,
-          ("NaClGioShmUnboundedWrite(0x%"NACL_PRIxPTR","
-           " 0x%"NACL_PRIxPTR", 0x%"NACL_PRIxS")\n"),
-          (uintptr_t) vself, (uintptr_t) buf, count);
-  if (SIZE_T_MAX - self->io_offset < count) {
-    errno = EINVAL;
-    return -1;
-  }
-
-  /*
-   * where we'll end up when the I/O is done
-   */
-  io_offset = self->io_offset + count;
+/*
+ * Grows the shm object, if needed, so that it holds at least end
+ * bytes.  Returns 0 and sets errno on failure.
+ */
+static int NaClGioShmUnboundedReserve(struct NaClGioShmUnbounded *self,
+                                      size_t                     end) {
+  size_t            new_avail_sz;
+  size_t            new_size;
+  struct NaClGioShm *ngsp;
 
   /*
    * For sequential I/O, an "if" suffices.  For writes that occur
    * after a seek, however, we may need to double more than once.
    */
   for (new_avail_sz = self->shm_avail_sz;
-       new_avail_sz < io_offset;
+       new_avail_sz < end;
        new_avail_sz = new_size) {
     if (SIZE_T_MAX / 2 >= new_avail_sz) {
       new_size = 2 * new_avail_sz;
@@ -181,7 +163,7 @@ static ssize_t NaClGioShmUnboundedWrite(struct Gio  *vself,
          * We get equality if we try to expand again.
          */
         errno = ENOMEM;
-        return -1;
+        return 0;
       }
     }
   }
@@ -191,37 +173,74 @@ static ssize_t NaClGioShmUnboundedWrite(struct Gio  *vself,
      * that there is a temporary 3x VM hit in the worst case.  This
      * should be primarily paging space, since I/O between the
      * NaClGioShm object should use relatively little RAM.  It will
-     * trash the cache, however.  Hopefully the shm object is in the
-     * buffer cache, and we're just mapping in chunks of it into our
-     * address space.  This is a bit more explicit than mmapping both
-     * source and destinaton objects completely and using madvise with
-     * MADV_SEQUENTIAL -- and likely less efficient -- but avoids
-     * OS-specific calls.
+     * trash the cache, however.  The shm objects cannot be resized in
+     * place portably (there is no mremap for a Windows section), so
+     * we copy between large mapped windows instead, which also avoids
+     * OS-specific calls.  Doubling keeps the number of copies
+     * logarithmic in the final size.
      */
 
     ngsp = malloc(sizeof *ngsp);
 
     if (NULL == ngsp) {
       errno = ENOMEM;
-      return -1;
+      return 0;
     }
     if (!NaClGioShmAllocCtor(ngsp, new_avail_sz)) {
       free(ngsp);
       errno = ENOMEM;
-      return -1;
+      return 0;
     }
-    GioCopy((struct Gio *) ngsp, (struct Gio *) self->ngsp, self->shm_avail_sz);
+    GioShmCopy(ngsp, (struct Gio *) self->ngsp, self->shm_written);
     self->shm_avail_sz = new_avail_sz;
 
     if (-1 == (*self->ngsp->base.vtbl->Close)(&self->ngsp->base)) {
       NaClLog(LOG_ERROR,
-              "NaClGioShmUnboundedWrite: close of src temporary failed\n");
+              "NaClGioShmUnboundedReserve: close of src temporary failed\n");
     }
     (*self->ngsp->base.vtbl->Dtor)(&self->ngsp->base);
     free(self->ngsp);
     self->ngsp = ngsp;
     ngsp = NULL;
   }
+  return 1;
+}
+
+static void NaClGioShmUnboundedAdvance(struct NaClGioShmUnbounded *self,
+                                       size_t                     nbytes) {
+  size_t  io_offset = self->io_offset + nbytes;
+
+  if (io_offset > self->shm_written) {
+    self->shm_written = io_offset;
+    NaClLog(4,
+            ("UPDATE: io_offset 0x%"NACL_PRIxS
+             ", shm_written 0x%"NACL_PRIxS"\n"),
+            self->io_offset, self->shm_written);
+  }
+  self->io_offset = io_offset;
+}
+
+static ssize_t NaClGioShmUnboundedWrite(struct Gio  *vself,
+                                        void const   *buf,
+                                        size_t       count) {
+  struct NaClGioShmUnbounded  *self = (struct NaClGioShmUnbounded *) vself;
+  ssize_t                     retval;
+
+  NaClLog(4,
+          ("NaClGioShmUnboundedWrite(0x%"NACL_PRIxPTR","
+           " 0x%"NACL_PRIxPTR", 0x%"NACL_PRIxS")\n"),
+          (uintptr_t) vself, (uintptr_t) buf, count);
+  if (SIZE_T_MAX - self->io_offset < count) {
+    errno = EINVAL;
+    return -1;
+  }
+
+  /*
+   * where we'll end up when the I/O is done
+   */
+  if (!NaClGioShmUnboundedReserve(self, self->io_offset + count)) {
+    return -1;
+  }
 
   retval = (*self->ngsp->base.vtbl->Write)(&self->ngsp->base,
                                            buf, count);
@@ -230,16 +249,7 @@ static ssize_t NaClGioShmUnboundedWrite(struct Gio  *vself,
       errno = EIO;  /* internal error */
       return -1;
     }
-    io_offset = self->io_offset + retval;
-
-    if (io_offset > self->shm_written) {
-      self->shm_written = io_offset;
-      NaClLog(4,
-              ("UPDATE: io_offset 0x%"NACL_PRIxS
-               ", shm_written 0x%"NACL_PRIxS"\n"),
-              self->io_offset, self->shm_written);
-    }
-    self->io_offset = io_offset;
+    NaClGioShmUnboundedAdvance(self, (size_t) retval);
   }
 
   NaClLog(4, "io_offset 0x%"NACL_PRIxS", shm_written 0x%"NACL_PRIxS"\n",
@@ -248,6 +258,29 @@ static ssize_t NaClGioShmUnboundedWrite(struct Gio  *vself,
   return retval;
 }
 
+char *NaClGioShmUnboundedGetWriteBuffer(struct NaClGioShmUnbounded  *self,
+                                        size_t                      min_bytes,
+                                        size_t                      *avail) {
+  if (0 == min_bytes) {
+    min_bytes = 1;
+  }
+  if (min_bytes > NACL_GIO_SHM_MAX_BUFFER
+      || SIZE_T_MAX - self->io_offset < min_bytes) {
+    errno = EINVAL;
+    return NULL;
+  }
+  if (!NaClGioShmUnboundedReserve(self, self->io_offset + min_bytes)) {
+    return NULL;
+  }
+  return NaClGioShmGetWriteBuffer(self->ngsp, min_bytes, avail);
+}
+
+void NaClGioShmUnboundedCommitWrite(struct NaClGioShmUnbounded  *self,
+                                    size_t                      nbytes) {
+  NaClGioShmCommitWrite(self->ngsp, nbytes);
+  NaClGioShmUnboundedAdvance(self, nbytes);
+}
+
 static off_t NaClGioShmUnboundedSeek(struct Gio *vself,
                                      off_t      offset,
                                      int        whence) {
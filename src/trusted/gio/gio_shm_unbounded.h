@@ -50,6 +50,20 @@ struct NaClDesc *NaClGioShmUnboundedGetNaClDesc(
 
 int NaClGioShmUnboundedCtor(struct NaClGioShmUnbounded *self);
 
+/*
+ * Zero-copy writes; see NaClGioShmGetWriteBuffer.  GetWriteBuffer
+ * first grows the shm object so that at least min_bytes fit past the
+ * I/O offset, so it only fails if min_bytes exceeds
+ * NACL_GIO_SHM_MAX_BUFFER or memory runs out.  CommitWrite counts the
+ * committed bytes as written.
+ */
+char *NaClGioShmUnboundedGetWriteBuffer(struct NaClGioShmUnbounded  *self,
+                                        size_t                      min_bytes,
+                                        size_t                      *avail);
+
+void NaClGioShmUnboundedCommitWrite(struct NaClGioShmUnbounded  *self,
+                                    size_t                      nbytes);
+
 
 EXTERN_C_END
 
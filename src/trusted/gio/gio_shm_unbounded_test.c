@@ -89,6 +89,44 @@ size_t FillGioWithGenerator(struct NaClGioShmUnbounded  *ngsup,
   return nerrs;
 }
 
+/*
+ * Same data as FillGioWithGenerator, but generated directly into the
+ * shm object.
+ */
+size_t FillGioZeroCopyWithGenerator(struct NaClGioShmUnbounded  *ngsup,
+                                    struct DataGenerator        *genp,
+                                    size_t                      nbytes) {
+  size_t  nerrs = 0;
+  size_t  ix;
+  size_t  jx;
+  size_t  ask;
+  size_t  avail;
+  uint8_t *window;
+
+  (*ngsup->base.vtbl->Seek)(&ngsup->base, 0, SEEK_SET);
+  for (ix = 0; ix < nbytes; ) {
+    ask = (*genp->Next)(genp) + 1;
+    if (ask > (nbytes - ix)) {
+      ask = nbytes - ix;
+    }
+    window = (uint8_t *) NaClGioShmUnboundedGetWriteBuffer(ngsup, ask, &avail);
+    if (NULL == window || avail < ask) {
+      ++nerrs;
+      NaClLog(LOG_FATAL,
+              ("gio_shm_unbounded_test: no write buffer for %"NACL_PRIdS
+               " bytes at %"NACL_PRIdS"\n"),
+              ask,
+              ix);
+    }
+    for (jx = 0; jx < ask; ++jx) {
+      window[jx] = (*genp->Next)(genp);
+    }
+    NaClGioShmUnboundedCommitWrite(ngsup, ask);
+    ix += ask;
+  }
+  return nerrs;
+}
+
 size_t CheckGioWithGenerator(struct NaClGioShmUnbounded  *ngsup,
                              struct DataGenerator        *genp,
                              size_t                      nbytes) {
@@ -158,6 +196,45 @@ size_t TestWithDataGenerators(struct NaClGioShmUnbounded *ngsup) {
   return nerrs;
 }
 
+size_t TestZeroCopyWrites(void) {
+  size_t                      nerrs = 0;
+  struct NaClGioShmUnbounded  ngsu;
+  struct LinearGenerator      lg;
+  size_t                      avail;
+  size_t                      written;
+  /* Grows several times, and spans several map windows. */
+  size_t                      nbytes = 2 * NACL_GIO_SHM_WINDOW_SIZE + 4321;
+
+  if (!NaClGioShmUnboundedCtor(&ngsu)) {
+    fprintf(stderr, "NaClGioShmUnboundedCtor failed\n");
+    return 1;
+  }
+  if (NULL != NaClGioShmUnboundedGetWriteBuffer(&ngsu,
+                                                NACL_GIO_SHM_MAX_BUFFER + 1,
+                                                &avail)) {
+    fprintf(stderr, "oversized write buffer request succeeded\n");
+    ++nerrs;
+  }
+
+  LinearGeneratorCtor(&lg);
+  nerrs += FillGioZeroCopyWithGenerator(&ngsu, (struct DataGenerator *) &lg,
+                                        nbytes);
+  (*lg.base.Dtor)((struct DataGenerator *) &lg);
+
+  (void) NaClGioShmUnboundedGetNaClDesc(&ngsu, &written);
+  if (written != nbytes) {
+    fprintf(stderr, "wrote %"NACL_PRIdS" bytes, expected %"NACL_PRIdS"\n",
+            written, nbytes);
+    ++nerrs;
+  }
+
+  LinearGeneratorCtor(&lg);
+  nerrs += CheckGioWithGenerator(&ngsu, (struct DataGenerator *) &lg, nbytes);
+  (*lg.base.Dtor)((struct DataGenerator *) &lg);
+
+  (*ngsu.base.vtbl->Dtor)(&ngsu.base);
+  return nerrs;
+}
 
 int main(int ac, char **av) {
   int                         opt;
@@ -191,6 +268,7 @@ int main(int ac, char **av) {
   }
 
   nerrs += TestWithDataGenerators(&ngsu);
+  nerrs += TestZeroCopyWrites();
 
  unrecoverable:
   NaClNrdAllModulesFini();
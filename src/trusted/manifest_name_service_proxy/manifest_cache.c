@@ -0,0 +1,317 @@
+/*
+ * Copyright (c) 2013 The Native Client Authors. All rights reserved.
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "native_client/src/trusted/manifest_name_service_proxy/manifest_cache.h"
+
+#include "native_client/src/include/nacl_macros.h"
+#include "native_client/src/public/name_service.h"
+#include "native_client/src/shared/platform/nacl_clock.h"
+#include "native_client/src/shared/platform/nacl_log.h"
+#include "native_client/src/shared/platform/nacl_sync_checked.h"
+#include "native_client/src/trusted/desc/nacl_desc_base.h"
+#include "native_client/src/trusted/desc_cacheability/desc_cacheability.h"
+#include "native_client/src/trusted/service_runtime/include/sys/fcntl.h"
+#include "native_client/src/trusted/service_runtime/include/sys/time.h"
+#include "native_client/src/trusted/validator/nacl_file_info.h"
+
+struct NaClManifestCacheEntry {
+  struct NaClManifestCacheEntry *next;
+  struct NaClManifestCacheEntry *prev;
+  uint32_t                      hash;
+  int                           flags;
+  int                           status;
+  /* For a failed lookup; NULL for a successful one. */
+  struct NaClDesc               *desc;
+  /* For a successful lookup, exchanged for a new descriptor per hit. */
+  struct NaClFileToken          file_token;
+  /* Monotonic time after which a negative entry is stale; 0 if never. */
+  int64_t                       expires_ns;
+  char                          name[1];  /* NUL terminated, allocated */
+};
+
+static int64_t NaClManifestCacheNowNs(void) {
+  struct nacl_abi_timespec now;
+
+  if (0 != NaClClockGetTime(NACL_CLOCK_MONOTONIC, &now)) {
+    return 0;
+  }
+  return (int64_t) now.tv_sec * NACL_NANOS_PER_UNIT + now.tv_nsec;
+}
+
+/* FNV-1a, so most mismatches are found without a strcmp. */
+static uint32_t NaClManifestCacheHash(char const *name, int flags) {
+  uint32_t hash = 2166136261U ^ (uint32_t) flags;
+
+  while ('\0' != *name) {
+    hash ^= (uint8_t) *name++;
+    hash *= 16777619U;
+  }
+  return hash;
+}
+
+static int NaClManifestCacheable(int flags) {
+  return NACL_ABI_O_RDONLY == (flags & NACL_ABI_O_ACCMODE);
+}
+
+static void NaClManifestCacheUnlink(struct NaClManifestCache       *self,
+                                    struct NaClManifestCacheEntry  *entry) {
+  if (NULL == entry->prev) {
+    self->head = entry->next;
+  } else {
+    entry->prev->next = entry->next;
+  }
+  if (NULL == entry->next) {
+    self->tail = entry->prev;
+  } else {
+    entry->next->prev = entry->prev;
+  }
+  --self->num_entries;
+}
+
+static void NaClManifestCachePushFront(struct NaClManifestCache       *self,
+                                       struct NaClManifestCacheEntry  *entry) {
+  entry->prev = NULL;
+  entry->next = self->head;
+  if (NULL == self->head) {
+    self->tail = entry;
+  } else {
+    self->head->prev = entry;
+  }
+  self->head = entry;
+  ++self->num_entries;
+}
+
+static void NaClManifestCacheEntryDelete(
+    struct NaClManifestCacheEntry *entry) {
+  NaClDescSafeUnref(entry->desc);
+  free(entry);
+}
+
+static struct NaClManifestCacheEntry *NaClManifestCacheFind(
+    struct NaClManifestCache  *self,
+    char const                *name,
+    int                       flags,
+    uint32_t                  hash) {
+  struct NaClManifestCacheEntry *entry;
+
+  for (entry = self->head; NULL != entry; entry = entry->next) {
+    if (entry->hash == hash && entry->flags == flags &&
+        0 == strcmp(entry->name, name)) {
+      return entry;
+    }
+  }
+  return NULL;
+}
+
+int NaClManifestCacheCtor(struct NaClManifestCache  *self,
+                          size_t                    max_entries,
+                          uint32_t                  negative_ttl_ms) {
+  if (!NaClMutexCtor(&self->mu)) {
+    return 0;
+  }
+  self->max_entries = max_entries;
+  self->negative_ttl_ns = (int64_t) negative_ttl_ms * NACL_NANOS_PER_MILLI;
+  self->tokens_reusable = 1;
+  self->head = NULL;
+  self->tail = NULL;
+  self->num_entries = 0;
+  self->hits = 0;
+  self->misses = 0;
+  return 1;
+}
+
+void NaClManifestCacheDtor(struct NaClManifestCache *self) {
+  NaClManifestCacheInvalidate(self, NULL);
+  NaClMutexDtor(&self->mu);
+}
+
+int NaClManifestCacheLookup(struct NaClManifestCache    *self,
+                            char const                  *name,
+                            int                         flags,
+                            struct NaClValidationCache  *validation_cache,
+                            int                         *status,
+                            struct NaClDesc             **out) {
+  uint32_t                      hash;
+  struct NaClManifestCacheEntry *entry;
+  struct NaClManifestCacheEntry *doomed = NULL;
+  struct NaClFileToken          file_token;
+  struct NaClDesc               *desc = NULL;
+  int                           found = 0;
+
+  if (!NaClManifestCacheable(flags)) {
+    return 0;
+  }
+  hash = NaClManifestCacheHash(name, flags);
+
+  NaClXMutexLock(&self->mu);
+  entry = NaClManifestCacheFind(self, name, flags, hash);
+  if (NULL != entry) {
+    NaClManifestCacheUnlink(self, entry);
+    if (0 != entry->expires_ns &&
+        NaClManifestCacheNowNs() >= entry->expires_ns) {
+      doomed = entry;
+    } else {
+      NaClManifestCachePushFront(self, entry);
+      *status = entry->status;
+      if (NULL != entry->desc) {
+        desc = NaClDescRef(entry->desc);
+      } else {
+        file_token = entry->file_token;
+      }
+      found = 1;
+    }
+  }
+  /* A successful lookup is counted once its token has been exchanged. */
+  if (!found) {
+    ++self->misses;
+  } else if (NULL != desc) {
+    ++self->hits;
+  }
+  NaClXMutexUnlock(&self->mu);
+
+  if (found && NULL == desc) {
+    /*
+     * The token exchange may be an RPC to the embedder, so it is made
+     * without holding the lock.
+     */
+    desc = NaClExchangeFileTokenForMappableDesc(&file_token,
+                                                validation_cache);
+    NaClXMutexLock(&self->mu);
+    if (NULL != desc) {
+      ++self->hits;
+    } else {
+      found = 0;
+      ++self->misses;
+      NaClLog(4,
+              "NaClManifestCacheLookup: %s no longer resolves, not caching"
+              " successful lookups\n", name);
+      self->tokens_reusable = 0;
+      entry = NaClManifestCacheFind(self, name, flags, hash);
+      if (NULL != entry && NULL == entry->desc) {
+        NaClManifestCacheUnlink(self, entry);
+        doomed = entry;
+      }
+    }
+    NaClXMutexUnlock(&self->mu);
+  }
+
+  if (NULL != doomed) {
+    NaClManifestCacheEntryDelete(doomed);
+  }
+  if (found) {
+    *out = desc;
+  }
+  NaClLog(4, "NaClManifestCacheLookup: %s, flags %d: %s\n",
+          name, flags, found ? "hit" : "miss");
+  return found;
+}
+
+void NaClManifestCacheInsert(struct NaClManifestCache     *self,
+                             char const                   *name,
+                             int                          flags,
+                             int                          status,
+                             struct NaClDesc              *desc,
+                             struct NaClFileToken const   *file_token) {
+  size_t                        name_len;
+  struct NaClManifestCacheEntry *entry;
+  struct NaClManifestCacheEntry *old;
+  struct NaClManifestCacheEntry *evicted = NULL;
+
+  if (!NaClManifestCacheable(flags) || 0 == self->max_entries) {
+    return;
+  }
+  if (NACL_NAME_SERVICE_SUCCESS == status) {
+    /*
+     * Every open of a resource must get its own file position, so a
+     * successful lookup can only be replayed through its file token.
+     */
+    if (NULL == file_token ||
+        (0 == file_token->lo && 0 == file_token->hi)) {
+      return;
+    }
+  } else if (NULL == desc || 0 == self->negative_ttl_ns) {
+    return;
+  }
+
+  name_len = strlen(name);
+  entry = (struct NaClManifestCacheEntry *) malloc(sizeof *entry + name_len);
+  if (NULL == entry) {
+    return;
+  }
+  memcpy(entry->name, name, name_len + 1);
+  entry->hash = NaClManifestCacheHash(name, flags);
+  entry->flags = flags;
+  entry->status = status;
+  if (NACL_NAME_SERVICE_SUCCESS == status) {
+    entry->desc = NULL;
+    entry->file_token = *file_token;
+    entry->expires_ns = 0;
+  } else {
+    entry->desc = NaClDescRef(desc);
+    entry->file_token.lo = 0;
+    entry->file_token.hi = 0;
+    entry->expires_ns = NaClManifestCacheNowNs() + self->negative_ttl_ns;
+  }
+
+  NaClXMutexLock(&self->mu);
+  if (NACL_NAME_SERVICE_SUCCESS == status && !self->tokens_reusable) {
+    NaClXMutexUnlock(&self->mu);
+    free(entry);
+    return;
+  }
+  /* Another connection may have looked the name up meanwhile. */
+  old = NaClManifestCacheFind(self, name, flags, entry->hash);
+  if (NULL != old) {
+    NaClManifestCacheUnlink(self, old);
+    evicted = old;
+  } else if (self->num_entries == self->max_entries) {
+    evicted = self->tail;
+    NaClManifestCacheUnlink(self, evicted);
+  }
+  NaClManifestCachePushFront(self, entry);
+  NaClXMutexUnlock(&self->mu);
+
+  if (NULL != evicted) {
+    NaClManifestCacheEntryDelete(evicted);
+  }
+}
+
+void NaClManifestCacheInvalidate(struct NaClManifestCache *self,
+                                 char const               *name) {
+  struct NaClManifestCacheEntry *entry;
+  struct NaClManifestCacheEntry *next;
+  struct NaClManifestCacheEntry *doomed = NULL;
+
+  NaClXMutexLock(&self->mu);
+  for (entry = self->head; NULL != entry; entry = next) {
+    next = entry->next;
+    if (NULL == name || 0 == strcmp(entry->name, name)) {
+      NaClManifestCacheUnlink(self, entry);
+      entry->next = doomed;
+      doomed = entry;
+    }
+  }
+  NaClXMutexUnlock(&self->mu);
+
+  /* Descriptors are released without holding the lock. */
+  while (NULL != doomed) {
+    entry = doomed;
+    doomed = entry->next;
+    NaClManifestCacheEntryDelete(entry);
+  }
+}
+
+void NaClManifestCacheGetStats(struct NaClManifestCache *self,
+                               uint64_t                 *hits,
+                               uint64_t                 *misses) {
+  NaClXMutexLock(&self->mu);
+  *hits = self->hits;
+  *misses = self->misses;
+  NaClXMutexUnlock(&self->mu);
+}
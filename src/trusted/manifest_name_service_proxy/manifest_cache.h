@@ -0,0 +1,109 @@
+/*
+ * Copyright (c) 2013 The Native Client Authors. All rights reserved.
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#ifndef NATIVE_CLIENT_SRC_TRUSTED_MANIFEST_NAME_SERVICE_PROXY_MANIFEST_CACHE_H_
+#define NATIVE_CLIENT_SRC_TRUSTED_MANIFEST_NAME_SERVICE_PROXY_MANIFEST_CACHE_H_
+
+#include "native_client/src/include/nacl_base.h"
+#include "native_client/src/include/portability.h"
+
+#include "native_client/src/shared/platform/nacl_sync.h"
+
+EXTERN_C_BEGIN
+
+struct NaClDesc;
+struct NaClFileToken;
+struct NaClManifestCacheEntry;
+struct NaClValidationCache;
+
+/*
+ * Cache of manifest lookup results, so that modules that open the
+ * same read-only resource repeatedly -- e.g., ld.so loading shared
+ * libraries or searching its library path -- do not make a reverse
+ * RPC to the embedder every time.
+ *
+ * Only lookups whose flags ask for read-only access are cached.  A
+ * successful lookup is remembered by its file token, not by its
+ * descriptor: the descriptor carries a file position, so every hit
+ * exchanges the token with the validation cache for a new descriptor
+ * of its own.  If an exchange fails, e.g. because the embedder's
+ * tokens can only be resolved once, the lookup is a miss and
+ * successful lookups are no longer cached.  A lookup that the
+ * embedder failed, e.g. because the name is not in the manifest, is
+ * remembered for negative_ttl_ms milliseconds, or not at all if that
+ * is 0.  Entries are evicted least recently used first, or
+ * invalidated.
+ */
+#define NACL_MANIFEST_CACHE_DEFAULT_ENTRIES 64
+#define NACL_MANIFEST_CACHE_DEFAULT_NEGATIVE_TTL_MS 5000
+
+struct NaClManifestCache {
+  struct NaClMutex                mu;
+  size_t                          max_entries;
+  int64_t                         negative_ttl_ns;
+  /* Cleared once a cached file token fails to resolve. */
+  int                             tokens_reusable;
+
+  /* Doubly linked, most recently used first. */
+  struct NaClManifestCacheEntry   *head;
+  struct NaClManifestCacheEntry   *tail;
+  size_t                          num_entries;
+
+  uint64_t                        hits;
+  uint64_t                        misses;
+};
+
+int NaClManifestCacheCtor(struct NaClManifestCache  *self,
+                          size_t                    max_entries,
+                          uint32_t                  negative_ttl_ms);
+
+void NaClManifestCacheDtor(struct NaClManifestCache *self);
+
+/*
+ * Returns 1 if the lookup of name with flags is cached, setting
+ * *status to the status the embedder returned and *out to a new
+ * reference to a descriptor: for a successful lookup, a new
+ * descriptor obtained by exchanging the cached file token with
+ * validation_cache, and for a failed one, the (invalid) descriptor the
+ * embedder returned.  Returns 0 on a miss.
+ */
+int NaClManifestCacheLookup(struct NaClManifestCache    *self,
+                            char const                  *name,
+                            int                         flags,
+                            struct NaClValidationCache  *validation_cache,
+                            int                         *status,
+                            struct NaClDesc             **out);
+
+/*
+ * Remembers the result of a lookup made by the embedder, if it may be
+ * cached.  A successful lookup is cached only with the file_token it
+ * was resolved from; a failed one takes its own reference to desc.
+ */
+void NaClManifestCacheInsert(struct NaClManifestCache     *self,
+                             char const                   *name,
+                             int                          flags,
+                             int                          status,
+                             struct NaClDesc              *desc,
+                             struct NaClFileToken const   *file_token);
+
+/*
+ * Forgets every cached lookup of name, or of all names if name is
+ * NULL.  Used when the embedder's manifest changes.
+ */
+void NaClManifestCacheInvalidate(struct NaClManifestCache *self,
+                                 char const               *name);
+
+/*
+ * Reports how many read-only lookups were answered from the cache, and
+ * how many had to go to the embedder.
+ */
+void NaClManifestCacheGetStats(struct NaClManifestCache *self,
+                               uint64_t                 *hits,
+                               uint64_t                 *misses);
+
+EXTERN_C_END
+
+#endif
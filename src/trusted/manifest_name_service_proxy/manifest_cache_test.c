@@ -0,0 +1,261 @@
+/*
+ * Copyright (c) 2013 The Native Client Authors. All rights reserved.
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "native_client/src/include/nacl_assert.h"
+#include "native_client/src/include/nacl_macros.h"
+#include "native_client/src/public/name_service.h"
+#include "native_client/src/shared/platform/nacl_time.h"
+#include "native_client/src/trusted/desc/nacl_desc_base.h"
+#include "native_client/src/trusted/desc/nacl_desc_null.h"
+#include "native_client/src/trusted/desc/nrd_all_modules.h"
+#include "native_client/src/trusted/manifest_name_service_proxy/manifest_cache.h"
+#include "native_client/src/trusted/service_runtime/include/sys/errno.h"
+#include "native_client/src/trusted/service_runtime/include/sys/fcntl.h"
+#include "native_client/src/trusted/service_runtime/include/sys/time.h"
+#include "native_client/src/trusted/validator/nacl_file_info.h"
+#include "native_client/src/trusted/validator/validation_cache.h"
+
+#define kNegativeTtlMs 50
+#define kLongTtlMs 60000
+
+static struct NaClDesc *MakeDesc(void) {
+  struct NaClDescNull *desc = (struct NaClDescNull *) malloc(sizeof *desc);
+
+  ASSERT_NE(desc, NULL);
+  ASSERT(NaClDescNullCtor(desc));
+  return (struct NaClDesc *) desc;
+}
+
+/*
+ * A validation cache whose file tokens resolve to fresh opens of
+ * file_path, resolve_budget more times.
+ */
+static char file_path[] = "/tmp/manifest_cache_test_XXXXXX";
+static int resolve_budget;
+
+static int ResolveFileToken(void *handle, struct NaClFileToken *file_token,
+                            int32_t *fd, char **path, uint32_t *path_length) {
+  UNREFERENCED_PARAMETER(handle);
+  UNREFERENCED_PARAMETER(file_token);
+  if (0 == resolve_budget) {
+    return 0;
+  }
+  --resolve_budget;
+  *fd = open(file_path, O_RDONLY);
+  ASSERT_NE(*fd, -1);
+  *path = strdup(file_path);
+  ASSERT_NE(*path, NULL);
+  *path_length = (uint32_t) strlen(file_path);
+  return 1;
+}
+
+static struct NaClValidationCache validation_cache;
+
+/* Returns the descriptor a lookup hit, or NULL on a miss. */
+static struct NaClDesc *Lookup(struct NaClManifestCache *cache,
+                               char const *name, int flags, int *status) {
+  struct NaClDesc *desc;
+
+  if (!NaClManifestCacheLookup(cache, name, flags, &validation_cache,
+                               status, &desc)) {
+    return NULL;
+  }
+  ASSERT_NE(desc, NULL);
+  NaClDescUnref(desc);
+  return desc;
+}
+
+static void TestHitsAndMisses(void) {
+  struct NaClManifestCache cache;
+  struct NaClDesc *libc = MakeDesc();
+  struct NaClDesc *invalid = MakeDesc();
+  uint64_t hits;
+  uint64_t misses;
+  int status;
+
+  ASSERT(NaClManifestCacheCtor(&cache, 2, kLongTtlMs));
+  ASSERT_EQ(Lookup(&cache, "missing", NACL_ABI_O_RDONLY, &status), NULL);
+  NaClManifestCacheInsert(&cache, "missing", NACL_ABI_O_RDONLY,
+                          NACL_ABI_ENOENT, invalid, NULL);
+  ASSERT_EQ(Lookup(&cache, "missing", NACL_ABI_O_RDONLY, &status), invalid);
+  ASSERT_EQ(status, NACL_ABI_ENOENT);
+
+  /*
+   * Successful lookups without a file token are not cached, since
+   * every open must get its own file position.
+   */
+  NaClManifestCacheInsert(&cache, "libc.so", NACL_ABI_O_RDONLY,
+                          NACL_NAME_SERVICE_SUCCESS, libc, NULL);
+  ASSERT_EQ(Lookup(&cache, "libc.so", NACL_ABI_O_RDONLY, &status), NULL);
+
+  /* The flags are part of the key, and only read-only lookups count. */
+  ASSERT_EQ(Lookup(&cache, "missing", NACL_ABI_O_RDONLY | NACL_ABI_O_CREAT,
+                   &status), NULL);
+  NaClManifestCacheInsert(&cache, "missing", NACL_ABI_O_RDWR,
+                          NACL_ABI_ENOENT, invalid, NULL);
+  ASSERT_EQ(Lookup(&cache, "missing", NACL_ABI_O_RDWR, &status), NULL);
+
+  NaClManifestCacheGetStats(&cache, &hits, &misses);
+  ASSERT_EQ(hits, 1);
+  ASSERT_EQ(misses, 3);
+
+  NaClManifestCacheInvalidate(&cache, "missing");
+  ASSERT_EQ(Lookup(&cache, "missing", NACL_ABI_O_RDONLY, &status), NULL);
+
+  NaClManifestCacheDtor(&cache);
+
+  /* Failures are not remembered without a TTL. */
+  ASSERT(NaClManifestCacheCtor(&cache, 2, 0));
+  NaClManifestCacheInsert(&cache, "missing", NACL_ABI_O_RDONLY,
+                          NACL_ABI_ENOENT, invalid, NULL);
+  ASSERT_EQ(Lookup(&cache, "missing", NACL_ABI_O_RDONLY, &status), NULL);
+  NaClManifestCacheDtor(&cache);
+
+  NaClDescUnref(libc);
+  NaClDescUnref(invalid);
+}
+
+static void TestEviction(void) {
+  struct NaClManifestCache cache;
+  struct NaClDesc *a = MakeDesc();
+  struct NaClDesc *b = MakeDesc();
+  struct NaClDesc *c = MakeDesc();
+  int status;
+
+  ASSERT(NaClManifestCacheCtor(&cache, 2, kLongTtlMs));
+  NaClManifestCacheInsert(&cache, "a", NACL_ABI_O_RDONLY,
+                          NACL_ABI_ENOENT, a, NULL);
+  NaClManifestCacheInsert(&cache, "b", NACL_ABI_O_RDONLY,
+                          NACL_ABI_ENOENT, b, NULL);
+  /* Using "a" makes "b" the least recently used. */
+  ASSERT_EQ(Lookup(&cache, "a", NACL_ABI_O_RDONLY, &status), a);
+  NaClManifestCacheInsert(&cache, "c", NACL_ABI_O_RDONLY,
+                          NACL_ABI_ENOENT, c, NULL);
+  ASSERT_EQ(Lookup(&cache, "b", NACL_ABI_O_RDONLY, &status), NULL);
+  ASSERT_EQ(Lookup(&cache, "a", NACL_ABI_O_RDONLY, &status), a);
+  ASSERT_EQ(Lookup(&cache, "c", NACL_ABI_O_RDONLY, &status), c);
+
+  /* A second insert of the same lookup replaces the first. */
+  NaClManifestCacheInsert(&cache, "a", NACL_ABI_O_RDONLY,
+                          NACL_ABI_EACCES, b, NULL);
+  ASSERT_EQ(Lookup(&cache, "a", NACL_ABI_O_RDONLY, &status), b);
+  ASSERT_EQ(status, NACL_ABI_EACCES);
+  ASSERT_EQ(Lookup(&cache, "c", NACL_ABI_O_RDONLY, &status), c);
+
+  NaClManifestCacheInvalidate(&cache, NULL);
+  ASSERT_EQ(Lookup(&cache, "c", NACL_ABI_O_RDONLY, &status), NULL);
+
+  NaClManifestCacheDtor(&cache);
+  NaClDescUnref(a);
+  NaClDescUnref(b);
+  NaClDescUnref(c);
+}
+
+static void TestNegativeEntries(void) {
+  struct NaClManifestCache cache;
+  struct NaClDesc *invalid = MakeDesc();
+  struct nacl_abi_timespec sleep_time;
+  int status;
+
+  ASSERT(NaClManifestCacheCtor(&cache, 2, kNegativeTtlMs));
+  NaClManifestCacheInsert(&cache, "missing", NACL_ABI_O_RDONLY,
+                          NACL_ABI_ENOENT, invalid, NULL);
+  ASSERT_EQ(Lookup(&cache, "missing", NACL_ABI_O_RDONLY, &status), invalid);
+  ASSERT_EQ(status, NACL_ABI_ENOENT);
+
+  sleep_time.tv_sec = 0;
+  sleep_time.tv_nsec = 2 * kNegativeTtlMs * NACL_NANOS_PER_MILLI;
+  ASSERT_EQ(NaClNanosleep(&sleep_time, NULL), 0);
+  ASSERT_EQ(Lookup(&cache, "missing", NACL_ABI_O_RDONLY, &status), NULL);
+
+  NaClManifestCacheDtor(&cache);
+  NaClDescUnref(invalid);
+}
+
+static void ExpectRead(struct NaClDesc *desc, char const *expected) {
+  char buf[4];
+
+  ASSERT_EQ((*NACL_VTBL(NaClDesc, desc)->Read)(desc, buf, sizeof buf),
+            (ssize_t) sizeof buf);
+  ASSERT_EQ(memcmp(buf, expected, sizeof buf), 0);
+}
+
+static void TestPositiveEntries(void) {
+  struct NaClManifestCache cache;
+  struct NaClFileToken token;
+  struct NaClDesc *libc = MakeDesc();
+  struct NaClDesc *first;
+  struct NaClDesc *second;
+  uint64_t hits;
+  uint64_t misses;
+  int status;
+
+  token.lo = 1;
+  token.hi = 2;
+  resolve_budget = 2;
+  ASSERT(NaClManifestCacheCtor(&cache, 2, kLongTtlMs));
+  NaClManifestCacheInsert(&cache, "libc.so", NACL_ABI_O_RDONLY,
+                          NACL_NAME_SERVICE_SUCCESS, libc, &token);
+
+  /* Every hit gets a descriptor, and a file position, of its own. */
+  ASSERT(NaClManifestCacheLookup(&cache, "libc.so", NACL_ABI_O_RDONLY,
+                                 &validation_cache, &status, &first));
+  ASSERT_EQ(status, NACL_NAME_SERVICE_SUCCESS);
+  ASSERT(NaClManifestCacheLookup(&cache, "libc.so", NACL_ABI_O_RDONLY,
+                                 &validation_cache, &status, &second));
+  ASSERT_NE(first, second);
+  ExpectRead(first, "0123");
+  ExpectRead(second, "0123");
+  ExpectRead(first, "4567");
+  NaClDescUnref(first);
+  NaClDescUnref(second);
+
+  /*
+   * Once a token fails to resolve, the lookup is a miss and successful
+   * lookups are no longer cached.
+   */
+  ASSERT_EQ(Lookup(&cache, "libc.so", NACL_ABI_O_RDONLY, &status), NULL);
+  NaClManifestCacheInsert(&cache, "libc.so", NACL_ABI_O_RDONLY,
+                          NACL_NAME_SERVICE_SUCCESS, libc, &token);
+  ASSERT_EQ(Lookup(&cache, "libc.so", NACL_ABI_O_RDONLY, &status), NULL);
+
+  NaClManifestCacheGetStats(&cache, &hits, &misses);
+  ASSERT_EQ(hits, 2);
+  ASSERT_EQ(misses, 2);
+
+  NaClManifestCacheDtor(&cache);
+  NaClDescUnref(libc);
+}
+
+int main(void) {
+  static char const kContents[] = "0123456789";
+  int fd;
+
+
+  NaClNrdAllModulesInit();
+  fd = mkstemp(file_path);
+  ASSERT_NE(fd, -1);
+  ASSERT_EQ(write(fd, kContents, sizeof kContents),
+            (ssize_t) sizeof kContents);
+  ASSERT_EQ(close(fd), 0);
+  validation_cache.ResolveFileToken = ResolveFileToken;
+
+  TestHitsAndMisses();
+  TestEviction();
+  TestNegativeEntries();
+  TestPositiveEntries();
+
+  ASSERT_EQ(unlink(file_path), 0);
+  NaClNrdAllModulesFini();
+  printf("PASSED\n");
+  return 0;
+}
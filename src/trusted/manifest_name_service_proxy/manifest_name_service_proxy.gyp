@@ -13,6 +13,8 @@
     'target_conditions': [
       ['target_base=="manifest_proxy"', {
         'sources': [
+          'manifest_cache.h',
+          'manifest_cache.c',
           'manifest_proxy.h',
           'manifest_proxy.c',
         ],
@@ -15,6 +15,7 @@
 #include "native_client/src/shared/srpc/nacl_srpc.h"
 #include "native_client/src/trusted/desc/nacl_desc_io.h"
 #include "native_client/src/trusted/desc_cacheability/desc_cacheability.h"
+#include "native_client/src/trusted/manifest_name_service_proxy/manifest_cache.h"
 #include "native_client/src/trusted/reverse_service/manifest_rpc.h"
 #include "native_client/src/trusted/reverse_service/reverse_control_rpc.h"
 #include "native_client/src/trusted/service_runtime/include/sys/errno.h"
@@ -108,17 +109,35 @@ static void NaClManifestNameServiceLookupRpc(
     struct NaClSrpcClosure  *done_cls) {
   struct NaClManifestProxyConnection  *proxy_conn =
       (struct NaClManifestProxyConnection *) rpc->channel->server_instance_data;
+  struct NaClManifestProxy            *proxy =
+      (struct NaClManifestProxy *) proxy_conn->base.server;
+  struct NaClManifestCache            *cache = &proxy->server->manifest_cache;
   char                                *name = in_args[0]->arrays.str;
   int                                 flags = in_args[1]->u.ival;
   char                                cookie[20];
   uint32_t                            cookie_size = sizeof cookie;
   int                                 status;
-  struct NaClDesc                     *desc;
+  struct NaClDesc                     *desc = NULL;
   struct NaClFileToken                file_token;
   NaClSrpcError                       srpc_error;
 
   NaClLog(4, "NaClManifestNameServiceLookupRpc\n");
 
+  /*
+   * Repeated read-only lookups are answered without waiting for, or
+   * making an RPC on, the reverse channel.
+   */
+  if (NaClManifestCacheLookup(cache, name, flags,
+                              proxy->server->nap->validation_cache,
+                              &status, &desc)) {
+    out_args[0]->u.ival = status;
+    out_args[1]->u.hval = desc;
+    rpc->result = NACL_SRPC_RESULT_OK;
+    (*done_cls->Run)(done_cls);
+    NaClDescSafeUnref(desc);
+    return;
+  }
+
   NaClManifestWaitForChannel_yield_mu(proxy_conn);
 
   NaClLog(4,
@@ -145,10 +164,9 @@ static void NaClManifestNameServiceLookupRpc(
              NACL_MANIFEST_LOOKUP" failed: %d\n"),
             (uintptr_t) &proxy_conn->client_channel,
             srpc_error);
+    desc = NULL;
     rpc->result = srpc_error;
   } else {
-    struct NaClManifestProxy *proxy =
-        (struct NaClManifestProxy *) proxy_conn->base.server;
     struct NaClValidationCache *validation_cache =
         proxy->server->nap->validation_cache;
     struct NaClDesc *replacement_desc;
@@ -171,6 +189,10 @@ static void NaClManifestNameServiceLookupRpc(
     if (NULL != replacement_desc) {
       NaClDescUnref(desc);
       desc = replacement_desc;
+      /* Only a token that resolved can be exchanged again on a hit. */
+      NaClManifestCacheInsert(cache, name, flags, status, desc, &file_token);
+    } else {
+      NaClManifestCacheInsert(cache, name, flags, status, desc, NULL);
     }
 
     out_args[0]->u.ival = status;
@@ -178,7 +200,7 @@ static void NaClManifestNameServiceLookupRpc(
     rpc->result = NACL_SRPC_RESULT_OK;
   }
   (*done_cls->Run)(done_cls);
-  NaClDescUnref(desc);
+  NaClDescSafeUnref(desc);
   NaClManifestReleaseChannel_release_mu(proxy_conn);
 }
 
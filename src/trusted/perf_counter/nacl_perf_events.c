@@ -0,0 +1,667 @@
+/*
+ * Copyright (c) 2013 The Native Client Authors. All rights reserved.
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+
+#if NACL_LINUX
+# include <errno.h>
+# include <linux/perf_event.h>
+# include <sys/mman.h>
+# include <sys/syscall.h>
+# include <unistd.h>
+#endif
+
+#include "native_client/src/include/nacl_macros.h"
+#include "native_client/src/include/portability.h"
+#include "native_client/src/include/portability_io.h"
+#include "native_client/src/include/portability_string.h"
+#include "native_client/src/shared/platform/nacl_check.h"
+#include "native_client/src/shared/platform/nacl_log.h"
+#include "native_client/src/shared/platform/nacl_sync.h"
+#include "native_client/src/shared/platform/nacl_sync_checked.h"
+#include "native_client/src/shared/platform/nacl_threads.h"
+#include "native_client/src/trusted/perf_counter/nacl_perf_events.h"
+#include "native_client/src/trusted/perf_counter/nacl_perf_json.h"
+#include "native_client/src/trusted/perf_counter/nacl_perf_output.h"
+#include "native_client/src/trusted/perf_counter/nacl_perf_symbols.h"
+
+#if NACL_LINUX && defined(__NR_perf_event_open)
+# define NACL_PERF_EVENTS_SUPPORTED 1
+#else
+# define NACL_PERF_EVENTS_SUPPORTED 0
+#endif
+
+#define NACL_PERF_EVENTS_DEFAULT_PERIOD 1000000
+/* Data pages in each thread's sample ring; must be a power of 2. */
+#define NACL_PERF_EVENTS_RING_PAGES     16
+#define NACL_PERF_EVENTS_DRAIN_NANOS    10000000
+#define NACL_PERF_EVENTS_STACK_SIZE     (64 << 10)
+
+struct NaClPerfEventsThread {
+  struct NaClPerfEvents       *pe;
+  struct NaClPerfEventsThread *next;
+  int                         fds[NACL_PERF_EVENTS_NUM_COUNTERS];
+  /* The cycles counter's sample ring, preceded by its control page. */
+  void                        *ring;
+  size_t                      ring_size;
+};
+
+/* Samples per untrusted address, in an open-addressed hash table. */
+struct NaClPerfEventsSample {
+  uint32_t  addr;
+  uint32_t  count;  /* 0 if the slot is free */
+};
+
+struct NaClPerfEvents {
+  /* Protects everything below. */
+  struct NaClMutex            mu;
+  struct NaClCondVar          cv;
+  FILE                        *out;
+  enum NaClPerfEventsSource   source;
+  uint64_t                    sample_period;
+  uintptr_t                   sandbox_base;
+  uintptr_t                   sandbox_size;
+  /* Threads whose counters are open. */
+  struct NaClPerfEventsThread *threads;
+  /* Counts of the threads that have stopped. */
+  uint64_t                    retired[NACL_PERF_EVENTS_NUM_COUNTERS];
+  uint64_t                    trusted_samples;
+  uint64_t                    lost_samples;
+  struct NaClPerfEventsSample *samples;
+  size_t                      samples_capacity;  /* a power of 2 */
+  size_t                      samples_used;
+  struct NaClPerfSymbols      symbols;
+  int                         drain_stop;
+  int                         drain_running;
+  struct NaClThread           drain_thread;
+};
+
+static char const *const kCounterNames[NACL_PERF_EVENTS_NUM_COUNTERS] = {
+  "cycles",
+  "instructions",
+  "cache_misses",
+  "branch_misses",
+};
+
+static void NaClPerfEventsRecordSample_mu(struct NaClPerfEvents *pe,
+                                          uint64_t pc) {
+  uint32_t  addr;
+  size_t    mask;
+  size_t    i;
+
+  if (pc < pe->sandbox_base || pc - pe->sandbox_base >= pe->sandbox_size) {
+    pe->trusted_samples++;
+    return;
+  }
+  addr = (uint32_t) (pc - pe->sandbox_base);
+
+  if (2 * (pe->samples_used + 1) > pe->samples_capacity) {
+    size_t                      new_capacity = 2 * pe->samples_capacity;
+    struct NaClPerfEventsSample *new_samples;
+    size_t                      j;
+
+    new_samples = (struct NaClPerfEventsSample *)
+        calloc(new_capacity, sizeof *new_samples);
+    if (NULL == new_samples) {
+      pe->lost_samples++;
+      return;
+    }
+    for (j = 0; j < pe->samples_capacity; ++j) {
+      struct NaClPerfEventsSample const *s = &pe->samples[j];
+
+      if (0 == s->count) {
+        continue;
+      }
+      for (i = (s->addr * 2654435761U) & (new_capacity - 1);
+           0 != new_samples[i].count;
+           i = (i + 1) & (new_capacity - 1)) {
+      }
+      new_samples[i] = *s;
+    }
+    free(pe->samples);
+    pe->samples = new_samples;
+    pe->samples_capacity = new_capacity;
+  }
+
+  mask = pe->samples_capacity - 1;
+  for (i = (addr * 2654435761U) & mask;
+       0 != pe->samples[i].count && pe->samples[i].addr != addr;
+       i = (i + 1) & mask) {
+  }
+  if (0 == pe->samples[i].count) {
+    pe->samples[i].addr = addr;
+    pe->samples_used++;
+  }
+  pe->samples[i].count++;
+}
+
+#if NACL_PERF_EVENTS_SUPPORTED
+
+static uint64_t const kCounterConfigs[NACL_PERF_EVENTS_NUM_COUNTERS] = {
+  PERF_COUNT_HW_CPU_CYCLES,
+  PERF_COUNT_HW_INSTRUCTIONS,
+  PERF_COUNT_HW_CACHE_MISSES,
+  PERF_COUNT_HW_BRANCH_MISSES,
+};
+
+/*
+ * Opens a counter for the calling thread.  Only the cycles counter
+ * samples.  The counters are not grouped, so that the kernel can
+ * multiplex them if there are fewer hardware counters than events;
+ * NaClPerfEventsRead() scales the counts to make up for it.  The
+ * software source only has the cycles counter, which counts CPU time.
+ */
+static int NaClPerfEventsOpen(enum NaClPerfEventsSource source,
+                              enum NaClPerfEventsCounter counter,
+                              uint64_t sample_period) {
+  struct perf_event_attr attr;
+
+  memset(&attr, 0, sizeof attr);
+  attr.size = sizeof attr;
+  if (NACL_PERF_EVENTS_SOFTWARE == source) {
+    if (NACL_PERF_EVENTS_CYCLES != counter) {
+      errno = ENOENT;
+      return -1;
+    }
+    attr.type = PERF_TYPE_SOFTWARE;
+    attr.config = PERF_COUNT_SW_CPU_CLOCK;
+  } else {
+    attr.type = PERF_TYPE_HARDWARE;
+    attr.config = kCounterConfigs[counter];
+  }
+  attr.read_format = (PERF_FORMAT_TOTAL_TIME_ENABLED |
+                      PERF_FORMAT_TOTAL_TIME_RUNNING);
+  attr.exclude_kernel = 1;
+  attr.exclude_hv = 1;
+  if (NACL_PERF_EVENTS_CYCLES == counter) {
+    attr.sample_period = sample_period;
+    attr.sample_type = PERF_SAMPLE_IP;
+  }
+  /* pid 0 and cpu -1 count the calling thread on any CPU. */
+  return (int) syscall(__NR_perf_event_open, &attr, 0, -1, -1, 0);
+}
+
+static uint64_t NaClPerfEventsRead(int fd) {
+  uint64_t values[3];  /* value, time enabled, time running */
+
+  if (fd < 0 || (ssize_t) sizeof values != read(fd, values, sizeof values)) {
+    return 0;
+  }
+  if (0 != values[2] && values[2] < values[1]) {
+    return (uint64_t) ((double) values[0] * values[1] / values[2]);
+  }
+  return values[0];
+}
+
+static void NaClPerfEventsRingCopy(struct NaClPerfEventsThread *thread,
+                                   uint64_t offset, void *dst, size_t size) {
+  size_t      page_size = (size_t) sysconf(_SC_PAGESIZE);
+  size_t      data_size = thread->ring_size - page_size;
+  char const  *data = (char const *) thread->ring + page_size;
+  size_t      start = (size_t) (offset & (data_size - 1));
+  size_t      first = size < data_size - start ? size : data_size - start;
+
+  memcpy(dst, data + start, first);
+  memcpy((char *) dst + first, data, size - first);
+}
+
+/* Moves the samples in the thread's ring into the histogram. */
+static void NaClPerfEventsDrain_mu(struct NaClPerfEventsThread *thread) {
+  struct NaClPerfEvents       *pe = thread->pe;
+  struct perf_event_mmap_page *meta;
+  uint64_t                    head;
+  uint64_t                    tail;
+
+  if (NULL == thread->ring) {
+    return;
+  }
+  meta = (struct perf_event_mmap_page *) thread->ring;
+  head = meta->data_head;
+  /* Reading the records must not be reordered before reading head. */
+  __sync_synchronize();
+  tail = meta->data_tail;
+  while (tail < head) {
+    struct perf_event_header  hdr;
+    uint64_t                  values[2];
+
+    NaClPerfEventsRingCopy(thread, tail, &hdr, sizeof hdr);
+    if (hdr.size < sizeof hdr || hdr.size > head - tail) {
+      /* Should not happen; drop the rest rather than misparse it. */
+      tail = head;
+      break;
+    }
+    if (PERF_RECORD_SAMPLE == hdr.type && hdr.size >= sizeof hdr + 8) {
+      NaClPerfEventsRingCopy(thread, tail + sizeof hdr, values, 8);
+      NaClPerfEventsRecordSample_mu(pe, values[0]);
+    } else if (PERF_RECORD_LOST == hdr.type &&
+               hdr.size >= sizeof hdr + sizeof values) {
+      /* The record holds an event id and the number of samples lost. */
+      NaClPerfEventsRingCopy(thread, tail + sizeof hdr, values, sizeof values);
+      pe->lost_samples += values[1];
+    }
+    tail += hdr.size;
+  }
+  /* The kernel must not overwrite the records until they have been read. */
+  __sync_synchronize();
+  meta->data_tail = tail;
+}
+
+static void NaClPerfEventsClose(struct NaClPerfEventsThread *thread) {
+  int i;
+
+  if (NULL != thread->ring) {
+    (void) munmap(thread->ring, thread->ring_size);
+  }
+  for (i = 0; i < NACL_PERF_EVENTS_NUM_COUNTERS; ++i) {
+    if (thread->fds[i] >= 0) {
+      (void) close(thread->fds[i]);
+    }
+  }
+}
+
+static int NaClPerfEventsProbe(enum NaClPerfEventsSource source,
+                               uint64_t sample_period) {
+  int fd = NaClPerfEventsOpen(source, NACL_PERF_EVENTS_CYCLES, sample_period);
+
+  if (fd < 0) {
+    NaClLog(LOG_WARNING,
+            "NaClPerfEvents: perf_event_open of %s events failed, errno %d;"
+            " check /proc/sys/kernel/perf_event_paranoid\n",
+            NACL_PERF_EVENTS_SOFTWARE == source ? "software" : "hardware",
+            errno);
+    return 0;
+  }
+  (void) close(fd);
+  return 1;
+}
+
+#else  /* NACL_PERF_EVENTS_SUPPORTED */
+
+static uint64_t NaClPerfEventsRead(int fd) {
+  UNREFERENCED_PARAMETER(fd);
+  return 0;
+}
+
+static void NaClPerfEventsDrain_mu(struct NaClPerfEventsThread *thread) {
+  UNREFERENCED_PARAMETER(thread);
+}
+
+static void NaClPerfEventsClose(struct NaClPerfEventsThread *thread) {
+  UNREFERENCED_PARAMETER(thread);
+}
+
+static int NaClPerfEventsProbe(enum NaClPerfEventsSource source,
+                               uint64_t sample_period) {
+  UNREFERENCED_PARAMETER(source);
+  UNREFERENCED_PARAMETER(sample_period);
+  NaClLog(LOG_WARNING,
+          "NaClPerfEvents: perf events are only supported on Linux\n");
+  return 0;
+}
+
+#endif  /* NACL_PERF_EVENTS_SUPPORTED */
+
+static void WINAPI NaClPerfEventsDrainThread(void *state) {
+  struct NaClPerfEvents       *pe = (struct NaClPerfEvents *) state;
+  struct NaClPerfEventsThread *thread;
+  NACL_TIMESPEC_T             interval;
+
+  interval.tv_sec = 0;
+  interval.tv_nsec = NACL_PERF_EVENTS_DRAIN_NANOS;
+  NaClXMutexLock(&pe->mu);
+  while (!pe->drain_stop) {
+    for (thread = pe->threads; NULL != thread; thread = thread->next) {
+      NaClPerfEventsDrain_mu(thread);
+    }
+    (void) NaClCondVarTimedWaitRelative(&pe->cv, &pe->mu, &interval);
+  }
+  NaClXMutexUnlock(&pe->mu);
+}
+
+struct NaClPerfEvents *NaClPerfEventsCreate(FILE *out,
+                                            uint64_t sample_period,
+                                            enum NaClPerfEventsSource source) {
+  struct NaClPerfEvents *pe;
+
+  if (0 == sample_period) {
+    sample_period = NACL_PERF_EVENTS_DEFAULT_PERIOD;
+  }
+  if (!NaClPerfEventsProbe(source, sample_period)) {
+    return NULL;
+  }
+  pe = (struct NaClPerfEvents *) calloc(1, sizeof *pe);
+  if (NULL == pe) {
+    return NULL;
+  }
+  pe->samples_capacity = 1024;
+  pe->samples = (struct NaClPerfEventsSample *)
+      calloc(pe->samples_capacity, sizeof *pe->samples);
+  if (NULL == pe->samples) {
+    goto cleanup_pe;
+  }
+  if (!NaClMutexCtor(&pe->mu)) {
+    goto cleanup_samples;
+  }
+  if (!NaClCondVarCtor(&pe->cv)) {
+    goto cleanup_mu;
+  }
+  NaClPerfSymbolsCtor(&pe->symbols);
+  pe->out = out;
+  pe->source = source;
+  pe->sample_period = sample_period;
+  if (!NaClThreadCreateJoinable(&pe->drain_thread, NaClPerfEventsDrainThread,
+                                pe, NACL_PERF_EVENTS_STACK_SIZE)) {
+    goto cleanup_cv;
+  }
+  pe->drain_running = 1;
+  return pe;
+
+ cleanup_cv:
+  NaClCondVarDtor(&pe->cv);
+ cleanup_mu:
+  NaClMutexDtor(&pe->mu);
+ cleanup_samples:
+  free(pe->samples);
+ cleanup_pe:
+  free(pe);
+  return NULL;
+}
+
+static int g_perf_events_enabled = 0;
+
+struct NaClPerfEvents *NaClPerfEventsCreateFromEnv(void) {
+  char const            *path = getenv("NACL_PERF_EVENTS");
+  char const            *period = getenv("NACL_PERF_EVENTS_PERIOD");
+  uint64_t              sample_period = 0;
+  FILE                  *out;
+  struct NaClPerfEvents *pe;
+
+  if (NULL == path) {
+    return NULL;
+  }
+  if (NULL != period) {
+    sample_period = STRTOULL(period, (char **) NULL, 0);
+  }
+  out = NaClPerfOutputOpen(path, "NaClPerfEventsCreateFromEnv", "profiling");
+  if (NULL == out) {
+    return NULL;
+  }
+  pe = NaClPerfEventsCreate(out, sample_period, NACL_PERF_EVENTS_HARDWARE);
+  if (NULL == pe) {
+    NaClLog(LOG_WARNING,
+            "NaClPerfEventsCreateFromEnv: falling back to sampling on"
+            " CPU time\n");
+    pe = NaClPerfEventsCreate(out, sample_period, NACL_PERF_EVENTS_SOFTWARE);
+  }
+  if (NULL == pe) {
+    NaClLog(LOG_WARNING,
+            "NaClPerfEventsCreateFromEnv: profiling disabled\n");
+    NaClPerfOutputClose(out);
+    return NULL;
+  }
+  NaClLog(LOG_INFO, "Perf event profiling enabled, writing to %s\n", path);
+  g_perf_events_enabled = 1;
+  return pe;
+}
+
+int NaClPerfEventsEnabled(void) {
+  return g_perf_events_enabled;
+}
+
+void NaClPerfEventsDelete(struct NaClPerfEvents *pe) {
+  if (NULL == pe) {
+    return;
+  }
+  CHECK(NULL == pe->threads);
+  NaClXMutexLock(&pe->mu);
+  pe->drain_stop = 1;
+  NaClXCondVarSignal(&pe->cv);
+  NaClXMutexUnlock(&pe->mu);
+  if (pe->drain_running) {
+    NaClThreadJoin(&pe->drain_thread);
+  }
+  NaClPerfSymbolsDtor(&pe->symbols);
+  free(pe->samples);
+  NaClCondVarDtor(&pe->cv);
+  NaClMutexDtor(&pe->mu);
+  free(pe);
+}
+
+void NaClPerfEventsSetSandbox(struct NaClPerfEvents *pe,
+                              uintptr_t base, uintptr_t size) {
+  NaClXMutexLock(&pe->mu);
+  pe->sandbox_base = base;
+  pe->sandbox_size = size;
+  NaClXMutexUnlock(&pe->mu);
+}
+
+void NaClPerfEventsAddSymbol(struct NaClPerfEvents *pe,
+                             uint32_t addr, uint32_t size, char const *name) {
+  NaClXMutexLock(&pe->mu);
+  NaClPerfSymbolsAdd(&pe->symbols, addr, size, name);
+  NaClXMutexUnlock(&pe->mu);
+}
+
+struct NaClPerfEventsThread *NaClPerfEventsThreadStart(
+    struct NaClPerfEvents *pe) {
+#if NACL_PERF_EVENTS_SUPPORTED
+  struct NaClPerfEventsThread *thread;
+  size_t                      page_size = (size_t) sysconf(_SC_PAGESIZE);
+  int                         i;
+
+  thread = (struct NaClPerfEventsThread *) calloc(1, sizeof *thread);
+  if (NULL == thread) {
+    return NULL;
+  }
+  thread->pe = pe;
+  for (i = 0; i < NACL_PERF_EVENTS_NUM_COUNTERS; ++i) {
+    thread->fds[i] = NaClPerfEventsOpen(pe->source,
+                                        (enum NaClPerfEventsCounter) i,
+                                        pe->sample_period);
+    if (thread->fds[i] < 0 &&
+        (NACL_PERF_EVENTS_HARDWARE == pe->source ||
+         NACL_PERF_EVENTS_CYCLES == i)) {
+      NaClLog(LOG_WARNING,
+              "NaClPerfEventsThreadStart: could not open the %s counter,"
+              " errno %d\n", kCounterNames[i], errno);
+      if (NACL_PERF_EVENTS_CYCLES == i) {
+        goto cleanup;
+      }
+    }
+  }
+  thread->ring_size = (1 + NACL_PERF_EVENTS_RING_PAGES) * page_size;
+  thread->ring = mmap(NULL, thread->ring_size, PROT_READ | PROT_WRITE,
+                      MAP_SHARED, thread->fds[NACL_PERF_EVENTS_CYCLES], 0);
+  if (MAP_FAILED == thread->ring) {
+    NaClLog(LOG_WARNING,
+            "NaClPerfEventsThreadStart: could not map the sample ring,"
+            " errno %d\n", errno);
+    thread->ring = NULL;
+    goto cleanup;
+  }
+
+  NaClXMutexLock(&pe->mu);
+  thread->next = pe->threads;
+  pe->threads = thread;
+  NaClXMutexUnlock(&pe->mu);
+  return thread;
+
+ cleanup:
+  NaClPerfEventsClose(thread);
+  free(thread);
+  return NULL;
+#else
+  UNREFERENCED_PARAMETER(pe);
+  return NULL;
+#endif
+}
+
+void NaClPerfEventsThreadStop(struct NaClPerfEventsThread *thread) {
+  struct NaClPerfEvents       *pe;
+  struct NaClPerfEventsThread **link;
+  int                         i;
+
+  if (NULL == thread) {
+    return;
+  }
+  pe = thread->pe;
+  NaClXMutexLock(&pe->mu);
+  for (link = &pe->threads; *link != thread; link = &(*link)->next) {
+  }
+  *link = thread->next;
+  NaClPerfEventsDrain_mu(thread);
+  for (i = 0; i < NACL_PERF_EVENTS_NUM_COUNTERS; ++i) {
+    pe->retired[i] += NaClPerfEventsRead(thread->fds[i]);
+  }
+  NaClXMutexUnlock(&pe->mu);
+  NaClPerfEventsClose(thread);
+  free(thread);
+}
+
+static uint64_t NaClPerfEventsTotal_mu(struct NaClPerfEvents *pe,
+                                       enum NaClPerfEventsCounter counter) {
+  struct NaClPerfEventsThread *thread;
+  uint64_t                    total = pe->retired[counter];
+
+  for (thread = pe->threads; NULL != thread; thread = thread->next) {
+    total += NaClPerfEventsRead(thread->fds[counter]);
+  }
+  return total;
+}
+
+uint64_t NaClPerfEventsTotal(struct NaClPerfEvents *pe,
+                             enum NaClPerfEventsCounter counter) {
+  uint64_t total;
+
+  NaClXMutexLock(&pe->mu);
+  total = NaClPerfEventsTotal_mu(pe, counter);
+  NaClXMutexUnlock(&pe->mu);
+  return total;
+}
+
+/*
+ * Returns the index of the symbol containing addr, or num_symbols if
+ * there is none.
+ */
+static size_t NaClPerfEventsLookup_mu(struct NaClPerfEvents *pe,
+                                      uint32_t addr) {
+  struct NaClPerfSymbol const *sym = NaClPerfSymbolsLookup(&pe->symbols,
+                                                           addr);
+
+  if (NULL == sym) {
+    return pe->symbols.num_symbols;
+  }
+  return sym - pe->symbols.symbols;
+}
+
+struct NaClPerfEventsFunction {
+  size_t    symbol;
+  uint64_t  samples;
+};
+
+static int NaClPerfEventsFunctionCompare(void const *a, void const *b) {
+  uint64_t samples_a = ((struct NaClPerfEventsFunction const *) a)->samples;
+  uint64_t samples_b = ((struct NaClPerfEventsFunction const *) b)->samples;
+
+  return samples_a > samples_b ? -1 : samples_a < samples_b;
+}
+
+char *NaClPerfEventsToJson(struct NaClPerfEvents *pe) {
+  struct NaClPerfJson           buf;
+  struct NaClPerfEventsThread   *thread;
+  struct NaClPerfEventsFunction *functions;
+  uint64_t                      untrusted_samples = 0;
+  size_t                        num_symbols;
+  size_t                        i;
+  char const                    *sep = "";
+
+  if (!NaClPerfJsonCtor(&buf)) {
+    return NULL;
+  }
+
+  NaClXMutexLock(&pe->mu);
+  for (thread = pe->threads; NULL != thread; thread = thread->next) {
+    NaClPerfEventsDrain_mu(thread);
+  }
+  num_symbols = pe->symbols.num_symbols;
+  /* One entry per symbol, and a last one for unknown addresses. */
+  functions = (struct NaClPerfEventsFunction *)
+      calloc(num_symbols + 1, sizeof *functions);
+  if (NULL == functions) {
+    NaClXMutexUnlock(&pe->mu);
+    free(NaClPerfJsonRelease(&buf));
+    return NULL;
+  }
+  for (i = 0; i <= num_symbols; ++i) {
+    functions[i].symbol = i;
+  }
+  for (i = 0; i < pe->samples_capacity; ++i) {
+    struct NaClPerfEventsSample const *s = &pe->samples[i];
+
+    if (0 != s->count) {
+      functions[NaClPerfEventsLookup_mu(pe, s->addr)].samples += s->count;
+      untrusted_samples += s->count;
+    }
+  }
+  qsort(functions, num_symbols + 1, sizeof *functions,
+        NaClPerfEventsFunctionCompare);
+
+  NaClPerfJsonAppend(&buf, "{\n  \"source\": \"%s\",\n"
+                     "  \"sample_period\": %"NACL_PRIu64",\n"
+                     "  \"counters\": {",
+                     NACL_PERF_EVENTS_SOFTWARE == pe->source ? "software"
+                                                             : "hardware",
+                     pe->sample_period);
+  for (i = 0; i < NACL_PERF_EVENTS_NUM_COUNTERS; ++i) {
+    NaClPerfJsonAppend(
+        &buf, "%s\"%s\": %"NACL_PRIu64, sep, kCounterNames[i],
+        NaClPerfEventsTotal_mu(pe, (enum NaClPerfEventsCounter) i));
+    sep = ", ";
+  }
+  NaClPerfJsonAppend(
+      &buf,
+      "},\n  \"samples\": {\"untrusted\": %"NACL_PRIu64
+      ", \"trusted\": %"NACL_PRIu64", \"lost\": %"NACL_PRIu64"},\n"
+      "  \"functions\": [",
+      untrusted_samples, pe->trusted_samples, pe->lost_samples);
+  sep = "";
+  for (i = 0; i <= num_symbols && 0 != functions[i].samples; ++i) {
+    size_t symbol = functions[i].symbol;
+
+    NaClPerfJsonAppend(&buf, "%s\n    {\"name\": ", sep);
+    if (symbol == num_symbols) {
+      NaClPerfJsonAppend(&buf, "\"[unknown]\", \"address\": null");
+    } else {
+      NaClPerfJsonAppendString(&buf, pe->symbols.symbols[symbol].name);
+      NaClPerfJsonAppend(&buf, ", \"address\": %"NACL_PRIu32,
+                         pe->symbols.symbols[symbol].addr);
+    }
+    NaClPerfJsonAppend(&buf, ", \"samples\": %"NACL_PRIu64"}",
+                       functions[i].samples);
+    sep = ",";
+  }
+  NaClXMutexUnlock(&pe->mu);
+  NaClPerfJsonAppend(&buf, "\n  ]\n}\n");
+  free(functions);
+  return NaClPerfJsonRelease(&buf);
+}
+
+void NaClPerfEventsWrite(struct NaClPerfEvents *pe) {
+  char *json;
+
+  if (NULL == pe || NULL == pe->out) {
+    return;
+  }
+  json = NaClPerfEventsToJson(pe);
+  if (NULL == json) {
+    NaClLog(LOG_WARNING, "NaClPerfEventsWrite: out of memory\n");
+    return;
+  }
+  fputs(json, pe->out);
+  fflush(pe->out);
+  free(json);
+}
@@ -0,0 +1,137 @@
+/*
+ * Copyright (c) 2013 The Native Client Authors. All rights reserved.
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+/*
+ * Opt-in hardware performance counter profiling of untrusted code.
+ * When the NACL_PERF_EVENTS environment variable names an output file
+ * ("-" for stderr), each untrusted thread counts CPU cycles,
+ * instructions, cache misses and branch misses with perf_event_open,
+ * and samples its program counter every NACL_PERF_EVENTS_PERIOD
+ * cycles (default 1000000).  When the main thread exits, a JSON
+ * profile is written with the counter totals and the samples that
+ * landed in the sandbox, attributed to the nexe's function symbols.
+ *
+ * Host profilers see untrusted code only as anonymous memory, so they
+ * cannot do this attribution themselves.  The counters only count
+ * user mode, but include time spent in trusted code; samples taken
+ * there are reported as a single total.
+ *
+ * Where there are no hardware counters, as on many virtual machines,
+ * NaClPerfEventsCreateFromEnv() falls back to sampling every
+ * NACL_PERF_EVENTS_PERIOD nanoseconds of CPU time with the kernel's
+ * software cpu-clock event.  The "cycles" counter then holds
+ * nanoseconds, and the others stay 0; the profile's "source" field
+ * says which kind of events were used.
+ *
+ * This is only available on Linux.  Elsewhere, and if the kernel
+ * refuses to open even the software event, NaClPerfEventsCreateFromEnv()
+ * warns and returns NULL.
+ */
+
+#ifndef NATIVE_CLIENT_SRC_TRUSTED_PERF_COUNTER_NACL_PERF_EVENTS_H_
+#define NATIVE_CLIENT_SRC_TRUSTED_PERF_COUNTER_NACL_PERF_EVENTS_H_
+
+#include <stdio.h>
+
+#include "native_client/src/include/nacl_base.h"
+#include "native_client/src/include/portability.h"
+
+EXTERN_C_BEGIN
+
+enum NaClPerfEventsCounter {
+  NACL_PERF_EVENTS_CYCLES,
+  NACL_PERF_EVENTS_INSTRUCTIONS,
+  NACL_PERF_EVENTS_CACHE_MISSES,
+  NACL_PERF_EVENTS_BRANCH_MISSES,
+  NACL_PERF_EVENTS_NUM_COUNTERS
+};
+
+enum NaClPerfEventsSource {
+  NACL_PERF_EVENTS_HARDWARE,
+  /* Only NACL_PERF_EVENTS_CYCLES, counting CPU time in nanoseconds. */
+  NACL_PERF_EVENTS_SOFTWARE
+};
+
+struct NaClPerfEvents;
+struct NaClPerfEventsThread;
+
+/*
+ * Returns a profiler that samples every sample_period cycles (or
+ * nanoseconds, for the software source) and writes its profile to
+ * out, or to nowhere if out is NULL.  Returns NULL if the source's
+ * events are not available or on allocation failure.
+ */
+struct NaClPerfEvents *NaClPerfEventsCreate(FILE *out, uint64_t sample_period,
+                                            enum NaClPerfEventsSource source);
+
+/*
+ * Returns a profiler set up from the environment, or NULL if
+ * profiling was not requested or is not available.  This must be
+ * called before the outer sandbox is enabled, since it opens the
+ * output file.
+ */
+struct NaClPerfEvents *NaClPerfEventsCreateFromEnv(void);
+
+/*
+ * Returns nonzero once NaClPerfEventsCreateFromEnv() has returned a
+ * profiler.  The seccomp-bpf outer sandbox only allows perf_event_open
+ * if so.
+ */
+int NaClPerfEventsEnabled(void);
+
+/*
+ * Stops the profiler and frees it.  All threads must have been
+ * stopped first.
+ */
+void NaClPerfEventsDelete(struct NaClPerfEvents *pe);
+
+/*
+ * Sets the host address range of the sandbox.  Samples with a
+ * program counter in [base, base + size) are attributed to the
+ * untrusted address pc - base, which is what NaClSysToUser() would
+ * return; all others count as trusted.
+ */
+void NaClPerfEventsSetSandbox(struct NaClPerfEvents *pe,
+                              uintptr_t base, uintptr_t size);
+
+/* Adds a function symbol of the nexe, at untrusted address addr. */
+void NaClPerfEventsAddSymbol(struct NaClPerfEvents *pe,
+                             uint32_t addr, uint32_t size, char const *name);
+
+/*
+ * Opens the counters for the calling thread.  Returns NULL, after
+ * logging why, if they could not be opened; the thread then runs
+ * unprofiled.
+ */
+struct NaClPerfEventsThread *NaClPerfEventsThreadStart(
+    struct NaClPerfEvents *pe);
+
+/*
+ * Collects the thread's remaining samples, adds its counts to the
+ * totals and closes its counters.  Accepts NULL.
+ */
+void NaClPerfEventsThreadStop(struct NaClPerfEventsThread *thread);
+
+/*
+ * Returns the current value of a counter, summed over all threads
+ * that have run so far.
+ */
+uint64_t NaClPerfEventsTotal(struct NaClPerfEvents *pe,
+                             enum NaClPerfEventsCounter counter);
+
+/*
+ * Returns a malloc()ed JSON profile of everything collected so far,
+ * including the threads that are still running, or NULL on
+ * allocation failure.
+ */
+char *NaClPerfEventsToJson(struct NaClPerfEvents *pe);
+
+/* Writes the profile to the output file, if there is one.  Accepts NULL. */
+void NaClPerfEventsWrite(struct NaClPerfEvents *pe);
+
+EXTERN_C_END
+
+#endif  /* NATIVE_CLIENT_SRC_TRUSTED_PERF_COUNTER_NACL_PERF_EVENTS_H_ */
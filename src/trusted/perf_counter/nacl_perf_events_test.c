@@ -0,0 +1,119 @@
+/*
+ * Copyright (c) 2013 The Native Client Authors. All rights reserved.
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+/*
+ * Profiles a busy loop, pretending that the code around it is the
+ * sandbox, and checks that the samples are attributed to it.  This is
+ * done with the software cpu-clock event, which goes through the same
+ * sample ring as the hardware counters but needs no PMU, and then
+ * with the hardware counters where they are available; many virtual
+ * machines have none.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "native_client/src/include/portability.h"
+#include "native_client/src/shared/platform/nacl_check.h"
+#include "native_client/src/shared/platform/platform_init.h"
+#include "native_client/src/trusted/perf_counter/nacl_perf_events.h"
+
+#define kSamplePeriod 100000
+#define kSandboxSize (1 << 20)
+
+static volatile uint32_t g_sink;
+
+static void Spin(void) {
+  uint32_t  x = 1;
+  int       i;
+
+  for (i = 0; i < 100000000; ++i) {
+    x = x * 1103515245 + 12345;
+  }
+  g_sink = x;
+}
+
+static int Expect(char const *what, int condition) {
+  if (!condition) {
+    printf("FAILED: %s\n", what);
+    return 1;
+  }
+  return 0;
+}
+
+/*
+ * Returns the number of failed checks, or -1 if the source's events
+ * are not available.
+ */
+static int TestSource(enum NaClPerfEventsSource source) {
+  struct NaClPerfEvents       *pe;
+  struct NaClPerfEventsThread *thread;
+  uintptr_t                   base = (uintptr_t) Spin & ~((uintptr_t) 0xfff);
+  char                        *json;
+  int                         errors = 0;
+
+  pe = NaClPerfEventsCreate(NULL, kSamplePeriod, source);
+  if (NULL == pe) {
+    return -1;
+  }
+  NaClPerfEventsSetSandbox(pe, base, kSandboxSize);
+  NaClPerfEventsAddSymbol(pe, (uint32_t) ((uintptr_t) Spin - base), 0,
+                          "Spin");
+
+  thread = NaClPerfEventsThreadStart(pe);
+  CHECK(NULL != thread);
+  Spin();
+  NaClPerfEventsThreadStop(thread);
+
+  errors += Expect("cycles counted",
+                   0 != NaClPerfEventsTotal(pe, NACL_PERF_EVENTS_CYCLES));
+  if (NACL_PERF_EVENTS_HARDWARE == source) {
+    errors += Expect("instructions counted",
+                     0 != NaClPerfEventsTotal(pe,
+                                              NACL_PERF_EVENTS_INSTRUCTIONS));
+  }
+  json = NaClPerfEventsToJson(pe);
+  CHECK(NULL != json);
+  printf("%s", json);
+  errors += Expect("samples attributed to Spin",
+                   NULL != strstr(json, "\"name\": \"Spin\""));
+  errors += Expect("source reported",
+                   NULL != strstr(json,
+                                  NACL_PERF_EVENTS_HARDWARE == source
+                                  ? "\"source\": \"hardware\""
+                                  : "\"source\": \"software\""));
+  free(json);
+
+  NaClPerfEventsDelete(pe);
+  return errors;
+}
+
+int main(void) {
+  int errors = 0;
+  int rc;
+
+  NaClPlatformInit();
+  rc = TestSource(NACL_PERF_EVENTS_SOFTWARE);
+  if (rc < 0) {
+    printf("perf events are not available; skipping\n");
+    NaClPlatformFini();
+    return 0;
+  }
+  errors += rc;
+  rc = TestSource(NACL_PERF_EVENTS_HARDWARE);
+  if (rc < 0) {
+    printf("hardware counters are not available; skipping them\n");
+  } else {
+    errors += rc;
+  }
+
+  NaClPlatformFini();
+  if (0 == errors) {
+    printf("PASSED\n");
+  }
+  return 0 != errors;
+}
@@ -0,0 +1,82 @@
+/*
+ * Copyright (c) 2013 The Native Client Authors. All rights reserved.
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "native_client/src/include/portability.h"
+#include "native_client/src/include/portability_io.h"
+#include "native_client/src/trusted/perf_counter/nacl_perf_json.h"
+
+#define NACL_PERF_JSON_INITIAL_SIZE 4096
+
+int NaClPerfJsonCtor(struct NaClPerfJson *buf) {
+  buf->size = NACL_PERF_JSON_INITIAL_SIZE;
+  buf->len = 0;
+  buf->failed = 0;
+  buf->data = (char *) malloc(buf->size);
+  if (NULL == buf->data) {
+    return 0;
+  }
+  buf->data[0] = '\0';
+  return 1;
+}
+
+void NaClPerfJsonAppend(struct NaClPerfJson *buf, char const *fmt, ...) {
+  va_list ap;
+  int     n;
+
+  if (buf->failed) {
+    return;
+  }
+  for (;;) {
+    va_start(ap, fmt);
+    n = VSNPRINTF(buf->data + buf->len, buf->size - buf->len, fmt, ap);
+    va_end(ap);
+    if (n >= 0 && (size_t) n < buf->size - buf->len) {
+      buf->len += n;
+      return;
+    }
+    {
+      size_t  new_size = 2 * buf->size;
+      char    *p = (char *) realloc(buf->data, new_size);
+      if (NULL == p) {
+        buf->failed = 1;
+        return;
+      }
+      buf->data = p;
+      buf->size = new_size;
+    }
+  }
+}
+
+void NaClPerfJsonAppendString(struct NaClPerfJson *buf, char const *str) {
+  NaClPerfJsonAppend(buf, "\"");
+  for (; '\0' != *str; ++str) {
+    unsigned char c = (unsigned char) *str;
+
+    if ('"' == c || '\\' == c) {
+      NaClPerfJsonAppend(buf, "\\%c", c);
+    } else if (c < 0x20 || c >= 0x7f) {
+      NaClPerfJsonAppend(buf, "\\u%04x", c);
+    } else {
+      NaClPerfJsonAppend(buf, "%c", c);
+    }
+  }
+  NaClPerfJsonAppend(buf, "\"");
+}
+
+char *NaClPerfJsonRelease(struct NaClPerfJson *buf) {
+  char *data = buf->data;
+
+  buf->data = NULL;
+  if (buf->failed) {
+    free(data);
+    return NULL;
+  }
+  return data;
+}
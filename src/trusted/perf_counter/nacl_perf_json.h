@@ -0,0 +1,52 @@
+/*
+ * Copyright (c) 2013 The Native Client Authors. All rights reserved.
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+/*
+ * A growable string buffer for the JSON written by the opt-in
+ * profilers (NaClPerfTrace, NaClPerfEvents, the sampling and syscall
+ * profilers).  Appends never fail outright: once an allocation fails,
+ * the buffer is marked as failed, further appends are ignored, and
+ * NaClPerfJsonRelease() returns NULL, so the profilers need only check
+ * for errors once, at the end.
+ */
+
+#ifndef NATIVE_CLIENT_SRC_TRUSTED_PERF_COUNTER_NACL_PERF_JSON_H_
+#define NATIVE_CLIENT_SRC_TRUSTED_PERF_COUNTER_NACL_PERF_JSON_H_
+
+#include "native_client/src/include/nacl_base.h"
+#include "native_client/src/include/nacl_compiler_annotations.h"
+#include "native_client/src/include/portability.h"
+
+EXTERN_C_BEGIN
+
+struct NaClPerfJson {
+  char    *data;
+  size_t  len;
+  size_t  size;
+  int     failed;
+};
+
+/* Returns 0 if the initial allocation fails. */
+int NaClPerfJsonCtor(struct NaClPerfJson *buf) NACL_WUR;
+
+void NaClPerfJsonAppend(struct NaClPerfJson *buf, char const *fmt, ...)
+    ATTRIBUTE_FORMAT_PRINTF(2, 3);
+
+/*
+ * Appends str as a quoted JSON string.  Quotes, backslashes, control
+ * characters and bytes outside ASCII are escaped.
+ */
+void NaClPerfJsonAppendString(struct NaClPerfJson *buf, char const *str);
+
+/*
+ * Returns the malloc()ed, NUL-terminated contents, or NULL (freeing
+ * them) if an append failed.  The buffer must not be used afterwards.
+ */
+char *NaClPerfJsonRelease(struct NaClPerfJson *buf);
+
+EXTERN_C_END
+
+#endif  /* NATIVE_CLIENT_SRC_TRUSTED_PERF_COUNTER_NACL_PERF_JSON_H_ */
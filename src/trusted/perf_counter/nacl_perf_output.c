@@ -0,0 +1,32 @@
+/*
+ * Copyright (c) 2013 The Native Client Authors. All rights reserved.
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#include <stdio.h>
+#include <string.h>
+
+#include "native_client/src/shared/platform/nacl_log.h"
+#include "native_client/src/trusted/perf_counter/nacl_perf_output.h"
+
+FILE *NaClPerfOutputOpen(char const *path, char const *caller,
+                         char const *what) {
+  FILE *out;
+
+  if (0 == strcmp(path, "-")) {
+    return stderr;
+  }
+  out = fopen(path, "w");
+  if (NULL == out) {
+    NaClLog(LOG_WARNING, "%s: could not open %s; %s disabled\n",
+            caller, path, what);
+  }
+  return out;
+}
+
+void NaClPerfOutputClose(FILE *out) {
+  if (stderr != out) {
+    fclose(out);
+  }
+}
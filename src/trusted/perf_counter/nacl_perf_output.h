@@ -0,0 +1,35 @@
+/*
+ * Copyright (c) 2013 The Native Client Authors. All rights reserved.
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+/*
+ * The output files of the opt-in profilers (NaClPerfTrace,
+ * NaClPerfEvents, the sampling and syscall profilers), each of which
+ * is named by an environment variable, with "-" meaning stderr.
+ */
+
+#ifndef NATIVE_CLIENT_SRC_TRUSTED_PERF_COUNTER_NACL_PERF_OUTPUT_H_
+#define NATIVE_CLIENT_SRC_TRUSTED_PERF_COUNTER_NACL_PERF_OUTPUT_H_
+
+#include <stdio.h>
+
+#include "native_client/src/include/nacl_base.h"
+
+EXTERN_C_BEGIN
+
+/*
+ * Opens path for writing, or returns stderr if path is "-".  If the
+ * file cannot be opened, logs a warning from caller that what is
+ * disabled, and returns NULL.
+ */
+FILE *NaClPerfOutputOpen(char const *path, char const *caller,
+                         char const *what);
+
+/* Closes a file from NaClPerfOutputOpen(), unless it is stderr. */
+void NaClPerfOutputClose(FILE *out);
+
+EXTERN_C_END
+
+#endif  /* NATIVE_CLIENT_SRC_TRUSTED_PERF_COUNTER_NACL_PERF_OUTPUT_H_ */
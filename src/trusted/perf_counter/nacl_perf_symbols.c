@@ -0,0 +1,93 @@
+/*
+ * Copyright (c) 2013 The Native Client Authors. All rights reserved.
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#include <stdlib.h>
+
+#include "native_client/src/include/portability_string.h"
+#include "native_client/src/trusted/perf_counter/nacl_perf_symbols.h"
+
+void NaClPerfSymbolsCtor(struct NaClPerfSymbols *self) {
+  self->symbols = NULL;
+  self->num_symbols = 0;
+  self->capacity = 0;
+  self->sorted = 1;
+}
+
+void NaClPerfSymbolsDtor(struct NaClPerfSymbols *self) {
+  size_t i;
+
+  for (i = 0; i < self->num_symbols; ++i) {
+    free(self->symbols[i].name);
+  }
+  free(self->symbols);
+  self->symbols = NULL;
+  self->num_symbols = 0;
+  self->capacity = 0;
+}
+
+void NaClPerfSymbolsAdd(struct NaClPerfSymbols *self,
+                        uint32_t addr, uint32_t size, char const *name) {
+  struct NaClPerfSymbol *sym;
+
+  if (self->num_symbols == self->capacity) {
+    size_t                new_capacity = 2 * self->capacity + 64;
+    struct NaClPerfSymbol *p;
+
+    p = (struct NaClPerfSymbol *)
+        realloc(self->symbols, new_capacity * sizeof *p);
+    if (NULL == p) {
+      return;
+    }
+    self->symbols = p;
+    self->capacity = new_capacity;
+  }
+  sym = &self->symbols[self->num_symbols];
+  sym->name = STRDUP(name);
+  if (NULL != sym->name) {
+    sym->addr = addr;
+    sym->size = size;
+    self->num_symbols++;
+    self->sorted = 0;
+  }
+}
+
+static int NaClPerfSymbolCompare(void const *a, void const *b) {
+  uint32_t addr_a = ((struct NaClPerfSymbol const *) a)->addr;
+  uint32_t addr_b = ((struct NaClPerfSymbol const *) b)->addr;
+
+  return addr_a < addr_b ? -1 : addr_a > addr_b;
+}
+
+struct NaClPerfSymbol const *NaClPerfSymbolsLookup(
+    struct NaClPerfSymbols *self, uint32_t addr) {
+  size_t lo = 0;
+  size_t hi = self->num_symbols;
+  size_t mid;
+
+  if (!self->sorted) {
+    qsort(self->symbols, self->num_symbols, sizeof *self->symbols,
+          NaClPerfSymbolCompare);
+    self->sorted = 1;
+  }
+  /* Finds the last symbol that starts at or below addr. */
+  while (lo < hi) {
+    mid = lo + (hi - lo) / 2;
+    if (self->symbols[mid].addr <= addr) {
+      lo = mid + 1;
+    } else {
+      hi = mid;
+    }
+  }
+  if (0 == lo) {
+    return NULL;
+  }
+  --lo;
+  if (0 != self->symbols[lo].size &&
+      addr - self->symbols[lo].addr >= self->symbols[lo].size) {
+    return NULL;
+  }
+  return &self->symbols[lo];
+}
@@ -0,0 +1,57 @@
+/*
+ * Copyright (c) 2013 The Native Client Authors. All rights reserved.
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+/*
+ * A table of the nexe's function symbols, for the profilers that
+ * attribute untrusted addresses to functions (NaClPerfEvents and the
+ * sampling profiler).  The table does no locking of its own; each
+ * profiler guards its table with its own mutex.
+ */
+
+#ifndef NATIVE_CLIENT_SRC_TRUSTED_PERF_COUNTER_NACL_PERF_SYMBOLS_H_
+#define NATIVE_CLIENT_SRC_TRUSTED_PERF_COUNTER_NACL_PERF_SYMBOLS_H_
+
+#include "native_client/src/include/nacl_base.h"
+#include "native_client/src/include/portability.h"
+
+EXTERN_C_BEGIN
+
+struct NaClPerfSymbol {
+  uint32_t  addr;
+  uint32_t  size;
+  char      *name;
+};
+
+struct NaClPerfSymbols {
+  struct NaClPerfSymbol *symbols;
+  size_t                num_symbols;
+  size_t                capacity;
+  int                   sorted;
+};
+
+void NaClPerfSymbolsCtor(struct NaClPerfSymbols *self);
+
+void NaClPerfSymbolsDtor(struct NaClPerfSymbols *self);
+
+/*
+ * Adds a symbol at untrusted address addr, copying name.  The symbol
+ * is dropped if memory runs out.
+ */
+void NaClPerfSymbolsAdd(struct NaClPerfSymbols *self,
+                        uint32_t addr, uint32_t size, char const *name);
+
+/*
+ * Returns the symbol containing addr, or NULL if there is none.  A
+ * symbol of size 0 is taken to extend to the next.  The table is
+ * sorted by address on the first lookup after an add, so symbols'
+ * indices are stable only between adds.
+ */
+struct NaClPerfSymbol const *NaClPerfSymbolsLookup(
+    struct NaClPerfSymbols *self, uint32_t addr);
+
+EXTERN_C_END
+
+#endif  /* NATIVE_CLIENT_SRC_TRUSTED_PERF_COUNTER_NACL_PERF_SYMBOLS_H_ */
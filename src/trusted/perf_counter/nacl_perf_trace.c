@@ -0,0 +1,256 @@
+/*
+ * Copyright (c) 2013 The Native Client Authors. All rights reserved.
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#include <stdlib.h>
+
+#include "native_client/src/include/nacl_macros.h"
+#include "native_client/src/include/portability.h"
+#include "native_client/src/include/portability_process.h"
+#include "native_client/src/shared/platform/nacl_clock.h"
+#include "native_client/src/shared/platform/nacl_log.h"
+#include "native_client/src/shared/platform/nacl_sync.h"
+#include "native_client/src/shared/platform/nacl_sync_checked.h"
+#include "native_client/src/shared/platform/nacl_threads.h"
+#include "native_client/src/trusted/perf_counter/nacl_perf_json.h"
+#include "native_client/src/trusted/perf_counter/nacl_perf_output.h"
+#include "native_client/src/trusted/perf_counter/nacl_perf_trace.h"
+#include "native_client/src/trusted/service_runtime/include/sys/time.h"
+
+#define NACL_PERF_TRACE_CHUNK_EVENTS 512
+
+struct NaClPerfTraceEvent {
+  int64_t     ns;
+  char const  *name;
+  char        phase;
+};
+
+struct NaClPerfTraceChunk {
+  struct NaClPerfTraceChunk *next;
+  size_t                    count;
+  struct NaClPerfTraceEvent events[NACL_PERF_TRACE_CHUNK_EVENTS];
+};
+
+/*
+ * The events of one host thread.  Only that thread appends, but mu is
+ * also taken by NaClPerfTraceToJson(), which may run concurrently.
+ * It is never contended otherwise.
+ */
+struct NaClPerfTraceThread {
+  struct NaClPerfTraceThread  *next;
+  uint32_t                    tid;
+  struct NaClMutex            mu;
+  struct NaClPerfTraceChunk   *first;
+  struct NaClPerfTraceChunk   *last;
+};
+
+int gNaClPerfTraceEnabled = 0;
+volatile int gNaClPerfTraceFirstSyscallPending = 0;
+
+static struct NaClMutex           g_trace_mu;
+/* Protected by g_trace_mu.  Buffers are never freed. */
+static struct NaClPerfTraceThread *g_trace_threads = NULL;
+static FILE                       *g_trace_out = NULL;
+static int64_t                    g_trace_start_ns = 0;
+
+#if NACL_PLATFORM_HAS_TLS
+static THREAD struct NaClPerfTraceThread *g_tls_trace_thread = NULL;
+#endif
+
+static int64_t NaClPerfTraceNowNs(void) {
+  struct nacl_abi_timespec now;
+
+  if (0 != NaClClockGetTime(NACL_CLOCK_MONOTONIC, &now)) {
+    return 0;
+  }
+  return (int64_t) now.tv_sec * NACL_NANOS_PER_UNIT + now.tv_nsec;
+}
+
+int NaClPerfTraceStart(FILE *out) {
+  if (!NaClMutexCtor(&g_trace_mu)) {
+    return 0;
+  }
+  g_trace_out = out;
+  g_trace_start_ns = NaClPerfTraceNowNs();
+  gNaClPerfTraceFirstSyscallPending = 1;
+  gNaClPerfTraceEnabled = 1;
+  return 1;
+}
+
+void NaClPerfTraceInitFromEnv(void) {
+  char const  *path = getenv("NACL_PERF_TRACE");
+  FILE        *out;
+
+  if (NULL == path) {
+    return;
+  }
+  out = NaClPerfOutputOpen(path, "NaClPerfTraceInitFromEnv", "tracing");
+  if (NULL == out) {
+    return;
+  }
+  if (!NaClPerfTraceStart(out)) {
+    NaClLog(LOG_WARNING,
+            "NaClPerfTraceInitFromEnv: NaClMutexCtor failed;"
+            " tracing disabled\n");
+    NaClPerfOutputClose(out);
+    return;
+  }
+  NaClLog(LOG_INFO, "Startup tracing enabled, writing to %s\n", path);
+}
+
+static struct NaClPerfTraceThread *NaClPerfTraceThreadNew(uint32_t tid) {
+  struct NaClPerfTraceThread *thread;
+
+  thread = (struct NaClPerfTraceThread *) calloc(1, sizeof *thread);
+  if (NULL == thread) {
+    return NULL;
+  }
+  if (!NaClMutexCtor(&thread->mu)) {
+    free(thread);
+    return NULL;
+  }
+  thread->tid = tid;
+  NaClXMutexLock(&g_trace_mu);
+  thread->next = g_trace_threads;
+  g_trace_threads = thread;
+  NaClXMutexUnlock(&g_trace_mu);
+  return thread;
+}
+
+#if NACL_PLATFORM_HAS_TLS
+static struct NaClPerfTraceThread *NaClPerfTraceGetThread(void) {
+  if (NULL == g_tls_trace_thread) {
+    g_tls_trace_thread = NaClPerfTraceThreadNew(NaClThreadId());
+  }
+  return g_tls_trace_thread;
+}
+#else
+/*
+ * Without TLS the buffer is looked up by thread id.  A host thread
+ * that reuses the id of one that has exited appends to its buffer,
+ * which is harmless since the two never run at the same time.
+ */
+static struct NaClPerfTraceThread *NaClPerfTraceGetThread(void) {
+  uint32_t                    tid = NaClThreadId();
+  struct NaClPerfTraceThread  *thread;
+
+  NaClXMutexLock(&g_trace_mu);
+  for (thread = g_trace_threads; NULL != thread; thread = thread->next) {
+    if (thread->tid == tid) {
+      break;
+    }
+  }
+  NaClXMutexUnlock(&g_trace_mu);
+  if (NULL == thread) {
+    thread = NaClPerfTraceThreadNew(tid);
+  }
+  return thread;
+}
+#endif
+
+void NaClPerfTraceRecord(char phase, char const *name) {
+  int64_t                     now = NaClPerfTraceNowNs();
+  struct NaClPerfTraceThread  *thread = NaClPerfTraceGetThread();
+  struct NaClPerfTraceChunk   *chunk;
+  struct NaClPerfTraceEvent   *event;
+
+  if (NULL == thread) {
+    return;
+  }
+  NaClXMutexLock(&thread->mu);
+  chunk = thread->last;
+  if (NULL == chunk || NACL_PERF_TRACE_CHUNK_EVENTS == chunk->count) {
+    chunk = (struct NaClPerfTraceChunk *) malloc(sizeof *chunk);
+    if (NULL == chunk) {
+      NaClXMutexUnlock(&thread->mu);
+      return;
+    }
+    chunk->next = NULL;
+    chunk->count = 0;
+    if (NULL == thread->last) {
+      thread->first = chunk;
+    } else {
+      thread->last->next = chunk;
+    }
+    thread->last = chunk;
+  }
+  event = &chunk->events[chunk->count++];
+  event->ns = now;
+  event->name = name;
+  event->phase = phase;
+  NaClXMutexUnlock(&thread->mu);
+}
+
+void NaClPerfTraceFirstSyscallSlow(void) {
+  int first;
+
+  /* Threads may race here; only the one that clears the flag records. */
+  NaClXMutexLock(&g_trace_mu);
+  first = gNaClPerfTraceFirstSyscallPending;
+  gNaClPerfTraceFirstSyscallPending = 0;
+  NaClXMutexUnlock(&g_trace_mu);
+  if (first) {
+    NaClPerfTraceInstant("FirstSyscall");
+  }
+}
+
+char *NaClPerfTraceToJson(void) {
+  struct NaClPerfJson         buf;
+  struct NaClPerfTraceThread  *thread;
+  struct NaClPerfTraceChunk   *chunk;
+  size_t                      i;
+  int                         pid = GETPID();
+  char const                  *sep = "";
+
+  if (!gNaClPerfTraceEnabled) {
+    return NULL;
+  }
+  if (!NaClPerfJsonCtor(&buf)) {
+    return NULL;
+  }
+
+  NaClPerfJsonAppend(&buf, "{\"traceEvents\":[");
+  NaClXMutexLock(&g_trace_mu);
+  for (thread = g_trace_threads; NULL != thread; thread = thread->next) {
+    NaClXMutexLock(&thread->mu);
+    for (chunk = thread->first; NULL != chunk; chunk = chunk->next) {
+      for (i = 0; i < chunk->count; ++i) {
+        struct NaClPerfTraceEvent const *e = &chunk->events[i];
+        int64_t ns = e->ns - g_trace_start_ns;
+
+        /* Timestamps are in microseconds, with nanosecond fractions. */
+        NaClPerfJsonAppend(&buf, "%s\n{\"name\":", sep);
+        NaClPerfJsonAppendString(&buf, e->name);
+        NaClPerfJsonAppend(
+            &buf,
+            ",\"cat\":\"nacl\",\"ph\":\"%c\",\"pid\":%d,\"tid\":%"NACL_PRIu32
+            ",\"ts\":%"NACL_PRId64".%03d%s}",
+            e->phase, pid, thread->tid, ns / 1000, (int) (ns % 1000),
+            NACL_PERF_TRACE_INSTANT == e->phase ? ",\"s\":\"t\"" : "");
+        sep = ",";
+      }
+    }
+    NaClXMutexUnlock(&thread->mu);
+  }
+  NaClXMutexUnlock(&g_trace_mu);
+  NaClPerfJsonAppend(&buf, "\n],\"displayTimeUnit\":\"ns\"}\n");
+  return NaClPerfJsonRelease(&buf);
+}
+
+void NaClPerfTraceWrite(void) {
+  char *json;
+
+  if (!gNaClPerfTraceEnabled || NULL == g_trace_out) {
+    return;
+  }
+  json = NaClPerfTraceToJson();
+  if (NULL == json) {
+    NaClLog(LOG_WARNING, "NaClPerfTraceWrite: out of memory\n");
+    return;
+  }
+  fputs(json, g_trace_out);
+  fflush(g_trace_out);
+  free(json);
+}
@@ -0,0 +1,106 @@
+/*
+ * Copyright (c) 2013 The Native Client Authors. All rights reserved.
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+/*
+ * Opt-in startup tracing.  When the NACL_PERF_TRACE environment
+ * variable names an output file ("-" for stderr), the service runtime
+ * records nested spans (ELF parsing, segment loading, validation, IRT
+ * loading, the start_module RPC, ...) and instant events (the first
+ * syscall) with nanosecond monotonic timestamps, and writes them out
+ * as Chrome trace-event JSON, which chrome://tracing and similar tools
+ * can display, when the main thread exits.
+ *
+ * Each host thread appends to its own buffer, which grows without
+ * bound, so spans may nest arbitrarily deeply.  The cost when tracing
+ * is disabled is one predictable branch per span.
+ *
+ * Unlike NaClPerfCounter, which logs the intervals of one sequence of
+ * marks, trace events are kept until they are exported.
+ */
+
+#ifndef NATIVE_CLIENT_SRC_TRUSTED_PERF_COUNTER_NACL_PERF_TRACE_H_
+#define NATIVE_CLIENT_SRC_TRUSTED_PERF_COUNTER_NACL_PERF_TRACE_H_
+
+#include <stdio.h>
+
+#include "native_client/src/include/nacl_base.h"
+#include "native_client/src/include/nacl_compiler_annotations.h"
+#include "native_client/src/include/portability.h"
+
+EXTERN_C_BEGIN
+
+/* Event phases, as named in the trace-event format. */
+#define NACL_PERF_TRACE_BEGIN    'B'
+#define NACL_PERF_TRACE_END      'E'
+#define NACL_PERF_TRACE_INSTANT  'i'
+
+/* Set once by NaClPerfTraceStart(), before any events are recorded. */
+extern int gNaClPerfTraceEnabled;
+/* Nonzero until the first syscall has been recorded. */
+extern volatile int gNaClPerfTraceFirstSyscallPending;
+
+/*
+ * Starts tracing, with the JSON to be written to out at exit, or to
+ * nowhere if out is NULL.  Must be called after NaClPlatformInit()
+ * and before any other thread records events.  Returns bool-as-int.
+ */
+int NaClPerfTraceStart(FILE *out) NACL_WUR;
+
+/*
+ * Starts tracing if the NACL_PERF_TRACE environment variable is set.
+ * This must be called before the outer sandbox is enabled, since it
+ * opens the output file.
+ */
+void NaClPerfTraceInitFromEnv(void);
+
+/*
+ * Records an event in the calling thread's buffer.  name must be a
+ * string constant, since only the pointer is kept.  Use the inline
+ * wrappers below, which skip the call when tracing is off.
+ */
+void NaClPerfTraceRecord(char phase, char const *name);
+
+void NaClPerfTraceFirstSyscallSlow(void);
+
+static INLINE void NaClPerfTraceBegin(char const *name) {
+  if (NACL_UNLIKELY(gNaClPerfTraceEnabled)) {
+    NaClPerfTraceRecord(NACL_PERF_TRACE_BEGIN, name);
+  }
+}
+
+/* Closes the innermost open span of the calling thread. */
+static INLINE void NaClPerfTraceEnd(char const *name) {
+  if (NACL_UNLIKELY(gNaClPerfTraceEnabled)) {
+    NaClPerfTraceRecord(NACL_PERF_TRACE_END, name);
+  }
+}
+
+static INLINE void NaClPerfTraceInstant(char const *name) {
+  if (NACL_UNLIKELY(gNaClPerfTraceEnabled)) {
+    NaClPerfTraceRecord(NACL_PERF_TRACE_INSTANT, name);
+  }
+}
+
+/* Called on every syscall; records an instant event for the first. */
+static INLINE void NaClPerfTraceFirstSyscall(void) {
+  if (NACL_UNLIKELY(0 != gNaClPerfTraceFirstSyscallPending)) {
+    NaClPerfTraceFirstSyscallSlow();
+  }
+}
+
+/*
+ * Returns the events recorded so far by all threads as a malloc()ed
+ * Chrome trace-event JSON object, or NULL if tracing is off or on
+ * allocation failure.
+ */
+char *NaClPerfTraceToJson(void);
+
+/* Writes the JSON to the output file, if there is one. */
+void NaClPerfTraceWrite(void);
+
+EXTERN_C_END
+
+#endif  /* NATIVE_CLIENT_SRC_TRUSTED_PERF_COUNTER_NACL_PERF_TRACE_H_ */
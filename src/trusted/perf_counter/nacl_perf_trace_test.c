@@ -0,0 +1,116 @@
+/*
+ * Copyright (c) 2013 The Native Client Authors. All rights reserved.
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+/*
+ * Records nested spans from two threads, enough of them to fill
+ * several buffer chunks, and checks the trace-event JSON.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "native_client/src/include/portability.h"
+#include "native_client/src/include/portability_io.h"
+#include "native_client/src/shared/platform/nacl_check.h"
+#include "native_client/src/shared/platform/nacl_threads.h"
+#include "native_client/src/shared/platform/platform_init.h"
+#include "native_client/src/trusted/perf_counter/nacl_perf_trace.h"
+
+#define kIterations 1000
+#define kThreadStackSize (64 << 10)
+
+static void WINAPI TraceThread(void *state) {
+  int i;
+
+  UNREFERENCED_PARAMETER(state);
+  NaClPerfTraceBegin("Outer");
+  for (i = 0; i < kIterations; ++i) {
+    NaClPerfTraceBegin("Inner");
+    NaClPerfTraceEnd("Inner");
+  }
+  NaClPerfTraceEnd("Outer");
+}
+
+static int CountOccurrences(char const *haystack, char const *needle) {
+  int count = 0;
+
+  while (NULL != (haystack = strstr(haystack, needle))) {
+    ++count;
+    ++haystack;
+  }
+  return count;
+}
+
+static int Expect(char const *what, int condition) {
+  if (!condition) {
+    printf("FAILED: %s\n", what);
+    return 1;
+  }
+  return 0;
+}
+
+int main(void) {
+  struct NaClThread thread;
+  char              *json;
+  char              *other;
+  unsigned          tid;
+  char              tid_field[32];
+  int               errors = 0;
+
+  NaClPlatformInit();
+  NaClPerfTraceBegin("BeforeStart");
+  CHECK(NULL == NaClPerfTraceToJson());
+  CHECK(NaClPerfTraceStart(NULL));
+
+  CHECK(NaClThreadCreateJoinable(&thread, TraceThread, NULL,
+                                 kThreadStackSize));
+  TraceThread(NULL);
+  NaClThreadJoin(&thread);
+  NaClPerfTraceFirstSyscall();
+  NaClPerfTraceFirstSyscall();
+  NaClPerfTraceInstant("With \"quotes\"");
+
+  json = NaClPerfTraceToJson();
+  CHECK(NULL != json);
+  errors += Expect("starts with traceEvents",
+                   0 == strncmp(json, "{\"traceEvents\":[", 16));
+  errors += Expect("ends with displayTimeUnit",
+                   NULL != strstr(json, "],\"displayTimeUnit\":\"ns\"}\n"));
+  errors += Expect("events before start are dropped",
+                   NULL == strstr(json, "BeforeStart"));
+  errors += Expect("two outer spans",
+                   4 == CountOccurrences(json, "\"name\":\"Outer\""));
+  errors += Expect("all inner spans",
+                   4 * kIterations ==
+                   CountOccurrences(json, "\"name\":\"Inner\""));
+  errors += Expect("one first syscall",
+                   1 == CountOccurrences(json, "\"name\":\"FirstSyscall\""));
+  errors += Expect("names are escaped",
+                   NULL != strstr(json, "\"name\":\"With \\\"quotes\\\"\""));
+  errors += Expect("instants are thread-scoped",
+                   NULL != strstr(json, "\"ph\":\"i\",") &&
+                   NULL != strstr(json, ",\"s\":\"t\"}"));
+
+  /* The thread of the first Outer span did not record everything. */
+  other = strstr(json, "\"name\":\"Outer\"");
+  CHECK(NULL != other);
+  other = strstr(other, "\"tid\":");
+  CHECK(NULL != other);
+  CHECK(1 == sscanf(other, "\"tid\":%u,", &tid));
+  SNPRINTF(tid_field, sizeof tid_field, "\"tid\":%u,", tid);
+  errors += Expect("each thread has its own tid",
+                   CountOccurrences(json, tid_field) >= 2 * kIterations + 2 &&
+                   CountOccurrences(json, tid_field) <
+                   CountOccurrences(json, "\"tid\":"));
+
+  free(json);
+  NaClPlatformFini();
+  if (0 == errors) {
+    printf("PASSED\n");
+  }
+  return 0 != errors;
+}
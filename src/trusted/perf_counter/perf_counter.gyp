@@ -21,6 +21,11 @@
       'type': 'static_library',
       'sources': [
         'nacl_perf_counter.c',
+        'nacl_perf_events.c',
+        'nacl_perf_json.c',
+        'nacl_perf_output.c',
+        'nacl_perf_symbols.c',
+        'nacl_perf_trace.c',
       ],
     },
   ],
@@ -37,6 +42,11 @@
           },
           'sources': [
             'nacl_perf_counter.c',
+            'nacl_perf_events.c',
+            'nacl_perf_json.c',
+            'nacl_perf_output.c',
+            'nacl_perf_symbols.c',
+            'nacl_perf_trace.c',
           ],
         },
       ],
@@ -168,6 +168,36 @@ static struct sock_filter filter[] = {
   BPF_STMT(BPF_RET + BPF_K, SECCOMP_RET_ALLOW),
 #endif
 
+#ifdef __NR_readv
+  BPF_JUMP(BPF_JMP + BPF_JEQ + BPF_K, __NR_readv, 0, 1),
+  BPF_STMT(BPF_RET + BPF_K, SECCOMP_RET_ALLOW),
+#endif
+
+#ifdef __NR_writev
+  BPF_JUMP(BPF_JMP + BPF_JEQ + BPF_K, __NR_writev, 0, 1),
+  BPF_STMT(BPF_RET + BPF_K, SECCOMP_RET_ALLOW),
+#endif
+
+#ifdef __NR_preadv
+  BPF_JUMP(BPF_JMP + BPF_JEQ + BPF_K, __NR_preadv, 0, 1),
+  BPF_STMT(BPF_RET + BPF_K, SECCOMP_RET_ALLOW),
+#endif
+
+#ifdef __NR_pwritev
+  BPF_JUMP(BPF_JMP + BPF_JEQ + BPF_K, __NR_pwritev, 0, 1),
+  BPF_STMT(BPF_RET + BPF_K, SECCOMP_RET_ALLOW),
+#endif
+
+#ifdef __NR_sendfile
+  BPF_JUMP(BPF_JMP + BPF_JEQ + BPF_K, __NR_sendfile, 0, 1),
+  BPF_STMT(BPF_RET + BPF_K, SECCOMP_RET_ALLOW),
+#endif
+
+#ifdef __NR_sendfile64
+  BPF_JUMP(BPF_JMP + BPF_JEQ + BPF_K, __NR_sendfile64, 0, 1),
+  BPF_STMT(BPF_RET + BPF_K, SECCOMP_RET_ALLOW),
+#endif
+
 #ifdef __NR_modify_ldt
   BPF_JUMP(BPF_JMP + BPF_JEQ + BPF_K, __NR_modify_ldt, 0, 1),
   BPF_STMT(BPF_RET + BPF_K, SECCOMP_RET_ALLOW),
@@ -268,6 +298,19 @@ static struct sock_filter filter[] = {
   BPF_JUMP(BPF_JMP + BPF_JEQ + BPF_K, __NR_sched_getaffinity, 0, 1),
   BPF_STMT(BPF_RET + BPF_K, SECCOMP_RET_ALLOW),
 
+  /*
+   * for the thread_sched_set syscall, which only changes the calling
+   * thread, so pid (args[0]) must be 0.  The kernel truncates pid to
+   * 32 bits, which on x86-64 are the low word loaded here.  This
+   * overwrites the syscall number, so other pids are rejected at once.
+   */
+  BPF_JUMP(BPF_JMP + BPF_JEQ + BPF_K, __NR_sched_setaffinity, 1, 0),
+  BPF_JUMP(BPF_JMP + BPF_JEQ + BPF_K, __NR_sched_setscheduler, 0, 4),
+  BPF_STMT(BPF_LD + BPF_W + BPF_ABS, SyscallArg(0)),
+  BPF_JUMP(BPF_JMP + BPF_JEQ + BPF_K, 0, 0, 1),
+  BPF_STMT(BPF_RET + BPF_K, SECCOMP_RET_ALLOW),
+  BPF_STMT(BPF_RET + BPF_K, SECCOMP_RET_TRAP),
+
   /* for abort(), called as tgkill(pid,tid,SIGABORT) */
   BPF_JUMP(BPF_JMP + BPF_JEQ + BPF_K, __NR_tgkill, 0, 1),
   BPF_STMT(BPF_RET + BPF_K, SECCOMP_RET_ALLOW),
@@ -275,19 +318,51 @@ static struct sock_filter filter[] = {
   /* for abort(), called as rt_sigprocmask(SIG_UNBLOCK, [ABRT], NULL, 8) */
   BPF_JUMP(BPF_JMP + BPF_JEQ + BPF_K, __NR_rt_sigprocmask, 0, 1),
   BPF_STMT(BPF_RET + BPF_K, SECCOMP_RET_ALLOW),
+};
 
+/*
+ * for NACL_PERF_EVENTS, which opens counters as each untrusted thread
+ * starts.  They only ever count the calling thread, so pid (args[1])
+ * must be 0, checked as for sched_setaffinity above.  Only appended
+ * to the filter when profiling is on.  Both a perf_event_open with
+ * another pid and any other syscall fall through to the final
+ * SECCOMP_RET_TRAP.
+ */
+static struct sock_filter perf_event_open_filter[] = {
+#ifdef __NR_perf_event_open
+  BPF_JUMP(BPF_JMP + BPF_JEQ + BPF_K, __NR_perf_event_open, 0, 3),
+  BPF_STMT(BPF_LD + BPF_W + BPF_ABS, SyscallArg(1)),
+  BPF_JUMP(BPF_JMP + BPF_JEQ + BPF_K, 0, 0, 1),
+  BPF_STMT(BPF_RET + BPF_K, SECCOMP_RET_ALLOW),
+#endif
   /* send SIGSYS for other syscalls, not listed above */
   BPF_STMT(BPF_RET + BPF_K, SECCOMP_RET_TRAP),
 };
 
-int NaClInstallBpfFilter(void) {
-  struct sock_fprog prog = {
-    .len = (uint16_t) (sizeof(filter) / sizeof(filter[0])),
-    .filter = filter,
-  };
+#define FILTER_LEN(f) (sizeof(f) / sizeof((f)[0]))
+
+int NaClInstallBpfFilter(int allow_perf_event_open) {
+  struct sock_filter program[FILTER_LEN(filter) +
+                             FILTER_LEN(perf_event_open_filter)];
+  struct sock_fprog prog;
+  size_t len;
+  size_t skip;
   sigset_t mask;
   struct sigaction act;
 
+  /*
+   * Without profiling, only the final SECCOMP_RET_TRAP is kept, which
+   * also serves as the trap for a perf_event_open with another pid.
+   */
+  skip = allow_perf_event_open ? 0 : FILTER_LEN(perf_event_open_filter) - 1;
+  len = FILTER_LEN(filter);
+  memcpy(program, filter, sizeof(filter));
+  memcpy(program + len, perf_event_open_filter + skip,
+         sizeof(perf_event_open_filter) - skip * sizeof(program[0]));
+  len += FILTER_LEN(perf_event_open_filter) - skip;
+  prog.len = (uint16_t) len;
+  prog.filter = program;
+
   /* Unmask SIGSYS */
   if (sigemptyset(&mask) ||
       sigaddset(&mask, SIGSYS)) {
@@ -326,7 +401,8 @@ int NaClInstallBpfFilter(void) {
 
 #else   /* SUPPORTED_ARCH_AND_OS */
 
-int NaClInstallBpfFilter(void) {
+int NaClInstallBpfFilter(int allow_perf_event_open) {
+  UNREFERENCED_PARAMETER(allow_perf_event_open);
   return 1;
 }
 
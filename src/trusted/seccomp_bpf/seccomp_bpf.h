@@ -12,10 +12,11 @@
 EXTERN_C_BEGIN
 
 /*
- * Turns on seccomp-bpf syscall policy.
+ * Turns on seccomp-bpf syscall policy.  perf_event_open on the calling
+ * thread is allowed only if allow_perf_event_open is nonzero.
  * On success, returns 0.
  */
-int NaClInstallBpfFilter(void);
+int NaClInstallBpfFilter(int allow_perf_event_open);
 
 EXTERN_C_END
 
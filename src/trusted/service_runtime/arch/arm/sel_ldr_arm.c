@@ -5,6 +5,7 @@
  */
 
 #include "native_client/src/shared/platform/nacl_check.h"
+#include "native_client/src/trusted/service_runtime/include/bits/nacl_syscalls.h"
 #include "native_client/src/trusted/service_runtime/nacl_globals.h"
 #include "native_client/src/trusted/service_runtime/sel_ldr.h"
 #include "native_client/src/trusted/service_runtime/arch/arm/sel_ldr_arm.h"
@@ -46,9 +47,44 @@ void  NaClPatchOneTrampolineCall(uintptr_t call_target_addr,
   NaClApplyPatchToMemory(&patch_info);
 }
 
+/*
+ * Install a trampoline that returns a TLS value without making a
+ * syscall.  See tramp_arm.S.
+ */
+static void NaClPatchTlsGetTrampoline(uintptr_t  target_addr,
+                                      const char *code,
+                                      const char *code_end) {
+  struct NaClPatchInfo patch_info;
+
+  NaClPatchInfoCtor(&patch_info);
+  patch_info.dst = target_addr;
+  patch_info.src = (uintptr_t) code;
+  patch_info.nbytes = code_end - code;
+  CHECK(patch_info.nbytes <= NACL_INSTR_BLOCK_SIZE);
+
+  NaClApplyPatchToMemory(&patch_info);
+}
+
 void  NaClPatchOneTrampoline(struct NaClApp *nap,
                              uintptr_t      target_addr) {
+#if !defined(NACL_TARGET_ARM_THUMB2_MODE)
+  uintptr_t syscall_num = ((target_addr - nap->mem_start -
+                            NACL_SYSCALL_START_ADDR) /
+                           NACL_SYSCALL_BLOCK_SIZE);
+
+  if (NACL_sys_tls_get == syscall_num) {
+    NaClPatchTlsGetTrampoline(target_addr, &NaCl_tls_get1_code,
+                              &NaCl_tls_get1_end);
+    return;
+  }
+  if (NACL_sys_second_tls_get == syscall_num) {
+    NaClPatchTlsGetTrampoline(target_addr, &NaCl_tls_get2_code,
+                              &NaCl_tls_get2_end);
+    return;
+  }
+#else
   UNREFERENCED_PARAMETER(nap);
+#endif
 
   NaClPatchOneTrampolineCall((uintptr_t) &NaClSyscallSeg, target_addr);
 }
@@ -11,6 +11,11 @@ extern const char NaCl_trampoline_seg_code;
 extern const char NaCl_trampoline_seg_end;
 extern const char NaCl_trampoline_syscall_seg_addr;
 
+extern const char NaCl_tls_get1_code;
+extern const char NaCl_tls_get1_end;
+extern const char NaCl_tls_get2_code;
+extern const char NaCl_tls_get2_end;
+
 extern void NaClSyscallSeg(void);
 extern void NaClSyscallSegRegsSaved(void);
 extern void NaClSyscallSegEnd(void);
@@ -1003,3 +1003,152 @@ void NaClElfImageDelete(struct NaClElfImage *image) {
 uintptr_t NaClElfImageGetEntryPoint(struct NaClElfImage *image) {
   return image->ehdr.e_entry;
 }
+
+
+uintptr_t NaClElfImageGetLoadAddress(struct NaClElfImage *image) {
+  int segnum;
+  int found = 0;
+  Elf_Addr load_addr = 0;
+
+  for (segnum = 0; segnum < image->ehdr.e_phnum; ++segnum) {
+    const Elf_Phdr *php = &image->phdrs[segnum];
+
+    if (PT_LOAD == php->p_type && (!found || php->p_vaddr < load_addr)) {
+      load_addr = php->p_vaddr;
+      found = 1;
+    }
+  }
+  return load_addr;
+}
+
+
+/*
+ * Symbol tables are only read for profiling, so give up on any that
+ * are implausibly large rather than allocate without bound.
+ */
+#define NACL_ELF_MAX_SYMBOL_TABLE_BYTES (64 << 20)
+
+/* Returns a malloc()ed copy of size bytes at offset, or NULL. */
+static void *NaClElfReadAlloc(struct NaClDesc *ndp,
+                              uint64_t        offset,
+                              uint64_t        size) {
+  void    *buf;
+  ssize_t read_ret;
+
+  if (0 == size || size > NACL_ELF_MAX_SYMBOL_TABLE_BYTES) {
+    return NULL;
+  }
+  /* One more byte, so that string tables can be terminated. */
+  buf = malloc((size_t) size + 1);
+  if (NULL == buf) {
+    return NULL;
+  }
+  read_ret = (*NACL_VTBL(NaClDesc, ndp)->PRead)(ndp, buf, (size_t) size,
+                                                (nacl_off64_t) offset);
+  if (NaClSSizeIsNegErrno(&read_ret) || (size_t) read_ret != size) {
+    free(buf);
+    return NULL;
+  }
+  ((char *) buf)[size] = '\0';
+  return buf;
+}
+
+/* Fetches section header i in the 64-bit form. */
+static void NaClElfGetShdr(uint8_t const *shdrs, int is_64, Elf_Half i,
+                           Elf64_Shdr *shdr) {
+  if (is_64) {
+    memcpy(shdr, shdrs + i * sizeof(Elf64_Shdr), sizeof *shdr);
+  } else {
+    Elf32_Shdr shdr32;
+
+    memcpy(&shdr32, shdrs + i * sizeof shdr32, sizeof shdr32);
+    shdr->sh_type = shdr32.sh_type;
+    shdr->sh_offset = shdr32.sh_offset;
+    shdr->sh_size = shdr32.sh_size;
+    shdr->sh_link = shdr32.sh_link;
+  }
+}
+
+int NaClElfImageForEachFunctionSymbol(
+    struct NaClElfImage *image,
+    struct NaClDesc *ndp,
+    void (*fn)(void *state, uint32_t addr, uint32_t size, char const *name),
+    void *state) {
+  /*
+   * ELFCLASS64 headers were converted to ELFCLASS32 form when they
+   * were read, but e_shentsize still tells the two apart.
+   */
+  int       is_64 = image->ehdr.e_shentsize == sizeof(Elf64_Shdr);
+  size_t    shentsize = is_64 ? sizeof(Elf64_Shdr) : sizeof(Elf32_Shdr);
+  size_t    symentsize = is_64 ? sizeof(Elf64_Sym) : sizeof(Elf32_Sym);
+  uint8_t   *shdrs = NULL;
+  uint8_t   *syms = NULL;
+  char      *strtab = NULL;
+  Elf64_Shdr symtab_shdr;
+  Elf64_Shdr strtab_shdr;
+  Elf_Half  i;
+  uint64_t  j;
+  int       rv = 0;
+
+  if (0 == image->ehdr.e_shoff || 0 == image->ehdr.e_shnum ||
+      image->ehdr.e_shentsize != shentsize) {
+    goto done;
+  }
+  shdrs = (uint8_t *) NaClElfReadAlloc(ndp, image->ehdr.e_shoff,
+                                       (uint64_t) image->ehdr.e_shnum *
+                                       shentsize);
+  if (NULL == shdrs) {
+    goto done;
+  }
+  for (i = 0; i < image->ehdr.e_shnum; ++i) {
+    NaClElfGetShdr(shdrs, is_64, i, &symtab_shdr);
+    if (SHT_SYMTAB == symtab_shdr.sh_type) {
+      break;
+    }
+  }
+  if (i == image->ehdr.e_shnum ||
+      symtab_shdr.sh_link >= image->ehdr.e_shnum) {
+    NaClLog(3, "NaClElfImageForEachFunctionSymbol: no symbol table\n");
+    goto done;
+  }
+  NaClElfGetShdr(shdrs, is_64, (Elf_Half) symtab_shdr.sh_link, &strtab_shdr);
+  if (SHT_STRTAB != strtab_shdr.sh_type) {
+    goto done;
+  }
+  syms = (uint8_t *) NaClElfReadAlloc(ndp, symtab_shdr.sh_offset,
+                                      symtab_shdr.sh_size);
+  strtab = (char *) NaClElfReadAlloc(ndp, strtab_shdr.sh_offset,
+                                     strtab_shdr.sh_size);
+  if (NULL == syms || NULL == strtab) {
+    goto done;
+  }
+  for (j = 0; j + symentsize <= symtab_shdr.sh_size; j += symentsize) {
+    Elf64_Sym sym;
+
+    if (is_64) {
+      memcpy(&sym, syms + j, sizeof sym);
+    } else {
+      Elf32_Sym sym32;
+
+      memcpy(&sym32, syms + j, sizeof sym32);
+      sym.st_name = sym32.st_name;
+      sym.st_info = sym32.st_info;
+      sym.st_value = sym32.st_value;
+      sym.st_size = sym32.st_size;
+    }
+    if (STT_FUNC != ELF64_ST_TYPE(sym.st_info) || 0 == sym.st_value ||
+        sym.st_value > 0xffffffffU || sym.st_name >= strtab_shdr.sh_size) {
+      continue;
+    }
+    (*fn)(state, (uint32_t) sym.st_value,
+          (uint32_t) (sym.st_size > 0xffffffffU ? 0 : sym.st_size),
+          strtab + sym.st_name);
+  }
+  rv = 1;
+
+ done:
+  free(strtab);
+  free(syms);
+  free(shdrs);
+  return rv;
+}
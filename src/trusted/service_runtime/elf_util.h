@@ -17,6 +17,12 @@ struct Gio;
 
 uintptr_t NaClElfImageGetEntryPoint(struct NaClElfImage *image);
 
+/*
+ * Returns the lowest address of the image's PT_LOAD segments, or 0 if
+ * it has none.
+ */
+uintptr_t NaClElfImageGetLoadAddress(struct NaClElfImage *image);
+
 struct NaClElfImage *NaClElfImageNew(struct NaClDesc *gp,
                                      NaClErrorCode *err_code);
 
@@ -55,5 +61,17 @@ NaClErrorCode NaClElfImageLoadDynamically(
 
 void NaClElfImageDelete(struct NaClElfImage *image);
 
+/*
+ * Calls fn for each function symbol in the image's symbol table, with
+ * its address, size (0 if unknown) and name, which is only valid
+ * during the call.  Returns 0 if the image has no symbol table or it
+ * could not be read, which is not an error: nexes may be stripped.
+ */
+int NaClElfImageForEachFunctionSymbol(
+    struct NaClElfImage *image,
+    struct NaClDesc *ndp,
+    void (*fn)(void *state, uint32_t addr, uint32_t size, char const *name),
+    void *state);
+
 
 #endif  /* NATIVE_CLIENT_SRC_TRUSTED_SERVICE_RUNTIME_ELF_UTIL_H__ */
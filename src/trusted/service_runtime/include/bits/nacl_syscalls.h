@@ -115,7 +115,15 @@
 
 #define NACL_sys_pread                  130
 #define NACL_sys_pwrite                 131
-
-#define NACL_MAX_SYSCALLS               132
+#define NACL_sys_readv                  132
+#define NACL_sys_writev                 133
+#define NACL_sys_preadv                 134
+#define NACL_sys_pwritev                135
+#define NACL_sys_sendfile               136
+#define NACL_sys_thread_sched_set       137
+#define NACL_sys_syscall_ring_register  138
+#define NACL_sys_syscall_ring_enter     139
+
+#define NACL_MAX_SYSCALLS               140
 
 #endif
@@ -15,4 +15,19 @@
 #define NICE_NORMAL     0
 #define NICE_BACKGROUND 5
 
+/*
+ * Scheduling policies for the thread_sched_set system call.  The
+ * values match Linux's SCHED_* constants.
+ */
+#define NACL_ABI_SCHED_OTHER  0
+#define NACL_ABI_SCHED_FIFO   1
+#define NACL_ABI_SCHED_RR     2
+#define NACL_ABI_SCHED_BATCH  3
+#define NACL_ABI_SCHED_IDLE   5
+/* Leaves the thread's policy and priority unchanged. */
+#define NACL_ABI_SCHED_KEEP   -1
+
+/* CPU masks passed to thread_sched_set cover at most this many CPUs. */
+#define NACL_ABI_SCHED_MAX_CPUS 64
+
 #endif
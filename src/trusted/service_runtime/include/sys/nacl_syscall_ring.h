@@ -0,0 +1,71 @@
+/*
+ * Copyright (c) 2013 The Native Client Authors. All rights reserved.
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+/*
+ * NaCl Service Runtime API.  Layout of the syscall ring.
+ *
+ * A thread may register a submission queue and a completion queue,
+ * both in untrusted memory, with the syscall_ring_register syscall.
+ * It then queues requests by filling in submission entries and
+ * advancing sq.tail, and has them run with one syscall_ring_enter
+ * syscall.  The service runtime consumes entries from sq.head,
+ * calling the same handlers that the individual syscalls do, and
+ * posts one completion entry per request at cq.tail.  Untrusted code
+ * advances cq.head as it consumes completions.
+ *
+ * Each queue is a NaClAbiSyscallRingHeader followed by an array of
+ * entries.  The number of entries is a power of two, and head and tail
+ * are free-running counters that are reduced modulo the number of
+ * entries to index the array.  Requests are run in order on the
+ * calling thread, and syscall_ring_enter stops early if the completion
+ * queue fills up.
+ *
+ * The 64-bit fields are naturally aligned so that the layout is the
+ * same for trusted and untrusted code on all architectures.
+ */
+
+#ifndef NATIVE_CLIENT_SRC_TRUSTED_SERVICE_RUNTIME_INCLUDE_SYS_NACL_SYSCALL_RING_H_
+#define NATIVE_CLIENT_SRC_TRUSTED_SERVICE_RUNTIME_INCLUDE_SYS_NACL_SYSCALL_RING_H_
+
+#if defined(__native_client__)
+# include <stdint.h>
+#else
+# include "native_client/src/include/portability.h"
+#endif
+
+#define NACL_ABI_SYSCALL_RING_MAX_ENTRIES 4096
+
+/* Opcodes for NaClAbiSyscallRingSqe::opcode. */
+#define NACL_ABI_SYSCALL_RING_NOP         0
+#define NACL_ABI_SYSCALL_RING_READ        1  /* read(d, addr, count) */
+#define NACL_ABI_SYSCALL_RING_WRITE       2  /* write(d, addr, count) */
+#define NACL_ABI_SYSCALL_RING_PREAD       3  /* pread(d, addr, count, offset) */
+#define NACL_ABI_SYSCALL_RING_PWRITE      4  /* pwrite(d, addr, count, offset) */
+#define NACL_ABI_SYSCALL_RING_FUTEX_WAKE  5  /* futex_wake(addr, count) */
+
+struct NaClAbiSyscallRingHeader {
+  uint32_t head;
+  uint32_t tail;
+};
+
+struct NaClAbiSyscallRingSqe {
+  uint32_t opcode;
+  int32_t  d;
+  uint32_t addr;
+  uint32_t count;
+  int64_t  offset;
+  /* Copied to the completion entry, to match it with its request. */
+  uint64_t user_data;
+};
+
+struct NaClAbiSyscallRingCqe {
+  uint64_t user_data;
+  /* The request's syscall result, a negated errno value on failure. */
+  int32_t  result;
+  uint32_t reserved;
+};
+
+#endif  /* NATIVE_CLIENT_SRC_TRUSTED_SERVICE_RUNTIME_INCLUDE_SYS_NACL_SYSCALL_RING_H_ */
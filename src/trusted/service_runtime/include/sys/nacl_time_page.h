@@ -0,0 +1,65 @@
+/*
+ * Copyright (c) 2013 The Native Client Authors. All rights reserved.
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+/*
+ * NaCl Service Runtime API.  Layout of the time page.
+ *
+ * The service runtime maps a read-only page into untrusted address
+ * space and passes its address in the auxiliary vector under
+ * AT_NACL_TIME_PAGE.  When NACL_TIME_PAGE_TSC_VALID is set, untrusted
+ * code may compute CLOCK_REALTIME and CLOCK_MONOTONIC from the time
+ * stamp counter without making a syscall:
+ *
+ *   delta = rdtsc() - tsc_base;   (if delta > tsc_max_delta, use the syscall)
+ *   ns = {realtime,monotonic}_ns + ((delta * tsc_mult) >> tsc_shift);
+ *
+ * The fields are protected by a sequence lock: seq is odd while the
+ * service runtime is updating the page, and changes whenever it does,
+ * so readers must read seq before and after the other fields and
+ * retry (or make the syscall) if the two values differ or are odd.
+ *
+ * The page is only refreshed by the clock_gettime and gettimeofday
+ * syscalls, which readers fall back to once tsc_max_delta has passed.
+ * The syscalls compute their results from the page as well, so
+ * CLOCK_MONOTONIC does not go backwards when switching between the
+ * two.
+ *
+ * The 64-bit fields are naturally aligned so that the layout is the
+ * same for trusted and untrusted code on all architectures.
+ */
+
+#ifndef NATIVE_CLIENT_SRC_TRUSTED_SERVICE_RUNTIME_INCLUDE_SYS_NACL_TIME_PAGE_H_
+#define NATIVE_CLIENT_SRC_TRUSTED_SERVICE_RUNTIME_INCLUDE_SYS_NACL_TIME_PAGE_H_
+
+#if defined(__native_client__)
+# include <stdint.h>
+#else
+# include "native_client/src/include/portability.h"
+#endif
+
+#define NACL_TIME_PAGE_VERSION        1
+
+/* The tsc_* fields are calibrated and may be used. */
+#define NACL_TIME_PAGE_TSC_VALID      0x1
+/*
+ * gettimeofday results need not be coarsened to 10 microseconds, as
+ * the syscall would otherwise do.
+ */
+#define NACL_TIME_PAGE_HIGH_RES_TOD   0x2
+
+struct NaClTimePage {
+  uint32_t version;
+  uint32_t seq;
+  uint32_t flags;
+  uint32_t tsc_shift;
+  uint64_t tsc_base;
+  uint64_t tsc_mult;
+  uint64_t tsc_max_delta;
+  int64_t  monotonic_ns;
+  int64_t  realtime_ns;
+};
+
+#endif /* NATIVE_CLIENT_SRC_TRUSTED_SERVICE_RUNTIME_INCLUDE_SYS_NACL_TIME_PAGE_H_ */
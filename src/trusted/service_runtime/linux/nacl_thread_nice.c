@@ -13,8 +13,12 @@
 #include <string.h>
 #include <sys/resource.h>
 
+#include "native_client/src/shared/platform/nacl_host_desc.h"
 #include "native_client/src/shared/platform/nacl_log.h"
+#include "native_client/src/trusted/service_runtime/include/sys/errno.h"
 #include "native_client/src/trusted/service_runtime/include/sys/nacl_nice.h"
+#include "native_client/src/trusted/service_runtime/nacl_thread_nice.h"
+#include "native_client/src/trusted/service_runtime/nacl_thread_sched.h"
 
 static void handle_warning_en(const int en, const char *s) {
   char errs[256];
@@ -66,3 +70,66 @@ int nacl_thread_nice(int nacl_nice) {
   }
   return -1;
 }
+
+uint64_t NaClThreadSchedHostCpus(void) {
+  cpu_set_t set;
+  uint64_t  mask = 0;
+  int       cpu;
+
+  if (0 != sched_getaffinity(0, sizeof set, &set)) {
+    handle_warning_en(errno, "sched_getaffinity");
+    return 0;
+  }
+  for (cpu = 0; cpu < NACL_ABI_SCHED_MAX_CPUS; ++cpu) {
+    if (CPU_ISSET(cpu, &set)) {
+      mask |= (uint64_t) 1 << cpu;
+    }
+  }
+  return mask;
+}
+
+static int HostSchedPolicy(int nacl_policy) {
+  switch (nacl_policy) {
+    case NACL_ABI_SCHED_FIFO:
+      return SCHED_FIFO;
+    case NACL_ABI_SCHED_RR:
+      return SCHED_RR;
+    case NACL_ABI_SCHED_BATCH:
+      return SCHED_BATCH;
+    case NACL_ABI_SCHED_IDLE:
+      return SCHED_IDLE;
+    default:
+      return SCHED_OTHER;
+  }
+}
+
+/*
+ * Both calls affect only the calling thread when given a pid of 0.
+ * The policy is set first because it is the call that is liable to
+ * fail, for want of privileges.
+ */
+int NaClThreadSchedSetSelf(struct NaClThreadSched const *sched) {
+  struct sched_param  param;
+  cpu_set_t           set;
+  int                 cpu;
+
+  if (NACL_ABI_SCHED_KEEP != sched->policy) {
+    memset(&param, 0, sizeof param);
+    param.sched_priority = sched->priority;
+    if (0 != sched_setscheduler(0, HostSchedPolicy(sched->policy), &param)) {
+      return -NaClXlateErrno(errno);
+    }
+  }
+  if (0 != sched->cpu_mask) {
+    CPU_ZERO(&set);
+    for (cpu = 0; cpu < NACL_ABI_SCHED_MAX_CPUS; ++cpu) {
+      if (0 != (sched->cpu_mask & ((uint64_t) 1 << cpu))) {
+        CPU_SET(cpu, &set);
+      }
+    }
+    if (0 != sched_setaffinity(0, sizeof set, &set)) {
+      return -NaClXlateErrno(errno);
+    }
+  }
+  return 0;
+}
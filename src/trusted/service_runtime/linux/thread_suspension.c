@@ -109,6 +109,14 @@ static void HandleSuspendSignal(struct NaClSignalContext *regs) {
    */
   natp->suspend_state |= NACL_APP_THREAD_SUSPENDED;
   FutexWake(&natp->suspend_state, 1);
+  /*
+   * Every sender of NACL_THREAD_SUSPEND_SIGNAL counts it in
+   * suspend_pending_count, so tell NaClUntrustedThreadsSuspendAll()
+   * when the last outstanding signal has been handled.
+   */
+  if (AtomicIncrement(&natp->nap->suspend_pending_count, -1) == 0) {
+    FutexWake(&natp->nap->suspend_pending_count, 1);
+  }
 
   /* Wait until we are asked to resume. */
   while (1) {
@@ -218,8 +226,14 @@ static void WaitForUntrustedThreadToSuspend(struct NaClAppThread *natp) {
   }
 }
 
-void NaClUntrustedThreadSuspend(struct NaClAppThread *natp,
-                                int save_registers) {
+/*
+ * Marks the thread as NACL_APP_THREAD_SUSPENDING and, if it is running
+ * untrusted code, sends it the suspension signal.  Returns whether a
+ * signal was sent, in which case the caller must wait for the thread
+ * to suspend before using its state.
+ */
+static int SignalUntrustedThreadToSuspend(struct NaClAppThread *natp,
+                                          int save_registers) {
   Atomic32 old_state;
   Atomic32 suspending_state;
 
@@ -245,27 +259,77 @@ void NaClUntrustedThreadSuspend(struct NaClAppThread *natp,
    */
   DCHECK(natp->suspend_state == suspending_state);
 
-  if (old_state == NACL_APP_THREAD_UNTRUSTED) {
-    /*
-     * Allocate register state struct if needed.  This is race-free
-     * when we are called by NaClUntrustedThreadsSuspendAll(), since
-     * that claims nap->threads_mu.
-     */
-    if (save_registers && natp->suspended_registers == NULL) {
-      natp->suspended_registers = malloc(sizeof(*natp->suspended_registers));
-      if (natp->suspended_registers == NULL) {
-        NaClLog(LOG_FATAL, "NaClUntrustedThreadSuspend: malloc() failed\n");
-      }
-    }
-    CHECK(natp->host_thread_is_defined);
-    if (pthread_kill(natp->host_thread.tid, NACL_THREAD_SUSPEND_SIGNAL) != 0) {
-      NaClLog(LOG_FATAL, "NaClUntrustedThreadSuspend: "
-              "pthread_kill() call failed\n");
+  if (old_state != NACL_APP_THREAD_UNTRUSTED) {
+    return 0;
+  }
+  /*
+   * Allocate register state struct if needed.  This is race-free
+   * when we are called by NaClUntrustedThreadsSuspendAll(), since
+   * that claims nap->threads_mu.
+   */
+  if (save_registers && natp->suspended_registers == NULL) {
+    natp->suspended_registers = malloc(sizeof(*natp->suspended_registers));
+    if (natp->suspended_registers == NULL) {
+      NaClLog(LOG_FATAL, "NaClUntrustedThreadSuspend: malloc() failed\n");
     }
+  }
+  CHECK(natp->host_thread_is_defined);
+  AtomicIncrement(&natp->nap->suspend_pending_count, 1);
+  if (pthread_kill(natp->host_thread.tid, NACL_THREAD_SUSPEND_SIGNAL) != 0) {
+    NaClLog(LOG_FATAL, "NaClUntrustedThreadSuspend: "
+            "pthread_kill() call failed\n");
+  }
+  return 1;
+}
+
+void NaClUntrustedThreadSuspend(struct NaClAppThread *natp,
+                                int save_registers) {
+  if (SignalUntrustedThreadToSuspend(natp, save_registers)) {
     WaitForUntrustedThreadToSuspend(natp);
   }
 }
 
+void NaClUntrustedThreadsSuspendAllInternal(struct NaClApp *nap,
+                                            int save_registers) {
+  size_t index;
+  Atomic32 pending;
+
+  /*
+   * Signal every thread before waiting for any of them, so that the
+   * threads take their signals concurrently and the total pause is
+   * roughly that of suspending one thread rather than growing
+   * linearly with the number of threads.
+   */
+  for (index = 0; index < nap->threads.num_entries; index++) {
+    struct NaClAppThread *natp = NaClGetThreadMu(nap, (int) index);
+    if (natp != NULL) {
+      SignalUntrustedThreadToSuspend(natp, save_registers);
+    }
+  }
+
+  /*
+   * Wait until every signal has been handled.  The count may include
+   * signals sent by a concurrent NaClUntrustedThreadSuspend() call,
+   * which only makes this wait longer than strictly necessary.
+   */
+  while ((pending = nap->suspend_pending_count) != 0) {
+    FutexWait(&nap->suspend_pending_count, pending);
+  }
+
+  /*
+   * Signalled threads have NACL_APP_THREAD_UNTRUSTED set and should
+   * all have reached NACL_APP_THREAD_SUSPENDED by now, so this only
+   * checks their states.
+   */
+  for (index = 0; index < nap->threads.num_entries; index++) {
+    struct NaClAppThread *natp = NaClGetThreadMu(nap, (int) index);
+    if (natp != NULL &&
+        (natp->suspend_state & NACL_APP_THREAD_UNTRUSTED) != 0) {
+      WaitForUntrustedThreadToSuspend(natp);
+    }
+  }
+}
+
 void NaClUntrustedThreadResume(struct NaClAppThread *natp) {
   Atomic32 old_state;
   Atomic32 new_state;
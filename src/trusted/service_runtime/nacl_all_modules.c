@@ -11,6 +11,7 @@
 #include "native_client/src/trusted/debug_stub/debug_stub.h"
 #include "native_client/src/trusted/desc/nrd_all_modules.h"
 #include "native_client/src/trusted/fault_injection/fault_injection.h"
+#include "native_client/src/trusted/perf_counter/nacl_perf_trace.h"
 #include "native_client/src/trusted/service_runtime/nacl_globals.h"
 #include "native_client/src/trusted/service_runtime/nacl_syscall_handlers.h"
 #include "native_client/src/trusted/service_runtime/nacl_thread_nice.h"
@@ -19,6 +20,7 @@
 
 void  NaClAllModulesInit(void) {
   NaClNrdAllModulesInit();
+  NaClPerfTraceInitFromEnv();
   NaClFaultInjectionModuleInit();
   NaClGlobalModuleInit();  /* various global variables */
   NaClSrpcModuleInit();
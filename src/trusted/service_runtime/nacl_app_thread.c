@@ -15,6 +15,7 @@
 #include "native_client/src/shared/platform/nacl_exit.h"
 #include "native_client/src/shared/platform/nacl_sync_checked.h"
 
+#include "native_client/src/trusted/perf_counter/nacl_perf_events.h"
 #include "native_client/src/trusted/service_runtime/arch/sel_ldr_arch.h"
 #include "native_client/src/trusted/service_runtime/nacl_desc_effector_ldr.h"
 #include "native_client/src/trusted/service_runtime/nacl_globals.h"
@@ -22,15 +23,13 @@
 #include "native_client/src/trusted/service_runtime/nacl_switch_to_app.h"
 #include "native_client/src/trusted/service_runtime/nacl_stack_safety.h"
 #include "native_client/src/trusted/service_runtime/nacl_syscall_common.h"
+#include "native_client/src/trusted/service_runtime/nacl_syscall_profile.h"
+#include "native_client/src/trusted/service_runtime/nacl_thread_sched.h"
 #include "native_client/src/trusted/service_runtime/osx/mach_thread_map.h"
 
 
-void WINAPI NaClAppThreadLauncher(void *state) {
-  struct NaClAppThread *natp = (struct NaClAppThread *) state;
+static NORETURN void NaClAppThreadRun(struct NaClAppThread *natp) {
   uint32_t thread_idx;
-  NaClLog(4, "NaClAppThreadLauncher: entered\n");
-
-  NaClSignalStackRegister(natp->signal_stack);
 
   NaClLog(4, "      natp = 0x%016"NACL_PRIxPTR"\n", (uintptr_t) natp);
   NaClLog(4, " prog_ctr  = 0x%016"NACL_PRIxNACL_REG"\n", natp->user.prog_ctr);
@@ -41,7 +40,14 @@ void WINAPI NaClAppThreadLauncher(void *state) {
   CHECK(0 < thread_idx);
   CHECK(thread_idx < NACL_THREAD_MAX);
   NaClTlsSetCurrentThread(natp);
+
+  /* The counters count the calling thread, so they are opened here. */
+  if (NULL != natp->nap->perf_events) {
+    natp->perf_events = NaClPerfEventsThreadStart(natp->nap->perf_events);
+  }
   nacl_user[thread_idx] = &natp->user;
+
+  NaClThreadSchedApplyInitial(natp);
 #if NACL_WINDOWS
   nacl_thread_ids[thread_idx] = GetCurrentThreadId();
 #elif NACL_OSX
@@ -79,6 +85,123 @@ void WINAPI NaClAppThreadLauncher(void *state) {
   NaClStartThreadInApp(natp, natp->user.prog_ctr);
 }
 
+#if NACL_APP_THREAD_POOL_MAX > 0
+/*
+ * Parks the calling thread, which has exited, in its app's thread
+ * pool and waits for NaClAppThreadPoolReuse() to hand it a new
+ * untrusted thread.  Returns 0 without parking if the pool is full.
+ *
+ * Parked threads do not hold a thread index, so the TLS entry is
+ * freed here and allocated again when the thread is reused.
+ */
+static int NaClAppThreadPoolPark(struct NaClAppThread *natp) {
+  struct NaClApp *nap = natp->nap;
+
+  if (natp->sched_changed) {
+    return 0;
+  }
+  NaClXMutexLock(&nap->thread_pool_mu);
+  if (nap->thread_pool_size >= NACL_APP_THREAD_POOL_MAX) {
+    NaClXMutexUnlock(&nap->thread_pool_mu);
+    return 0;
+  }
+  NaClTlsFree(natp);
+  natp->pool_wakeup = 0;
+  natp->pool_next = nap->thread_pool_head;
+  nap->thread_pool_head = natp;
+  nap->thread_pool_size++;
+  NaClLog(3, "NaClAppThreadPoolPark: parked 0x%08"NACL_PRIxPTR"\n",
+          (uintptr_t) natp);
+  while (!natp->pool_wakeup) {
+    NaClXCondVarWait(&natp->pool_cv, &nap->thread_pool_mu);
+  }
+  NaClXMutexUnlock(&nap->thread_pool_mu);
+  return 1;
+}
+
+static void NaClAppThreadPoolPush(struct NaClApp        *nap,
+                                  struct NaClAppThread  *natp) {
+  NaClXMutexLock(&nap->thread_pool_mu);
+  natp->pool_next = nap->thread_pool_head;
+  nap->thread_pool_head = natp;
+  nap->thread_pool_size++;
+  NaClXMutexUnlock(&nap->thread_pool_mu);
+}
+
+/*
+ * Starts a new untrusted thread on a parked host thread, if there is
+ * one.  Only the register and TLS state needs to be set up; the
+ * NaClAppThread's locks and signal stack are kept from its last use.
+ */
+static int NaClAppThreadPoolReuse(struct NaClApp *nap,
+                                  uintptr_t      usr_entry,
+                                  uintptr_t      usr_stack_ptr,
+                                  uint32_t       user_tls1,
+                                  uint32_t       user_tls2) {
+  struct NaClAppThread *natp;
+
+  NaClXMutexLock(&nap->thread_pool_mu);
+  natp = nap->thread_pool_head;
+  if (NULL != natp) {
+    nap->thread_pool_head = natp->pool_next;
+    nap->thread_pool_size--;
+  }
+  NaClXMutexUnlock(&nap->thread_pool_mu);
+  if (NULL == natp) {
+    return 0;
+  }
+
+  natp->thread_num = -1;  /* illegal index */
+  if (!NaClAppThreadInitArchSpecific(natp, usr_entry, usr_stack_ptr)) {
+    NaClAppThreadPoolPush(nap, natp);
+    return 0;
+  }
+  NaClTlsSetTlsValue1(natp, user_tls1);
+  NaClTlsSetTlsValue2(natp, user_tls2);
+  natp->exception_stack = 0;
+  natp->exception_flag = 0;
+  natp->fault_signal = 0;
+  natp->dynamic_delete_generation = 0;
+  natp->syscall_ring_entries = 0;
+  CHECK(natp->suspend_state == NACL_APP_THREAD_TRUSTED);
+
+  NaClXMutexLock(&nap->thread_pool_mu);
+  natp->pool_wakeup = 1;
+  NaClXCondVarSignal(&natp->pool_cv);
+  NaClXMutexUnlock(&nap->thread_pool_mu);
+  return 1;
+}
+#endif
+
+void WINAPI NaClAppThreadLauncher(void *state) {
+  struct NaClAppThread *natp = (struct NaClAppThread *) state;
+  NaClLog(4, "NaClAppThreadLauncher: entered\n");
+
+  NaClSignalStackRegister(natp->signal_stack);
+
+#if NACL_APP_THREAD_POOL_MAX > 0
+  if (setjmp(natp->pool_jmp_buf) != 0) {
+    /*
+     * NaClAppThreadTeardown() jumped back here after the untrusted
+     * thread exited.
+     */
+    if (!NaClAppThreadPoolPark(natp)) {
+      NaClLog(3, " unregistering signal stack\n");
+      NaClSignalStackUnregister();
+      NaClLog(3, " freeing thread object\n");
+      NaClAppThreadDelete(natp);
+      NaClLog(3, " NaClThreadExit\n");
+      NaClThreadExit();
+      NaClLog(LOG_FATAL,
+              "NaClAppThreadLauncher: NaClThreadExit() should not return\n");
+    }
+    NaClLog(4, "NaClAppThreadLauncher: reusing parked thread\n");
+  }
+#endif
+
+  NaClAppThreadRun(natp);
+}
+
 
 /*
  * natp should be thread_self(), called while holding no locks.
@@ -105,6 +228,9 @@ void NaClAppThreadTeardown(struct NaClAppThread *natp) {
     nap->debug_stub_callbacks->thread_exit_hook(natp);
   }
 
+  NaClPerfEventsThreadStop(natp->perf_events);
+  natp->perf_events = NULL;
+
   NaClLog(3, " getting thread table lock\n");
   NaClXMutexLock(&nap->threads_mu);
   NaClLog(3, " getting thread lock\n");
@@ -138,10 +264,20 @@ void NaClAppThreadTeardown(struct NaClAppThread *natp) {
   NaClLog(3, " removing thread from thread table\n");
   /* Deallocate the ID natp->thread_num. */
   NaClRemoveThreadMu(nap, natp->thread_num);
+  NaClSyscallProfileRetireThreadMu(natp);
   NaClLog(3, " unlocking thread\n");
   NaClXMutexUnlock(&natp->mu);
   NaClLog(3, " unlocking thread table\n");
   NaClXMutexUnlock(&nap->threads_mu);
+#if NACL_APP_THREAD_POOL_MAX > 0
+  if (natp->host_thread_is_defined) {
+    /*
+     * Let NaClAppThreadLauncher() park or free the thread once it is
+     * back at the top of the host thread's stack.
+     */
+    longjmp(natp->pool_jmp_buf, 1);
+  }
+#endif
   NaClLog(3, " unregistering signal stack\n");
   NaClSignalStackUnregister();
   NaClLog(3, " freeing thread object\n");
@@ -205,12 +341,33 @@ struct NaClAppThread *NaClAppThreadMake(struct NaClApp *nap,
   natp->fault_signal = 0;
 
   natp->dynamic_delete_generation = 0;
+  natp->sched_changed = 0;
+  natp->syscall_ring_entries = 0;
 
   if (!NaClCondVarCtor(&natp->futex_condvar)) {
     goto cleanup_suspend_mu;
   }
+
+  natp->pool_next = NULL;
+  natp->pool_wakeup = 0;
+  if (!NaClCondVarCtor(&natp->pool_cv)) {
+    goto cleanup_futex_condvar;
+  }
+
+  natp->perf_events = NULL;
+  natp->syscall_profile = NULL;
+  if (NULL != nap->syscall_profile) {
+    natp->syscall_profile = NaClSyscallProfileThreadCreate();
+    if (NULL == natp->syscall_profile) {
+      goto cleanup_pool_cv;
+    }
+  }
   return natp;
 
+ cleanup_pool_cv:
+  NaClCondVarDtor(&natp->pool_cv);
+ cleanup_futex_condvar:
+  NaClCondVarDtor(&natp->futex_condvar);
  cleanup_suspend_mu:
   NaClMutexDtor(&natp->suspend_mu);
  cleanup_mu:
@@ -230,8 +387,16 @@ int NaClAppThreadSpawn(struct NaClApp *nap,
                        uintptr_t      usr_stack_ptr,
                        uint32_t       user_tls1,
                        uint32_t       user_tls2) {
-  struct NaClAppThread *natp = NaClAppThreadMake(nap, usr_entry, usr_stack_ptr,
-                                                 user_tls1, user_tls2);
+  struct NaClAppThread *natp;
+
+#if NACL_APP_THREAD_POOL_MAX > 0
+  if (NaClAppThreadPoolReuse(nap, usr_entry, usr_stack_ptr,
+                             user_tls1, user_tls2)) {
+    return 1;
+  }
+#endif
+  natp = NaClAppThreadMake(nap, usr_entry, usr_stack_ptr,
+                           user_tls1, user_tls2);
   if (natp == NULL) {
     return 0;
   }
@@ -268,6 +433,8 @@ void NaClAppThreadDelete(struct NaClAppThread *natp) {
   NaClSignalStackFree(natp->signal_stack);
   natp->signal_stack = NULL;
   NaClCondVarDtor(&natp->futex_condvar);
+  NaClCondVarDtor(&natp->pool_cv);
+  NaClSyscallProfileThreadFree(natp->syscall_profile);
   NaClTlsFree(natp);
   NaClMutexDtor(&natp->mu);
   NaClAlignedFree(natp);
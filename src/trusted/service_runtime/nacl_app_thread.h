@@ -12,6 +12,9 @@
 #define NATIVE_CLIENT_SERVICE_RUNTIME_NACL_APP_THREAD_H__ 1
 
 #include <stddef.h>
+#if !NACL_WINDOWS
+# include <setjmp.h>
+#endif
 
 #include "native_client/src/include/atomic_ops.h"
 #include "native_client/src/shared/platform/nacl_sync.h"
@@ -25,6 +28,24 @@ EXTERN_C_BEGIN
 
 struct NaClApp;
 struct NaClAppThreadSuspendedRegisters;
+struct NaClPerfEventsThread;
+struct NaClSyscallProfileThread;
+
+/*
+ * When an untrusted thread exits, its host thread, NaClAppThread and
+ * signal stack are parked in a per-app pool (up to this many of them)
+ * rather than torn down, so that NaClAppThreadSpawn() can reuse them.
+ * Parked threads are never destroyed; like all host threads running
+ * untrusted code, they are not joined when the app exits.
+ *
+ * The pool is not used on Windows, where NaClAppThreadTeardown()
+ * cannot longjmp() back out of the syscall that exits the thread.
+ */
+#if NACL_WINDOWS
+# define NACL_APP_THREAD_POOL_MAX 0
+#else
+# define NACL_APP_THREAD_POOL_MAX 8
+#endif
 
 /*
  * The thread hosting the NaClAppThread may change suspend_state
@@ -161,6 +182,54 @@ struct NaClAppThread {
    */
   uint32_t                  futex_wait_addr;
   struct NaClCondVar        futex_condvar;
+
+  /*
+   * This thread's syscall counts, or NULL if the app is not being
+   * profiled.  See nacl_syscall_profile.h.
+   */
+  struct NaClSyscallProfileThread *syscall_profile;
+
+  /*
+   * This thread's hardware counters, or NULL if they are not open.
+   * Opened when the host thread starts running untrusted code and
+   * closed in NaClAppThreadTeardown().
+   */
+  struct NaClPerfEventsThread *perf_events;
+
+  /*
+   * Set once the thread has tried to change its own scheduling with
+   * the thread_sched_set syscall, whether or not that succeeded.  Such
+   * a host thread is not reused, so that its scheduling does not leak
+   * into a later untrusted thread.
+   */
+  int                       sched_changed;
+
+  /*
+   * The untrusted addresses of this thread's syscall ring queues, if
+   * syscall_ring_entries is non-zero.  See nacl_syscall_ring.h.
+   */
+  uint32_t                  syscall_ring_sq;
+  uint32_t                  syscall_ring_cq;
+  uint32_t                  syscall_ring_entries;
+
+  /*
+   * Thread pool state, protected by NaClApp::thread_pool_mu.  While
+   * the thread is parked, pool_next links it into
+   * NaClApp::thread_pool_head and it waits on pool_cv until
+   * pool_wakeup is set by NaClAppThreadSpawn().
+   */
+  struct NaClAppThread      *pool_next;
+  int                       pool_wakeup;
+  struct NaClCondVar        pool_cv;
+#if !NACL_WINDOWS
+  /*
+   * NaClAppThreadTeardown() jumps back to NaClAppThreadLauncher()'s
+   * frame through pool_jmp_buf, discarding the frames of the exiting
+   * syscall so that a reused host thread's trusted stack does not
+   * grow.
+   */
+  jmp_buf                   pool_jmp_buf;
+#endif
 };
 
 void WINAPI NaClAppThreadLauncher(void *state);
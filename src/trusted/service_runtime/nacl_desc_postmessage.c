@@ -101,6 +101,11 @@ static struct NaClDescVtbl const kNaClDescPostMessageVtbl = {
   NaClDescSeekNotImplemented,
   NaClDescPReadNotImplemented,
   NaClDescPWriteNotImplemented,
+  NaClDescReadVByParts,
+  NaClDescWriteVByParts,
+  NaClDescPReadVByParts,
+  NaClDescPWriteVByParts,
+  NaClDescSendFileByCopy,
   NaClDescIoctlNotImplemented,
   NaClDescPostMessageFstat,
   NaClDescGetdentsNotImplemented,
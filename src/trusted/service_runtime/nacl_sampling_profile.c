@@ -0,0 +1,549 @@
+/*
+ * Copyright (c) 2013 The Native Client Authors. All rights reserved.
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "native_client/src/include/nacl_platform.h"
+#include "native_client/src/include/portability.h"
+#include "native_client/src/include/portability_io.h"
+
+#if NACL_WINDOWS
+# include <windows.h>
+#else
+# include <unistd.h>
+#endif
+
+#include "native_client/src/shared/platform/nacl_check.h"
+#include "native_client/src/shared/platform/nacl_log.h"
+#include "native_client/src/shared/platform/nacl_sync.h"
+#include "native_client/src/shared/platform/nacl_sync_checked.h"
+#include "native_client/src/shared/platform/nacl_threads.h"
+#include "native_client/src/trusted/perf_counter/nacl_perf_json.h"
+#include "native_client/src/trusted/perf_counter/nacl_perf_output.h"
+#include "native_client/src/trusted/perf_counter/nacl_perf_symbols.h"
+#include "native_client/src/trusted/service_runtime/include/sys/time.h"
+#include "native_client/src/trusted/service_runtime/nacl_app_thread.h"
+#include "native_client/src/trusted/service_runtime/nacl_sampling_profile.h"
+#include "native_client/src/trusted/service_runtime/nacl_signal.h"
+#include "native_client/src/trusted/service_runtime/sel_ldr.h"
+#include "native_client/src/trusted/service_runtime/thread_suspension.h"
+
+#define NACL_SAMPLING_PROFILE_STACK_SIZE (64 << 10)
+
+/*
+ * The frame record that a frame pointer points to: the caller's frame
+ * pointer, then the return address.  On x86-64 both are pushed as
+ * 64-bit values, of which the low 32 bits are the untrusted address.
+ */
+#if NACL_ARCH(NACL_BUILD_ARCH) == NACL_x86 && NACL_BUILD_SUBARCH == 64
+# define NACL_SAMPLING_PROFILE_FRAME_PTR(regs) ((regs)->rbp)
+typedef uint64_t NaClSamplingProfileSlot;
+#elif NACL_ARCH(NACL_BUILD_ARCH) == NACL_x86
+# define NACL_SAMPLING_PROFILE_FRAME_PTR(regs) ((regs)->ebp)
+typedef uint32_t NaClSamplingProfileSlot;
+#elif NACL_ARCH(NACL_BUILD_ARCH) == NACL_arm
+# define NACL_SAMPLING_PROFILE_FRAME_PTR(regs) ((regs)->r11)
+typedef uint32_t NaClSamplingProfileSlot;
+#endif
+
+#if defined(NACL_SAMPLING_PROFILE_FRAME_PTR)
+struct NaClSamplingProfileFrame {
+  NaClSamplingProfileSlot fp;
+  NaClSamplingProfileSlot ret;
+};
+#endif
+
+/*
+ * Samples per distinct stack, in an open-addressed hash table.
+ * Frames are innermost first, and are the start addresses of the
+ * functions they fall in, where known, so that stacks differing only
+ * in where within the same functions they were sampled share an entry.
+ */
+struct NaClSamplingProfileStack {
+  uint32_t  count;  /* 0 if the slot is free */
+  uint32_t  hash;
+  uint32_t  num_frames;
+  int       in_syscall;
+  uint32_t  *frames;
+};
+
+struct NaClSamplingProfile {
+  /*
+   * Protects everything below except frames and pipe_fds, which only
+   * the sampling thread uses.  Lock ordering: claimed after threads_mu.
+   */
+  struct NaClMutex                  mu;
+  struct NaClCondVar                cv;
+  FILE                              *out;
+  unsigned                          interval_ns;
+  unsigned                          max_depth;
+  struct NaClSamplingProfileStack   *stacks;
+  size_t                            stacks_capacity;  /* a power of 2 */
+  size_t                            stacks_used;
+  uint64_t                          lost_samples;
+  struct NaClPerfSymbols            symbols;
+  int                               stop;
+  int                               running;
+  struct NaClThread                 thread;
+  uint32_t                          *frames;
+#if !NACL_WINDOWS
+  int                               pipe_fds[2];
+#endif
+};
+
+struct NaClSamplingProfile *NaClSamplingProfileCreate(FILE *out,
+                                                      unsigned hz,
+                                                      unsigned max_depth) {
+  struct NaClSamplingProfile *sp;
+
+  CHECK(0 < hz && hz <= NACL_SAMPLING_PROFILE_MAX_HZ);
+  CHECK(0 < max_depth && max_depth <= NACL_SAMPLING_PROFILE_MAX_DEPTH);
+  sp = (struct NaClSamplingProfile *) calloc(1, sizeof *sp);
+  if (NULL == sp) {
+    return NULL;
+  }
+  sp->frames = (uint32_t *) malloc(max_depth * sizeof *sp->frames);
+  if (NULL == sp->frames) {
+    goto cleanup_sp;
+  }
+#if !NACL_WINDOWS
+  if (0 != pipe(sp->pipe_fds)) {
+    goto cleanup_frames;
+  }
+#endif
+  if (!NaClMutexCtor(&sp->mu)) {
+    goto cleanup_pipe;
+  }
+  if (!NaClCondVarCtor(&sp->cv)) {
+    goto cleanup_mu;
+  }
+  NaClPerfSymbolsCtor(&sp->symbols);
+  sp->out = out;
+  sp->interval_ns = NACL_NANOS_PER_UNIT / hz;
+  sp->max_depth = max_depth;
+  return sp;
+
+ cleanup_mu:
+  NaClMutexDtor(&sp->mu);
+ cleanup_pipe:
+#if !NACL_WINDOWS
+  (void) close(sp->pipe_fds[0]);
+  (void) close(sp->pipe_fds[1]);
+ cleanup_frames:
+#endif
+  free(sp->frames);
+ cleanup_sp:
+  free(sp);
+  return NULL;
+}
+
+void NaClSamplingProfileDelete(struct NaClSamplingProfile *sp) {
+  size_t i;
+
+  CHECK(!sp->running);
+  for (i = 0; i < sp->stacks_capacity; ++i) {
+    free(sp->stacks[i].frames);
+  }
+  free(sp->stacks);
+  NaClPerfSymbolsDtor(&sp->symbols);
+  NaClCondVarDtor(&sp->cv);
+  NaClMutexDtor(&sp->mu);
+#if !NACL_WINDOWS
+  (void) close(sp->pipe_fds[0]);
+  (void) close(sp->pipe_fds[1]);
+#endif
+  free(sp->frames);
+  free(sp);
+}
+
+/* Returns the value of an unsigned environment variable, or dflt. */
+static unsigned NaClSamplingProfileGetEnv(char const *name, unsigned dflt,
+                                          unsigned max) {
+  char const    *value = getenv(name);
+  char          *end;
+  unsigned long n;
+
+  if (NULL == value) {
+    return dflt;
+  }
+  n = strtoul(value, &end, 0);
+  if ('\0' == *value || '\0' != *end || 0 == n || n > max) {
+    NaClLog(LOG_WARNING,
+            "NaClSamplingProfileInitFromEnv: %s must be between 1 and %u;"
+            " using %u\n", name, max, dflt);
+    return dflt;
+  }
+  return (unsigned) n;
+}
+
+void NaClSamplingProfileInitFromEnv(struct NaClApp *nap) {
+  char const  *path = getenv("NACL_SAMPLING_PROFILE");
+  unsigned    hz;
+  unsigned    max_depth;
+  FILE        *out;
+
+  nap->sampling_profile = NULL;
+  if (NULL == path) {
+    return;
+  }
+  hz = NaClSamplingProfileGetEnv("NACL_SAMPLING_PROFILE_HZ",
+                                 NACL_SAMPLING_PROFILE_DEFAULT_HZ,
+                                 NACL_SAMPLING_PROFILE_MAX_HZ);
+  max_depth = NaClSamplingProfileGetEnv("NACL_SAMPLING_PROFILE_DEPTH",
+                                        NACL_SAMPLING_PROFILE_DEFAULT_DEPTH,
+                                        NACL_SAMPLING_PROFILE_MAX_DEPTH);
+  out = NaClPerfOutputOpen(path, "NaClSamplingProfileInitFromEnv",
+                           "sampling profiling");
+  if (NULL == out) {
+    return;
+  }
+  nap->sampling_profile = NaClSamplingProfileCreate(out, hz, max_depth);
+  if (NULL == nap->sampling_profile) {
+    NaClLog(LOG_WARNING,
+            "NaClSamplingProfileInitFromEnv: out of resources;"
+            " sampling profiling disabled\n");
+    NaClPerfOutputClose(out);
+    return;
+  }
+  NaClLog(LOG_INFO,
+          "Sampling profiling enabled at %u Hz, %u frames,"
+          " writing to %s\n", hz, max_depth, path);
+}
+
+void NaClSamplingProfileAddSymbol(struct NaClSamplingProfile *sp,
+                                  uint32_t addr, uint32_t size,
+                                  char const *name) {
+  NaClXMutexLock(&sp->mu);
+  NaClPerfSymbolsAdd(&sp->symbols, addr, size, name);
+  NaClXMutexUnlock(&sp->mu);
+}
+
+static uint32_t NaClSamplingProfileHash(uint32_t const *frames,
+                                        size_t num_frames, int in_syscall) {
+  /* FNV-1a, a word at a time. */
+  uint32_t  hash = 2166136261U ^ (uint32_t) in_syscall;
+  size_t    i;
+
+  for (i = 0; i < num_frames; ++i) {
+    hash = (hash ^ frames[i]) * 16777619U;
+  }
+  return hash;
+}
+
+/* Returns the slot for a stack with the given hash and frames. */
+static struct NaClSamplingProfileStack *NaClSamplingProfileFind_mu(
+    struct NaClSamplingProfile *sp, uint32_t hash,
+    uint32_t const *frames, size_t num_frames, int in_syscall) {
+  size_t                          mask = sp->stacks_capacity - 1;
+  size_t                          i;
+  struct NaClSamplingProfileStack *s;
+
+  for (i = hash & mask; ; i = (i + 1) & mask) {
+    s = &sp->stacks[i];
+    if (0 == s->count ||
+        (s->hash == hash && s->num_frames == num_frames &&
+         s->in_syscall == in_syscall &&
+         0 == memcmp(s->frames, frames, num_frames * sizeof *frames))) {
+      return s;
+    }
+  }
+}
+
+/* Keeps the table at most half full.  Returns 0 on allocation failure. */
+static int NaClSamplingProfileReserve_mu(struct NaClSamplingProfile *sp) {
+  struct NaClSamplingProfileStack *old_stacks = sp->stacks;
+  size_t                          old_capacity = sp->stacks_capacity;
+  size_t                          new_capacity;
+  size_t                          i;
+
+  if (2 * (sp->stacks_used + 1) <= sp->stacks_capacity) {
+    return 1;
+  }
+  new_capacity = 0 == old_capacity ? 256 : 2 * old_capacity;
+  sp->stacks = (struct NaClSamplingProfileStack *)
+      calloc(new_capacity, sizeof *sp->stacks);
+  if (NULL == sp->stacks) {
+    sp->stacks = old_stacks;
+    return 0;
+  }
+  sp->stacks_capacity = new_capacity;
+  for (i = 0; i < old_capacity; ++i) {
+    struct NaClSamplingProfileStack *old = &old_stacks[i];
+
+    if (0 != old->count) {
+      *NaClSamplingProfileFind_mu(sp, old->hash, old->frames,
+                                  old->num_frames, old->in_syscall) = *old;
+    }
+  }
+  free(old_stacks);
+  return 1;
+}
+
+void NaClSamplingProfileRecord(struct NaClSamplingProfile *sp,
+                               uint32_t const *frames, size_t num_frames,
+                               int in_syscall) {
+  uint32_t                        keys[NACL_SAMPLING_PROFILE_MAX_DEPTH];
+  struct NaClPerfSymbol const     *sym;
+  struct NaClSamplingProfileStack *s;
+  uint32_t                        hash;
+  size_t                          i;
+
+  if (0 == num_frames) {
+    return;
+  }
+  in_syscall = 0 != in_syscall;
+  if (num_frames > sp->max_depth) {
+    num_frames = sp->max_depth;
+  }
+  NaClXMutexLock(&sp->mu);
+  for (i = 0; i < num_frames; ++i) {
+    /*
+     * A return address may be just past the end of the calling
+     * function, if the call was its last instruction.
+     */
+    sym = NaClPerfSymbolsLookup(&sp->symbols,
+                                0 == i ? frames[i] : frames[i] - 1);
+    keys[i] = NULL == sym ? frames[i] : sym->addr;
+  }
+  hash = NaClSamplingProfileHash(keys, num_frames, in_syscall);
+  if (!NaClSamplingProfileReserve_mu(sp)) {
+    sp->lost_samples++;
+    NaClXMutexUnlock(&sp->mu);
+    return;
+  }
+  s = NaClSamplingProfileFind_mu(sp, hash, keys, num_frames, in_syscall);
+  if (0 == s->count) {
+    s->frames = (uint32_t *) malloc(num_frames * sizeof *s->frames);
+    if (NULL == s->frames) {
+      sp->lost_samples++;
+      NaClXMutexUnlock(&sp->mu);
+      return;
+    }
+    memcpy(s->frames, keys, num_frames * sizeof *s->frames);
+    s->hash = hash;
+    s->num_frames = (uint32_t) num_frames;
+    s->in_syscall = in_syscall;
+    sp->stacks_used++;
+  }
+  s->count++;
+  NaClXMutexUnlock(&sp->mu);
+}
+
+/*
+ * Copies untrusted memory that may not be mapped.  Returns 0 if it
+ * could not all be read.
+ */
+static int NaClSamplingProfileReadMemory(struct NaClSamplingProfile *sp,
+                                         void *dst, uintptr_t src,
+                                         size_t size) {
+#if NACL_WINDOWS
+  SIZE_T got;
+
+  UNREFERENCED_PARAMETER(sp);
+  return ReadProcessMemory(GetCurrentProcess(), (void const *) src, dst, size,
+                           &got) && got == size;
+#else
+  /*
+   * As in the debug stub, we get the kernel to do the read, so that it
+   * fails with EFAULT rather than faulting.  Whatever part of the
+   * write succeeded is read back, so the pipe is always left empty.
+   */
+  ssize_t written = write(sp->pipe_fds[1], (void const *) src, size);
+
+  if (written <= 0) {
+    return 0;
+  }
+  if (read(sp->pipe_fds[0], dst, written) != written) {
+    return 0;
+  }
+  return (size_t) written == size;
+#endif
+}
+
+/*
+ * Fills frames with the untrusted program counter of a suspended
+ * thread and the return addresses found by following its frame
+ * pointers, and returns how many there are.
+ */
+static size_t NaClSamplingProfileWalk(struct NaClApp *nap,
+                                      struct NaClSamplingProfile *sp,
+                                      struct NaClSignalContext const *regs,
+                                      uint32_t *frames) {
+  size_t num_frames = 0;
+
+  /* Where the sandbox base is not 0, it is 4GB-aligned. */
+  frames[num_frames++] = (uint32_t) regs->prog_ctr;
+#if defined(NACL_SAMPLING_PROFILE_FRAME_PTR)
+  {
+    uint32_t                        fp;
+    uintptr_t                       sys_addr;
+    struct NaClSamplingProfileFrame frame;
+
+    fp = (uint32_t) NACL_SAMPLING_PROFILE_FRAME_PTR(regs);
+    while (num_frames < sp->max_depth) {
+      if (0 == fp || 0 != fp % sizeof frame.fp) {
+        break;
+      }
+      sys_addr = NaClUserToSysAddrRange(nap, fp, sizeof frame);
+      if (kNaClBadAddress == sys_addr ||
+          !NaClSamplingProfileReadMemory(sp, &frame, sys_addr, sizeof frame) ||
+          0 == (uint32_t) frame.ret) {
+        break;
+      }
+      frames[num_frames++] = (uint32_t) frame.ret;
+      /* Callers' frames are higher up the stack, so the walk ends. */
+      if ((uint32_t) frame.fp <= fp) {
+        break;
+      }
+      fp = (uint32_t) frame.fp;
+    }
+  }
+#else
+  UNREFERENCED_PARAMETER(nap);
+  UNREFERENCED_PARAMETER(sp);
+#endif
+  return num_frames;
+}
+
+static void NaClSamplingProfileSampleThreads(struct NaClApp *nap) {
+  struct NaClSamplingProfile  *sp = nap->sampling_profile;
+  struct NaClSignalContext    regs;
+  size_t                      index;
+  size_t                      num_frames;
+
+  NaClUntrustedThreadsSuspendAll(nap, /* save_registers= */ 1);
+  for (index = 0; index < nap->threads.num_entries; ++index) {
+    struct NaClAppThread *natp = NaClGetThreadMu(nap, (int) index);
+
+    if (NULL == natp) {
+      continue;
+    }
+    NaClAppThreadGetSuspendedRegisters(natp, &regs);
+    num_frames = NaClSamplingProfileWalk(nap, sp, &regs, sp->frames);
+    NaClSamplingProfileRecord(sp, sp->frames, num_frames,
+                              NaClAppThreadIsSuspendedInSyscall(natp));
+  }
+  NaClUntrustedThreadsResumeAll(nap);
+}
+
+static void WINAPI NaClSamplingProfileThread(void *state) {
+  struct NaClApp              *nap = (struct NaClApp *) state;
+  struct NaClSamplingProfile  *sp = nap->sampling_profile;
+  NACL_TIMESPEC_T             interval;
+
+  interval.tv_sec = sp->interval_ns / NACL_NANOS_PER_UNIT;
+  interval.tv_nsec = sp->interval_ns % NACL_NANOS_PER_UNIT;
+  NaClXMutexLock(&sp->mu);
+  while (!sp->stop) {
+    (void) NaClCondVarTimedWaitRelative(&sp->cv, &sp->mu, &interval);
+    if (sp->stop) {
+      break;
+    }
+    /* Suspending threads claims threads_mu, which comes first. */
+    NaClXMutexUnlock(&sp->mu);
+    NaClSamplingProfileSampleThreads(nap);
+    NaClXMutexLock(&sp->mu);
+  }
+  NaClXMutexUnlock(&sp->mu);
+}
+
+void NaClSamplingProfileStart(struct NaClApp *nap) {
+  struct NaClSamplingProfile *sp = nap->sampling_profile;
+
+  if (NULL == sp || sp->running) {
+    return;
+  }
+  if (!NaClThreadCreateJoinable(&sp->thread, NaClSamplingProfileThread, nap,
+                                NACL_SAMPLING_PROFILE_STACK_SIZE)) {
+    NaClLog(LOG_WARNING,
+            "NaClSamplingProfileStart: could not create the sampling thread;"
+            " sampling profiling disabled\n");
+    return;
+  }
+  sp->running = 1;
+}
+
+/*
+ * Appends the name of a frame.  ';' and spaces delimit frames and
+ * counts, so they are replaced in symbol names.
+ */
+static void NaClSamplingProfileAppendFrame_mu(
+    struct NaClPerfJson *buf,
+    struct NaClSamplingProfile *sp, uint32_t addr) {
+  struct NaClPerfSymbol const *sym;
+  char const                  *p;
+
+  sym = NaClPerfSymbolsLookup(&sp->symbols, addr);
+  if (NULL == sym) {
+    NaClPerfJsonAppend(buf, "0x%08"NACL_PRIx32, addr);
+    return;
+  }
+  for (p = sym->name; '\0' != *p; ++p) {
+    NaClPerfJsonAppend(buf, "%c",
+                       ';' == *p || ' ' == *p || '\n' == *p ? '_' : *p);
+  }
+}
+
+char *NaClSamplingProfileToFolded(struct NaClSamplingProfile *sp) {
+  struct NaClPerfJson buf;
+  size_t              i;
+  uint32_t            j;
+
+  if (!NaClPerfJsonCtor(&buf)) {
+    return NULL;
+  }
+
+  NaClXMutexLock(&sp->mu);
+  for (i = 0; i < sp->stacks_capacity; ++i) {
+    struct NaClSamplingProfileStack const *s = &sp->stacks[i];
+
+    if (0 == s->count) {
+      continue;
+    }
+    for (j = s->num_frames; j > 0; --j) {
+      NaClSamplingProfileAppendFrame_mu(&buf, sp, s->frames[j - 1]);
+      if (j > 1) {
+        NaClPerfJsonAppend(&buf, ";");
+      }
+    }
+    NaClPerfJsonAppend(&buf, "%s %"NACL_PRIu32"\n",
+                       s->in_syscall ? ";[syscall]" : "", s->count);
+  }
+  if (0 != sp->lost_samples) {
+    NaClPerfJsonAppend(&buf, "[lost] %"NACL_PRIu64"\n", sp->lost_samples);
+  }
+  NaClXMutexUnlock(&sp->mu);
+  return NaClPerfJsonRelease(&buf);
+}
+
+void NaClSamplingProfileWrite(struct NaClApp *nap) {
+  struct NaClSamplingProfile  *sp = nap->sampling_profile;
+  char                        *folded;
+
+  if (NULL == sp) {
+    return;
+  }
+  NaClXMutexLock(&sp->mu);
+  sp->stop = 1;
+  NaClXCondVarSignal(&sp->cv);
+  NaClXMutexUnlock(&sp->mu);
+  if (sp->running) {
+    NaClThreadJoin(&sp->thread);
+    sp->running = 0;
+  }
+  if (NULL == sp->out) {
+    return;
+  }
+  folded = NaClSamplingProfileToFolded(sp);
+  if (NULL == folded) {
+    NaClLog(LOG_WARNING, "NaClSamplingProfileWrite: out of memory\n");
+    return;
+  }
+  fputs(folded, sp->out);
+  fflush(sp->out);
+  free(folded);
+}
@@ -0,0 +1,105 @@
+/*
+ * Copyright (c) 2013 The Native Client Authors. All rights reserved.
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+/*
+ * Opt-in sampling profiler for untrusted code.  When the
+ * NACL_SAMPLING_PROFILE environment variable names an output file
+ * ("-" for stderr), a background thread suspends all untrusted
+ * threads NACL_SAMPLING_PROFILE_HZ times a second (default 100),
+ * records each one's program counter and, by following the frame
+ * pointer chain, up to NACL_SAMPLING_PROFILE_DEPTH - 1 callers
+ * (default 64 frames in all; 1 records only the program counter).
+ *
+ * Samples are aggregated by call stack and written, when the main
+ * thread exits, in the "folded" format read by flame graph tools: one
+ * line per distinct stack, with frames from outermost to innermost
+ * separated by ';' and followed by the number of samples.  Frames are
+ * named after the nexe's function symbols, or given as untrusted
+ * addresses if the nexe is stripped.  Threads that were inside a NaCl
+ * syscall get a last "[syscall]" frame.  The profile can also be
+ * fetched at any time over the secure service channel.
+ *
+ * This uses only the thread suspension interface, so it needs no
+ * special privileges.  Frame pointer walking requires untrusted code
+ * built with frame pointers, and is not done on MIPS.  Stack memory is
+ * read via the kernel, so a corrupt chain just ends the walk.
+ */
+
+#ifndef NATIVE_CLIENT_SRC_TRUSTED_SERVICE_RUNTIME_NACL_SAMPLING_PROFILE_H_
+#define NATIVE_CLIENT_SRC_TRUSTED_SERVICE_RUNTIME_NACL_SAMPLING_PROFILE_H_
+
+#include <stdio.h>
+
+#include "native_client/src/include/nacl_base.h"
+#include "native_client/src/include/nacl_compiler_annotations.h"
+#include "native_client/src/include/portability.h"
+
+EXTERN_C_BEGIN
+
+struct NaClApp;
+
+#define NACL_SAMPLING_PROFILE_DEFAULT_HZ 100
+#define NACL_SAMPLING_PROFILE_MAX_HZ 10000
+#define NACL_SAMPLING_PROFILE_DEFAULT_DEPTH 64
+#define NACL_SAMPLING_PROFILE_MAX_DEPTH 1024
+
+struct NaClSamplingProfile;
+
+/*
+ * Returns a profile that samples hz times a second, recording at most
+ * max_depth frames per stack, and writes itself to out at exit, or to
+ * nowhere if out is NULL.  Returns NULL on failure.
+ */
+struct NaClSamplingProfile *NaClSamplingProfileCreate(FILE *out,
+                                                      unsigned hz,
+                                                      unsigned max_depth);
+
+/* Frees a profile whose sampling thread has not been started. */
+void NaClSamplingProfileDelete(struct NaClSamplingProfile *sp);
+
+/*
+ * Sets up nap->sampling_profile from the environment.  This must be
+ * called before the outer sandbox is enabled, since it opens the
+ * output file.
+ */
+void NaClSamplingProfileInitFromEnv(struct NaClApp *nap);
+
+/* Adds a function symbol of the nexe, at untrusted address addr. */
+void NaClSamplingProfileAddSymbol(struct NaClSamplingProfile *sp,
+                                  uint32_t addr, uint32_t size,
+                                  char const *name);
+
+/*
+ * Starts sampling the app's threads, if profiling is enabled.  This
+ * must be called after the nexe's symbols have been added, and before
+ * the main thread is created.  Profiling is disabled, with a warning,
+ * if the sampling thread cannot be started.
+ */
+void NaClSamplingProfileStart(struct NaClApp *nap);
+
+/*
+ * Records one sample.  frames[0] is the untrusted program counter and
+ * the rest are return addresses, innermost first.
+ */
+void NaClSamplingProfileRecord(struct NaClSamplingProfile *sp,
+                               uint32_t const *frames, size_t num_frames,
+                               int in_syscall);
+
+/*
+ * Returns the samples so far in folded format, malloc()ed, or NULL on
+ * allocation failure.
+ */
+char *NaClSamplingProfileToFolded(struct NaClSamplingProfile *sp);
+
+/*
+ * Stops sampling and writes the profile to the output file, if there
+ * is one.
+ */
+void NaClSamplingProfileWrite(struct NaClApp *nap);
+
+EXTERN_C_END
+
+#endif  /* NATIVE_CLIENT_SRC_TRUSTED_SERVICE_RUNTIME_NACL_SAMPLING_PROFILE_H_ */
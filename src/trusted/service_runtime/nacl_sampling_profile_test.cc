@@ -0,0 +1,105 @@
+/*
+ * Copyright (c) 2013 The Native Client Authors. All rights reserved.
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "native_client/src/include/nacl_macros.h"
+#include "native_client/src/trusted/service_runtime/nacl_sampling_profile.h"
+
+#include "gtest/gtest.h"
+
+class SamplingProfileTest : public testing::Test {
+ protected:
+  virtual void SetUp();
+  virtual void TearDown();
+
+  struct NaClSamplingProfile *sp_;
+};
+
+void SamplingProfileTest::SetUp() {
+  sp_ = NaClSamplingProfileCreate(NULL, NACL_SAMPLING_PROFILE_DEFAULT_HZ, 3);
+  ASSERT_TRUE(NULL != sp_);
+  NaClSamplingProfileAddSymbol(sp_, 0x20000, 0x100, "main");
+  NaClSamplingProfileAddSymbol(sp_, 0x20100, 0x80, "work");
+  // Symbols of unknown size extend to the next one.
+  NaClSamplingProfileAddSymbol(sp_, 0x20200, 0, "with;delimiters in");
+}
+
+void SamplingProfileTest::TearDown() {
+  NaClSamplingProfileDelete(sp_);
+}
+
+// Samples anywhere within the same functions share a line, with the
+// outermost frame first.
+TEST_F(SamplingProfileTest, AggregatesByFunction) {
+  static const uint32_t kFirst[] = { 0x20104, 0x20010 };
+  static const uint32_t kSecond[] = { 0x20170, 0x20020 };
+  char *folded;
+
+  NaClSamplingProfileRecord(sp_, kFirst, NACL_ARRAY_SIZE(kFirst), 0);
+  NaClSamplingProfileRecord(sp_, kSecond, NACL_ARRAY_SIZE(kSecond), 0);
+  folded = NaClSamplingProfileToFolded(sp_);
+  ASSERT_TRUE(NULL != folded);
+  EXPECT_STREQ("main;work 2\n", folded);
+  free(folded);
+}
+
+// A return address just past the end of a function belongs to it.
+TEST_F(SamplingProfileTest, ReturnAddressAtEndOfCaller) {
+  static const uint32_t kFrames[] = { 0x20100, 0x20100 };
+  char *folded;
+
+  NaClSamplingProfileRecord(sp_, kFrames, NACL_ARRAY_SIZE(kFrames), 0);
+  folded = NaClSamplingProfileToFolded(sp_);
+  ASSERT_TRUE(NULL != folded);
+  EXPECT_STREQ("main;work 1\n", folded);
+  free(folded);
+}
+
+TEST_F(SamplingProfileTest, UnknownAddressesAndSyscalls) {
+  static const uint32_t kFrames[] = { 0x20300, 0x10000 };
+  char *folded;
+
+  NaClSamplingProfileRecord(sp_, kFrames, NACL_ARRAY_SIZE(kFrames), 1);
+  folded = NaClSamplingProfileToFolded(sp_);
+  ASSERT_TRUE(NULL != folded);
+  EXPECT_STREQ("0x00010000;with_delimiters_in;[syscall] 1\n", folded);
+  free(folded);
+}
+
+// Stacks are cut at the innermost max_depth frames.
+TEST_F(SamplingProfileTest, TruncatesDeepStacks) {
+  static const uint32_t kFrames[] = { 0x20104, 0x20110, 0x20120, 0x20010 };
+  char *folded;
+
+  NaClSamplingProfileRecord(sp_, kFrames, NACL_ARRAY_SIZE(kFrames), 0);
+  folded = NaClSamplingProfileToFolded(sp_);
+  ASSERT_TRUE(NULL != folded);
+  EXPECT_STREQ("work;work;work 1\n", folded);
+  free(folded);
+}
+
+// Enough distinct stacks to make the table grow are all kept.
+TEST_F(SamplingProfileTest, ManyStacks) {
+  uint32_t frame;
+  char *folded;
+  char *line;
+  int lines = 0;
+
+  for (frame = 0x10000; frame < 0x10000 + 1000; ++frame) {
+    NaClSamplingProfileRecord(sp_, &frame, 1, 0);
+    NaClSamplingProfileRecord(sp_, &frame, 1, 0);
+  }
+  folded = NaClSamplingProfileToFolded(sp_);
+  ASSERT_TRUE(NULL != folded);
+  for (line = folded; NULL != (line = strchr(line, '\n')); ++line) {
+    ++lines;
+  }
+  EXPECT_EQ(1000, lines);
+  EXPECT_TRUE(NULL != strstr(folded, "0x000103e7 2\n"));
+  free(folded);
+}
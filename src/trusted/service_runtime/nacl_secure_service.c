@@ -8,6 +8,7 @@
 
 #include <string.h>
 
+#include "native_client/src/include/portability_string.h"
 #include "native_client/src/public/secure_service.h"
 
 #include "native_client/src/shared/platform/nacl_exit.h"
@@ -19,6 +20,7 @@
 #include "native_client/src/trusted/desc/nacl_desc_invalid.h"
 #include "native_client/src/trusted/fault_injection/fault_injection.h"
 #include "native_client/src/trusted/manifest_name_service_proxy/manifest_proxy.h"
+#include "native_client/src/trusted/perf_counter/nacl_perf_trace.h"
 #include "native_client/src/trusted/simple_service/nacl_simple_service.h"
 #include "native_client/src/trusted/service_runtime/include/sys/errno.h"
 #include "native_client/src/trusted/service_runtime/include/sys/fcntl.h"
@@ -26,7 +28,9 @@
 #include "native_client/src/trusted/service_runtime/nacl_error_code.h"
 #include "native_client/src/trusted/service_runtime/nacl_reverse_host_interface.h"
 #include "native_client/src/trusted/service_runtime/nacl_reverse_quota_interface.h"
+#include "native_client/src/trusted/service_runtime/nacl_sampling_profile.h"
 #include "native_client/src/trusted/service_runtime/nacl_signal.h"
+#include "native_client/src/trusted/service_runtime/nacl_syscall_profile.h"
 #include "native_client/src/trusted/service_runtime/sel_ldr.h"
 
 struct NaClSrpcHandlerDesc const kNaClSecureServiceHandlers[];
@@ -57,6 +61,12 @@ int NaClSecureServiceCtor(struct NaClSecureService  *self,
     NaClLog(4, "NaClCondVar failed\n");
     goto failure_condvar_ctor;
   }
+  if (!NaClManifestCacheCtor(&self->manifest_cache,
+                             NACL_MANIFEST_CACHE_DEFAULT_ENTRIES,
+                             NACL_MANIFEST_CACHE_DEFAULT_NEGATIVE_TTL_MS)) {
+    NaClLog(4, "NaClManifestCacheCtor failed\n");
+    goto failure_manifest_cache_ctor;
+  }
   NaClXMutexCtor(&self->mu);
   NaClXCondVarCtor(&self->cv);
   self->nap = nap;
@@ -68,6 +78,8 @@ int NaClSecureServiceCtor(struct NaClSecureService  *self,
       (struct NaClRefCountVtbl *) &kNaClSecureServiceVtbl;
   return 1;
 
+ failure_manifest_cache_ctor:
+  NaClCondVarDtor(&self->cv);
  failure_condvar_ctor:
   NaClMutexDtor(&self->mu);
  failure_mutex_ctor:
@@ -103,6 +115,7 @@ void NaClSecureServiceDtor(struct NaClRefCount *vself) {
   }
   NaClXMutexUnlock(&self->mu);
 
+  NaClManifestCacheDtor(&self->manifest_cache);
   NaClCondVarDtor(&self->cv);
   NaClMutexDtor(&self->mu);
 
@@ -205,10 +218,17 @@ static void NaClSecureServiceLoadModuleRpc(
 
   NaClLog(4, "NaClSecureServiceLoadModuleRpc: loading module\n");
   rpc->result = NACL_SRPC_RESULT_OK;
-  NaClAppLoadModule(nssp->nap,
-                    nexe,
-                    NaClSecureServiceLoadModuleRpcCallback,
-                    (void *) done_cls);
+  /*
+   * Validation runs on its own thread, so that this connection can
+   * serve reverse_setup and other RPCs meanwhile.  start_module waits
+   * for the load to finish.
+   */
+  NaClPerfTraceBegin("LoadModuleRpc");
+  NaClAppLoadModuleInBackground(nssp->nap,
+                                nexe,
+                                NaClSecureServiceLoadModuleRpcCallback,
+                                (void *) done_cls);
+  NaClPerfTraceEnd("LoadModuleRpc");
 
   NaClLog(4, "NaClSecureServiceLoadModuleRpc: done\n");
   NaClDescUnref(nexe);
@@ -427,6 +447,7 @@ static void NaClSecureServiceStartModuleRpc(
   UNREFERENCED_PARAMETER(in_args);
 
   NaClLog(4, "NaClSecureChannelStartModuleRpc: starting module\n");
+  NaClPerfTraceBegin("StartModuleRpc");
 
   /*
    * When reverse setup is being used, we have to block and wait for reverse
@@ -446,6 +467,7 @@ static void NaClSecureServiceStartModuleRpc(
   if (NULL == state) {
     rpc->result = NACL_SRPC_RESULT_NO_MEMORY;
     (*done_cls->Run)(done_cls);
+    NaClPerfTraceEnd("StartModuleRpc");
     return;
   }
   state->out_status = &out_args[0]->u.ival;
@@ -455,6 +477,7 @@ static void NaClSecureServiceStartModuleRpc(
   NaClAppStartModule(nssp->nap,
                      NaClSecureServiceStartModuleRpcCallback,
                      (void *) state);
+  NaClPerfTraceEnd("StartModuleRpc");
 
   NaClLog(4, "NaClSecureChannelStartModuleRpc: done\n");
 }
@@ -490,12 +513,107 @@ static void NaClSecureServiceShutdownRpc(
   NaClAppShutdown(nssp->nap, 0);
 }
 
+static void NaClSecureServiceSyscallProfileRpc(
+    struct NaClSrpcRpc      *rpc,
+    struct NaClSrpcArg      **in_args,
+    struct NaClSrpcArg      **out_args,
+    struct NaClSrpcClosure  *done_cls) {
+  struct NaClSecureService  *nssp =
+      (struct NaClSecureService *) rpc->channel->server_instance_data;
+  char                      *json;
+  UNREFERENCED_PARAMETER(in_args);
+
+  NaClLog(4, "NaClSecureServiceSyscallProfileRpc\n");
+  if (NULL == nssp->nap->syscall_profile) {
+    json = STRDUP("");
+  } else {
+    json = NaClSyscallProfileToJson(nssp->nap);
+  }
+  if (NULL == json) {
+    rpc->result = NACL_SRPC_RESULT_NO_MEMORY;
+  } else {
+    /* Freed by the SRPC library once the reply has been sent. */
+    out_args[0]->arrays.str = json;
+    rpc->result = NACL_SRPC_RESULT_OK;
+  }
+  (*done_cls->Run)(done_cls);
+}
+
+static void NaClSecureServiceSamplingProfileRpc(
+    struct NaClSrpcRpc      *rpc,
+    struct NaClSrpcArg      **in_args,
+    struct NaClSrpcArg      **out_args,
+    struct NaClSrpcClosure  *done_cls) {
+  struct NaClSecureService  *nssp =
+      (struct NaClSecureService *) rpc->channel->server_instance_data;
+  char                      *folded;
+  UNREFERENCED_PARAMETER(in_args);
+
+  NaClLog(4, "NaClSecureServiceSamplingProfileRpc\n");
+  if (NULL == nssp->nap->sampling_profile) {
+    folded = STRDUP("");
+  } else {
+    folded = NaClSamplingProfileToFolded(nssp->nap->sampling_profile);
+  }
+  if (NULL == folded) {
+    rpc->result = NACL_SRPC_RESULT_NO_MEMORY;
+  } else {
+    /* Freed by the SRPC library once the reply has been sent. */
+    out_args[0]->arrays.str = folded;
+    rpc->result = NACL_SRPC_RESULT_OK;
+  }
+  (*done_cls->Run)(done_cls);
+}
+
+static void NaClSecureServiceManifestCacheInvalidateRpc(
+    struct NaClSrpcRpc      *rpc,
+    struct NaClSrpcArg      **in_args,
+    struct NaClSrpcArg      **out_args,
+    struct NaClSrpcClosure  *done_cls) {
+  struct NaClSecureService  *nssp =
+      (struct NaClSecureService *) rpc->channel->server_instance_data;
+  char                      *name = in_args[0]->arrays.str;
+  UNREFERENCED_PARAMETER(out_args);
+
+  NaClLog(4, "NaClSecureServiceManifestCacheInvalidateRpc: \"%s\"\n", name);
+  NaClManifestCacheInvalidate(&nssp->manifest_cache,
+                              '\0' == name[0] ? NULL : name);
+  rpc->result = NACL_SRPC_RESULT_OK;
+  (*done_cls->Run)(done_cls);
+}
+
+static void NaClSecureServiceManifestCacheStatsRpc(
+    struct NaClSrpcRpc      *rpc,
+    struct NaClSrpcArg      **in_args,
+    struct NaClSrpcArg      **out_args,
+    struct NaClSrpcClosure  *done_cls) {
+  struct NaClSecureService  *nssp =
+      (struct NaClSecureService *) rpc->channel->server_instance_data;
+  uint64_t                  hits;
+  uint64_t                  misses;
+  UNREFERENCED_PARAMETER(in_args);
+
+  NaClLog(4, "NaClSecureServiceManifestCacheStatsRpc\n");
+  NaClManifestCacheGetStats(&nssp->manifest_cache, &hits, &misses);
+  out_args[0]->u.lval = (int64_t) hits;
+  out_args[1]->u.lval = (int64_t) misses;
+  rpc->result = NACL_SRPC_RESULT_OK;
+  (*done_cls->Run)(done_cls);
+}
+
 struct NaClSrpcHandlerDesc const kNaClSecureServiceHandlers[] = {
   { NACL_SECURE_SERVICE_LOAD_MODULE, NaClSecureServiceLoadModuleRpc, },
   { NACL_SECURE_SERVICE_REVERSE_SETUP, NaClSecureServiceReverseSetupRpc, },
   { NACL_SECURE_SERVICE_START_MODULE, NaClSecureServiceStartModuleRpc, },
   { NACL_SECURE_SERVICE_LOG, NaClSecureServiceLogRpc, },
   { NACL_SECURE_SERVICE_HARD_SHUTDOWN, NaClSecureServiceShutdownRpc, },
+  { NACL_SECURE_SERVICE_SYSCALL_PROFILE, NaClSecureServiceSyscallProfileRpc, },
+  { NACL_SECURE_SERVICE_SAMPLING_PROFILE,
+    NaClSecureServiceSamplingProfileRpc, },
+  { NACL_SECURE_SERVICE_MANIFEST_CACHE_INVALIDATE,
+    NaClSecureServiceManifestCacheInvalidateRpc, },
+  { NACL_SECURE_SERVICE_MANIFEST_CACHE_STATS,
+    NaClSecureServiceManifestCacheStatsRpc, },
   { (char const *) NULL, (NaClSrpcMethod) NULL, },
 };
 
@@ -8,6 +8,7 @@
 #define NATIVE_CLIENT_SRC_TRUSTED_SERVICE_RUNTIME_NACL_SECURE_SERVICE_H_
 
 #include "native_client/src/include/nacl_base.h"
+#include "native_client/src/trusted/manifest_name_service_proxy/manifest_cache.h"
 #include "native_client/src/trusted/service_runtime/sel_ldr.h"
 #include "native_client/src/trusted/simple_service/nacl_simple_service.h"
 #include "native_client/src/trusted/simple_service/nacl_simple_rservice.h"
@@ -40,6 +41,9 @@ struct NaClSecureService {
   struct NaClSecureReverseClient  *reverse_client;
 
   uint32_t                        conn_count;
+
+  /* Shared by all connections to the manifest proxy. */
+  struct NaClManifestCache        manifest_cache;
 };
 
 int NaClSecureServiceCtor(
@@ -45,6 +45,8 @@
 #include "native_client/src/trusted/service_runtime/nacl_globals.h"
 #include "native_client/src/trusted/service_runtime/nacl_syscall_handlers.h"
 #include "native_client/src/trusted/service_runtime/nacl_thread_nice.h"
+#include "native_client/src/trusted/service_runtime/nacl_thread_sched.h"
+#include "native_client/src/trusted/service_runtime/nacl_time_page.h"
 #include "native_client/src/trusted/service_runtime/nacl_tls.h"
 #include "native_client/src/trusted/service_runtime/sel_ldr.h"
 
@@ -283,7 +285,9 @@ cleanup:
 
 /*
  * This is not used on x86-64 and its functionality is replaced by
- * NaClGetTlsFastPath1 (see nacl_syscall_64.S).
+ * NaClGetTlsFastPath1 (see nacl_syscall_64.S).  On ARM, other than in
+ * Thumb-2 mode, its trampoline is replaced by NaCl_tls_get1_code (see
+ * tramp_arm.S).
  */
 int32_t NaClSysTlsGet(struct NaClAppThread *natp) {
   return NaClTlsGetTlsValue1(natp);
@@ -297,7 +301,9 @@ int32_t NaClSysSecondTlsSet(struct NaClAppThread *natp,
 
 /*
  * This is not used on x86-64 and its functionality is replaced by
- * NaClGetTlsFastPath2 (see nacl_syscall_64.S).
+ * NaClGetTlsFastPath2 (see nacl_syscall_64.S).  On ARM, other than in
+ * Thumb-2 mode, its trampoline is replaced by NaCl_tls_get2_code (see
+ * tramp_arm.S).
  */
 int32_t NaClSysSecondTlsGet(struct NaClAppThread *natp) {
   return NaClTlsGetTlsValue2(natp);
@@ -310,6 +316,58 @@ int NaClSysThreadNice(struct NaClAppThread *natp,
   return nacl_thread_nice(nice);
 }
 
+/*
+ * A cpu_mask_addr of 0 leaves the thread's CPU affinity unchanged.
+ * The mask is little-endian, as are all the architectures NaCl runs
+ * on, so it can be copied into the low bytes of a uint64_t as is.
+ */
+int32_t NaClSysThreadSchedSet(struct NaClAppThread *natp,
+                              uint32_t             cpu_mask_addr,
+                              uint32_t             mask_bytes,
+                              int32_t              policy,
+                              int32_t              priority) {
+  struct NaClApp          *nap = natp->nap;
+  struct NaClThreadSched  sched;
+  int32_t                 retval;
+
+  NaClLog(3,
+          ("Entered NaClSysThreadSchedSet(0x%08"NACL_PRIxPTR", 0x%08"
+           NACL_PRIx32", %"NACL_PRIu32", %"NACL_PRId32", %"NACL_PRId32")\n"),
+          (uintptr_t) natp, cpu_mask_addr, mask_bytes, policy, priority);
+
+  sched.cpu_mask = 0;
+  sched.policy = policy;
+  sched.priority = priority;
+  if (0 != cpu_mask_addr) {
+    if (mask_bytes > sizeof sched.cpu_mask) {
+      retval = -NACL_ABI_EINVAL;
+      goto cleanup;
+    }
+    if (!NaClCopyInFromUser(nap, &sched.cpu_mask, cpu_mask_addr,
+                            mask_bytes)) {
+      retval = -NACL_ABI_EFAULT;
+      goto cleanup;
+    }
+    if (0 == sched.cpu_mask) {
+      retval = -NACL_ABI_EINVAL;
+      goto cleanup;
+    }
+  }
+  retval = NaClThreadSchedCheck(&nap->thread_sched_limits, &sched);
+  if (0 != retval) {
+    goto cleanup;
+  }
+  /*
+   * Set before the host is asked, since a failure part way through may
+   * leave some of the change in effect.
+   */
+  natp->sched_changed = 1;
+  retval = NaClThreadSchedSetSelf(&sched);
+cleanup:
+  NaClLog(3, "NaClSysThreadSchedSet: returning %"NACL_PRId32"\n", retval);
+  return retval;
+}
+
 int32_t NaClSysMutexCreate(struct NaClAppThread *natp) {
   struct NaClApp       *nap = natp->nap;
   int32_t              retval = -NACL_ABI_EINVAL;
@@ -958,8 +1016,9 @@ int32_t NaClSysTestCrash(struct NaClAppThread *natp, int crash_type) {
 int32_t NaClSysGetTimeOfDay(struct NaClAppThread      *natp,
                             struct nacl_abi_timeval   *tv,
                             struct nacl_abi_timezone  *tz) {
-  int                     retval;
-  struct nacl_abi_timeval now;
+  int                       retval;
+  struct nacl_abi_timeval   now;
+  struct nacl_abi_timespec  ts;
 
   UNREFERENCED_PARAMETER(tz);
 
@@ -976,9 +1035,15 @@ int32_t NaClSysGetTimeOfDay(struct NaClAppThread      *natp,
    * applications?
    */
 
-  retval = NaClGetTimeOfDay(&now);
-  if (0 != retval) {
-    return retval;
+  if (0 == NaClTimePageGetTime(natp->nap, NACL_CLOCK_REALTIME, &ts)) {
+    /* Agree with untrusted readers of the time page. */
+    now.nacl_abi_tv_sec = ts.tv_sec;
+    now.nacl_abi_tv_usec = ts.tv_nsec / NACL_NANOS_PER_MICRO;
+  } else {
+    retval = NaClGetTimeOfDay(&now);
+    if (0 != retval) {
+      return retval;
+    }
   }
 #if !NACL_WINDOWS
   /*
@@ -1042,6 +1107,21 @@ int32_t NaClSysClockGetRes(struct NaClAppThread *natp,
 int32_t NaClSysClockGetTime(struct NaClAppThread  *natp,
                             int                   clk_id,
                             uint32_t              tsp) {
+  struct nacl_abi_timespec  out_buf;
+
+  /*
+   * Once the time page is in use, CLOCK_REALTIME and CLOCK_MONOTONIC
+   * are computed from it here too, so that switching between the page
+   * and the syscall cannot make CLOCK_MONOTONIC go backwards.
+   */
+  if (0 == NaClTimePageGetTime(natp->nap, (nacl_clockid_t) clk_id,
+                               &out_buf)) {
+    if (!NaClCopyOutToUser(natp->nap, (uintptr_t) tsp,
+                           &out_buf, sizeof out_buf)) {
+      return -NACL_ABI_EFAULT;
+    }
+    return 0;
+  }
   return NaClSysClockGetCommon(natp, clk_id, (uintptr_t) tsp,
                                      NaClClockGetTime);
 }
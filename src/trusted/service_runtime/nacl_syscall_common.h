@@ -86,6 +86,12 @@ int32_t NaClSysSecondTlsSet(struct NaClAppThread *natp,
 
 int32_t NaClSysSecondTlsGet(struct NaClAppThread *natp);
 
+int32_t NaClSysThreadSchedSet(struct NaClAppThread *natp,
+                              uint32_t             cpu_mask_addr,
+                              uint32_t             mask_bytes,
+                              int32_t              policy,
+                              int32_t              priority);
+
 int32_t NaClSysThreadNice(struct NaClAppThread *natp,
                           const int nice);
 
@@ -10,6 +10,8 @@
 
 #include "native_client/src/include/nacl_base.h"
 
+EXTERN_C_BEGIN
+
 struct NaClAppThread;
 
 struct NaClSyscallTableEntry {
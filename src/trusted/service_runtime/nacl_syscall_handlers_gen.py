@@ -38,6 +38,7 @@ AUTOGEN_HEADER = """\
 #include "native_client/src/trusted/service_runtime/sys_list_mappings.h"
 #include "native_client/src/trusted/service_runtime/sys_memory.h"
 #include "native_client/src/trusted/service_runtime/sys_parallel_io.h"
+#include "native_client/src/trusted/service_runtime/sys_syscall_ring.h"
 
 """
 
@@ -139,6 +140,23 @@ SYSCALL_LIST = [
     ('NACL_sys_pwrite', 'NaClSysPWrite',
      ['int32_t d', 'uint32_t usr_addr', 'uint32_t buffer_bytes',
       'uint32_t offset_addr']),
+    ('NACL_sys_readv', 'NaClSysReadv',
+     ['int32_t d', 'uint32_t iov_addr', 'uint32_t iovcnt']),
+    ('NACL_sys_writev', 'NaClSysWritev',
+     ['int32_t d', 'uint32_t iov_addr', 'uint32_t iovcnt']),
+    ('NACL_sys_preadv', 'NaClSysPReadv',
+     ['int32_t d', 'uint32_t iov_addr', 'uint32_t iovcnt',
+      'uint32_t offset_addr']),
+    ('NACL_sys_pwritev', 'NaClSysPWritev',
+     ['int32_t d', 'uint32_t iov_addr', 'uint32_t iovcnt',
+      'uint32_t offset_addr']),
+    ('NACL_sys_sendfile', 'NaClSysSendfile',
+     ['int32_t out_d', 'int32_t in_d', 'uint32_t offset_addr',
+      'uint32_t count']),
+    ('NACL_sys_syscall_ring_register', 'NaClSysSyscallRingRegister',
+     ['uint32_t sq_addr', 'uint32_t cq_addr', 'uint32_t entries']),
+    ('NACL_sys_syscall_ring_enter', 'NaClSysSyscallRingEnter',
+     ['uint32_t to_submit']),
     ('NACL_sys_imc_makeboundsock', 'NaClSysImcMakeBoundSock',
      ['int32_t *sap']),
     ('NACL_sys_imc_accept', 'NaClSysImcAccept', ['int d']),
@@ -155,6 +173,9 @@ SYSCALL_LIST = [
       'uint32_t thread_ptr', 'uint32_t second_thread_ptr']),
     ('NACL_sys_tls_get', 'NaClSysTlsGet', []),
     ('NACL_sys_thread_nice', 'NaClSysThreadNice', ['const int nice']),
+    ('NACL_sys_thread_sched_set', 'NaClSysThreadSchedSet',
+     ['uint32_t cpu_mask_addr', 'uint32_t mask_bytes', 'int32_t policy',
+      'int32_t priority']),
     ('NACL_sys_mutex_create', 'NaClSysMutexCreate', []),
     ('NACL_sys_mutex_lock', 'NaClSysMutexLock',
      ['int32_t mutex_handle']),
@@ -0,0 +1,277 @@
+/*
+ * Copyright (c) 2013 The Native Client Authors. All rights reserved.
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "native_client/src/include/nacl_macros.h"
+#include "native_client/src/include/nacl_platform.h"
+#include "native_client/src/include/portability.h"
+#include "native_client/src/shared/platform/nacl_clock.h"
+#include "native_client/src/shared/platform/nacl_log.h"
+#include "native_client/src/shared/platform/nacl_sync.h"
+#include "native_client/src/shared/platform/nacl_sync_checked.h"
+#include "native_client/src/trusted/perf_counter/nacl_perf_json.h"
+#include "native_client/src/trusted/perf_counter/nacl_perf_output.h"
+#include "native_client/src/trusted/service_runtime/nacl_app_thread.h"
+#include "native_client/src/trusted/service_runtime/nacl_syscall_handlers.h"
+#include "native_client/src/trusted/service_runtime/nacl_syscall_profile.h"
+#include "native_client/src/trusted/service_runtime/sel_ldr.h"
+
+#if NACL_ARCH(NACL_BUILD_ARCH) == NACL_x86 && NACL_WINDOWS
+# include <intrin.h>  /* __rdtsc intrinsic */
+#endif
+
+struct NaClSyscallProfile {
+  /* Protects retired.  Lock ordering: claimed after threads_mu. */
+  struct NaClMutex                mu;
+  FILE                            *out;
+  /* Totals of threads that have exited. */
+  struct NaClSyscallProfileThread retired;
+  /* Used to convert ticks to nanoseconds when the summary is made. */
+  uint64_t                        start_ticks;
+  int64_t                         start_ns;
+};
+
+static int64_t NaClSyscallProfileNowNs(void) {
+  struct nacl_abi_timespec now;
+
+  if (0 != NaClClockGetTime(NACL_CLOCK_MONOTONIC, &now)) {
+    return 0;
+  }
+  return (int64_t) now.tv_sec * NACL_NANOS_PER_UNIT + now.tv_nsec;
+}
+
+/*
+ * Reading the TSC takes a few nanoseconds, whereas clock_gettime()
+ * alone would use up most of the time budget for recording a
+ * syscall.  The TSC need not be invariant here: the tick rate is only
+ * used to scale the summary, and it is averaged over the whole run.
+ */
+static INLINE uint64_t NaClSyscallProfileTicks(void) {
+#if NACL_ARCH(NACL_BUILD_ARCH) == NACL_x86
+# if NACL_WINDOWS
+  return __rdtsc();
+# else
+  uint32_t lo;
+  uint32_t hi;
+
+  __asm__ volatile("rdtsc" : "=a"(lo), "=d"(hi));
+  return ((uint64_t) hi << 32) | lo;
+# endif
+#else
+  return (uint64_t) NaClSyscallProfileNowNs();
+#endif
+}
+
+static INLINE unsigned NaClSyscallProfileBucket(uint64_t ticks) {
+  unsigned bucket = 0;
+
+  if (ticks >= ((uint64_t) 1 << 32)) {
+    return NACL_SYSCALL_PROFILE_BUCKETS - 1;
+  }
+  if (ticks >= (1U << 16)) { ticks >>= 16; bucket += 16; }
+  if (ticks >= (1U << 8)) { ticks >>= 8; bucket += 8; }
+  if (ticks >= (1U << 4)) { ticks >>= 4; bucket += 4; }
+  if (ticks >= (1U << 2)) { ticks >>= 2; bucket += 2; }
+  if (ticks >= (1U << 1)) { bucket += 1; }
+  return bucket;
+}
+
+struct NaClSyscallProfile *NaClSyscallProfileCreate(FILE *out) {
+  struct NaClSyscallProfile *profile;
+
+  profile = (struct NaClSyscallProfile *) calloc(1, sizeof *profile);
+  if (NULL == profile) {
+    return NULL;
+  }
+  if (!NaClMutexCtor(&profile->mu)) {
+    free(profile);
+    return NULL;
+  }
+  profile->out = out;
+  profile->start_ticks = NaClSyscallProfileTicks();
+  profile->start_ns = NaClSyscallProfileNowNs();
+  return profile;
+}
+
+void NaClSyscallProfileInitFromEnv(struct NaClApp *nap) {
+  char const  *path = getenv("NACL_SYSCALL_PROFILE");
+  FILE        *out;
+
+  nap->syscall_profile = NULL;
+  if (NULL == path) {
+    return;
+  }
+  out = NaClPerfOutputOpen(path, "NaClSyscallProfileInitFromEnv",
+                           "syscall profiling");
+  if (NULL == out) {
+    return;
+  }
+  nap->syscall_profile = NaClSyscallProfileCreate(out);
+  if (NULL == nap->syscall_profile) {
+    NaClLog(LOG_WARNING,
+            "NaClSyscallProfileInitFromEnv: out of memory;"
+            " syscall profiling disabled\n");
+    NaClPerfOutputClose(out);
+    return;
+  }
+  NaClLog(LOG_INFO, "Syscall profiling enabled, writing to %s\n", path);
+}
+
+struct NaClSyscallProfileThread *NaClSyscallProfileThreadCreate(void) {
+  return (struct NaClSyscallProfileThread *) calloc(
+      1, sizeof(struct NaClSyscallProfileThread));
+}
+
+void NaClSyscallProfileThreadFree(struct NaClSyscallProfileThread *thread) {
+  free(thread);
+}
+
+int32_t NaClSyscallProfileDispatch(struct NaClAppThread *natp,
+                                   size_t               sysnum) {
+  struct NaClSyscallProfileEntry  *entry =
+      &natp->syscall_profile->entries[sysnum];
+  uint64_t                        start;
+  uint64_t                        ticks;
+  int32_t                         sysret;
+
+  /* Counted up front, since exit syscalls do not return. */
+  entry->count++;
+  start = NaClSyscallProfileTicks();
+  sysret = (*(natp->nap->syscall_table[sysnum].handler))(natp);
+  ticks = NaClSyscallProfileTicks() - start;
+  entry->total_ticks += ticks;
+  entry->histogram[NaClSyscallProfileBucket(ticks)]++;
+  return sysret;
+}
+
+static void NaClSyscallProfileAdd(struct NaClSyscallProfileThread       *dst,
+                                  struct NaClSyscallProfileThread const *src) {
+  size_t    sysnum;
+  unsigned  bucket;
+
+  for (sysnum = 0; sysnum < NACL_MAX_SYSCALLS; ++sysnum) {
+    struct NaClSyscallProfileEntry        *d = &dst->entries[sysnum];
+    struct NaClSyscallProfileEntry const  *s = &src->entries[sysnum];
+
+    if (0 == s->count) {
+      continue;
+    }
+    d->count += s->count;
+    d->total_ticks += s->total_ticks;
+    for (bucket = 0; bucket < NACL_SYSCALL_PROFILE_BUCKETS; ++bucket) {
+      d->histogram[bucket] += s->histogram[bucket];
+    }
+  }
+}
+
+void NaClSyscallProfileRetireThreadMu(struct NaClAppThread *natp) {
+  struct NaClSyscallProfile *profile = natp->nap->syscall_profile;
+
+  if (NULL == profile || NULL == natp->syscall_profile) {
+    return;
+  }
+  NaClXMutexLock(&profile->mu);
+  NaClSyscallProfileAdd(&profile->retired, natp->syscall_profile);
+  NaClXMutexUnlock(&profile->mu);
+  /* The table is reused if the host thread is. */
+  memset(natp->syscall_profile, 0, sizeof *natp->syscall_profile);
+}
+
+char *NaClSyscallProfileToJson(struct NaClApp *nap) {
+  struct NaClSyscallProfile       *profile = nap->syscall_profile;
+  struct NaClSyscallProfileThread *totals;
+  struct NaClPerfJson             buf;
+  size_t                          index;
+  size_t                          sysnum;
+  unsigned                        bucket;
+  double                          ns_per_tick = 1.0;
+  uint64_t                        elapsed_ticks;
+  int64_t                         elapsed_ns;
+  char const                      *sep = "";
+
+  if (NULL == profile) {
+    return NULL;
+  }
+  totals = (struct NaClSyscallProfileThread *) malloc(sizeof *totals);
+  if (NULL == totals) {
+    return NULL;
+  }
+
+  NaClXMutexLock(&nap->threads_mu);
+  NaClXMutexLock(&profile->mu);
+  *totals = profile->retired;
+  NaClXMutexUnlock(&profile->mu);
+  for (index = 0; index < nap->threads.num_entries; ++index) {
+    struct NaClAppThread *natp = NaClGetThreadMu(nap, (int) index);
+    if (NULL != natp && NULL != natp->syscall_profile) {
+      /* Racy reads: the owning thread updates these without locking. */
+      NaClSyscallProfileAdd(totals, natp->syscall_profile);
+    }
+  }
+  NaClXMutexUnlock(&nap->threads_mu);
+
+  elapsed_ticks = NaClSyscallProfileTicks() - profile->start_ticks;
+  elapsed_ns = NaClSyscallProfileNowNs() - profile->start_ns;
+  if (0 != elapsed_ticks && elapsed_ns > 0) {
+    ns_per_tick = (double) elapsed_ns / (double) elapsed_ticks;
+  }
+
+  if (!NaClPerfJsonCtor(&buf)) {
+    free(totals);
+    return NULL;
+  }
+
+  NaClPerfJsonAppend(&buf, "{\n  \"ns_per_tick\": %.6f,\n"
+                     "  \"syscalls\": [", ns_per_tick);
+  for (sysnum = 0; sysnum < NACL_MAX_SYSCALLS; ++sysnum) {
+    struct NaClSyscallProfileEntry const *e = &totals->entries[sysnum];
+    char const *bucket_sep = "";
+
+    if (0 == e->count) {
+      continue;
+    }
+    NaClPerfJsonAppend(
+        &buf,
+        "%s\n    {\"number\": %"NACL_PRIuS", \"count\": %"NACL_PRIu64
+        ", \"total_ns\": %.0f, \"histogram\": [",
+        sep, sysnum, e->count, (double) e->total_ticks * ns_per_tick);
+    /* Each bucket is reported as [lower bound in ns, count]. */
+    for (bucket = 0; bucket < NACL_SYSCALL_PROFILE_BUCKETS; ++bucket) {
+      if (0 == e->histogram[bucket]) {
+        continue;
+      }
+      NaClPerfJsonAppend(
+          &buf, "%s[%.0f, %"NACL_PRIu64"]", bucket_sep,
+          (double) (bucket == 0 ? 0 : (uint64_t) 1 << bucket) * ns_per_tick,
+          e->histogram[bucket]);
+      bucket_sep = ", ";
+    }
+    NaClPerfJsonAppend(&buf, "]}");
+    sep = ",";
+  }
+  NaClPerfJsonAppend(&buf, "\n  ]\n}\n");
+  free(totals);
+  return NaClPerfJsonRelease(&buf);
+}
+
+void NaClSyscallProfileWrite(struct NaClApp *nap) {
+  struct NaClSyscallProfile *profile = nap->syscall_profile;
+  char                      *json;
+
+  if (NULL == profile || NULL == profile->out) {
+    return;
+  }
+  json = NaClSyscallProfileToJson(nap);
+  if (NULL == json) {
+    NaClLog(LOG_WARNING, "NaClSyscallProfileWrite: out of memory\n");
+    return;
+  }
+  fputs(json, profile->out);
+  fflush(profile->out);
+  free(json);
+}
@@ -0,0 +1,95 @@
+/*
+ * Copyright (c) 2013 The Native Client Authors. All rights reserved.
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+/*
+ * Opt-in syscall profiler.  When the NACL_SYSCALL_PROFILE environment
+ * variable names an output file ("-" for stderr), every NaCl syscall
+ * is counted and timed, and a JSON summary is written to that file
+ * when the main thread exits.  The summary can also be fetched at any
+ * time over the secure service channel.
+ *
+ * Each NaClAppThread records into its own table, so recording takes
+ * no locks.  The cost when disabled is one predictable branch in
+ * NaClSyscallCSegHook().
+ */
+
+#ifndef NATIVE_CLIENT_SRC_TRUSTED_SERVICE_RUNTIME_NACL_SYSCALL_PROFILE_H_
+#define NATIVE_CLIENT_SRC_TRUSTED_SERVICE_RUNTIME_NACL_SYSCALL_PROFILE_H_
+
+#include <stdio.h>
+
+#include "native_client/src/include/nacl_base.h"
+#include "native_client/src/include/portability.h"
+#include "native_client/src/trusted/service_runtime/include/bits/nacl_syscalls.h"
+
+EXTERN_C_BEGIN
+
+struct NaClApp;
+struct NaClAppThread;
+
+/*
+ * Latencies are bucketed by the base-2 logarithm of their duration in
+ * clock ticks; the last bucket also collects anything longer.
+ */
+#define NACL_SYSCALL_PROFILE_BUCKETS 32
+
+struct NaClSyscallProfileEntry {
+  /* Includes calls that never return, such as thread_exit. */
+  uint64_t  count;
+  uint64_t  total_ticks;
+  uint64_t  histogram[NACL_SYSCALL_PROFILE_BUCKETS];
+};
+
+struct NaClSyscallProfileThread {
+  struct NaClSyscallProfileEntry entries[NACL_MAX_SYSCALLS];
+};
+
+struct NaClSyscallProfile;
+
+/*
+ * Returns a profile that writes its summary to out at exit, or to
+ * nowhere if out is NULL.  Returns NULL on allocation failure.
+ */
+struct NaClSyscallProfile *NaClSyscallProfileCreate(FILE *out);
+
+/*
+ * Sets up nap->syscall_profile from the NACL_SYSCALL_PROFILE
+ * environment variable.  This must be called before the outer
+ * sandbox is enabled, since it opens the output file.
+ */
+void NaClSyscallProfileInitFromEnv(struct NaClApp *nap);
+
+struct NaClSyscallProfileThread *NaClSyscallProfileThreadCreate(void);
+
+void NaClSyscallProfileThreadFree(struct NaClSyscallProfileThread *thread);
+
+/*
+ * Invokes syscall sysnum, which must be valid, for natp and records
+ * it in natp->syscall_profile.
+ */
+int32_t NaClSyscallProfileDispatch(struct NaClAppThread *natp,
+                                   size_t               sysnum);
+
+/*
+ * Moves the counts of an exiting thread into the app-wide totals.
+ * The caller must hold nap->threads_mu, and natp must already have
+ * been removed from the thread table.
+ */
+void NaClSyscallProfileRetireThreadMu(struct NaClAppThread *natp);
+
+/*
+ * Returns a malloc()ed JSON summary of all syscalls made so far by
+ * the app's live and exited threads, or NULL on allocation failure.
+ * Counts of threads that are still running may be slightly stale.
+ */
+char *NaClSyscallProfileToJson(struct NaClApp *nap);
+
+/* Writes the summary to the output file, if there is one. */
+void NaClSyscallProfileWrite(struct NaClApp *nap);
+
+EXTERN_C_END
+
+#endif  /* NATIVE_CLIENT_SRC_TRUSTED_SERVICE_RUNTIME_NACL_SYSCALL_PROFILE_H_ */
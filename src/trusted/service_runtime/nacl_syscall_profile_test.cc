@@ -0,0 +1,82 @@
+/*
+ * Copyright (c) 2013 The Native Client Authors. All rights reserved.
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "native_client/src/shared/platform/nacl_sync_checked.h"
+#include "native_client/src/trusted/desc/nrd_all_modules.h"
+#include "native_client/src/trusted/service_runtime/nacl_app_thread.h"
+#include "native_client/src/trusted/service_runtime/nacl_syscall_handlers.h"
+#include "native_client/src/trusted/service_runtime/nacl_syscall_profile.h"
+#include "native_client/src/trusted/service_runtime/sel_ldr.h"
+
+#include "gtest/gtest.h"
+
+class SyscallProfileTest : public testing::Test {
+ protected:
+  virtual void SetUp();
+  virtual void TearDown();
+};
+
+void SyscallProfileTest::SetUp() {
+  NaClNrdAllModulesInit();
+}
+
+void SyscallProfileTest::TearDown() {
+  NaClNrdAllModulesFini();
+}
+
+static int32_t TestSyscall(struct NaClAppThread *natp) {
+  UNREFERENCED_PARAMETER(natp);
+  return 42;
+}
+
+// Syscalls made by a thread are counted, survive the thread's exit,
+// and appear in the JSON summary.
+TEST_F(SyscallProfileTest, CountsSurviveThreadExit) {
+  static struct NaClSyscallTableEntry table[NACL_MAX_SYSCALLS];
+  struct NaClApp app;
+  struct NaClAppThread natp;
+  char *json;
+  int i;
+
+  for (i = 0; i < NACL_MAX_SYSCALLS; i++) {
+    table[i].handler = TestSyscall;
+  }
+  ASSERT_EQ(1, NaClAppWithSyscallTableCtor(&app, table));
+  ASSERT_TRUE(NULL == app.syscall_profile);
+
+  // Before profiling is enabled there is nothing to report.
+  ASSERT_TRUE(NULL == NaClSyscallProfileToJson(&app));
+
+  app.syscall_profile = NaClSyscallProfileCreate(NULL);
+  ASSERT_TRUE(NULL != app.syscall_profile);
+  memset(&natp, 0, sizeof natp);
+  natp.nap = &app;
+  natp.syscall_profile = NaClSyscallProfileThreadCreate();
+  ASSERT_TRUE(NULL != natp.syscall_profile);
+
+  for (i = 0; i < 3; i++) {
+    ASSERT_EQ(42, NaClSyscallProfileDispatch(&natp, 5));
+  }
+  ASSERT_EQ(42, NaClSyscallProfileDispatch(&natp, 7));
+  ASSERT_EQ(3U, natp.syscall_profile->entries[5].count);
+
+  NaClXMutexLock(&app.threads_mu);
+  NaClSyscallProfileRetireThreadMu(&natp);
+  NaClXMutexUnlock(&app.threads_mu);
+  ASSERT_EQ(0U, natp.syscall_profile->entries[5].count);
+
+  json = NaClSyscallProfileToJson(&app);
+  ASSERT_TRUE(NULL != json);
+  EXPECT_TRUE(NULL != strstr(json, "{\"number\": 5, \"count\": 3,"));
+  EXPECT_TRUE(NULL != strstr(json, "{\"number\": 7, \"count\": 1,"));
+  EXPECT_TRUE(NULL == strstr(json, "\"number\": 6,"));
+  free(json);
+
+  NaClSyscallProfileThreadFree(natp.syscall_profile);
+}
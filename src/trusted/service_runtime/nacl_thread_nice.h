@@ -7,8 +7,26 @@
 #ifndef NATIVE_CLIENT_SERVICE_RUNTIME_NACL_THREAD_NICE_H__
 #define NATIVE_CLIENT_SERVICE_RUNTIME_NACL_THREAD_NICE_H__ 1
 
+#include "native_client/src/include/portability.h"
+
+struct NaClThreadSched;
+
 void NaClThreadNiceInit(void);
 
 int nacl_thread_nice(int nacl_nice);
 
+/*
+ * Returns the mask of CPUs, among the first NACL_ABI_SCHED_MAX_CPUS,
+ * that the calling thread may run on, or 0 if the host does not
+ * support CPU affinity.
+ */
+uint64_t NaClThreadSchedHostCpus(void);
+
+/*
+ * Applies sched, which has already been checked against the app's
+ * limits, to the calling thread.  Returns 0 or a negated NaCl errno;
+ * on failure, part of sched may nonetheless have been applied.
+ */
+int NaClThreadSchedSetSelf(struct NaClThreadSched const *sched);
+
 #endif  /* NATIVE_CLIENT_SERVICE_RUNTIME_NACL_THREAD_NICE_H__ */
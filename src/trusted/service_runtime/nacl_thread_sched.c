@@ -0,0 +1,106 @@
+/*
+ * Copyright (c) 2013 The Native Client Authors. All rights reserved.
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#include "native_client/src/trusted/service_runtime/nacl_thread_sched.h"
+
+#include "native_client/src/shared/platform/nacl_log.h"
+#include "native_client/src/trusted/service_runtime/include/sys/errno.h"
+#include "native_client/src/trusted/service_runtime/include/sys/nacl_nice.h"
+#include "native_client/src/trusted/service_runtime/nacl_app_thread.h"
+#include "native_client/src/trusted/service_runtime/nacl_thread_nice.h"
+#include "native_client/src/trusted/service_runtime/sel_ldr.h"
+
+/* The policies that only ever lower a thread's priority. */
+#define NACL_THREAD_SCHED_DEFAULT_POLICIES ((1U << NACL_ABI_SCHED_OTHER) | \
+                                            (1U << NACL_ABI_SCHED_BATCH) | \
+                                            (1U << NACL_ABI_SCHED_IDLE))
+
+void NaClThreadSchedLimitsCtor(struct NaClThreadSchedLimits *limits) {
+  limits->allowed_cpus = 0;
+  limits->allowed_policies = NACL_THREAD_SCHED_DEFAULT_POLICIES;
+  limits->max_priority = 0;
+  limits->initial_set = 0;
+  limits->initial.cpu_mask = 0;
+  limits->initial.policy = NACL_ABI_SCHED_KEEP;
+  limits->initial.priority = 0;
+}
+
+int NaClAppSetThreadSchedLimits(struct NaClApp  *nap,
+                                uint64_t        allowed_cpus,
+                                uint32_t        allowed_policies,
+                                int32_t         max_priority) {
+  struct NaClThreadSchedLimits *limits = &nap->thread_sched_limits;
+
+  limits->allowed_cpus = allowed_cpus & NaClThreadSchedHostCpus();
+  limits->allowed_policies = allowed_policies;
+  limits->max_priority = max_priority;
+  NaClLog(2,
+          ("NaClAppSetThreadSchedLimits: cpus 0x%"NACL_PRIx64
+           ", policies 0x%"NACL_PRIx32", max priority %"NACL_PRId32"\n"),
+          limits->allowed_cpus, allowed_policies, max_priority);
+  return 0 == allowed_cpus || 0 != limits->allowed_cpus;
+}
+
+int NaClAppSetInitialThreadSched(struct NaClApp               *nap,
+                                 struct NaClThreadSched const *sched) {
+  struct NaClThreadSchedLimits *limits = &nap->thread_sched_limits;
+
+  if (0 != NaClThreadSchedCheck(limits, sched)) {
+    return 0;
+  }
+  limits->initial = *sched;
+  limits->initial_set = 1;
+  return 1;
+}
+
+int NaClThreadSchedCheck(struct NaClThreadSchedLimits const *limits,
+                         struct NaClThreadSched const       *sched) {
+  if (0 != (sched->cpu_mask & ~limits->allowed_cpus)) {
+    return -NACL_ABI_EPERM;
+  }
+  switch (sched->policy) {
+    case NACL_ABI_SCHED_KEEP:
+      return 0 == sched->priority ? 0 : -NACL_ABI_EINVAL;
+    case NACL_ABI_SCHED_OTHER:
+    case NACL_ABI_SCHED_BATCH:
+    case NACL_ABI_SCHED_IDLE:
+      if (0 != sched->priority) {
+        return -NACL_ABI_EINVAL;
+      }
+      break;
+    case NACL_ABI_SCHED_FIFO:
+    case NACL_ABI_SCHED_RR:
+      if (sched->priority < 1) {
+        return -NACL_ABI_EINVAL;
+      }
+      if (sched->priority > limits->max_priority) {
+        return -NACL_ABI_EPERM;
+      }
+      break;
+    default:
+      return -NACL_ABI_EINVAL;
+  }
+  if (0 == (limits->allowed_policies & (1U << sched->policy))) {
+    return -NACL_ABI_EPERM;
+  }
+  return 0;
+}
+
+void NaClThreadSchedApplyInitial(struct NaClAppThread *natp) {
+  struct NaClThreadSchedLimits const *limits =
+      &natp->nap->thread_sched_limits;
+  int                                result;
+
+  if (!limits->initial_set) {
+    return;
+  }
+  result = NaClThreadSchedSetSelf(&limits->initial);
+  if (0 != result) {
+    NaClLog(LOG_WARNING,
+            "NaClThreadSchedApplyInitial: could not set scheduling: %d\n",
+            result);
+  }
+}
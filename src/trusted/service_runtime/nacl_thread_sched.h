@@ -0,0 +1,82 @@
+/*
+ * Copyright (c) 2013 The Native Client Authors. All rights reserved.
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+/*
+ * CPU affinity and scheduling policy of untrusted threads.
+ *
+ * An untrusted thread may change its own scheduling with the
+ * thread_sched_set syscall, but only within the limits the embedder
+ * sets on its NaClApp.  By default a thread may switch between the
+ * non-realtime policies and may not pin itself to any CPU.
+ */
+
+#ifndef NATIVE_CLIENT_SRC_TRUSTED_SERVICE_RUNTIME_NACL_THREAD_SCHED_H_
+#define NATIVE_CLIENT_SRC_TRUSTED_SERVICE_RUNTIME_NACL_THREAD_SCHED_H_
+
+#include "native_client/src/include/nacl_base.h"
+#include "native_client/src/include/nacl_compiler_annotations.h"
+#include "native_client/src/include/portability.h"
+
+EXTERN_C_BEGIN
+
+struct NaClApp;
+struct NaClAppThread;
+
+struct NaClThreadSched {
+  /* Bit n selects CPU n.  Zero leaves the affinity unchanged. */
+  uint64_t  cpu_mask;
+  /* A NACL_ABI_SCHED_* policy, or NACL_ABI_SCHED_KEEP. */
+  int32_t   policy;
+  /* Must be 0 unless policy is NACL_ABI_SCHED_FIFO or NACL_ABI_SCHED_RR. */
+  int32_t   priority;
+};
+
+struct NaClThreadSchedLimits {
+  /* CPUs that threads may pin themselves to. */
+  uint64_t                allowed_cpus;
+  /* Bit (1 << policy) is set for each policy that threads may use. */
+  uint32_t                allowed_policies;
+  /* Highest priority that threads may use with a realtime policy. */
+  int32_t                 max_priority;
+  /* If initial_set, initial is applied to each thread as it starts. */
+  int                     initial_set;
+  struct NaClThreadSched  initial;
+};
+
+void NaClThreadSchedLimitsCtor(struct NaClThreadSchedLimits *limits);
+
+/*
+ * Sets the limits for nap's threads.  allowed_cpus is
+ * intersected with the CPUs that the host lets this process run on.
+ * This must be called before the app starts running.  Returns 0 if
+ * allowed_cpus is non-zero but none of its CPUs are available.
+ */
+int NaClAppSetThreadSchedLimits(struct NaClApp  *nap,
+                                uint64_t        allowed_cpus,
+                                uint32_t        allowed_policies,
+                                int32_t         max_priority) NACL_WUR;
+
+/*
+ * Sets the scheduling that each of nap's threads starts with.  This
+ * must be called after NaClAppSetThreadSchedLimits() and before the
+ * app starts running.  Returns 0 if sched is outside the limits.
+ */
+int NaClAppSetInitialThreadSched(struct NaClApp               *nap,
+                                 struct NaClThreadSched const *sched) NACL_WUR;
+
+/* Returns 0 if sched is within limits, or else a negated NaCl errno. */
+int NaClThreadSchedCheck(struct NaClThreadSchedLimits const *limits,
+                         struct NaClThreadSched const       *sched);
+
+/*
+ * Applies the app's initial scheduling, if any, to the calling thread,
+ * which must be natp's host thread.
+ */
+void NaClThreadSchedApplyInitial(struct NaClAppThread *natp);
+
+EXTERN_C_END
+
+#endif  /* NATIVE_CLIENT_SRC_TRUSTED_SERVICE_RUNTIME_NACL_THREAD_SCHED_H_ */
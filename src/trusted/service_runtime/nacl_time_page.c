@@ -0,0 +1,446 @@
+/*
+ * Copyright (c) 2013 The Native Client Authors. All rights reserved.
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#include <stdlib.h>
+
+#include "native_client/src/include/nacl_macros.h"
+#include "native_client/src/include/nacl_platform.h"
+#include "native_client/src/include/portability.h"
+#include "native_client/src/shared/platform/nacl_check.h"
+#include "native_client/src/shared/platform/nacl_clock.h"
+#include "native_client/src/shared/platform/nacl_log.h"
+#include "native_client/src/shared/platform/nacl_sync.h"
+#include "native_client/src/shared/platform/nacl_sync_checked.h"
+#include "native_client/src/trusted/desc/nacl_desc_base.h"
+#include "native_client/src/trusted/desc/nacl_desc_effector_trusted_mem.h"
+#include "native_client/src/trusted/desc/nacl_desc_imc_shm.h"
+#include "native_client/src/trusted/service_runtime/include/bits/mman.h"
+#include "native_client/src/trusted/service_runtime/include/sys/errno.h"
+#include "native_client/src/trusted/service_runtime/include/sys/nacl_time_page.h"
+#include "native_client/src/trusted/service_runtime/nacl_syscall_common.h"
+#include "native_client/src/trusted/service_runtime/nacl_time_page.h"
+#include "native_client/src/trusted/service_runtime/sel_ldr.h"
+#include "native_client/src/trusted/service_runtime/sel_memory.h"
+
+#if NACL_ARCH(NACL_BUILD_ARCH) == NACL_x86
+# if NACL_WINDOWS
+#  include <intrin.h>  /* __cpuid, __rdtsc intrinsics */
+# else
+#  include <cpuid.h>   /* __cpuid macro */
+# endif
+#endif
+
+struct NaClTimePageState {
+  /*
+   * Serializes refreshes of the page.  Syscalls read the page without
+   * it, as untrusted code does, unless the page needs a refresh.
+   */
+  struct NaClMutex              mu;
+  struct NaClDesc               *shm;
+  /* The service runtime's writable view of the page. */
+  volatile struct NaClTimePage  *page;
+  uint32_t                      user_addr;
+  /*
+   * The point against which the TSC rate is measured.  Measuring
+   * over an ever longer interval makes the rate ever more accurate.
+   */
+  uint64_t                      calib_tsc;
+  int64_t                       calib_ns;
+};
+
+uint32_t NaClTimePageUserAddr(struct NaClApp *nap) {
+  if (NULL == nap->time_page) {
+    return 0;
+  }
+  return nap->time_page->user_addr;
+}
+
+void NaClTimePageFree(struct NaClApp *nap) {
+  struct NaClTimePageState *state = nap->time_page;
+
+  if (NULL == state) {
+    return;
+  }
+  nap->time_page = NULL;
+  NaClDescUnmapUnsafe(state->shm, (void *) state->page, NACL_MAP_PAGESIZE);
+  NaClDescUnref(state->shm);
+  NaClMutexDtor(&state->mu);
+  free(state);
+}
+
+#if NACL_ARCH(NACL_BUILD_ARCH) == NACL_x86
+
+#define NACL_TIME_PAGE_TSC_SHIFT        32
+/* Minimum interval over which the TSC rate is first measured. */
+#define NACL_TIME_PAGE_CALIBRATION_NS   (10 * NACL_NANOS_PER_MILLI)
+/* How long readers may use the page before a syscall must refresh it. */
+#define NACL_TIME_PAGE_REFRESH_NS       NACL_NANOS_PER_UNIT
+/*
+ * Inaccessible space left between the time page and the bottom of the
+ * initial stack, so that a stack overflow still faults rather than
+ * running into the page.  Linux leaves a similar gap below stacks.
+ */
+#define NACL_TIME_PAGE_STACK_GAP        (16 * NACL_MAP_PAGESIZE)
+
+static void NaClTimePageCpuid(uint32_t op, uint32_t reg[4]) {
+#if NACL_WINDOWS
+  __cpuid((int *) reg, op);
+#else
+  __cpuid(op, reg[0], reg[1], reg[2], reg[3]);
+#endif
+}
+
+/*
+ * An invariant TSC runs at a constant rate in all ACPI P-, C- and
+ * T-states, which is what makes it usable as a clock.
+ */
+static int NaClTimePageHasInvariantTsc(void) {
+  uint32_t reg[4];
+
+  NaClTimePageCpuid(0x80000000, reg);
+  if (reg[0] < 0x80000007) {
+    return 0;
+  }
+  NaClTimePageCpuid(0x80000007, reg);
+  return 0 != (reg[3] & (1 << 8));
+}
+
+static uint64_t NaClTimePageReadTsc(void) {
+#if NACL_WINDOWS
+  return __rdtsc();
+#else
+  uint32_t lo;
+  uint32_t hi;
+
+  __asm__ volatile("rdtsc" : "=a"(lo), "=d"(hi));
+  return ((uint64_t) hi << 32) | lo;
+#endif
+}
+
+static int64_t NaClTimePageTimespecToNs(struct nacl_abi_timespec const *ts) {
+  return (int64_t) ts->tv_sec * NACL_NANOS_PER_UNIT + ts->tv_nsec;
+}
+
+/*
+ * TSC reads on different CPUs may be slightly out of order, so a
+ * value before tsc_base counts as tsc_base.
+ */
+static uint64_t NaClTimePageDelta(volatile struct NaClTimePage *page,
+                                  uint64_t tsc) {
+  return tsc > page->tsc_base ? tsc - page->tsc_base : 0;
+}
+
+/*
+ * Re-reads the host clocks and publishes new parameters.  The page is
+ * left untouched until the TSC rate has been measured over at least
+ * NACL_TIME_PAGE_CALIBRATION_NS.  Caller must hold state->mu.
+ */
+static void NaClTimePageRefresh(struct NaClTimePageState *state) {
+  volatile struct NaClTimePage  *page = state->page;
+  struct nacl_abi_timespec      mono;
+  struct nacl_abi_timespec      real;
+  uint64_t                      tsc;
+  int64_t                       host_mono_ns;
+  int64_t                       host_real_ns;
+  int64_t                       mono_ns;
+  uint64_t                      mult = 0;
+  uint64_t                      max_delta;
+  uint32_t                      flags;
+
+  tsc = NaClTimePageReadTsc();
+  if (0 != NaClClockGetTime(NACL_CLOCK_MONOTONIC, &mono) ||
+      0 != NaClClockGetTime(NACL_CLOCK_REALTIME, &real)) {
+    return;
+  }
+  tsc += (NaClTimePageReadTsc() - tsc) / 2;
+  host_mono_ns = NaClTimePageTimespecToNs(&mono);
+  host_real_ns = NaClTimePageTimespecToNs(&real);
+
+  if (host_mono_ns - state->calib_ns >= NACL_TIME_PAGE_CALIBRATION_NS &&
+      tsc > state->calib_tsc) {
+    mult = (uint64_t) ((double) (host_mono_ns - state->calib_ns)
+                       * (double) (1ULL << NACL_TIME_PAGE_TSC_SHIFT)
+                       / (double) (tsc - state->calib_tsc));
+  }
+
+  mono_ns = host_mono_ns;
+  if (0 != (page->flags & NACL_TIME_PAGE_TSC_VALID)) {
+    uint64_t  old_mult = page->tsc_mult;
+    uint64_t  delta = NaClTimePageDelta(page, tsc);
+    int64_t   prev_ns;
+
+    /*
+     * Readers of the old parameters may have seen times up to this
+     * one, so CLOCK_MONOTONIC must not restart below it.
+     */
+    if (delta > page->tsc_max_delta) {
+      delta = page->tsc_max_delta;
+    }
+    prev_ns = page->monotonic_ns + (int64_t) ((delta * old_mult)
+                                              >> page->tsc_shift);
+    if (prev_ns > mono_ns) {
+      mono_ns = prev_ns;
+    }
+    /*
+     * A large change in the measured rate means that the TSC and the
+     * host clock diverged, e.g. across a host suspend.  Keep the old
+     * rate and restart the measurement from here.
+     */
+    if (0 == mult) {
+      mult = old_mult;
+    } else if (mult > old_mult + (old_mult >> 10) ||
+               mult < old_mult - (old_mult >> 10)) {
+      state->calib_tsc = tsc;
+      state->calib_ns = host_mono_ns;
+      mult = old_mult;
+    }
+  }
+  if (0 == mult) {
+    return;
+  }
+
+  max_delta = (uint64_t) ((double) NACL_TIME_PAGE_REFRESH_NS
+                          * (double) (1ULL << NACL_TIME_PAGE_TSC_SHIFT)
+                          / (double) mult);
+  if (max_delta > NACL_UMAX_VAL(uint64_t) / mult) {
+    max_delta = NACL_UMAX_VAL(uint64_t) / mult;
+  }
+  flags = NACL_TIME_PAGE_TSC_VALID;
+  if (NaClHighResolutionTimerEnabled()) {
+    flags |= NACL_TIME_PAGE_HIGH_RES_TOD;
+  }
+
+  /*
+   * x86 does not reorder stores with other stores, and the page is
+   * accessed through a volatile pointer, so the sequence count is
+   * seen to change before and after the fields.
+   */
+  page->seq++;
+  page->flags = flags;
+  page->tsc_shift = NACL_TIME_PAGE_TSC_SHIFT;
+  page->tsc_base = tsc;
+  page->tsc_mult = mult;
+  page->tsc_max_delta = max_delta;
+  page->monotonic_ns = mono_ns;
+  /* Keep the host's offset between the two clocks. */
+  page->realtime_ns = host_real_ns + (mono_ns - host_mono_ns);
+  page->seq++;
+}
+
+NaClErrorCode NaClTimePageMap(struct NaClApp *nap) {
+  NaClErrorCode             retval = LOAD_NO_MEMORY;
+  struct NaClTimePageState  *state = NULL;
+  struct NaClDescImcShm     *shm = NULL;
+  uintptr_t                 stack_bottom;
+  uintptr_t                 user_addr;
+  uintptr_t                 sys_addr;
+  uintptr_t                 mapping;
+  struct nacl_abi_timespec  now;
+
+  if (!NaClTimePageHasInvariantTsc()) {
+    NaClLog(3, "NaClTimePageMap: no invariant TSC, not mapping time page\n");
+    return LOAD_OK;
+  }
+  stack_bottom = NaClTruncAllocPage(((uintptr_t) 1U << nap->addr_bits)
+                                    - nap->stack_size);
+  if (stack_bottom < NACL_TIME_PAGE_STACK_GAP + NACL_MAP_PAGESIZE) {
+    NaClLog(3, "NaClTimePageMap: no room below the stack for time page\n");
+    return LOAD_OK;
+  }
+  user_addr = stack_bottom - NACL_TIME_PAGE_STACK_GAP - NACL_MAP_PAGESIZE;
+  if (NaClRoundAllocPage(nap->break_addr) > user_addr) {
+    NaClLog(3, "NaClTimePageMap: no room below the stack for time page\n");
+    return LOAD_OK;
+  }
+
+  state = (struct NaClTimePageState *) malloc(sizeof *state);
+  if (NULL == state) {
+    goto cleanup;
+  }
+  if (!NaClMutexCtor(&state->mu)) {
+    free(state);
+    state = NULL;
+    goto cleanup;
+  }
+  shm = (struct NaClDescImcShm *) malloc(sizeof *shm);
+  if (NULL == shm) {
+    goto cleanup;
+  }
+  if (!NaClDescImcShmAllocCtor(shm, NACL_MAP_PAGESIZE, /* executable= */ 0)) {
+    /* cleanup invariant is if ptr is non-NULL, it's fully ctor'd */
+    free(shm);
+    shm = NULL;
+    goto cleanup;
+  }
+
+  mapping = (*NACL_VTBL(NaClDesc, shm)->Map)((struct NaClDesc *) shm,
+                                            NaClDescEffectorTrustedMem(),
+                                            NULL,
+                                            NACL_MAP_PAGESIZE,
+                                            (NACL_ABI_PROT_READ
+                                             | NACL_ABI_PROT_WRITE),
+                                            NACL_ABI_MAP_SHARED,
+                                            0);
+  if (NaClPtrIsNegErrno(&mapping)) {
+    NaClLog(LOG_ERROR, "NaClTimePageMap: could not map time page\n");
+    goto cleanup;
+  }
+  state->page = (volatile struct NaClTimePage *) mapping;
+
+  /* Existing memory is anonymous paging file backed. */
+  sys_addr = NaClUserToSys(nap, user_addr);
+  NaClPageFree((void *) sys_addr, NACL_MAP_PAGESIZE);
+  if (sys_addr != (*NACL_VTBL(NaClDesc, shm)->Map)(
+          (struct NaClDesc *) shm,
+          NaClDescEffectorTrustedMem(),
+          (void *) sys_addr,
+          NACL_MAP_PAGESIZE,
+          NACL_ABI_PROT_READ,
+          NACL_ABI_MAP_SHARED | NACL_ABI_MAP_FIXED,
+          0)) {
+    NaClLog(LOG_FATAL, "NaClTimePageMap: could not map in time page\n");
+  }
+  /*
+   * The shm desc has no O_ACCMODE flags, so NaClVmmapEntryMaxProt
+   * treats the mapping as read-only and mprotect cannot make it
+   * writable.
+   */
+  NaClVmmapAdd(&nap->mem_map,
+               user_addr >> NACL_PAGESHIFT,
+               NACL_MAP_PAGESIZE >> NACL_PAGESHIFT,
+               NACL_ABI_PROT_READ,
+               NACL_ABI_MAP_SHARED,
+               (struct NaClDesc *) shm,
+               0,
+               NACL_MAP_PAGESIZE);
+
+  state->page->version = NACL_TIME_PAGE_VERSION;
+  state->page->seq = 0;
+  state->page->flags = 0;
+  state->shm = (struct NaClDesc *) shm;
+  state->user_addr = (uint32_t) user_addr;
+
+  /*
+   * Start measuring the TSC rate now; by the time the first clock
+   * syscall refreshes the page, loading will usually have taken long
+   * enough for a usable measurement.
+   */
+  state->calib_tsc = NaClTimePageReadTsc();
+  state->calib_ns = 0;
+  if (0 == NaClClockGetTime(NACL_CLOCK_MONOTONIC, &now)) {
+    state->calib_ns = NaClTimePageTimespecToNs(&now);
+  }
+
+  NaClLog(3, "NaClTimePageMap: time page at user address 0x%08"NACL_PRIxPTR
+          "\n", user_addr);
+  nap->time_page = state;
+  return LOAD_OK;
+
+ cleanup:
+  NaClDescSafeUnref((struct NaClDesc *) shm);
+  if (NULL != state) {
+    NaClMutexDtor(&state->mu);
+    free(state);
+  }
+  return retval;
+}
+
+/*
+ * Reads clk_id from the page without taking state->mu, following the
+ * protocol in include/sys/nacl_time_page.h.  Returns 0 if the page is
+ * being refreshed, is not valid yet, or is stale.
+ */
+static int NaClTimePageTryRead(volatile struct NaClTimePage *page,
+                               nacl_clockid_t               clk_id,
+                               int64_t                      *ns) {
+  uint32_t  seq;
+  uint32_t  flags;
+  uint32_t  shift;
+  uint64_t  mult;
+  uint64_t  max_delta;
+  uint64_t  delta;
+  int64_t   base_ns;
+
+  seq = page->seq;
+  if (0 != (seq & 1)) {
+    return 0;
+  }
+  flags = page->flags;
+  shift = page->tsc_shift;
+  mult = page->tsc_mult;
+  max_delta = page->tsc_max_delta;
+  base_ns = (NACL_CLOCK_REALTIME == clk_id) ? page->realtime_ns
+                                            : page->monotonic_ns;
+  delta = NaClTimePageDelta(page, NaClTimePageReadTsc());
+  if (seq != page->seq ||
+      0 == (flags & NACL_TIME_PAGE_TSC_VALID) ||
+      delta > max_delta) {
+    return 0;
+  }
+  *ns = base_ns + (int64_t) ((delta * mult) >> shift);
+  return 1;
+}
+
+int NaClTimePageGetTime(struct NaClApp            *nap,
+                        nacl_clockid_t            clk_id,
+                        struct nacl_abi_timespec  *tp) {
+  struct NaClTimePageState      *state = nap->time_page;
+  volatile struct NaClTimePage  *page;
+  uint64_t                      delta;
+  int64_t                       ns;
+
+  if (NULL == state ||
+      (NACL_CLOCK_REALTIME != clk_id && NACL_CLOCK_MONOTONIC != clk_id)) {
+    return -NACL_ABI_ENOSYS;
+  }
+  page = state->page;
+
+  if (!NaClTimePageTryRead(page, clk_id, &ns)) {
+    /*
+     * Only refreshes take the lock, so once it is held the page is
+     * stable.  If another thread was refreshing it, this waits for
+     * that refresh instead of starting another one.
+     */
+    NaClXMutexLock(&state->mu);
+    if (0 == (page->flags & NACL_TIME_PAGE_TSC_VALID) ||
+        NaClTimePageDelta(page, NaClTimePageReadTsc()) > page->tsc_max_delta) {
+      NaClTimePageRefresh(state);
+    }
+    if (0 == (page->flags & NACL_TIME_PAGE_TSC_VALID)) {
+      NaClXMutexUnlock(&state->mu);
+      return -NACL_ABI_ENOSYS;
+    }
+    delta = NaClTimePageDelta(page, NaClTimePageReadTsc());
+    if (delta > page->tsc_max_delta) {
+      delta = page->tsc_max_delta;
+    }
+    ns = (NACL_CLOCK_REALTIME == clk_id) ? page->realtime_ns
+                                         : page->monotonic_ns;
+    ns += (int64_t) ((delta * page->tsc_mult) >> page->tsc_shift);
+    NaClXMutexUnlock(&state->mu);
+  }
+  tp->tv_sec = (nacl_abi_time_t) (ns / NACL_NANOS_PER_UNIT);
+  tp->tv_nsec = (int32_t) (ns % NACL_NANOS_PER_UNIT);
+  return 0;
+}
+
+#else  /* NACL_ARCH(NACL_BUILD_ARCH) == NACL_x86 */
+
+NaClErrorCode NaClTimePageMap(struct NaClApp *nap) {
+  UNREFERENCED_PARAMETER(nap);
+  return LOAD_OK;
+}
+
+int NaClTimePageGetTime(struct NaClApp            *nap,
+                        nacl_clockid_t            clk_id,
+                        struct nacl_abi_timespec  *tp) {
+  UNREFERENCED_PARAMETER(nap);
+  UNREFERENCED_PARAMETER(clk_id);
+  UNREFERENCED_PARAMETER(tp);
+  return -NACL_ABI_ENOSYS;
+}
+
+#endif  /* NACL_ARCH(NACL_BUILD_ARCH) == NACL_x86 */
@@ -0,0 +1,64 @@
+/*
+ * Copyright (c) 2013 The Native Client Authors. All rights reserved.
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#ifndef NATIVE_CLIENT_SRC_TRUSTED_SERVICE_RUNTIME_NACL_TIME_PAGE_H_
+#define NATIVE_CLIENT_SRC_TRUSTED_SERVICE_RUNTIME_NACL_TIME_PAGE_H_
+
+#include "native_client/src/include/portability.h"
+#include "native_client/src/include/nacl_compiler_annotations.h"
+#include "native_client/src/shared/platform/nacl_clock.h"
+#include "native_client/src/trusted/service_runtime/nacl_error_code.h"
+
+EXTERN_C_BEGIN
+
+struct NaClApp;
+struct nacl_abi_timespec;
+
+/*
+ * Maps the read-only time page (see include/sys/nacl_time_page.h)
+ * into untrusted address space, below the initial stack.  The page is
+ * placed NACL_TIME_PAGE_STACK_GAP (1MB with 64KB pages) below the
+ * stack, so that the inaccessible memory there still catches stack
+ * overflows; the page and the gap are taken from the top of the brk
+ * range.  The page is backed by shared memory, and the service runtime
+ * writes it through a second, trusted mapping, so untrusted code
+ * unmapping or mapping over its view cannot affect the service
+ * runtime.
+ *
+ * The page is only usable on x86 hosts with an invariant TSC; on other
+ * hosts, or if the data segment reaches up to the stack, no page is
+ * mapped, nap->time_page stays NULL, and LOAD_OK is returned.
+ */
+NaClErrorCode NaClTimePageMap(struct NaClApp *nap) NACL_WUR;
+
+/*
+ * Returns the untrusted address of the time page, or 0 if there is
+ * none.
+ */
+uint32_t NaClTimePageUserAddr(struct NaClApp *nap);
+
+/*
+ * Releases the service runtime's view of the time page and its other
+ * state.  The untrusted view goes away with the address space.  No
+ * untrusted thread may be running.
+ */
+void NaClTimePageFree(struct NaClApp *nap);
+
+/*
+ * Reads CLOCK_REALTIME or CLOCK_MONOTONIC from the time page, first
+ * refreshing the page if its parameters are stale, so that results
+ * from syscalls agree with results computed by untrusted readers of
+ * the page.  Returns 0 on success, or -NACL_ABI_ENOSYS if the page is
+ * not in use (yet) for clk_id and the caller should read the host
+ * clock instead.
+ */
+int NaClTimePageGetTime(struct NaClApp            *nap,
+                        nacl_clockid_t            clk_id,
+                        struct nacl_abi_timespec  *tp);
+
+EXTERN_C_END
+
+#endif  /* NATIVE_CLIENT_SRC_TRUSTED_SERVICE_RUNTIME_NACL_TIME_PAGE_H_ */
@@ -6,6 +6,8 @@
 
 #include <string.h>
 
+#include "native_client/src/include/atomic_ops.h"
+#include "native_client/src/include/concurrency_ops.h"
 #include "native_client/src/include/portability.h"
 #include "native_client/src/include/portability_string.h"
 
@@ -16,6 +18,7 @@
 #include "native_client/src/shared/platform/nacl_log.h"
 #include "native_client/src/shared/platform/nacl_sync.h"
 #include "native_client/src/shared/platform/nacl_sync_checked.h"
+#include "native_client/src/shared/platform/nacl_threads.h"
 
 #include "native_client/src/shared/srpc/nacl_srpc.h"
 
@@ -33,15 +36,19 @@
 
 
 /*
- * Name service is a linear linked list.  We could use a hash
- * container eventually, but performance is not a goal for this simple
- * bootstrap name service.  Static entry and factory-based generation
+ * Name service entries are kept on a doubly linked list, newest
+ * first, which gives the enumeration order, and in an open-addressed
+ * hash table for lookup.  Static entry and factory-based generation
  * are mutually exclusive; the |factory| function is used iff |entry|
- * is NULL.  Client code is expected to cache lookup results.
+ * is NULL.  Client code is expected to cache lookup results, but
+ * lookups are cheap and do not contend with each other: see the
+ * comment in name_service.h.
  */
 struct NaClNameServiceEntry {
   struct NaClNameServiceEntry *next;
+  struct NaClNameServiceEntry *prev;
   char const                  *name;
+  uint32_t                    hash;
   int                         mode;
   struct NaClDesc             *entry;  /* static entry, or, ... */
 
@@ -49,9 +56,163 @@ struct NaClNameServiceEntry {
   void                        *state;
 };
 
+/*
+ * Linear probing table of entries.  A probe sequence ends at a NULL
+ * slot; deleted entries leave a tombstone so that later entries on
+ * the same sequence stay reachable.  Slots only go from NULL to an
+ * entry, or from an entry to a tombstone, while a table is published,
+ * so a lookup racing with a change sees either the old or the new
+ * contents of each slot.  The table is rebuilt when it is half full,
+ * counting tombstones, so every probe sequence ends.
+ */
+struct NaClNameServiceTable {
+  uint32_t                              mask;  /* size - 1 */
+  uint32_t                              live;
+  uint32_t                              used;  /* live + tombstones */
+  struct NaClNameServiceEntry *volatile *slots;
+};
+
+#define NACL_NAME_SERVICE_MIN_TABLE_SIZE 16
+/* Keeps the slot array well below SIZE_T_MAX bytes on 32-bit hosts too. */
+#define NACL_NAME_SERVICE_MAX_TABLE_SIZE (1U << 24)
+
+static struct NaClNameServiceEntry gNaClNameServiceTombstone;
+
 struct NaClSrpcHandlerDesc const kNaClNameServiceHandlers[];
 /* fwd */
 
+/* FNV-1a, as for SRPC method signatures. */
+static uint32_t NameServiceHash(char const *name) {
+  uint32_t hash = 2166136261U;
+  unsigned char const *p;
+
+  for (p = (unsigned char const *) name; '\0' != *p; ++p) {
+    hash ^= *p;
+    hash *= 16777619U;
+  }
+  return hash;
+}
+
+static struct NaClNameServiceTable *NameServiceTableMake(uint32_t size) {
+  struct NaClNameServiceTable *table;
+
+  if (size > NACL_NAME_SERVICE_MAX_TABLE_SIZE) {
+    return NULL;
+  }
+  table = (struct NaClNameServiceTable *) malloc(sizeof *table +
+                                                 size * sizeof *table->slots);
+  if (NULL == table) {
+    return NULL;
+  }
+  table->mask = size - 1;
+  table->live = 0;
+  table->used = 0;
+  table->slots = (struct NaClNameServiceEntry *volatile *) (table + 1);
+  memset((void *) table->slots, 0, size * sizeof *table->slots);
+  return table;
+}
+
+/*
+ * Returns the slot holding |name|, or if it is absent, the NULL slot
+ * ending its probe sequence.
+ */
+static struct NaClNameServiceEntry *volatile *NameServiceSearch(
+    struct NaClNameServiceTable *table,
+    char const                  *name,
+    uint32_t                    hash) {
+  uint32_t                    index;
+  struct NaClNameServiceEntry *p;
+
+  for (index = hash & table->mask; ; index = (index + 1) & table->mask) {
+    p = table->slots[index];
+    if (NULL == p) {
+      break;
+    }
+    if (&gNaClNameServiceTombstone != p && hash == p->hash &&
+        0 == strcmp(p->name, name)) {
+      break;
+    }
+  }
+  return &table->slots[index];
+}
+
+/*
+ * Enters a read-side critical section, in which entries found in
+ * |nnsp->table| stay valid.  Returns the epoch to pass to
+ * NameServiceReadEnd.  The atomic operations used here and in
+ * NameServiceSynchronize are full barriers in every implementation.
+ */
+static Atomic32 NameServiceReadBegin(struct NaClNameService *nnsp) {
+  Atomic32 epoch;
+
+  for (;;) {
+    epoch = nnsp->reader_epoch;
+    AtomicIncrement(&nnsp->readers[epoch], 1);
+    /*
+     * If the epoch changed before we were counted, a writer may
+     * already have stopped waiting for it.
+     */
+    if (epoch == nnsp->reader_epoch) {
+      return epoch;
+    }
+    AtomicIncrement(&nnsp->readers[epoch], -1);
+  }
+}
+
+static void NameServiceReadEnd(struct NaClNameService *nnsp, Atomic32 epoch) {
+  AtomicIncrement(&nnsp->readers[epoch], -1);
+}
+
+/*
+ * Waits until no lookup can still see anything unpublished before
+ * the call.  Must be called with |nnsp->mu| held.  Lookups are short
+ * and never block, so this does not wait long.
+ */
+static void NameServiceSynchronize(struct NaClNameService *nnsp) {
+  Atomic32 old_epoch = nnsp->reader_epoch;
+
+  (void) AtomicExchange(&nnsp->reader_epoch, 1 - old_epoch);
+  while (0 != nnsp->readers[old_epoch]) {
+    NaClThreadYield();
+  }
+}
+
+/*
+ * Makes room for one more entry in |nnsp->table|, rebuilding it if
+ * needed.  Must be called with |nnsp->mu| held.  Returns 0 if there
+ * is no room and no memory to rebuild the table.
+ */
+static int NameServiceReserve(struct NaClNameService *nnsp) {
+  struct NaClNameServiceTable *old_table = nnsp->table;
+  struct NaClNameServiceTable *new_table;
+  struct NaClNameServiceEntry *p;
+  uint32_t                    size = NACL_NAME_SERVICE_MIN_TABLE_SIZE;
+
+  if (2 * (old_table->used + 1) <= old_table->mask + 1) {
+    return 1;
+  }
+  /* Leave the new table at most a quarter full. */
+  while (size < 4 * (old_table->live + 1)) {
+    size *= 2;
+  }
+  new_table = NameServiceTableMake(size);
+  if (NULL == new_table) {
+    /* Use up the slack rather than fail, keeping one NULL slot. */
+    return old_table->used + 2 <= old_table->mask + 1;
+  }
+  for (p = nnsp->head; NULL != p; p = p->next) {
+    *NameServiceSearch(new_table, p->name, p->hash) = p;
+  }
+  new_table->live = old_table->live;
+  new_table->used = old_table->live;
+
+  NaClWriteMemoryBarrier();
+  nnsp->table = new_table;
+  NameServiceSynchronize(nnsp);
+  free(old_table);
+  return 1;
+}
+
 int NaClNameServiceCtor(struct NaClNameService      *self,
                         NaClThreadIfFactoryFunction thread_factory_fn,
                         void                        *thread_factory_data) {
@@ -66,6 +227,11 @@ int NaClNameServiceCtor(struct NaClNameService      *self,
     NaClLog(4, "NaClSimpleLtdServiceCtor failed\n");
     goto done;
   }
+  self->table = NameServiceTableMake(NACL_NAME_SERVICE_MIN_TABLE_SIZE);
+  if (NULL == self->table) {
+    NaClLog(4, "NameServiceTableMake failed\n");
+    goto abort_table;
+  }
   if (!NaClMutexCtor(&self->mu)) {
     NaClLog(4, "NaClMutexCtor failed\n");
     goto abort_mu;
@@ -74,11 +240,16 @@ int NaClNameServiceCtor(struct NaClNameService      *self,
       &kNaClNameServiceVtbl;
   /* success return path */
   self->head = (struct NaClNameServiceEntry *) NULL;
+  self->readers[0] = 0;
+  self->readers[1] = 0;
+  self->reader_epoch = 0;
   retval = 1;
   goto done;
 
   /* cleanup unwind */
  abort_mu:  /* mutex ctor failed */
+  free(self->table);
+ abort_table:
   (*NACL_VTBL(NaClRefCount, self)->Dtor)((struct NaClRefCount *) self);
  done:
   return retval;
@@ -100,23 +271,57 @@ void NaClNameServiceDtor(struct NaClRefCount *vself) {
        */
       (void) (*p->factory)(p->state, p->name, 0, (struct NaClDesc **) NULL);
     }
+    free((void *) p->name);
     free(p);
   }
+  free(self->table);
   NaClMutexDtor(&self->mu);
   NACL_VTBL(NaClRefCount, self) = (struct NaClRefCountVtbl *)
       &kNaClSimpleLtdServiceVtbl;
   (*NACL_VTBL(NaClRefCount, self)->Dtor)((struct NaClRefCount *) self);
 }
 
-static struct NaClNameServiceEntry **NameServiceSearch(
-    struct NaClNameServiceEntry **hd,
-    char const                  *name) {
-  while (NULL != *hd && 0 != strcmp((*hd)->name, name)) {
-    hd = &(*hd)->next;
+/*
+ * Enters |name_entry|, whose name and contents are already filled
+ * in, unless its name is taken.  Takes ownership of |name_entry| on
+ * success.
+ */
+static int NameServiceInsert(struct NaClNameService      *nnsp,
+                             struct NaClNameServiceEntry *name_entry) {
+  struct NaClNameServiceEntry *volatile *slot;
+  int                                   retval;
+
+  name_entry->hash = NameServiceHash(name_entry->name);
+
+  NaClXMutexLock(&nnsp->mu);
+  if (NULL != *NameServiceSearch(nnsp->table, name_entry->name,
+                                 name_entry->hash)) {
+    retval = NACL_NAME_SERVICE_DUPLICATE_NAME;
+    goto unlock;
   }
-  return hd;
-}
+  if (!NameServiceReserve(nnsp)) {
+    retval = NACL_NAME_SERVICE_INSUFFICIENT_RESOURCES;
+    goto unlock;
+  }
+  name_entry->prev = NULL;
+  name_entry->next = nnsp->head;
+  if (NULL != nnsp->head) {
+    nnsp->head->prev = name_entry;
+  }
+  nnsp->head = name_entry;
 
+  /* Publish the entry only once it is complete. */
+  slot = NameServiceSearch(nnsp->table, name_entry->name, name_entry->hash);
+  NaClWriteMemoryBarrier();
+  *slot = name_entry;
+  ++nnsp->table->live;
+  ++nnsp->table->used;
+  retval = NACL_NAME_SERVICE_SUCCESS;
+
+ unlock:
+  NaClXMutexUnlock(&nnsp->mu);
+  return retval;
+}
 
 int NaClNameServiceCreateDescEntry(
     struct NaClNameService  *nnsp,
@@ -125,7 +330,6 @@ int NaClNameServiceCreateDescEntry(
     struct NaClDesc         *new_desc) {
   int                         retval = NACL_NAME_SERVICE_INSUFFICIENT_RESOURCES;
   struct NaClNameServiceEntry *name_entry = NULL;
-  struct NaClNameServiceEntry *found = NULL;
   char                        *dup_name = STRDUP(name);
 
   NaClLog(3,
@@ -145,25 +349,17 @@ int NaClNameServiceCreateDescEntry(
     goto entry_alloc_failed;
   }
 
-  NaClXMutexLock(&nnsp->mu);
-  found = *NameServiceSearch(&nnsp->head, name);
-  if (NULL != found) {
-    retval = NACL_NAME_SERVICE_DUPLICATE_NAME;
-    goto unlock_and_cleanup;
-  }
-  name_entry->next = nnsp->head;
   name_entry->name = dup_name;
-  dup_name = (char *) NULL;
   name_entry->mode = mode;
   name_entry->entry = new_desc;
   name_entry->factory = (NaClNameServiceFactoryFn_t) NULL;
   name_entry->state = (void *) NULL;
-  nnsp->head = name_entry;
-  name_entry = NULL;
-  retval = NACL_NAME_SERVICE_SUCCESS;
+  retval = NameServiceInsert(nnsp, name_entry);
+  if (NACL_NAME_SERVICE_SUCCESS == retval) {
+    name_entry = NULL;
+    dup_name = NULL;
+  }
 
- unlock_and_cleanup:
-  NaClXMutexUnlock(&nnsp->mu);
   free(name_entry);
  entry_alloc_failed:
   free(dup_name);
@@ -178,7 +374,6 @@ int NaClNameServiceCreateFactoryEntry(
     void                        *factory_state) {
   int                         retval = NACL_NAME_SERVICE_INSUFFICIENT_RESOURCES;
   struct NaClNameServiceEntry *name_entry = NULL;
-  struct NaClNameServiceEntry *found = NULL;
   char                        *dup_name = STRDUP(name);
 
   NaClLog(3,
@@ -200,24 +395,17 @@ int NaClNameServiceCreateFactoryEntry(
     goto entry_alloc_failed;
   }
 
-  NaClXMutexLock(&nnsp->mu);
-  found = *NameServiceSearch(&nnsp->head, name);
-  if (NULL != found) {
-    retval = NACL_NAME_SERVICE_DUPLICATE_NAME;
-    goto unlock_and_cleanup;
-  }
-  name_entry->next = nnsp->head;
   name_entry->name = dup_name;
-  dup_name = (char *) NULL;
+  name_entry->mode = 0;
   name_entry->entry = (struct NaClDesc *) NULL;
   name_entry->factory = factory_fn;
   name_entry->state = factory_state;
-  nnsp->head = name_entry;
-  name_entry = NULL;
-  retval = NACL_NAME_SERVICE_SUCCESS;
+  retval = NameServiceInsert(nnsp, name_entry);
+  if (NACL_NAME_SERVICE_SUCCESS == retval) {
+    name_entry = NULL;
+    dup_name = NULL;
+  }
 
- unlock_and_cleanup:
-  NaClXMutexUnlock(&nnsp->mu);
   free(name_entry);
  entry_alloc_failed:
   free(dup_name);
@@ -225,11 +413,63 @@ int NaClNameServiceCreateFactoryEntry(
   return retval;
 }
 
+/*
+ * Resolves a static entry.  Does not block, so it may be called
+ * without |nnsp->mu|.
+ */
+static int NameServiceResolveDescEntry(struct NaClNameServiceEntry  *nnsep,
+                                       char const                   *name,
+                                       int                          flags,
+                                       struct NaClDesc              **out) {
+  NaClLog(3,
+          "NaClNameServiceResolveName: found %s, mode %d (0x%x)\n",
+          name,
+          nnsep->mode, nnsep->mode);
+  /* check flags against nnsep->mode */
+  NaClLog(4,
+          ("NaClNameServiceResolveName: checking mode/flags"
+           " compatibility\n"));
+  switch (flags) {
+    case NACL_ABI_O_RDONLY:
+      if (NACL_ABI_O_WRONLY == nnsep->mode) {
+        NaClLog(4,
+                "NaClNameServiceResolveName: incompatible,"
+                " not readable\n");
+        return NACL_NAME_SERVICE_PERMISSION_DENIED;
+      }
+      break;
+    case NACL_ABI_O_WRONLY:
+      if (NACL_ABI_O_RDONLY == nnsep->mode) {
+        NaClLog(4,
+                "NaClNameServiceResolveName: incompatible,"
+                " not writeable\n");
+        return NACL_NAME_SERVICE_PERMISSION_DENIED;
+      }
+      break;
+    case NACL_ABI_O_RDWR:
+      if (NACL_ABI_O_RDWR != nnsep->mode) {
+        NaClLog(4, "NaClNameServiceResolveName: incompatible,"
+                " not for both read and write\n");
+        return NACL_NAME_SERVICE_PERMISSION_DENIED;
+      }
+      break;
+    default:
+      NaClLog(4, "NaClNameServiceResolveName: invalid flag\n");
+      return NACL_NAME_SERVICE_INVALID_ARGUMENT;
+  }
+  NaClLog(4, "NaClNameServiceResolveName: mode and flags are compatible\n");
+  *out = NaClDescRef(nnsep->entry);
+  return NACL_NAME_SERVICE_SUCCESS;
+}
+
 int NaClNameServiceResolveName(struct NaClNameService  *nnsp,
                                char const              *name,
                                int                     flags,
                                struct NaClDesc         **out) {
   struct NaClNameServiceEntry *nnsep;
+  uint32_t                    hash;
+  Atomic32                    epoch;
+  int                         is_factory = 0;
   int                         status = NACL_NAME_SERVICE_NAME_NOT_FOUND;
 
   NaClLog(3,
@@ -242,75 +482,60 @@ int NaClNameServiceResolveName(struct NaClNameService  *nnsp,
     goto quit;
   }
 
-  NaClXMutexLock(&nnsp->mu);
-  nnsep = *NameServiceSearch(&nnsp->head, name);
+  hash = NameServiceHash(name);
+  epoch = NameServiceReadBegin(nnsp);
+  nnsep = *NameServiceSearch(nnsp->table, name, hash);
   if (NULL != nnsep) {
     if (NULL != nnsep->entry) {
-      NaClLog(3,
-              "NaClNameServiceResolveName: found %s, mode %d (0x%x)\n",
-              name,
-              nnsep->mode, nnsep->mode);
-      /* check flags against nnsep->mode */
-      NaClLog(4,
-              ("NaClNameServiceResolveName: checking mode/flags"
-               " compatibility\n"));
-      switch (flags) {
-        case NACL_ABI_O_RDONLY:
-          if (NACL_ABI_O_WRONLY == nnsep->mode) {
-            status = NACL_NAME_SERVICE_PERMISSION_DENIED;
-            NaClLog(4,
-                    "NaClNameServiceResolveName: incompatible,"
-                    " not readable\n");
-            goto unlock_and_quit;
-          }
-          break;
-        case NACL_ABI_O_WRONLY:
-          if (NACL_ABI_O_RDONLY == nnsep->mode) {
-            status = NACL_NAME_SERVICE_PERMISSION_DENIED;
-            NaClLog(4,
-                    "NaClNameServiceResolveName: incompatible,"
-                    " not writeable\n");
-            goto unlock_and_quit;
-          }
-          break;
-        case NACL_ABI_O_RDWR:
-          if (NACL_ABI_O_RDWR != nnsep->mode) {
-            status = NACL_NAME_SERVICE_PERMISSION_DENIED;
-            NaClLog(4, "NaClNameServiceResolveName: incompatible,"
-                    " not for both read and write\n");
-            goto unlock_and_quit;
-          }
-          break;
-        default:
-          status = NACL_NAME_SERVICE_INVALID_ARGUMENT;
-          NaClLog(4, "NaClNameServiceResolveName: invalid flag\n");
-          goto unlock_and_quit;
-      }
-      NaClLog(4, "NaClNameServiceResolveName: mode and flags are compatible\n");
-      *out = NaClDescRef(nnsep->entry);
-      status = NACL_NAME_SERVICE_SUCCESS;
+      status = NameServiceResolveDescEntry(nnsep, name, flags, out);
+    } else {
+      is_factory = 1;
+    }
+  }
+  NameServiceReadEnd(nnsp, epoch);
+
+  /*
+   * Factories are called with |mu| held, so that they are not called
+   * concurrently or after their entry is deleted.
+   */
+  if (is_factory) {
+    NaClXMutexLock(&nnsp->mu);
+    nnsep = *NameServiceSearch(nnsp->table, name, hash);
+    if (NULL == nnsep) {
+      status = NACL_NAME_SERVICE_NAME_NOT_FOUND;
+    } else if (NULL != nnsep->entry) {
+      status = NameServiceResolveDescEntry(nnsep, name, flags, out);
     } else {
       status = (*nnsep->factory)(nnsep->state, name, flags, out);
     }
+    NaClXMutexUnlock(&nnsp->mu);
   }
- unlock_and_quit:
-  nnsep = NULL;
-  NaClXMutexUnlock(&nnsp->mu);
  quit:
   return status;
 }
 
 int NaClNameServiceDeleteName(struct NaClNameService *nnsp,
                               char const             *name) {
-  struct NaClNameServiceEntry **nnsepp;
+  struct NaClNameServiceEntry *volatile *slot;
   struct NaClNameServiceEntry *to_free = NULL;
   int                         status = NACL_NAME_SERVICE_NAME_NOT_FOUND;
 
   NaClXMutexLock(&nnsp->mu);
-  nnsepp = NameServiceSearch(&nnsp->head, name);
-  if (NULL != *nnsepp) {
-    to_free = *nnsepp;
-    *nnsepp = to_free->next;
+  slot = NameServiceSearch(nnsp->table, name, NameServiceHash(name));
+  if (NULL != *slot) {
+    to_free = *slot;
+    *slot = &gNaClNameServiceTombstone;
+    --nnsp->table->live;
+    if (NULL != to_free->prev) {
+      to_free->prev->next = to_free->next;
+    } else {
+      nnsp->head = to_free->next;
+    }
+    if (NULL != to_free->next) {
+      to_free->next->prev = to_free->prev;
+    }
+    /* Lookups that found the entry may still be using it. */
+    NameServiceSynchronize(nnsp);
     status = NACL_NAME_SERVICE_SUCCESS;
   }
   NaClXMutexUnlock(&nnsp->mu);
@@ -7,6 +7,7 @@
 #ifndef NATIVE_CLIENT_SRC_TRUSTED_SERVICE_RUNTIME_NAME_SERVICE_NAME_SERVICE_H_
 #define NATIVE_CLIENT_SRC_TRUSTED_SERVICE_RUNTIME_NAME_SERVICE_NAME_SERVICE_H_
 
+#include "native_client/src/include/atomic_ops.h"
 #include "native_client/src/include/nacl_base.h"
 #include "native_client/src/include/portability.h"
 
@@ -38,15 +39,26 @@ EXTERN_C_BEGIN
  */
 
 struct NaClNameServiceEntry;  /* fwd */
+struct NaClNameServiceTable;  /* fwd */
 
 struct NaClNameService {
   struct NaClSimpleLtdService base NACL_IS_REFCOUNT_SUBCLASS;
 
   struct NaClMutex            mu;
   /*
-   * |mu| protects the service entries hanging off of |head|.
+   * |mu| serializes changes to the service entries.  They hang off of
+   * |head|, newest first, which gives the enumeration order, and are
+   * indexed by name in |table|.
+   *
+   * Lookups do not take |mu|.  Instead they count themselves in
+   * |readers|[|reader_epoch|] while using |table|, and writers wait
+   * for the readers of the previous epoch to finish before freeing a
+   * table or an entry that lookups might still see.
    */
-  struct NaClNameServiceEntry *head;
+  struct NaClNameServiceEntry           *head;
+  struct NaClNameServiceTable *volatile table;
+  volatile Atomic32                     readers[2];
+  volatile Atomic32                     reader_epoch;
 };
 
 int NaClNameServiceCtor(struct NaClNameService      *self,
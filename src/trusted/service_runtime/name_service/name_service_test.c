@@ -0,0 +1,238 @@
+/*
+ * Copyright (c) 2013 The Native Client Authors. All rights reserved.
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+/*
+ * Tests the name service's table of entries, and measures resolve
+ * throughput with many entries and threads while other names are
+ * being inserted and deleted.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "native_client/src/include/atomic_ops.h"
+#include "native_client/src/include/nacl_assert.h"
+#include "native_client/src/include/nacl_macros.h"
+#include "native_client/src/include/portability.h"
+#include "native_client/src/include/portability_io.h"
+
+#include "native_client/src/public/name_service.h"
+
+#include "native_client/src/shared/platform/nacl_log.h"
+#include "native_client/src/shared/platform/nacl_threads.h"
+#include "native_client/src/shared/platform/nacl_time.h"
+
+#include "native_client/src/trusted/desc/nacl_desc_null.h"
+#include "native_client/src/trusted/service_runtime/include/sys/fcntl.h"
+#include "native_client/src/trusted/service_runtime/nacl_all_modules.h"
+#include "native_client/src/trusted/service_runtime/name_service/name_service.h"
+#include "native_client/src/trusted/threading/nacl_thread_interface.h"
+
+#define kNumEntries 10000
+#define kNumThreads 8
+#define kLookupsPerThread 200000
+#define kNameLength 32
+
+static struct NaClNameService *g_ns;
+static volatile Atomic32 g_readers_running;
+static int g_factory_calls;
+static int g_factory_deletes;
+
+static void EntryName(char *buf, char const *prefix, int index) {
+  SNPRINTF(buf, kNameLength, "%s_%d", prefix, index);
+}
+
+static struct NaClDesc *MakeDesc(void) {
+  struct NaClDescNull *desc = (struct NaClDescNull *) malloc(sizeof *desc);
+
+  ASSERT_NE(desc, NULL);
+  ASSERT(NaClDescNullCtor(desc));
+  return (struct NaClDesc *) desc;
+}
+
+static int Resolve(char const *name, int flags) {
+  struct NaClDesc *desc;
+  int status = NaClNameServiceResolveName(g_ns, name, flags, &desc);
+
+  if (NACL_NAME_SERVICE_SUCCESS == status) {
+    NaClDescUnref(desc);
+  }
+  return status;
+}
+
+static int CountingFactory(void *state, char const *name, int flags,
+                           struct NaClDesc **out) {
+  UNREFERENCED_PARAMETER(state);
+  UNREFERENCED_PARAMETER(name);
+  UNREFERENCED_PARAMETER(flags);
+  if (NULL == out) {
+    ++g_factory_deletes;
+    return NACL_NAME_SERVICE_SUCCESS;
+  }
+  ++g_factory_calls;
+  *out = MakeDesc();
+  return NACL_NAME_SERVICE_SUCCESS;
+}
+
+static void TestEntries(void) {
+  char name[kNameLength];
+  char *names;
+  char *p;
+  size_t nbytes = kNumEntries * kNameLength;
+  size_t written;
+  int index;
+
+  for (index = 0; index < kNumEntries; ++index) {
+    EntryName(name, "service", index);
+    ASSERT_EQ(NaClNameServiceCreateDescEntry(g_ns, name, NACL_ABI_O_RDWR,
+                                             MakeDesc()),
+              NACL_NAME_SERVICE_SUCCESS);
+  }
+  ASSERT_EQ(NaClNameServiceCreateDescEntry(g_ns, "service_0", NACL_ABI_O_RDWR,
+                                           NULL),
+            NACL_NAME_SERVICE_DUPLICATE_NAME);
+  ASSERT_EQ(NaClNameServiceCreateDescEntry(g_ns, "readonly", NACL_ABI_O_RDONLY,
+                                           MakeDesc()),
+            NACL_NAME_SERVICE_SUCCESS);
+
+  for (index = 0; index < kNumEntries; ++index) {
+    EntryName(name, "service", index);
+    ASSERT_EQ(Resolve(name, NACL_ABI_O_RDWR), NACL_NAME_SERVICE_SUCCESS);
+  }
+  ASSERT_EQ(Resolve("service_", NACL_ABI_O_RDONLY),
+            NACL_NAME_SERVICE_NAME_NOT_FOUND);
+  ASSERT_EQ(Resolve("readonly", NACL_ABI_O_RDONLY), NACL_NAME_SERVICE_SUCCESS);
+  ASSERT_EQ(Resolve("readonly", NACL_ABI_O_WRONLY),
+            NACL_NAME_SERVICE_PERMISSION_DENIED);
+
+  /* A deleted name is gone, and can be entered again. */
+  ASSERT_EQ(NaClNameServiceDeleteName(g_ns, "service_5000"),
+            NACL_NAME_SERVICE_SUCCESS);
+  ASSERT_EQ(Resolve("service_5000", NACL_ABI_O_RDWR),
+            NACL_NAME_SERVICE_NAME_NOT_FOUND);
+  ASSERT_EQ(NaClNameServiceDeleteName(g_ns, "service_5000"),
+            NACL_NAME_SERVICE_NAME_NOT_FOUND);
+  ASSERT_EQ(Resolve("service_5001", NACL_ABI_O_RDWR),
+            NACL_NAME_SERVICE_SUCCESS);
+  ASSERT_EQ(NaClNameServiceDeleteName(g_ns, "readonly"),
+            NACL_NAME_SERVICE_SUCCESS);
+
+  /* Factories are called for lookups, and told about deletion. */
+  ASSERT_EQ(NaClNameServiceCreateFactoryEntry(g_ns, "factory",
+                                              CountingFactory, NULL),
+            NACL_NAME_SERVICE_SUCCESS);
+  ASSERT_EQ(Resolve("factory", NACL_ABI_O_RDONLY), NACL_NAME_SERVICE_SUCCESS);
+  ASSERT_EQ(g_factory_calls, 1);
+  ASSERT_EQ(NaClNameServiceDeleteName(g_ns, "factory"),
+            NACL_NAME_SERVICE_SUCCESS);
+  ASSERT_EQ(g_factory_deletes, 1);
+
+  /* Enumeration lists the newest entries first. */
+  names = (char *) malloc(nbytes);
+  ASSERT_NE(names, NULL);
+  written = NaClNameServiceEnumerate(g_ns, names, nbytes);
+  ASSERT_LE(written, nbytes - 1);
+  p = names;
+  for (index = kNumEntries - 1; index >= 0; --index) {
+    if (5000 == index) {
+      continue;
+    }
+    EntryName(name, "service", index);
+    ASSERT_EQ(strcmp(p, name), 0);
+    p += strlen(p) + 1;
+  }
+  ASSERT_EQ((size_t) (p - names), written);
+  free(names);
+}
+
+static void WINAPI ReaderThread(void *arg) {
+  char name[kNameLength];
+  uint32_t seed = (uint32_t) (uintptr_t) arg;
+  int index;
+
+  for (index = 0; index < kLookupsPerThread; ++index) {
+    seed = seed * 1103515245 + 12345;
+    EntryName(name, "service", (seed >> 8) % kNumEntries);
+    if (0 == strcmp(name, "service_5000")) {
+      continue;
+    }
+    ASSERT_EQ(Resolve(name, NACL_ABI_O_RDWR), NACL_NAME_SERVICE_SUCCESS);
+  }
+  AtomicIncrement(&g_readers_running, -1);
+}
+
+/*
+ * Inserts and deletes other names while the readers run, so that
+ * lookups race with tombstones, table rebuilds and freed entries.
+ */
+static void WINAPI ChurnThread(void *arg) {
+  char name[kNameLength];
+  int *churned = (int *) arg;
+  int index;
+
+  while (0 != g_readers_running) {
+    for (index = 0; index < 100; ++index) {
+      EntryName(name, "churn", index);
+      ASSERT_EQ(NaClNameServiceCreateDescEntry(g_ns, name, NACL_ABI_O_RDWR,
+                                               MakeDesc()),
+                NACL_NAME_SERVICE_SUCCESS);
+    }
+    for (index = 0; index < 100; ++index) {
+      EntryName(name, "churn", index);
+      ASSERT_EQ(NaClNameServiceDeleteName(g_ns, name),
+                NACL_NAME_SERVICE_SUCCESS);
+    }
+    *churned += 100;
+  }
+}
+
+static void BenchmarkResolve(int num_threads) {
+  struct NaClThread readers[kNumThreads];
+  struct NaClThread churner;
+  int churned = 0;
+  int64_t start;
+  double seconds;
+  int index;
+
+  g_readers_running = num_threads;
+  start = NaClGetTimeOfDayMicroseconds();
+  ASSERT(NaClThreadCreateJoinable(&churner, ChurnThread, &churned, 64 << 10));
+  for (index = 0; index < num_threads; ++index) {
+    ASSERT(NaClThreadCreateJoinable(&readers[index], ReaderThread,
+                                    (void *) (uintptr_t) (index + 1),
+                                    64 << 10));
+  }
+  for (index = 0; index < num_threads; ++index) {
+    NaClThreadJoin(&readers[index]);
+  }
+  NaClThreadJoin(&churner);
+  seconds = (NaClGetTimeOfDayMicroseconds() - start) / 1e6;
+
+  printf("%d threads: %.0f resolves/sec with %d entries"
+         " (%d names inserted and deleted meanwhile)\n",
+         num_threads, num_threads * kLookupsPerThread / seconds,
+         kNumEntries, churned);
+}
+
+int main(void) {
+  int num_threads;
+
+  NaClAllModulesInit();
+
+  g_ns = (struct NaClNameService *) malloc(sizeof *g_ns);
+  ASSERT_NE(g_ns, NULL);
+  ASSERT(NaClNameServiceCtor(g_ns, NaClThreadInterfaceThreadFactory, NULL));
+  TestEntries();
+  for (num_threads = 1; num_threads <= kNumThreads; num_threads *= 2) {
+    BenchmarkResolve(num_threads);
+  }
+  NaClRefCountUnref((struct NaClRefCount *) g_ns);
+
+  NaClAllModulesFini();
+  printf("PASSED\n");
+  return 0;
+}
@@ -13,7 +13,10 @@
 #include <mach/thread_act.h>
 
 #include "native_client/src/shared/platform/nacl_log.h"
+#include "native_client/src/trusted/service_runtime/include/sys/errno.h"
 #include "native_client/src/trusted/service_runtime/include/sys/nacl_nice.h"
+#include "native_client/src/trusted/service_runtime/nacl_thread_nice.h"
+#include "native_client/src/trusted/service_runtime/nacl_thread_sched.h"
 
 /* MyConvertToHostTime converts nanoseconds to the time base used by MacOS.
  * Typically the time base is nanoseconds, and the conversion is trivial.
@@ -100,3 +103,25 @@ int nacl_thread_nice(int nacl_nice) {
     return 0;
   }
 }
+
+/*
+ * OSX has no way to pin a thread to a CPU; THREAD_AFFINITY_POLICY is
+ * only a hint about which threads share caches.
+ */
+uint64_t NaClThreadSchedHostCpus(void) {
+  return 0;
+}
+
+int NaClThreadSchedSetSelf(struct NaClThreadSched const *sched) {
+  switch (sched->policy) {
+    case NACL_ABI_SCHED_KEEP:
+      return 0;
+    case NACL_ABI_SCHED_OTHER:
+      return 0 == nacl_thread_nice(NICE_NORMAL) ? 0 : -NACL_ABI_EPERM;
+    case NACL_ABI_SCHED_BATCH:
+    case NACL_ABI_SCHED_IDLE:
+      return 0 == nacl_thread_nice(NICE_BACKGROUND) ? 0 : -NACL_ABI_EPERM;
+    default:
+      return -NACL_ABI_ENOSYS;
+  }
+}
@@ -15,6 +15,7 @@
 #include "native_client/src/include/nacl_macros.h"
 
 #include "native_client/src/public/desc_metadata_types.h"
+#include "native_client/src/public/imc_types.h"
 #include "native_client/src/public/nacl_app.h"
 #include "native_client/src/public/secure_service.h"
 
@@ -38,6 +39,8 @@
 #include "native_client/src/trusted/gio/gio_nacl_desc.h"
 #include "native_client/src/trusted/gio/gio_shm.h"
 #include "native_client/src/trusted/interval_multiset/nacl_interval_range_tree_intern.h"
+#include "native_client/src/trusted/perf_counter/nacl_perf_events.h"
+#include "native_client/src/trusted/perf_counter/nacl_perf_trace.h"
 #include "native_client/src/trusted/service_runtime/arch/sel_ldr_arch.h"
 #include "native_client/src/trusted/service_runtime/include/bits/nacl_syscalls.h"
 #include "native_client/src/trusted/service_runtime/include/sys/fcntl.h"
@@ -51,6 +54,9 @@
 #include "native_client/src/trusted/service_runtime/nacl_reverse_quota_interface.h"
 #include "native_client/src/trusted/service_runtime/nacl_syscall_common.h"
 #include "native_client/src/trusted/service_runtime/nacl_syscall_handlers.h"
+#include "native_client/src/trusted/service_runtime/nacl_sampling_profile.h"
+#include "native_client/src/trusted/service_runtime/nacl_syscall_profile.h"
+#include "native_client/src/trusted/service_runtime/nacl_thread_sched.h"
 #include "native_client/src/trusted/service_runtime/nacl_valgrind_hooks.h"
 #include "native_client/src/trusted/service_runtime/name_service/default_name_service.h"
 #include "native_client/src/trusted/service_runtime/name_service/name_service.h"
@@ -161,6 +167,7 @@ int NaClAppWithSyscallTableCtor(struct NaClApp               *nap,
   nap->enable_dyncode_syscalls = ShouldEnableDyncodeSyscalls();
   nap->use_shm_for_dynamic_text = ShouldEnableDynamicLoading();
   nap->text_shm = NULL;
+  nap->time_page = NULL;
   if (!NaClMutexCtor(&nap->dynamic_load_mutex)) {
     goto cleanup_effp_free;
   }
@@ -182,6 +189,7 @@ int NaClAppWithSyscallTableCtor(struct NaClApp               *nap,
   nap->bootstrap_channel = NULL;
   nap->secure_service = NULL;
   nap->irt_loaded = 0;
+  nap->irt_load_addr = 0;
   nap->main_exe_prevalidated = 0;
 
   nap->kernel_service = NULL;
@@ -236,6 +244,10 @@ int NaClAppWithSyscallTableCtor(struct NaClApp               *nap,
     NaClLog(LOG_INFO, "DANGER: ENABLED FILE ACCESS\n");
   }
 
+  NaClSyscallProfileInitFromEnv(nap);
+  nap->perf_events = NaClPerfEventsCreateFromEnv();
+  NaClSamplingProfileInitFromEnv(nap);
+
   nap->enable_list_mappings = 0;
   if (IsEnvironmentVariableSet("NACL_DANGEROUS_ENABLE_LIST_MAPPINGS")) {
     /*
@@ -274,6 +286,9 @@ int NaClAppWithSyscallTableCtor(struct NaClApp               *nap,
 #endif
   nap->enable_faulted_thread_queue = 0;
   nap->faulted_thread_count = 0;
+#if NACL_LINUX
+  nap->suspend_pending_count = 0;
+#endif
 #if NACL_WINDOWS
   nap->faulted_thread_event = INVALID_HANDLE_VALUE;
 #else
@@ -299,8 +314,18 @@ int NaClAppWithSyscallTableCtor(struct NaClApp               *nap,
   nap->futex_wait_list_head.next = &nap->futex_wait_list_head;
   nap->futex_wait_list_head.prev = &nap->futex_wait_list_head;
 
+  if (!NaClMutexCtor(&nap->thread_pool_mu)) {
+    goto cleanup_futex_wait_list_mu;
+  }
+  nap->thread_pool_head = NULL;
+  nap->thread_pool_size = 0;
+
+  NaClThreadSchedLimitsCtor(&nap->thread_sched_limits);
+
   return 1;
 
+ cleanup_futex_wait_list_mu:
+  NaClMutexDtor(&nap->futex_wait_list_mu);
  cleanup_exception_mu:
   NaClMutexDtor(&nap->exception_mu);
  cleanup_desc_mu:
@@ -1046,39 +1071,34 @@ void NaClSecureCommandChannel(struct NaClApp *nap) {
 }
 
 
-void NaClAppLoadModule(struct NaClApp   *nap,
-                       struct NaClDesc  *nexe,
-                       void             (*load_cb)(void *instance_data,
-                                                   NaClErrorCode status),
-                       void             *instance_data) {
+/*
+ * Moves the module from NACL_MODULE_UNINITIALIZED to
+ * NACL_MODULE_LOADING, so that a later NaClAppStartModule waits for
+ * the load to finish.  Returns LOAD_DUP_LOAD_MODULE if a module was
+ * already loaded.
+ */
+static NaClErrorCode NaClAppBeginLoadModule(struct NaClApp *nap) {
   NaClErrorCode status = LOAD_OK;
 
-  NaClLog(4,
-          ("Entered NaClAppLoadModule: nap 0x%"NACL_PRIxPTR","
-           " nexe 0x%"NACL_PRIxPTR"\n"),
-          (uintptr_t) nap, (uintptr_t) nexe);
-
-  /*
-   * TODO(bsy): consider doing the processing below after sending the
-   * RPC reply to increase parallelism.
-   */
   NaClXMutexLock(&nap->mu);
   if (nap->module_initialization_state != NACL_MODULE_UNINITIALIZED) {
     NaClLog(LOG_ERROR, "NaClAppLoadModule: repeated invocation\n");
     status = LOAD_DUP_LOAD_MODULE;
-    NaClXMutexUnlock(&nap->mu);
-    if (NULL != load_cb) {
-      (*load_cb)(instance_data, status);
-    }
-    return;
+  } else {
+    nap->module_initialization_state = NACL_MODULE_LOADING;
+    NaClXCondVarBroadcast(&nap->cv);
   }
-  nap->module_initialization_state = NACL_MODULE_LOADING;
-  NaClXCondVarBroadcast(&nap->cv);
   NaClXMutexUnlock(&nap->mu);
+  return status;
+}
 
-  if (NULL != load_cb) {
-    (*load_cb)(instance_data, status);
-  }
+/*
+ * Validates and loads the nexe, then sets the module state to
+ * NACL_MODULE_LOADED or NACL_MODULE_ERROR.
+ */
+static void NaClAppFinishLoadModule(struct NaClApp   *nap,
+                                    struct NaClDesc  *nexe) {
+  NaClErrorCode status;
 
   NaClXMutexLock(&nap->mu);
 
@@ -1128,6 +1148,91 @@ void NaClAppLoadModule(struct NaClApp   *nap,
   NaClGdbHook(nap);
 }
 
+void NaClAppLoadModule(struct NaClApp   *nap,
+                       struct NaClDesc  *nexe,
+                       void             (*load_cb)(void *instance_data,
+                                                   NaClErrorCode status),
+                       void             *instance_data) {
+  NaClErrorCode status;
+
+  NaClLog(4,
+          ("Entered NaClAppLoadModule: nap 0x%"NACL_PRIxPTR","
+           " nexe 0x%"NACL_PRIxPTR"\n"),
+          (uintptr_t) nap, (uintptr_t) nexe);
+
+  status = NaClAppBeginLoadModule(nap);
+  if (NULL != load_cb) {
+    (*load_cb)(instance_data, status);
+  }
+  if (LOAD_OK == status) {
+    NaClAppFinishLoadModule(nap, nexe);
+  }
+}
+
+struct NaClAppLoadModuleThreadState {
+  struct NaClApp   *nap;
+  struct NaClDesc  *nexe;
+};
+
+static void *NaClAppLoadModuleThread(struct NaClThreadInterface *tif) {
+  struct NaClAppLoadModuleThreadState *state =
+      (struct NaClAppLoadModuleThreadState *) tif->thread_data;
+
+  NaClLog(4, "NaClAppLoadModuleThread: loading\n");
+  NaClPerfTraceBegin("LoadModule");
+  NaClAppFinishLoadModule(state->nap, state->nexe);
+  NaClPerfTraceEnd("LoadModule");
+  NaClLog(4, "NaClAppLoadModuleThread: done\n");
+
+  NaClDescUnref(state->nexe);
+  free(state);
+  return NULL;
+}
+
+void NaClAppLoadModuleInBackground(
+    struct NaClApp   *nap,
+    struct NaClDesc  *nexe,
+    void             (*load_cb)(void *instance_data,
+                                NaClErrorCode status),
+    void             *instance_data) {
+  NaClErrorCode                       status;
+  struct NaClAppLoadModuleThreadState *state;
+  struct NaClThreadInterface          *tif;
+
+  NaClLog(4,
+          ("Entered NaClAppLoadModuleInBackground: nap 0x%"NACL_PRIxPTR","
+           " nexe 0x%"NACL_PRIxPTR"\n"),
+          (uintptr_t) nap, (uintptr_t) nexe);
+
+  status = NaClAppBeginLoadModule(nap);
+  if (NULL != load_cb) {
+    (*load_cb)(instance_data, status);
+  }
+  if (LOAD_OK != status) {
+    return;
+  }
+
+  state = (struct NaClAppLoadModuleThreadState *) malloc(sizeof *state);
+  if (NULL != state) {
+    state->nap = nap;
+    state->nexe = NaClDescRef(nexe);
+    if (NaClThreadInterfaceConstructAndStartThread(
+            NaClAddrSpSquattingThreadIfFactoryFunction,
+            (void *) nap,
+            NaClAppLoadModuleThread,
+            (void *) state,
+            NACL_KERN_STACK_SIZE,
+            &tif)) {
+      return;
+    }
+    NaClDescUnref(state->nexe);
+    free(state);
+  }
+  NaClLog(LOG_WARNING,
+          "NaClAppLoadModuleInBackground: no thread, loading synchronously\n");
+  NaClAppFinishLoadModule(nap, nexe);
+}
+
 int NaClAppRuntimeHostSetup(struct NaClApp                  *nap,
                             struct NaClRuntimeHostInterface *host_itf) {
   NaClErrorCode status = LOAD_OK;
@@ -1203,10 +1308,8 @@ void NaClAppStartModule(struct NaClApp  *nap,
    * fully loaded before we can proceed with start module.
    */
   NaClXMutexLock(&nap->mu);
-  if (NACL_MODULE_LOADING == nap->module_initialization_state) {
-    while (NACL_MODULE_LOADED != nap->module_initialization_state) {
-      NaClXCondVarWait(&nap->cv, &nap->mu);
-    }
+  while (NACL_MODULE_LOADING == nap->module_initialization_state) {
+    NaClXCondVarWait(&nap->cv, &nap->mu);
   }
   if (nap->module_initialization_state != NACL_MODULE_LOADED) {
     if (NACL_MODULE_ERROR == nap->module_initialization_state) {
@@ -1290,6 +1393,40 @@ void NaClVmIoHasEnded(struct NaClApp *nap,
   NaClXMutexUnlock(&nap->mu);
 }
 
+void NaClVmIoWillStartV(struct NaClApp                      *nap,
+                        struct NaClAbiNaClImcMsgIoVec const *iov,
+                        size_t                              iovcnt) {
+  size_t i;
+
+  NaClXMutexLock(&nap->mu);
+  for (i = 0; i < iovcnt; ++i) {
+    if (0 != iov[i].length) {
+      (*nap->mem_io_regions->vtbl->AddInterval)(
+          nap->mem_io_regions,
+          iov[i].base,
+          iov[i].base + iov[i].length - 1);
+    }
+  }
+  NaClXMutexUnlock(&nap->mu);
+}
+
+void NaClVmIoHasEndedV(struct NaClApp                       *nap,
+                       struct NaClAbiNaClImcMsgIoVec const  *iov,
+                       size_t                               iovcnt) {
+  size_t i;
+
+  NaClXMutexLock(&nap->mu);
+  for (i = 0; i < iovcnt; ++i) {
+    if (0 != iov[i].length) {
+      (*nap->mem_io_regions->vtbl->RemoveInterval)(
+          nap->mem_io_regions,
+          iov[i].base,
+          iov[i].base + iov[i].length - 1);
+    }
+  }
+  NaClXMutexUnlock(&nap->mu);
+}
+
 void NaClVmIoPendingCheck_mu(struct NaClApp *nap,
                              uint32_t addr_first_usr,
                              uint32_t addr_last_usr) {
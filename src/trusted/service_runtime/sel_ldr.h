@@ -49,6 +49,7 @@
 #include "native_client/src/trusted/service_runtime/nacl_kernel_service.h"
 #include "native_client/src/trusted/service_runtime/nacl_resource.h"
 #include "native_client/src/trusted/service_runtime/nacl_secure_service.h"
+#include "native_client/src/trusted/service_runtime/nacl_thread_sched.h"
 #include "native_client/src/trusted/service_runtime/name_service/name_service.h"
 #include "native_client/src/trusted/service_runtime/sel_addrspace.h"
 #include "native_client/src/trusted/service_runtime/sel_mem.h"
@@ -65,13 +66,18 @@ EXTERN_C_BEGIN
 
 #define NACL_DEFAULT_STACK_MAX  (16 << 20)  /* main thread stack */
 
+struct NaClAbiNaClImcMsgIoVec;
 struct NaClAppThread;
 struct NaClDesc;  /* see native_client/src/trusted/desc/nacl_desc_base.h */
 struct NaClDynamicRegion;
 struct NaClRuntimeHostInterface;
 struct NaClDescQuotaInterface;
+struct NaClPerfEvents;  /* see nacl_perf_events.h */
+struct NaClSamplingProfile;  /* see nacl_sampling_profile.c */
 struct NaClSignalContext;
+struct NaClSyscallProfile;  /* see nacl_syscall_profile.c */
 struct NaClThreadInterface;  /* see sel_ldr_thread_interface.h */
+struct NaClTimePageState;  /* see nacl_time_page.c */
 struct NaClValidationCache;
 struct NaClValidationMetadata;
 
@@ -216,6 +222,12 @@ struct NaClApp {
    * priority.
    */
   int irt_loaded;  /* bool */
+  /*
+   * Untrusted address of the first segment of the last object loaded
+   * by NaClAppLoadFileDynamically, i.e. the IRT.  Reported to the
+   * debugger.
+   */
+  uintptr_t irt_load_addr;
 
   /*
    * The main NaCl executable may already be validated during ELF
@@ -253,6 +265,21 @@ struct NaClApp {
    * at least NACL_MAX_SYSCALLS.
    */
   struct NaClSyscallTableEntry *syscall_table;
+  /*
+   * Per-syscall counts and latencies, or NULL unless profiling was
+   * requested.  See nacl_syscall_profile.h.
+   */
+  struct NaClSyscallProfile *syscall_profile;
+  /*
+   * Hardware counter profile of untrusted code, or NULL unless one was
+   * requested.  See perf_counter/nacl_perf_events.h.
+   */
+  struct NaClPerfEvents     *perf_events;
+  /*
+   * Call stacks of untrusted threads, sampled on a timer, or NULL
+   * unless sampling was requested.  See nacl_sampling_profile.h.
+   */
+  struct NaClSamplingProfile *sampling_profile;
 
   /*
    * Name service must launch after mu, cv, vm_hole_may_exit,
@@ -325,6 +352,11 @@ struct NaClApp {
   int                       use_shm_for_dynamic_text;
   struct NaClDesc           *text_shm;
   struct NaClMutex          dynamic_load_mutex;
+  /*
+   * The read-only clock page mapped into untrusted address space, or
+   * NULL if there is none.  See nacl_time_page.h.
+   */
+  struct NaClTimePageState  *time_page;
   /*
    * This records which pages in text_shm have been allocated.  When a
    * page is allocated, it is filled with halt instructions and then
@@ -385,6 +417,20 @@ struct NaClApp {
   struct DynArray           threads;   /* NaClAppThread pointers */
   int                       num_threads;  /* number actually running */
 
+  /*
+   * Host threads of exited NaClAppThreads that are parked for reuse;
+   * see NACL_APP_THREAD_POOL_MAX.  thread_pool_mu is a leaf lock.
+   */
+  struct NaClMutex          thread_pool_mu;
+  struct NaClAppThread      *thread_pool_head;
+  int                       thread_pool_size;
+
+  /*
+   * How far untrusted threads may change their own CPU affinity and
+   * scheduling policy; set by the embedder before the app runs.
+   */
+  struct NaClThreadSchedLimits thread_sched_limits;
+
   struct NaClFastMutex      desc_mu;
   struct DynArray           desc_tbl;  /* NaClDesc pointers */
 
@@ -408,6 +454,17 @@ struct NaClApp {
    * fault_signal is non-zero.
    */
   Atomic32                  faulted_thread_count;
+#if NACL_LINUX
+  /*
+   * suspend_pending_count is the number of suspension signals that
+   * have been sent to untrusted threads but not yet acted upon.  It
+   * is decremented by each thread's signal handler, which wakes any
+   * futex waiter when it reaches zero, so that
+   * NaClUntrustedThreadsSuspendAll() can signal all threads before
+   * waiting for any of them.
+   */
+  Atomic32                  suspend_pending_count;
+#endif
 #if NACL_WINDOWS
   /*
    * An event that is signaled by debug exception handler process when it fills
@@ -696,6 +753,19 @@ void NaClAppLoadModule(struct NaClApp      *self,
                                                       NaClErrorCode status),
                        void                *instance_data);
 
+/*
+ * Like NaClAppLoadModule, but validates and loads the |nexe| on a new
+ * thread, returning as soon as |load_cb| has been invoked.  The caller
+ * keeps its reference to |nexe|.  NaClAppStartModule waits for the
+ * load to finish.
+ */
+void NaClAppLoadModuleInBackground(
+    struct NaClApp      *self,
+    struct NaClDesc     *nexe,
+    void                (*load_cb)(void *instance_data,
+                                   NaClErrorCode status),
+    void                *instance_data);
+
 int NaClAppRuntimeHostSetup(struct NaClApp                  *self,
                             struct NaClRuntimeHostInterface *host_itf);
 
@@ -868,6 +938,20 @@ void NaClVmIoHasEnded(struct NaClApp *nap,
                       uint32_t addr_first_usr,
                       uint32_t addr_last_usr);
 
+/*
+ * Vectored versions of NaClVmIoWillStart and NaClVmIoHasEnded, for
+ * readv-like operations.  All of the (untrusted address) ranges in iov
+ * are recorded or removed under one acquisition of the lock.
+ * Zero-length entries are skipped.
+ */
+void NaClVmIoWillStartV(struct NaClApp                      *nap,
+                        struct NaClAbiNaClImcMsgIoVec const *iov,
+                        size_t                              iovcnt);
+
+void NaClVmIoHasEndedV(struct NaClApp                       *nap,
+                       struct NaClAbiNaClImcMsgIoVec const  *iov,
+                       size_t                               iovcnt);
+
 /*
  * Used by operations (mmap, munmap) that will open a VM hole.
  * Invoked while holding the VM lock.  Check that no I/O is pending;
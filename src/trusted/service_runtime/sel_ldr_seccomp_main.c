@@ -5,12 +5,14 @@
  */
 
 #include "native_client/src/shared/platform/nacl_log.h"
+#include "native_client/src/trusted/perf_counter/nacl_perf_events.h"
 #include "native_client/src/trusted/seccomp_bpf/seccomp_bpf.h"
 #include "native_client/src/trusted/service_runtime/outer_sandbox.h"
 #include "native_client/src/trusted/service_runtime/sel_main.h"
 
 static void EnableSeccompBpfSandbox(void) {
-  if (0 != NaClInstallBpfFilter()) {
+  /* The profiler, if any, was set up with the NaClApp. */
+  if (0 != NaClInstallBpfFilter(NaClPerfEventsEnabled())) {
     NaClLog(LOG_FATAL, "Seccomp-bpf filter failed to apply. "
             "Looks like the kernel does not support it yet.\n");
   }
@@ -26,6 +26,8 @@
 #include "native_client/src/shared/srpc/nacl_srpc.h"
 
 #include "native_client/src/trusted/perf_counter/nacl_perf_counter.h"
+#include "native_client/src/trusted/perf_counter/nacl_perf_events.h"
+#include "native_client/src/trusted/perf_counter/nacl_perf_trace.h"
 
 #include "native_client/src/trusted/reverse_service/reverse_control_rpc.h"
 
@@ -40,7 +42,10 @@
 #include "native_client/src/trusted/service_runtime/nacl_signal.h"
 #include "native_client/src/trusted/service_runtime/nacl_switch_to_app.h"
 #include "native_client/src/trusted/service_runtime/nacl_syscall_common.h"
+#include "native_client/src/trusted/service_runtime/nacl_sampling_profile.h"
+#include "native_client/src/trusted/service_runtime/nacl_syscall_profile.h"
 #include "native_client/src/trusted/service_runtime/nacl_text.h"
+#include "native_client/src/trusted/service_runtime/nacl_time_page.h"
 #include "native_client/src/trusted/service_runtime/sel_memory.h"
 #include "native_client/src/trusted/service_runtime/sel_ldr.h"
 #include "native_client/src/trusted/service_runtime/sel_ldr_thread_interface.h"
@@ -202,6 +207,19 @@ void NaClLogAddressSpaceLayout(struct NaClApp *nap) {
 }
 
 
+/* Gives a function symbol of the nexe to each profiler that is enabled. */
+static void NaClAppAddProfileSymbol(void *state, uint32_t addr,
+                                    uint32_t size, char const *name) {
+  struct NaClApp *nap = (struct NaClApp *) state;
+
+  if (NULL != nap->perf_events) {
+    NaClPerfEventsAddSymbol(nap->perf_events, addr, size, name);
+  }
+  if (NULL != nap->sampling_profile) {
+    NaClSamplingProfileAddSymbol(nap->sampling_profile, addr, size, name);
+  }
+}
+
 NaClErrorCode NaClAppLoadFileAslr(struct NaClDesc *ndp,
                                   struct NaClApp *nap,
                                   enum NaClAslrMode aslr_mode) {
@@ -215,6 +233,7 @@ NaClErrorCode NaClAppLoadFileAslr(struct NaClDesc *ndp,
   struct NaClElfImageInfo info;
 
   NaClPerfCounterCtor(&time_load_file, "NaClAppLoadFile");
+  NaClPerfTraceBegin("LoadFile");
 
   /* NACL_MAX_ADDR_BITS < 32 */
   if (nap->addr_bits > NACL_MAX_ADDR_BITS) {
@@ -225,8 +244,10 @@ NaClErrorCode NaClAppLoadFileAslr(struct NaClDesc *ndp,
   nap->stack_size = NaClRoundAllocPage(nap->stack_size);
 
   /* temporay object will be deleted at end of function */
+  NaClPerfTraceBegin("ElfParse");
   image = NaClElfImageNew(ndp, &subret);
   if (NULL == image || LOAD_OK != subret) {
+    NaClPerfTraceEnd("ElfParse");
     ret = subret;
     goto done;
   }
@@ -234,6 +255,7 @@ NaClErrorCode NaClAppLoadFileAslr(struct NaClDesc *ndp,
   subret = NaClElfImageValidateProgramHeaders(image,
                                               nap->addr_bits,
                                               &info);
+  NaClPerfTraceEnd("ElfParse");
   if (LOAD_OK != subret) {
     ret = subret;
     goto done;
@@ -321,7 +343,9 @@ NaClErrorCode NaClAppLoadFileAslr(struct NaClDesc *ndp,
   NaClLog(2, "Allocating address space\n");
   NaClPerfCounterMark(&time_load_file, "PreAllocAddrSpace");
   NaClPerfCounterIntervalLast(&time_load_file);
+  NaClPerfTraceBegin("AllocAddrSpace");
   subret = NaClAllocAddrSpaceAslr(nap, aslr_mode);
+  NaClPerfTraceEnd("AllocAddrSpace");
   NaClPerfCounterMark(&time_load_file,
                       NACL_PERF_IMPORTANT_PREFIX "AllocAddrSpace");
   NaClPerfCounterIntervalLast(&time_load_file);
@@ -330,6 +354,18 @@ NaClErrorCode NaClAppLoadFileAslr(struct NaClDesc *ndp,
     goto done;
   }
 
+  if (NULL != nap->perf_events) {
+    NaClPerfEventsSetSandbox(nap->perf_events, nap->mem_start,
+                             (uintptr_t) 1 << nap->addr_bits);
+  }
+  if ((NULL != nap->perf_events || NULL != nap->sampling_profile) &&
+      !NaClElfImageForEachFunctionSymbol(image, ndp, NaClAppAddProfileSymbol,
+                                         nap)) {
+    NaClLog(LOG_WARNING,
+            "NaClAppLoadFile: no symbols; profiles will show addresses"
+            " rather than functions\n");
+  }
+
   /*
    * Make sure the static image pages are marked writable before we try
    * to write them.
@@ -344,7 +380,9 @@ NaClErrorCode NaClAppLoadFileAslr(struct NaClDesc *ndp,
             "Error code 0x%x\n",
             ret);
   }
+  NaClPerfTraceBegin("LoadSegments");
   subret = NaClElfImageLoad(image, ndp, nap);
+  NaClPerfTraceEnd("LoadSegments");
   if (LOAD_OK != subret) {
     ret = subret;
     goto done;
@@ -365,7 +403,9 @@ NaClErrorCode NaClAppLoadFileAslr(struct NaClDesc *ndp,
   NaClLog(2,
           ("Replacing gap between static text and"
            " (ro)data with shareable memory\n"));
+  NaClPerfTraceBegin("MakeDynText");
   subret = NaClMakeDynamicTextShared(nap);
+  NaClPerfTraceEnd("MakeDynText");
   NaClPerfCounterMark(&time_load_file,
                       NACL_PERF_IMPORTANT_PREFIX "MakeDynText");
   NaClPerfCounterIntervalLast(&time_load_file);
@@ -425,6 +465,13 @@ NaClErrorCode NaClAppLoadFileAslr(struct NaClDesc *ndp,
     goto done;
   }
 
+  NaClLog(2, "Mapping time page\n");
+  subret = NaClTimePageMap(nap);
+  if (LOAD_OK != subret) {
+    ret = subret;
+    goto done;
+  }
+
   NaClLog(2, "NaClAppLoadFile done; ");
   NaClLogAddressSpaceLayout(nap);
   ret = LOAD_OK;
@@ -433,6 +480,7 @@ done:
 
   NaClPerfCounterMark(&time_load_file, "EndLoadFile");
   NaClPerfCounterIntervalTotal(&time_load_file);
+  NaClPerfTraceEnd("LoadFile");
   return ret;
 }
 
@@ -448,16 +496,21 @@ NaClErrorCode NaClAppLoadFileDynamically(
   struct NaClElfImage *image = NULL;
   NaClErrorCode ret = LOAD_INTERNAL;
 
+  NaClPerfTraceBegin("ElfParse");
   image = NaClElfImageNew(ndp, &ret);
+  NaClPerfTraceEnd("ElfParse");
   if (NULL == image || LOAD_OK != ret) {
     goto done;
   }
+  NaClPerfTraceBegin("LoadSegments");
   ret = NaClElfImageLoadDynamically(image, nap, ndp, metadata);
+  NaClPerfTraceEnd("LoadSegments");
   if (LOAD_OK != ret) {
     goto done;
   }
   nap->user_entry_pt = nap->initial_entry_pt;
   nap->initial_entry_pt = NaClElfImageGetEntryPoint(image);
+  nap->irt_load_addr = NaClElfImageGetLoadAddress(image);
 
  done:
   NaClElfImageDelete(image);
@@ -713,6 +766,9 @@ int NaClCreateMainThread(struct NaClApp     *nap,
   if (0 != nap->user_entry_pt) {
     auxv_entries++;
   }
+  if (0 != NaClTimePageUserAddr(nap)) {
+    auxv_entries++;
+  }
   ptr_tbl_size = (((NACL_STACK_GETS_ARG ? 1 : 0) +
                    (3 + argc + 1 + envc + 1 + auxv_entries * 2)) *
                   sizeof(uint32_t));
@@ -788,6 +844,10 @@ int NaClCreateMainThread(struct NaClApp     *nap,
     *p++ = AT_ENTRY;
     *p++ = (uint32_t) nap->user_entry_pt;
   }
+  if (0 != NaClTimePageUserAddr(nap)) {
+    *p++ = AT_NACL_TIME_PAGE;
+    *p++ = NaClTimePageUserAddr(nap);
+  }
   *p++ = AT_NULL;
   *p++ = 0;
 
@@ -815,6 +875,8 @@ int NaClCreateMainThread(struct NaClApp     *nap,
   NaClLog(2, "  user stack ptr : %016"NACL_PRIxPTR"\n",
           NaClSysToUserStackAddr(nap, stack_ptr));
 
+  NaClSamplingProfileStart(nap);
+
   /* e_entry is user addr */
   retval = NaClAppThreadSpawn(nap,
                               nap->initial_entry_pt,
@@ -843,6 +905,12 @@ int NaClWaitForMainThreadToExit(struct NaClApp  *nap) {
    * Some thread invoked the exit (exit_group) syscall.
    */
 
+  NaClSyscallProfileWrite(nap);
+  NaClPerfEventsWrite(nap->perf_events);
+  NaClSamplingProfileWrite(nap);
+  NaClPerfTraceInstant("MainThreadExit");
+  NaClPerfTraceWrite();
+
   if (NULL != nap->debug_stub_callbacks) {
     nap->debug_stub_callbacks->process_exit_hook();
   }
@@ -9,6 +9,7 @@
  */
 #include "native_client/src/include/portability.h"
 #include "native_client/src/include/portability_io.h"
+#include "native_client/src/include/portability_string.h"
 
 #if NACL_OSX
 #include <crt_externs.h>
@@ -27,6 +28,7 @@
 #include "native_client/src/shared/platform/nacl_check.h"
 #include "native_client/src/shared/platform/nacl_exit.h"
 #include "native_client/src/shared/platform/nacl_log.h"
+#include "native_client/src/shared/platform/nacl_log_async.h"
 #include "native_client/src/shared/platform/nacl_sync.h"
 #include "native_client/src/shared/platform/nacl_sync_checked.h"
 #include "native_client/src/shared/srpc/nacl_srpc.h"
@@ -36,6 +38,7 @@
 #include "native_client/src/trusted/fault_injection/fault_injection.h"
 #include "native_client/src/trusted/fault_injection/test_injection.h"
 #include "native_client/src/trusted/perf_counter/nacl_perf_counter.h"
+#include "native_client/src/trusted/perf_counter/nacl_perf_trace.h"
 #include "native_client/src/trusted/service_runtime/env_cleanser.h"
 #include "native_client/src/trusted/service_runtime/include/sys/fcntl.h"
 #include "native_client/src/trusted/service_runtime/load_file.h"
@@ -48,6 +51,7 @@
 #include "native_client/src/trusted/service_runtime/nacl_runtime_host_interface.h"
 #include "native_client/src/trusted/service_runtime/nacl_signal.h"
 #include "native_client/src/trusted/service_runtime/nacl_syscall_common.h"
+#include "native_client/src/trusted/service_runtime/nacl_time_page.h"
 #include "native_client/src/trusted/service_runtime/nacl_valgrind_hooks.h"
 #include "native_client/src/trusted/service_runtime/osx/mach_exception_handler.h"
 #include "native_client/src/trusted/service_runtime/outer_sandbox.h"
@@ -127,7 +131,7 @@ static void PrintUsage(void) {
           "Usage: sel_ldr [-h d:D] [-r d:D] [-w d:D] [-i d:D]\n"
           "               [-f nacl_file]\n"
           "               [-l log_file]\n"
-          "               [-X d] [-acFglQRsSQv]\n"
+          "               [-X d] [-P cpu_mask] [-acFglQRsSQv]\n"
           "               -- [nacl_file] [args]\n"
           "\n");
   fprintf(stderr,
@@ -145,6 +149,8 @@ static void PrintUsage(void) {
           "    (use -1 to create the bound socket / address descriptor\n"
           "    pair, but that no export via IMC should occur)\n");
   fprintf(stderr,
+          " -P allow untrusted threads to pin themselves to the CPUs in\n"
+          "    the given mask, e.g. 0xc for CPUs 2 and 3\n"
           " -R an RPC supplies the NaCl module.\n"
           "    No nacl_file argument is expected, and the -f flag cannot be\n"
           "    used with this flag.\n"
@@ -212,6 +218,7 @@ int NaClSelLdrMain(int argc, char **argv) {
   int                           skip_qualification = 0;
   int                           handle_signals = 0;
   int                           enable_debug_stub = 0;
+  int                           log_async = 0;
   struct NaClPerfCounter        time_all_main;
   const char                    **envp;
   struct NaClEnvCleanser        env_cleanser;
@@ -269,7 +276,7 @@ int NaClSelLdrMain(int argc, char **argv) {
 #if NACL_LINUX
                        "+D:z:"
 #endif
-                       "aB:ceE:f:Fgh:i:l:qQr:RsSvw:X:Z")) != -1) {
+                       "aB:ceE:f:Fgh:i:l:P:qQr:RsSvw:X:Z")) != -1) {
     switch (opt) {
       case 'a':
         if (!quiet)
@@ -361,6 +368,16 @@ int NaClSelLdrMain(int argc, char **argv) {
           NaClLogSetFile(optarg);
         }
         break;
+      case 'P':
+        if (!NaClAppSetThreadSchedLimits(
+                nap, STRTOULL(optarg, (char **) 0, 0),
+                nap->thread_sched_limits.allowed_policies,
+                nap->thread_sched_limits.max_priority)) {
+          fprintf(stderr, "-P: none of the CPUs in %s are available\n",
+                  optarg);
+          exit(1);
+        }
+        break;
       case 'q':
         quiet = 1;
         break;
@@ -421,6 +438,16 @@ int NaClSelLdrMain(int argc, char **argv) {
     }
   }
 
+  /* Started after -l is handled, so that the drain thread uses its file. */
+  if (NULL != getenv("NACLLOG_ASYNC")) {
+    log_async = NaClLogAsyncStart(NULL);
+    if (!log_async) {
+      NaClLog(LOG_WARNING,
+              "NACLLOG_ASYNC is set, but asynchronous logging is not"
+              " available\n");
+    }
+  }
+
   if (debug_mode_ignore_validator == 1) {
     if (!quiet)
       fprintf(stderr, "DEBUG MODE ENABLED (ignore validator)\n");
@@ -583,7 +610,9 @@ int NaClSelLdrMain(int argc, char **argv) {
   if (!rpc_supplies_nexe) {
     if (LOAD_OK == errcode) {
       NaClLog(2, "Loading nacl file %s (non-RPC)\n", nacl_file);
+      NaClPerfTraceBegin("LoadNexe");
       errcode = NaClAppLoadFileFromFilename(nap, nacl_file);
+      NaClPerfTraceEnd("LoadNexe");
       if (LOAD_OK != errcode && !quiet) {
         fprintf(stderr, "Error while loading \"%s\": %s\n",
                 nacl_file,
@@ -663,7 +692,9 @@ int NaClSelLdrMain(int argc, char **argv) {
    */
 
   if (rpc_supplies_nexe) {
+    NaClPerfTraceBegin("WaitForLoadModule");
     errcode = NaClWaitForLoadModuleCommand(nap);
+    NaClPerfTraceEnd("WaitForLoadModule");
     NaClPerfCounterMark(&time_all_main, "WaitForLoad");
     NaClPerfCounterIntervalLast(&time_all_main);
   }
@@ -710,8 +741,10 @@ int NaClSelLdrMain(int argc, char **argv) {
       NaClLog(LOG_INFO, "IRT loaded via command channel; ignoring -B irt\n");
     } else if (LOAD_OK == errcode) {
       NaClLog(2, "Loading blob file %s\n", blob_library_file);
+      NaClPerfTraceBegin("LoadIrt");
       errcode = NaClAppLoadFileDynamically(nap, blob_file,
                                            NULL);
+      NaClPerfTraceEnd("LoadIrt");
       if (LOAD_OK == errcode) {
         nap->irt_loaded = 1;
       } else {
@@ -747,7 +780,9 @@ int NaClSelLdrMain(int argc, char **argv) {
     /*
      * wait for start_module RPC call on secure channel thread.
      */
+    NaClPerfTraceBegin("WaitForStartModule");
     start_result = NaClWaitForStartModuleCommand(nap);
+    NaClPerfTraceEnd("WaitForStartModule");
     NaClPerfCounterMark(&time_all_main, "WaitedForStartModuleCommand");
     NaClPerfCounterIntervalLast(&time_all_main);
     if (LOAD_OK == errcode) {
@@ -788,6 +823,7 @@ int NaClSelLdrMain(int argc, char **argv) {
     }
   }
   NACL_TEST_INJECTION(BeforeMainThreadLaunches, ());
+  NaClPerfTraceInstant("CreateMainThread");
   if (!NaClCreateMainThread(nap,
                             argc - optind,
                             argv + optind,
@@ -814,6 +850,9 @@ int NaClSelLdrMain(int argc, char **argv) {
    * addr space is still valid.  otherwise we'd have to kill threads
    * before we clean up the address space.
    */
+  if (log_async) {
+    NaClLogAsyncStop();
+  }
   NaClExit(ret_code);
 
  done:
@@ -844,6 +883,10 @@ int NaClSelLdrMain(int argc, char **argv) {
   }
   fflush(stdout);
 
+  NaClTimePageFree(nap);
+  if (log_async) {
+    NaClLogAsyncStop();
+  }
 #if NACL_LINUX
   NaClSignalHandlerFini();
 #endif
@@ -7,6 +7,7 @@
 #include "native_client/src/include/concurrency_ops.h"
 #include "native_client/src/shared/platform/nacl_log.h"
 #include "native_client/src/shared/utils/types.h"
+#include "native_client/src/trusted/perf_counter/nacl_perf_trace.h"
 #include "native_client/src/trusted/service_runtime/sel_ldr.h"
 #include "native_client/src/trusted/validator/ncvalidate.h"
 
@@ -64,6 +65,7 @@ int NaClValidateCode(struct NaClApp *nap, uintptr_t guest_addr,
             "stub_out_mode and fixed_feature_cpu_mode are incompatible\n");
     return LOAD_VALIDATION_FAILED;
   }
+  NaClPerfTraceBegin("ValidateCode");
   if (nap->validator_stub_out_mode) {
     /* Validation caching is currently incompatible with stubout. */
     metadata = NULL;
@@ -88,6 +90,7 @@ int NaClValidateCode(struct NaClApp *nap, uintptr_t guest_addr,
                                  metadata,
                                  cache);
   }
+  NaClPerfTraceEnd("ValidateCode");
   return NaClValidateStatus(status);
 }
 
@@ -51,12 +51,16 @@
           'nacl_reverse_host_interface.c',
           'nacl_reverse_quota_interface.c',
           'nacl_runtime_host_interface.c',
+          'nacl_sampling_profile.c',
           'nacl_secure_service.c',
           'nacl_signal_common.c',
           'nacl_stack_safety.c',
           'nacl_syscall_common.c',
           'nacl_syscall_hook.c',
+          'nacl_syscall_profile.c',
           'nacl_text.c',
+          'nacl_thread_sched.c',
+          'nacl_time_page.c',
           'nacl_valgrind_hooks.c',
           'name_service/default_name_service.c',
           'name_service/name_service.c',
@@ -79,6 +83,7 @@
           'sys_list_mappings.c',
           'sys_memory.c',
           'sys_parallel_io.c',
+          'sys_syscall_ring.c',
           'thread_suspension_common.c',
           'thread_suspension_unwind.c',
         ],
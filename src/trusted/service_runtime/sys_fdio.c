@@ -6,8 +6,10 @@
 
 #include "native_client/src/trusted/service_runtime/sys_fdio.h"
 
+#include <stdlib.h>
 #include <string.h>
 
+#include "native_client/src/public/imc_types.h"
 #include "native_client/src/trusted/desc/nacl_desc_base.h"
 #include "native_client/src/trusted/desc/nacl_desc_io.h"
 #include "native_client/src/trusted/service_runtime/include/sys/errno.h"
@@ -331,6 +333,191 @@ cleanup:
   return retval;
 }
 
+int32_t NaClSysIoVecCommon(struct NaClAppThread *natp,
+                           int32_t              d,
+                           uint32_t             iov_addr,
+                           uint32_t             iovcnt,
+                           int                  is_write,
+                           int                  positional,
+                           uint32_t             offset_addr) {
+  struct NaClApp                *nap = natp->nap;
+  struct NaClDesc               *ndp = NULL;
+  struct NaClAbiNaClImcMsgIoVec kern_naiov_small[NACL_SYS_IOV_ON_STACK];
+  struct NaClHostIoVec          kern_iov_small[NACL_SYS_IOV_ON_STACK];
+  struct NaClAbiNaClImcMsgIoVec *kern_naiov = kern_naiov_small;
+  struct NaClHostIoVec          *kern_iov = kern_iov_small;
+  struct NaClDescVtbl const     *vtbl;
+  nacl_abi_off64_t              offset = 0;
+  size_t                        total = 0;
+  uintptr_t                     sysaddr;
+  uint32_t                      i;
+  ssize_t                       io_result;
+  int32_t                       retval = -NACL_ABI_EINVAL;
+
+  NaClLog(3,
+          ("Entered NaClSysIoVecCommon(0x%08"NACL_PRIxPTR", %d,"
+           " 0x%08"NACL_PRIx32", %"NACL_PRIu32", %d, %d,"
+           " 0x%08"NACL_PRIx32")\n"),
+          (uintptr_t) natp, (int) d, iov_addr, iovcnt, is_write, positional,
+          offset_addr);
+
+  if (iovcnt > NACL_SYS_IOV_MAX) {
+    goto cleanup;
+  }
+  ndp = NaClAppGetDesc(nap, (int) d);
+  if (NULL == ndp) {
+    retval = -NACL_ABI_EBADF;
+    goto cleanup;
+  }
+  if (positional &&
+      !NaClCopyInFromUser(nap, &offset, (uintptr_t) offset_addr,
+                          sizeof offset)) {
+    retval = -NACL_ABI_EFAULT;
+    goto cleanup;
+  }
+  if (iovcnt > NACL_SYS_IOV_ON_STACK) {
+    kern_naiov = malloc(iovcnt * sizeof *kern_naiov);
+    kern_iov = malloc(iovcnt * sizeof *kern_iov);
+    if (NULL == kern_naiov || NULL == kern_iov) {
+      retval = -NACL_ABI_ENOMEM;
+      goto cleanup;
+    }
+  }
+  if (!NaClCopyInFromUser(nap, kern_naiov, (uintptr_t) iov_addr,
+                          iovcnt * sizeof *kern_naiov)) {
+    retval = -NACL_ABI_EFAULT;
+    goto cleanup;
+  }
+  /* copy before validating */
+
+  for (i = 0; i < iovcnt; ++i) {
+    /*
+     * As with read and write, a total larger than INT32_MAX is not an
+     * error; the request is clamped so that the result fits.
+     */
+    if (kern_naiov[i].length > INT32_MAX - total) {
+      kern_naiov[i].length = (nacl_abi_size_t) (INT32_MAX - total);
+    }
+    sysaddr = NaClUserToSysAddrRange(nap,
+                                     (uintptr_t) kern_naiov[i].base,
+                                     kern_naiov[i].length);
+    if (kNaClBadAddress == sysaddr) {
+      retval = -NACL_ABI_EFAULT;
+      goto cleanup;
+    }
+    kern_iov[i].base = (void *) sysaddr;
+    kern_iov[i].length = kern_naiov[i].length;
+    total += kern_naiov[i].length;
+  }
+
+  vtbl = (struct NaClDescVtbl const *) ndp->base.vtbl;
+  NaClVmIoWillStartV(nap, kern_naiov, iovcnt);
+  if (positional) {
+    io_result = is_write
+        ? (*vtbl->PWriteV)(ndp, kern_iov, iovcnt, offset)
+        : (*vtbl->PReadV)(ndp, kern_iov, iovcnt, offset);
+  } else {
+    io_result = is_write
+        ? (*vtbl->WriteV)(ndp, kern_iov, iovcnt)
+        : (*vtbl->ReadV)(ndp, kern_iov, iovcnt);
+  }
+  NaClVmIoHasEndedV(nap, kern_naiov, iovcnt);
+  NaClLog(4, "NaClSysIoVecCommon: %"NACL_PRIdS" of %"NACL_PRIuS" bytes\n",
+          io_result, total);
+
+  /* This cast is safe because we clamped the total above. */
+  retval = (int32_t) io_result;
+
+ cleanup:
+  if (kern_naiov != kern_naiov_small) {
+    free(kern_naiov);
+  }
+  if (kern_iov != kern_iov_small) {
+    free(kern_iov);
+  }
+  NaClDescSafeUnref(ndp);
+  return retval;
+}
+
+int32_t NaClSysReadv(struct NaClAppThread *natp,
+                     int32_t              d,
+                     uint32_t             iov_addr,
+                     uint32_t             iovcnt) {
+  return NaClSysIoVecCommon(natp, d, iov_addr, iovcnt, 0, 0, 0);
+}
+
+int32_t NaClSysWritev(struct NaClAppThread  *natp,
+                      int32_t               d,
+                      uint32_t              iov_addr,
+                      uint32_t              iovcnt) {
+  return NaClSysIoVecCommon(natp, d, iov_addr, iovcnt, 1, 0, 0);
+}
+
+int32_t NaClSysSendfile(struct NaClAppThread  *natp,
+                        int32_t               out_d,
+                        int32_t               in_d,
+                        uint32_t              offset_addr,
+                        uint32_t              count) {
+  struct NaClApp    *nap = natp->nap;
+  struct NaClDesc   *out_ndp = NULL;
+  struct NaClDesc   *in_ndp = NULL;
+  nacl_abi_off64_t  offset;
+  nacl_off64_t      host_offset = 0;
+  ssize_t           sendfile_result;
+  int32_t           retval = -NACL_ABI_EINVAL;
+
+  NaClLog(3,
+          ("Entered NaClSysSendfile(0x%08"NACL_PRIxPTR", %d, %d,"
+           " 0x%08"NACL_PRIx32", %"NACL_PRIu32")\n"),
+          (uintptr_t) natp, (int) out_d, (int) in_d, offset_addr, count);
+
+  out_ndp = NaClAppGetDesc(nap, (int) out_d);
+  in_ndp = NaClAppGetDesc(nap, (int) in_d);
+  if (NULL == out_ndp || NULL == in_ndp) {
+    retval = -NACL_ABI_EBADF;
+    goto cleanup;
+  }
+  if (0 != offset_addr) {
+    if (!NaClCopyInFromUser(nap, &offset, (uintptr_t) offset_addr,
+                            sizeof offset)) {
+      retval = -NACL_ABI_EFAULT;
+      goto cleanup;
+    }
+    if (offset < 0) {
+      goto cleanup;
+    }
+    host_offset = (nacl_off64_t) offset;
+  }
+  /* As with read and write, clamp so that the result fits. */
+  if (count > INT32_MAX) {
+    count = INT32_MAX;
+  }
+
+  /*
+   * No untrusted memory is touched, so there is no I/O range to
+   * register with NaClVmIoWillStart.
+   */
+  sendfile_result = (*NACL_VTBL(NaClDesc, out_ndp)->
+                     SendFile)(out_ndp, in_ndp,
+                               (0 != offset_addr) ? &host_offset : NULL,
+                               count);
+  if (sendfile_result > 0 && 0 != offset_addr) {
+    offset = (nacl_abi_off64_t) host_offset;
+    if (!NaClCopyOutToUser(nap, (uintptr_t) offset_addr, &offset,
+                           sizeof offset)) {
+      /* The data has already moved, so report the count, not EFAULT. */
+      NaClLog(LOG_WARNING, "NaClSysSendfile: offset copyout failed\n");
+    }
+  }
+  NaClLog(4, "NaClSysSendfile: %"NACL_PRIdS"\n", sendfile_result);
+  retval = (int32_t) sendfile_result;
+
+ cleanup:
+  NaClDescSafeUnref(out_ndp);
+  NaClDescSafeUnref(in_ndp);
+  return retval;
+}
+
 /*
  * This implements 64-bit offsets, so we use |offp| as an in/out
  * address so we can have a 64 bit return value.
@@ -17,6 +17,14 @@ struct NaClApp;
 struct NaClAppThread;
 struct nacl_abi_stat;
 
+/*
+ * Largest iovcnt accepted by the vectored I/O syscalls, as IOV_MAX on
+ * Linux.  Up to NACL_SYS_IOV_ON_STACK elements are handled without heap
+ * allocation; the syscall stack is too small to hold NACL_SYS_IOV_MAX.
+ */
+#define NACL_SYS_IOV_MAX      1024
+#define NACL_SYS_IOV_ON_STACK 16
+
 int32_t NaClSysClose(struct NaClAppThread *natp,
                      int                  d);
 
@@ -37,6 +45,44 @@ int32_t NaClSysWrite(struct NaClAppThread *natp,
                      void                 *buf,
                      size_t               count);
 
+int32_t NaClSysReadv(struct NaClAppThread *natp,
+                     int32_t              d,
+                     uint32_t             iov_addr,
+                     uint32_t             iovcnt);
+
+int32_t NaClSysWritev(struct NaClAppThread  *natp,
+                      int32_t               d,
+                      uint32_t              iov_addr,
+                      uint32_t              iovcnt);
+
+/*
+ * Common implementation of readv, writev, preadv and pwritev.  The
+ * untrusted iov array at iov_addr is copied in and validated in full,
+ * the total length is clamped to INT32_MAX, and all of the ranges are
+ * registered as in use by I/O before the descriptor's vectored method
+ * is invoked.  offset_addr is the untrusted address of a
+ * nacl_abi_off64_t, and is only used if positional is non-zero.
+ */
+int32_t NaClSysIoVecCommon(struct NaClAppThread *natp,
+                           int32_t              d,
+                           uint32_t             iov_addr,
+                           uint32_t             iovcnt,
+                           int                  is_write,
+                           int                  positional,
+                           uint32_t             offset_addr);
+
+/*
+ * Copies up to count bytes from in_d to out_d inside the service
+ * runtime, as sendfile(2).  offset_addr is zero, or the untrusted
+ * address of a nacl_abi_off64_t giving the read position in in_d,
+ * which is updated.
+ */
+int32_t NaClSysSendfile(struct NaClAppThread  *natp,
+                        int32_t               out_d,
+                        int32_t               in_d,
+                        uint32_t              offset_addr,
+                        uint32_t              count);
+
 int32_t NaClSysLseek(struct NaClAppThread *natp,
                      int                  d,
                      nacl_abi_off_t       *offp,
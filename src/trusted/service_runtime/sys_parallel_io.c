@@ -6,10 +6,8 @@
 
 /*
  * NaCl service run-time, non-platform specific system call helper
- * routines -- for parallel I/O functions (pread/pwrite).
- *
- * NB: This is likely to be replaced with a preadv/pwritev
- * implementation, with an IRT function to build a single-element iov.
+ * routines -- for parallel I/O functions (pread/pwrite and their
+ * vectored forms, preadv/pwritev).
  */
 
 #include "native_client/src/trusted/service_runtime/sys_parallel_io.h"
@@ -20,6 +18,7 @@
 #include "native_client/src/trusted/service_runtime/nacl_app_thread.h"
 #include "native_client/src/trusted/service_runtime/nacl_copy.h"
 #include "native_client/src/trusted/service_runtime/sel_ldr.h"
+#include "native_client/src/trusted/service_runtime/sys_fdio.h"
 
 int32_t NaClSysPRead(struct NaClAppThread *natp,
                      int32_t desc,
@@ -118,3 +117,19 @@ int32_t NaClSysPWrite(struct NaClAppThread *natp,
   NaClDescSafeUnref(ndp);
   return retval;
 }
+
+int32_t NaClSysPReadv(struct NaClAppThread *natp,
+                      int32_t desc,
+                      uint32_t iov_addr,
+                      uint32_t iovcnt,
+                      uint32_t offset_addr) {
+  return NaClSysIoVecCommon(natp, desc, iov_addr, iovcnt, 0, 1, offset_addr);
+}
+
+int32_t NaClSysPWritev(struct NaClAppThread *natp,
+                       int32_t desc,
+                       uint32_t iov_addr,
+                       uint32_t iovcnt,
+                       uint32_t offset_addr) {
+  return NaClSysIoVecCommon(natp, desc, iov_addr, iovcnt, 1, 1, offset_addr);
+}
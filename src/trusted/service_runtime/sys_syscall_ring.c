@@ -0,0 +1,171 @@
+/*
+ * Copyright (c) 2013 The Native Client Authors. All rights reserved.
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+/*
+ * NaCl service run-time, batched syscall submission.  A thread's ring
+ * is only ever drained by that thread, inside syscall_ring_enter, so
+ * the entries it wrote before the syscall need no memory barriers.
+ */
+
+#include <stddef.h>
+
+#include "native_client/src/trusted/service_runtime/sys_syscall_ring.h"
+
+#include "native_client/src/shared/platform/nacl_log.h"
+#include "native_client/src/trusted/service_runtime/include/sys/errno.h"
+#include "native_client/src/trusted/service_runtime/include/sys/nacl_syscall_ring.h"
+#include "native_client/src/trusted/service_runtime/nacl_app_thread.h"
+#include "native_client/src/trusted/service_runtime/nacl_copy.h"
+#include "native_client/src/trusted/service_runtime/sel_ldr.h"
+#include "native_client/src/trusted/service_runtime/sys_fdio.h"
+#include "native_client/src/trusted/service_runtime/sys_futex.h"
+#include "native_client/src/trusted/service_runtime/sys_parallel_io.h"
+
+static size_t NaClSyscallRingBytes(uint32_t entries, size_t entry_size) {
+  return sizeof(struct NaClAbiSyscallRingHeader) + entries * entry_size;
+}
+
+int32_t NaClSysSyscallRingRegister(struct NaClAppThread *natp,
+                                   uint32_t             sq_addr,
+                                   uint32_t             cq_addr,
+                                   uint32_t             entries) {
+  struct NaClApp  *nap = natp->nap;
+  int32_t         retval = -NACL_ABI_EINVAL;
+
+  NaClLog(3,
+          ("Entered NaClSysSyscallRingRegister(0x%08"NACL_PRIxPTR", 0x%08"
+           NACL_PRIx32", 0x%08"NACL_PRIx32", %"NACL_PRIu32")\n"),
+          (uintptr_t) natp, sq_addr, cq_addr, entries);
+
+  if (0 == entries) {
+    natp->syscall_ring_entries = 0;
+    retval = 0;
+    goto cleanup;
+  }
+  if (entries > NACL_ABI_SYSCALL_RING_MAX_ENTRIES ||
+      0 != (entries & (entries - 1))) {
+    goto cleanup;
+  }
+  /* The 64-bit fields in the entries must be naturally aligned. */
+  if (0 != (sq_addr & 7) || 0 != (cq_addr & 7)) {
+    goto cleanup;
+  }
+  if (kNaClBadAddress == NaClUserToSysAddrRange(
+          nap, sq_addr,
+          NaClSyscallRingBytes(entries,
+                               sizeof(struct NaClAbiSyscallRingSqe))) ||
+      kNaClBadAddress == NaClUserToSysAddrRange(
+          nap, cq_addr,
+          NaClSyscallRingBytes(entries,
+                               sizeof(struct NaClAbiSyscallRingCqe)))) {
+    retval = -NACL_ABI_EFAULT;
+    goto cleanup;
+  }
+  natp->syscall_ring_sq = sq_addr;
+  natp->syscall_ring_cq = cq_addr;
+  natp->syscall_ring_entries = entries;
+  retval = 0;
+
+ cleanup:
+  NaClLog(3, "NaClSysSyscallRingRegister: returning %"NACL_PRId32"\n",
+          retval);
+  return retval;
+}
+
+/*
+ * sqe is the trusted copy of the entry at sqe_addr.  The pread and
+ * pwrite handlers take the address of their offset rather than its
+ * value, so they are passed the offset field in the untrusted entry.
+ */
+static int32_t NaClSyscallRingDispatch(
+    struct NaClAppThread                *natp,
+    struct NaClAbiSyscallRingSqe const  *sqe,
+    uint32_t                            sqe_addr) {
+  uint32_t offset_addr =
+      sqe_addr + (uint32_t) offsetof(struct NaClAbiSyscallRingSqe, offset);
+
+  switch (sqe->opcode) {
+    case NACL_ABI_SYSCALL_RING_NOP:
+      return 0;
+    case NACL_ABI_SYSCALL_RING_READ:
+      return NaClSysRead(natp, sqe->d, (void *) (uintptr_t) sqe->addr,
+                         sqe->count);
+    case NACL_ABI_SYSCALL_RING_WRITE:
+      return NaClSysWrite(natp, sqe->d, (void *) (uintptr_t) sqe->addr,
+                          sqe->count);
+    case NACL_ABI_SYSCALL_RING_PREAD:
+      return NaClSysPRead(natp, sqe->d, sqe->addr, sqe->count, offset_addr);
+    case NACL_ABI_SYSCALL_RING_PWRITE:
+      return NaClSysPWrite(natp, sqe->d, sqe->addr, sqe->count, offset_addr);
+    case NACL_ABI_SYSCALL_RING_FUTEX_WAKE:
+      return NaClSysFutexWake(natp, sqe->addr, sqe->count);
+  }
+  return -NACL_ABI_EINVAL;
+}
+
+int32_t NaClSysSyscallRingEnter(struct NaClAppThread *natp,
+                                uint32_t             to_submit) {
+  struct NaClApp                  *nap = natp->nap;
+  uint32_t                        entries = natp->syscall_ring_entries;
+  uint32_t                        mask = entries - 1;
+  struct NaClAbiSyscallRingHeader sq;
+  struct NaClAbiSyscallRingHeader cq;
+  struct NaClAbiSyscallRingSqe    sqe;
+  struct NaClAbiSyscallRingCqe    cqe;
+  uint32_t                        sqe_addr;
+  uint32_t                        count;
+  uint32_t                        space;
+  uint32_t                        done;
+
+  if (0 == entries) {
+    return -NACL_ABI_EINVAL;
+  }
+  if (!NaClCopyInFromUser(nap, &sq, natp->syscall_ring_sq, sizeof sq) ||
+      !NaClCopyInFromUser(nap, &cq, natp->syscall_ring_cq, sizeof cq)) {
+    return -NACL_ABI_EFAULT;
+  }
+  count = sq.tail - sq.head;
+  space = entries - (cq.tail - cq.head);
+  if (count > entries || space > entries) {
+    return -NACL_ABI_EINVAL;
+  }
+  if (count > to_submit) {
+    count = to_submit;
+  }
+  if (count > space) {
+    count = space;
+  }
+
+  for (done = 0; done < count; ++done) {
+    sqe_addr = natp->syscall_ring_sq + sizeof sq +
+        ((sq.head + done) & mask) * sizeof sqe;
+    if (!NaClCopyInFromUser(nap, &sqe, sqe_addr, sizeof sqe)) {
+      break;
+    }
+    cqe.user_data = sqe.user_data;
+    cqe.result = NaClSyscallRingDispatch(natp, &sqe, sqe_addr);
+    cqe.reserved = 0;
+    if (!NaClCopyOutToUser(nap,
+                           natp->syscall_ring_cq + sizeof cq +
+                           ((cq.tail + done) & mask) * sizeof cqe,
+                           &cqe, sizeof cqe)) {
+      break;
+    }
+  }
+
+  /* Only publish the indices that belong to the service runtime. */
+  sq.head += done;
+  cq.tail += done;
+  if (!NaClCopyOutToUser(nap, natp->syscall_ring_sq +
+                         offsetof(struct NaClAbiSyscallRingHeader, head),
+                         &sq.head, sizeof sq.head) ||
+      !NaClCopyOutToUser(nap, natp->syscall_ring_cq +
+                         offsetof(struct NaClAbiSyscallRingHeader, tail),
+                         &cq.tail, sizeof cq.tail)) {
+    return -NACL_ABI_EFAULT;
+  }
+  return (int32_t) done;
+}
@@ -0,0 +1,35 @@
+/*
+ * Copyright (c) 2013 The Native Client Authors. All rights reserved.
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#ifndef NATIVE_CLIENT_SRC_TRUSTED_SERVICE_RUNTIME_SYS_SYSCALL_RING_H__
+#define NATIVE_CLIENT_SRC_TRUSTED_SERVICE_RUNTIME_SYS_SYSCALL_RING_H__
+
+#include "native_client/src/include/nacl_base.h"
+#include "native_client/src/include/portability.h"
+
+EXTERN_C_BEGIN
+
+struct NaClAppThread;
+
+/*
+ * Registers the calling thread's syscall ring; see nacl_syscall_ring.h
+ * for the layout.  An entries value of 0 unregisters it.
+ */
+int32_t NaClSysSyscallRingRegister(struct NaClAppThread *natp,
+                                   uint32_t             sq_addr,
+                                   uint32_t             cq_addr,
+                                   uint32_t             entries);
+
+/*
+ * Runs up to to_submit queued requests from the calling thread's ring
+ * and returns the number run.
+ */
+int32_t NaClSysSyscallRingEnter(struct NaClAppThread *natp,
+                                uint32_t             to_submit);
+
+EXTERN_C_END
+
+#endif
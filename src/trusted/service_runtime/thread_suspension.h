@@ -11,6 +11,7 @@
 
 EXTERN_C_BEGIN
 
+struct NaClApp;
 struct NaClAppThread;
 struct NaClSignalContext;
 
@@ -87,6 +88,14 @@ int NaClThreadSuspensionSignalHandler(int signal,
                                       struct NaClSignalContext *regs,
                                       int is_untrusted,
                                       struct NaClAppThread *natp);
+
+/*
+ * Suspends all threads, signalling every thread that is running
+ * untrusted code before waiting for any of them to suspend.  The
+ * caller must hold nap->threads_mu.
+ */
+void NaClUntrustedThreadsSuspendAllInternal(struct NaClApp *nap,
+                                            int save_registers);
 #endif
 
 void NaClAppThreadGetSuspendedRegistersInternal(
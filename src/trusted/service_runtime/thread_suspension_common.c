@@ -16,16 +16,21 @@
 #include "native_client/src/trusted/service_runtime/win/debug_exception_handler.h"
 
 void NaClUntrustedThreadsSuspendAll(struct NaClApp *nap, int save_registers) {
+#if !NACL_LINUX
   size_t index;
+#endif
 
   NaClXMutexLock(&nap->threads_mu);
 
+#if NACL_LINUX
+  NaClUntrustedThreadsSuspendAllInternal(nap, save_registers);
+#else
   /*
    * TODO(mseaborn): A possible refinement here would be to use separate loops
    * for initiating and waiting for the suspension of the threads.  This might
    * be faster, since we would not be waiting for each thread to suspend one by
    * one.  It would take advantage of the asynchronous nature of thread
-   * suspension.
+   * suspension.  The Linux implementation does this.
    */
   for (index = 0; index < nap->threads.num_entries; index++) {
     struct NaClAppThread *natp = NaClGetThreadMu(nap, (int) index);
@@ -33,6 +38,7 @@ void NaClUntrustedThreadsSuspendAll(struct NaClApp *nap, int save_registers) {
       NaClUntrustedThreadSuspend(natp, save_registers);
     }
   }
+#endif
 }
 
 void NaClUntrustedThreadsResumeAll(struct NaClApp *nap) {
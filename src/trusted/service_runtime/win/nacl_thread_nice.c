@@ -9,7 +9,10 @@
 
 #include <windows.h>
 #include "native_client/src/shared/platform/nacl_log.h"
+#include "native_client/src/trusted/service_runtime/include/sys/errno.h"
 #include "native_client/src/trusted/service_runtime/include/sys/nacl_nice.h"
+#include "native_client/src/trusted/service_runtime/nacl_thread_nice.h"
+#include "native_client/src/trusted/service_runtime/nacl_thread_sched.h"
 
 void NaClThreadNiceInit() { }
 
@@ -44,3 +47,51 @@ int nacl_thread_nice(int nacl_nice) {
   }
   return 0;
 }
+
+uint64_t NaClThreadSchedHostCpus(void) {
+  DWORD_PTR process_mask;
+  DWORD_PTR system_mask;
+
+  if (!GetProcessAffinityMask(GetCurrentProcess(), &process_mask,
+                              &system_mask)) {
+    NaClLog(LOG_WARNING, "GetProcessAffinityMask() failed.\n");
+    return 0;
+  }
+  return (uint64_t) process_mask;
+}
+
+/*
+ * Windows has no scheduling policies as such, so the non-realtime
+ * policies are mapped onto thread priorities as nacl_thread_nice()
+ * does, and the realtime ones are not supported.
+ */
+int NaClThreadSchedSetSelf(struct NaClThreadSched const *sched) {
+  HANDLE  thread = GetCurrentThread();
+  int     priority;
+
+  switch (sched->policy) {
+    case NACL_ABI_SCHED_KEEP:
+      priority = THREAD_PRIORITY_ERROR_RETURN;
+      break;
+    case NACL_ABI_SCHED_OTHER:
+      priority = THREAD_PRIORITY_NORMAL;
+      break;
+    case NACL_ABI_SCHED_BATCH:
+      priority = THREAD_PRIORITY_BELOW_NORMAL;
+      break;
+    case NACL_ABI_SCHED_IDLE:
+      priority = THREAD_PRIORITY_IDLE;
+      break;
+    default:
+      return -NACL_ABI_ENOSYS;
+  }
+  if (THREAD_PRIORITY_ERROR_RETURN != priority &&
+      !SetThreadPriority(thread, priority)) {
+    return -NACL_ABI_EPERM;
+  }
+  if (0 != sched->cpu_mask &&
+      0 == SetThreadAffinityMask(thread, (DWORD_PTR) sched->cpu_mask)) {
+    return -NACL_ABI_EINVAL;
+  }
+  return 0;
+}
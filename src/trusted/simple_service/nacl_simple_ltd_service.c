@@ -39,6 +39,11 @@ int NaClSimpleLtdServiceCtor(
   }
   self->max_clients = max_cli;
   self->num_clients = 0;
+  /*
+   * One worker per client.  A client accepted just after another hung
+   * up may find its worker still finishing, and waits for it.
+   */
+  self->base.max_workers = max_cli;
   NACL_VTBL(NaClRefCount, self) =
       (struct NaClRefCountVtbl *) &kNaClSimpleLtdServiceVtbl;
   NaClLog(4, "NaClSimpleLtdServiceCtor: success\n");
@@ -10,6 +10,7 @@
 
 #include "native_client/src/shared/platform/nacl_check.h"
 #include "native_client/src/shared/platform/nacl_log.h"
+#include "native_client/src/shared/platform/nacl_sync_checked.h"
 #include "native_client/src/shared/platform/nacl_threads.h"
 #include "native_client/src/shared/srpc/nacl_srpc.h"
 
@@ -43,6 +44,7 @@ int NaClSimpleServiceConnectionCtor(
   self->instance_data = instance_data;
 
   self->thread = NULL;
+  self->next_pending = NULL;
 
   self->base.vtbl = (struct NaClRefCountVtbl const *)
       &kNaClSimpleServiceConnectionVtbl;
@@ -96,22 +98,57 @@ void NaClSimpleServiceRpcHandler(
       conn);
 }
 
-static void *RpcHandlerBase(struct NaClThreadInterface *tif) {
-  struct NaClSimpleServiceConnection  *conn =
-      (struct NaClSimpleServiceConnection *) tif->thread_data;
+/*
+ * Removes the oldest pending connection, or returns NULL if there is
+ * none.  Caller holds pool_mu.
+ */
+static struct NaClSimpleServiceConnection *NaClSimpleServiceTakePending(
+    struct NaClSimpleService *self) {
+  struct NaClSimpleServiceConnection *conn = self->pending_head;
+
+  if (NULL != conn) {
+    self->pending_head = conn->next_pending;
+    if (NULL == self->pending_head) {
+      self->pending_tail = NULL;
+    }
+    conn->next_pending = NULL;
+    --self->num_pending;
+  }
+  return conn;
+}
 
-  NaClLog(4, "Entered RpcHandlerBase, invoking RpcHandler virtual fn\n");
-  (*NACL_VTBL(NaClSimpleService, conn->server)->RpcHandler)(conn->server,
-                                                            conn);
-  NaClLog(4, "Leaving RpcHandlerBase\n");
+static void *RpcHandlerBase(struct NaClThreadInterface *tif) {
+  struct NaClSimpleService            *server =
+      (struct NaClSimpleService *) tif->thread_data;
+  struct NaClSimpleServiceConnection  *conn;
+
+  NaClLog(4, "Entered RpcHandlerBase\n");
+  for (;;) {
+    NaClXMutexLock(&server->pool_mu);
+    while (NULL == server->pending_head && !server->shutting_down) {
+      ++server->idle_workers;
+      NaClXCondVarWait(&server->pool_cv, &server->pool_mu);
+      --server->idle_workers;
+    }
+    conn = NaClSimpleServiceTakePending(server);
+    if (NULL == conn) {
+      --server->num_workers;
+      NaClXMutexUnlock(&server->pool_mu);
+      break;
+    }
+    NaClXMutexUnlock(&server->pool_mu);
+
+    conn->thread = tif;
+    NaClLog(4, "RpcHandlerBase: invoking RpcHandler virtual fn\n");
+    (*NACL_VTBL(NaClSimpleService, server)->RpcHandler)(server, conn);
+    NaClRefCountUnref((struct NaClRefCount *) conn);
+  }
   /*
-   * The unref of conn may Dtor the currently running thread.  This is
-   * okay, since this only removes the ability to use the thread
-   * handle (in Windows) but does not otherwise affect the thread.  We
-   * don't log afterwards, just in case the logging code (is later
-   * modified to) use thread info.
+   * The unref of server may Dtor it, but not the currently running
+   * thread's NaClThreadInterface, which is released on thread exit.
    */
-  NaClRefCountUnref((struct NaClRefCount *) conn);
+  NaClLog(4, "Leaving RpcHandlerBase\n");
+  NaClRefCountUnref((struct NaClRefCount *) server);
   return (void *) NULL;
 }
 
@@ -127,14 +164,36 @@ static int NaClSimpleServiceCtorIntern(
     NaClLog(4, "NaClSimpleServiceCtorIntern: NaClRefCountCtor failed\n");
     return 0;
   }
+  if (!NaClMutexCtor(&self->pool_mu)) {
+    NaClLog(4, "NaClSimpleServiceCtorIntern: NaClMutexCtor failed\n");
+    goto mutex_ctor_fail;
+  }
+  if (!NaClCondVarCtor(&self->pool_cv)) {
+    NaClLog(4, "NaClSimpleServiceCtorIntern: NaClCondVarCtor failed\n");
+    goto condvar_ctor_fail;
+  }
   self->handlers = srpc_handlers;
   self->thread_factory_fn = thread_factory_fn;
   self->thread_factory_data = thread_factory_data;
   self->acceptor = (struct NaClThreadInterface *) NULL;
+  self->max_workers = NACL_SIMPLE_SERVICE_DEFAULT_MAX_WORKERS;
+  self->num_workers = 0;
+  self->idle_workers = 0;
+  self->pending_head = NULL;
+  self->pending_tail = NULL;
+  self->num_pending = 0;
+  self->reject_when_busy = 0;
+  self->shutting_down = 0;
 
   self->base.vtbl = (struct NaClRefCountVtbl const *) &kNaClSimpleServiceVtbl;
   NaClLog(4, "Leaving NaClSimpleServiceCtorIntern\n");
   return 1;
+
+ condvar_ctor_fail:
+  NaClMutexDtor(&self->pool_mu);
+ mutex_ctor_fail:
+  (*NACL_VTBL(NaClRefCount, self)->Dtor)((struct NaClRefCount *) self);
+  return 0;
 }
 
 int NaClSimpleServiceCtor(
@@ -184,6 +243,12 @@ void NaClSimpleServiceDtor(struct NaClRefCount *vself) {
   NaClRefCountSafeUnref((struct NaClRefCount *) self->bound_and_cap[0]);
   NaClRefCountSafeUnref((struct NaClRefCount *) self->bound_and_cap[1]);
 
+  /* Workers and pending connections hold references to the server. */
+  CHECK(0 == self->num_workers);
+  CHECK(NULL == self->pending_head);
+  NaClCondVarDtor(&self->pool_cv);
+  NaClMutexDtor(&self->pool_mu);
+
   NACL_VTBL(NaClRefCount, self) = &kNaClRefCountVtbl;
   (*NACL_VTBL(NaClRefCount, self)->Dtor)(vself);
 }
@@ -294,6 +359,8 @@ cleanup:
 int NaClSimpleServiceAcceptAndSpawnHandler(
     struct NaClSimpleService *self) {
   struct NaClSimpleServiceConnection  *conn = NULL;
+  struct NaClThreadInterface          *tif;
+  int                                 spawn;
   int                                 status;
 
   NaClLog(4, "Entered NaClSimpleServiceAcceptAndSpawnHandler\n");
@@ -311,26 +378,71 @@ int NaClSimpleServiceAcceptAndSpawnHandler(
   NaClLog(4,
           "NaClSimpleServiceAcceptAndSpawnHandler: conn is 0x%"NACL_PRIxPTR"\n",
           (uintptr_t) conn);
-  NaClLog(4, "NaClSimpleServiceAcceptAndSpawnHandler: spawning thread\n");
-
-  CHECK(NULL == conn->thread);
-
-  /* ownership of |conn| reference is passed to the thread */
-  if (!NaClThreadInterfaceConstructAndStartThread(
-          self->thread_factory_fn,
-          self->thread_factory_data,
-          RpcHandlerBase,
-          conn,
-          NACL_KERN_STACK_SIZE,
-          &conn->thread)) {
-    NaClLog(4, "NaClSimpleServiceAcceptAndSpawnHandler: no thread\n");
+  NaClXMutexLock(&self->pool_mu);
+  if (self->num_pending >= self->idle_workers &&
+      self->num_workers >= self->max_workers &&
+      self->reject_when_busy) {
+    NaClXMutexUnlock(&self->pool_mu);
+    NaClLog(LOG_WARNING,
+            "NaClSimpleServiceAcceptAndSpawnHandler: all %"NACL_PRIuS
+            " workers are busy; closing the new connection\n",
+            self->max_workers);
+    /* Keep accepting: a client hanging up frees a worker. */
     NaClRefCountUnref((struct NaClRefCount *) conn);
-    conn = NULL;
-    conn->thread = NULL;
-    status = -NACL_ABI_EAGAIN;
     goto abort;
   }
+  /* ownership of |conn| reference is passed to the pool */
+  if (NULL == self->pending_tail) {
+    self->pending_head = conn;
+  } else {
+    self->pending_tail->next_pending = conn;
+  }
+  self->pending_tail = conn;
+  ++self->num_pending;
+  if (self->num_pending <= self->idle_workers) {
+    NaClXCondVarSignal(&self->pool_cv);
+    spawn = 0;
+  } else if (self->num_workers < self->max_workers) {
+    ++self->num_workers;
+    spawn = 1;
+  } else {
+    NaClLog(4,
+            "NaClSimpleServiceAcceptAndSpawnHandler: all %"NACL_PRIuS
+            " workers busy, connection waits\n",
+            self->num_workers);
+    spawn = 0;
+  }
+  NaClXMutexUnlock(&self->pool_mu);
+
   status = 0;
+  /*
+   * The thread factory may block, e.g. while the untrusted address
+   * space is being set up, so the new worker is started unlocked.
+   */
+  if (spawn) {
+    NaClLog(4, "NaClSimpleServiceAcceptAndSpawnHandler: spawning thread\n");
+    /* The new worker holds a reference to the server. */
+    if (!NaClThreadInterfaceConstructAndStartThread(
+            self->thread_factory_fn,
+            self->thread_factory_data,
+            RpcHandlerBase,
+            NaClRefCountRef(&self->base),
+            NACL_KERN_STACK_SIZE,
+            &tif)) {
+      NaClLog(4, "NaClSimpleServiceAcceptAndSpawnHandler: no thread\n");
+      NaClRefCountUnref(&self->base);  /* undo ref in Ctor call arglist */
+      NaClXMutexLock(&self->pool_mu);
+      if (0 == --self->num_workers) {
+        /* Nobody would ever serve the connection. */
+        CHECK(conn == NaClSimpleServiceTakePending(self));
+        status = -NACL_ABI_EAGAIN;
+      }
+      NaClXMutexUnlock(&self->pool_mu);
+      if (0 != status) {
+        NaClRefCountUnref((struct NaClRefCount *) conn);
+      }
+    }
+  }
 abort:
   NaClLog(4,
           "Leaving NaClSimpleServiceAcceptAndSpawnHandler, status %d\n",
@@ -359,6 +471,11 @@ static void *AcceptThread(struct NaClThreadInterface *tif) {
     NaClLog(4, "AcceptThread: accepted, looping to next thread\n");
     continue;
   }
+  /* Idle workers exit once no more connections will arrive. */
+  NaClXMutexLock(&server->pool_mu);
+  server->shutting_down = 1;
+  NaClXCondVarBroadcast(&server->pool_cv);
+  NaClXMutexUnlock(&server->pool_mu);
   NaClRefCountUnref(&server->base);
   return (void *) NULL;
 }
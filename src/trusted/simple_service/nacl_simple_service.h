@@ -10,6 +10,7 @@
 #include "native_client/src/include/nacl_base.h"
 #include "native_client/src/include/nacl_compiler_annotations.h"
 
+#include "native_client/src/shared/platform/nacl_sync.h"
 #include "native_client/src/shared/platform/nacl_threads.h"
 #include "native_client/src/trusted/nacl_base/nacl_refcount.h"
 #include "native_client/src/trusted/threading/nacl_thread_interface.h"
@@ -18,6 +19,19 @@ EXTERN_C_BEGIN
 
 struct NaClSimpleServiceConnection;  /* fwd */
 
+/*
+ * Connections are served by a pool of worker threads.  A worker
+ * serves one connection at a time, until the client hangs up, and
+ * then waits for the next one.  Workers are started as needed, up to
+ * max_workers, so at most that many clients are served at once.  A
+ * connection accepted while all workers are busy waits for one to come
+ * free.  Subclasses may change max_workers in their Ctor, and may set
+ * reject_when_busy to have such a connection closed at once instead,
+ * with a warning, so that the client's NaClSrpcClientCtor fails rather
+ * than waiting for another client to hang up.
+ */
+#define NACL_SIMPLE_SERVICE_DEFAULT_MAX_WORKERS 16
+
 struct NaClSimpleService {
   struct NaClRefCount               base NACL_IS_REFCOUNT_SUBCLASS;
   struct NaClDesc                   *bound_and_cap[2];
@@ -34,6 +48,18 @@ struct NaClSimpleService {
   void                              *thread_factory_data;
 
   struct NaClThreadInterface        *acceptor;
+
+  /* Worker pool, protected by pool_mu. */
+  struct NaClMutex                  pool_mu;
+  struct NaClCondVar                pool_cv;
+  size_t                            max_workers;
+  size_t                            num_workers;
+  size_t                            idle_workers;
+  struct NaClSimpleServiceConnection *pending_head;
+  struct NaClSimpleServiceConnection *pending_tail;
+  size_t                            num_pending;
+  int                               reject_when_busy;
+  int                               shutting_down;
 };
 
 struct NaClSimpleServiceVtbl {
@@ -116,7 +142,10 @@ struct NaClSimpleServiceConnection {
 
   void                        *instance_data;
 
+  /* The worker serving this connection, once there is one. */
   struct NaClThreadInterface  *thread;
+  /* Next connection waiting for a worker. */
+  struct NaClSimpleServiceConnection  *next_pending;
   /* other data is application specific, in subclasses only */
 };
 
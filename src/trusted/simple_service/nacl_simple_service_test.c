@@ -0,0 +1,180 @@
+/*
+ * Copyright (c) 2013 The Native Client Authors. All rights reserved.
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+/*
+ * Tests that a NaClSimpleService serves connections with a bounded
+ * pool of worker threads, reusing a worker once its client hangs up.
+ * While all of the workers are busy, new clients are turned away if
+ * the service asks for that, and otherwise wait for a worker.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "native_client/src/include/nacl_assert.h"
+#include "native_client/src/include/nacl_macros.h"
+#include "native_client/src/shared/platform/nacl_sync_checked.h"
+#include "native_client/src/shared/platform/nacl_threads.h"
+#include "native_client/src/shared/platform/nacl_time.h"
+#include "native_client/src/shared/srpc/nacl_srpc.h"
+#include "native_client/src/trusted/desc/nacl_desc_base.h"
+#include "native_client/src/trusted/desc/nrd_all_modules.h"
+#include "native_client/src/trusted/service_runtime/nacl_config.h"
+#include "native_client/src/trusted/simple_service/nacl_simple_service.h"
+#include "native_client/src/trusted/threading/nacl_thread_interface.h"
+
+#define kMaxWorkers 2
+#define kNumClients 5
+
+struct Client {
+  struct NaClSrpcChannel  channel;
+  struct NaClThread       thread;
+  int                     connected;
+  int                     worker_id;
+  int                     done;
+};
+
+static struct NaClSimpleService g_service;
+static struct Client g_clients[kNumClients];
+static struct NaClMutex g_mu;
+static struct NaClCondVar g_cv;
+
+/* Returns the id of the worker thread serving the connection. */
+static void WorkerIdRpc(struct NaClSrpcRpc      *rpc,
+                        struct NaClSrpcArg      **in_args,
+                        struct NaClSrpcArg      **out_args,
+                        struct NaClSrpcClosure  *done_cls) {
+  UNREFERENCED_PARAMETER(in_args);
+  out_args[0]->u.ival = (int) NaClThreadId();
+  rpc->result = NACL_SRPC_RESULT_OK;
+  (*done_cls->Run)(done_cls);
+}
+
+static struct NaClSrpcHandlerDesc const kHandlers[] = {
+  { "worker_id::i", WorkerIdRpc, },
+  { (char const *) NULL, (NaClSrpcMethod) NULL, },
+};
+
+static void WINAPI ClientThread(void *arg) {
+  struct Client   *client = (struct Client *) arg;
+  struct NaClDesc *conn;
+  int             connected;
+  int             worker_id = -1;
+
+  ASSERT_EQ((*NACL_VTBL(NaClDesc, g_service.bound_and_cap[1])->ConnectAddr)(
+                g_service.bound_and_cap[1], &conn), 0);
+  /*
+   * The client Ctor waits for the service discovery RPC to be served,
+   * and fails if the service closes the connection instead.
+   */
+  connected = NaClSrpcClientCtor(&client->channel, conn);
+  if (connected) {
+    ASSERT_EQ(NaClSrpcInvokeBySignature(&client->channel, "worker_id::i",
+                                        &worker_id),
+              NACL_SRPC_RESULT_OK);
+  }
+  NaClDescUnref(conn);
+
+  NaClXMutexLock(&g_mu);
+  client->connected = connected;
+  client->worker_id = worker_id;
+  client->done = 1;
+  NaClXCondVarBroadcast(&g_cv);
+  NaClXMutexUnlock(&g_mu);
+}
+
+static void WaitForClient(struct Client *client) {
+  NaClXMutexLock(&g_mu);
+  while (!client->done) {
+    NaClXCondVarWait(&g_cv, &g_mu);
+  }
+  NaClXMutexUnlock(&g_mu);
+  NaClThreadJoin(&client->thread);
+}
+
+static void StartClient(struct Client *client) {
+  ASSERT(NaClThreadCreateJoinable(&client->thread, ClientThread, client,
+                                  NACL_KERN_STACK_SIZE));
+}
+
+static void WaitForIdleWorker(void) {
+  struct nacl_abi_timespec  delay;
+  size_t                    idle;
+
+  delay.tv_sec = 0;
+  delay.tv_nsec = NACL_NANOS_PER_MILLI;
+  for (;;) {
+    NaClXMutexLock(&g_service.pool_mu);
+    idle = g_service.idle_workers;
+    NaClXMutexUnlock(&g_service.pool_mu);
+    if (0 != idle) {
+      break;
+    }
+    ASSERT_EQ(NaClNanosleep(&delay, NULL), 0);
+  }
+}
+
+int main(void) {
+  struct nacl_abi_timespec  delay;
+  int                       index;
+
+  NaClNrdAllModulesInit();
+  NaClSrpcModuleInit();
+  NaClXMutexCtor(&g_mu);
+  NaClXCondVarCtor(&g_cv);
+  delay.tv_sec = 0;
+  delay.tv_nsec = 100 * NACL_NANOS_PER_MILLI;
+
+  ASSERT(NaClSimpleServiceCtor(&g_service, kHandlers,
+                               NaClThreadInterfaceThreadFactory, NULL));
+  g_service.max_workers = kMaxWorkers;
+  g_service.reject_when_busy = 1;
+  ASSERT(NaClSimpleServiceStartServiceThread(&g_service));
+
+  for (index = 0; index < kMaxWorkers; ++index) {
+    StartClient(&g_clients[index]);
+    WaitForClient(&g_clients[index]);
+    ASSERT(g_clients[index].connected);
+  }
+  ASSERT_NE(g_clients[0].worker_id, g_clients[1].worker_id);
+
+  /* Both workers are busy, so the next client is turned away. */
+  StartClient(&g_clients[2]);
+  WaitForClient(&g_clients[2]);
+  ASSERT(!g_clients[2].connected);
+  ASSERT_EQ(g_service.num_workers, kMaxWorkers);
+
+  /* Hanging up frees the first worker for the last client. */
+  NaClSrpcDtor(&g_clients[0].channel);
+  WaitForIdleWorker();
+  StartClient(&g_clients[3]);
+  WaitForClient(&g_clients[3]);
+  ASSERT(g_clients[3].connected);
+  ASSERT_EQ(g_clients[3].worker_id, g_clients[0].worker_id);
+  ASSERT_EQ(g_service.num_workers, kMaxWorkers);
+
+  /* By default, a client waits until a worker comes free. */
+  NaClXMutexLock(&g_service.pool_mu);
+  g_service.reject_when_busy = 0;
+  NaClXMutexUnlock(&g_service.pool_mu);
+  StartClient(&g_clients[4]);
+  ASSERT_EQ(NaClNanosleep(&delay, NULL), 0);
+  NaClXMutexLock(&g_mu);
+  ASSERT(!g_clients[4].done);
+  NaClXMutexUnlock(&g_mu);
+  NaClSrpcDtor(&g_clients[1].channel);
+  WaitForClient(&g_clients[4]);
+  ASSERT(g_clients[4].connected);
+  ASSERT_EQ(g_clients[4].worker_id, g_clients[1].worker_id);
+  ASSERT_EQ(g_service.num_workers, kMaxWorkers);
+
+  NaClSrpcDtor(&g_clients[3].channel);
+  NaClSrpcDtor(&g_clients[4].channel);
+
+  printf("PASSED\n");
+  /* The service threads are never shut down, so exit directly. */
+  return 0;
+}
@@ -20,7 +20,7 @@
  * minimal implementation suitable for testing.
  */
 
-void NaClLog(int detail_level, char const *fmt, ...) {
+void (NaClLog)(int detail_level, char const *fmt, ...) {
   va_list ap;
   UNREFERENCED_PARAMETER(detail_level);
   va_start(ap, fmt);
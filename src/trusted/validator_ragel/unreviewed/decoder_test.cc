@@ -32,7 +32,7 @@ const int INSN_WIDTH = 15; /* Counterpart of '--insn-width' objdump option. */
  * TODO(khim): remove the copy of NaClLog implementation as soon as
  * unreviewed/Makefile is eliminated.
  */
-void NaClLog(int detail_level, char const  *fmt, ...) {
+void (NaClLog)(int detail_level, char const  *fmt, ...) {
   va_list ap;
 
   UNREFERENCED_PARAMETER(detail_level);
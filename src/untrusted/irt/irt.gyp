@@ -30,6 +30,7 @@
       'irt_dev_getpid.c',
       'irt_exception_handling.c',
       'irt_dev_list_mappings.c',
+      'irt_dev_syscall_ring.c',
       'irt_nameservice.c',
       'irt_random.c',
 # support_srcs
@@ -14,6 +14,7 @@ struct timeval;
 struct timespec;
 struct stat;
 struct dirent;
+struct iovec;
 
 struct PP_StartFunctions;
 struct PP_ThreadFunctions;
@@ -103,6 +104,28 @@ struct nacl_irt_basic {
  */
 #define NACL_IRT_FDIO_v0_1      "nacl-irt-fdio-0.1"
 #define NACL_IRT_DEV_FDIO_v0_1  "nacl-irt-dev-fdio-0.1"
+struct nacl_irt_fdio_v0_1 {
+  int (*close)(int fd);
+  int (*dup)(int fd, int *newfd);
+  int (*dup2)(int fd, int newfd);
+  int (*read)(int fd, void *buf, size_t count, size_t *nread);
+  int (*write)(int fd, const void *buf, size_t count, size_t *nwrote);
+  int (*seek)(int fd, off_t offset, int whence, off_t *new_offset);
+  int (*fstat)(int fd, struct stat *);
+  int (*getdents)(int fd, struct dirent *, size_t count, size_t *nread);
+};
+
+/*
+ * Version 0.2 adds scatter/gather I/O, which transfers a whole iovec
+ * array in one call.  iovcnt may be at most 1024.  As with read() and
+ * write(), a short transfer is not an error.
+ *
+ * It also adds sendfile(), which copies count bytes from in_fd to
+ * out_fd without the data passing through the caller's memory.  If
+ * offset is non-NULL, in_fd is read from *offset, which is updated,
+ * rather than from its file position.
+ */
+#define NACL_IRT_FDIO_v0_2      "nacl-irt-fdio-0.2"
 struct nacl_irt_fdio {
   int (*close)(int fd);
   int (*dup)(int fd, int *newfd);
@@ -112,6 +135,14 @@ struct nacl_irt_fdio {
   int (*seek)(int fd, off_t offset, int whence, off_t *new_offset);
   int (*fstat)(int fd, struct stat *);
   int (*getdents)(int fd, struct dirent *, size_t count, size_t *nread);
+  int (*readv)(int fd, const struct iovec *iov, int iovcnt, size_t *nread);
+  int (*writev)(int fd, const struct iovec *iov, int iovcnt, size_t *nwrote);
+  int (*preadv)(int fd, const struct iovec *iov, int iovcnt, off_t offset,
+                size_t *nread);
+  int (*pwritev)(int fd, const struct iovec *iov, int iovcnt, off_t offset,
+                 size_t *nwrote);
+  int (*sendfile)(int out_fd, int in_fd, off_t *offset, size_t count,
+                  size_t *nsent);
 };
 
 /*
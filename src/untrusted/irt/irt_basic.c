@@ -6,6 +6,7 @@
 
 #include "native_client/src/include/nacl_macros.h"
 #include "native_client/src/untrusted/irt/irt.h"
+#include "native_client/src/untrusted/irt/irt_private.h"
 #include "native_client/src/untrusted/nacl/syscall_bindings_trampoline.h"
 
 static void nacl_irt_exit(int status) {
@@ -14,6 +15,9 @@ static void nacl_irt_exit(int status) {
 }
 
 static int nacl_irt_gettod(struct timeval *tv) {
+  if (0 == irt_time_page_gettod(tv)) {
+    return 0;
+  }
   return -NACL_SYSCALL(gettimeofday)(tv, NULL);
 }
 
@@ -14,6 +14,7 @@ struct dirent;
 struct stat;
 struct timeval;
 
+struct NaClAbiSyscallRingHeader;
 struct NaClMemMappingInfo;
 
 #if defined(__cplusplus)
@@ -81,6 +82,43 @@ struct nacl_irt_dev_list_mappings {
                        size_t count, size_t *result_count);
 };
 
+/*
+ * thread_sched_set() sets the CPU affinity and scheduling policy of
+ * the calling thread, within limits set by the embedder.
+ *
+ * If |cpu_mask| is non-NULL, it points to a bit mask of |mask_size|
+ * bytes, at most 8, in which bit n selects CPU n; the thread is
+ * pinned to those CPUs.  |policy| is one of the NACL_ABI_SCHED_*
+ * values in nacl_nice.h, or NACL_ABI_SCHED_KEEP to leave the policy
+ * unchanged, and |priority| is the realtime priority for
+ * NACL_ABI_SCHED_FIFO and NACL_ABI_SCHED_RR, or 0 otherwise.
+ *
+ * Returns EPERM if the request is outside the embedder's limits.
+ * Threads start with the embedder's default scheduling rather than
+ * inheriting that of the thread that created them.
+ */
+#define NACL_IRT_DEV_THREAD_SCHED_v0_1 "nacl-irt-dev-thread-sched-0.1"
+struct nacl_irt_dev_thread_sched {
+  int (*thread_sched_set)(const void *cpu_mask, size_t mask_size,
+                          int policy, int priority);
+};
+
+/*
+ * Batched syscall submission; see nacl_syscall_ring.h for the layout
+ * of the queues.  ring_register() registers the calling thread's
+ * submission and completion queues, each of which is a header followed
+ * by |entries| entries, or unregisters them if |entries| is 0.
+ * ring_enter() runs up to |to_submit| queued requests and returns the
+ * number it ran in |*submitted|.
+ */
+#define NACL_IRT_DEV_SYSCALL_RING_v0_1 "nacl-irt-dev-syscall-ring-0.1"
+struct nacl_irt_dev_syscall_ring {
+  int (*ring_register)(struct NaClAbiSyscallRingHeader *sq,
+                       struct NaClAbiSyscallRingHeader *cq,
+                       unsigned int entries);
+  int (*ring_enter)(unsigned int to_submit, unsigned int *submitted);
+};
+
 #if defined(__cplusplus)
 }
 #endif
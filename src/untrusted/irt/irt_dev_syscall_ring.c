@@ -0,0 +1,31 @@
+/*
+ * Copyright (c) 2013 The Native Client Authors. All rights reserved.
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#include "native_client/src/untrusted/irt/irt.h"
+#include "native_client/src/untrusted/irt/irt_dev.h"
+#include "native_client/src/untrusted/nacl/syscall_bindings_trampoline.h"
+
+static int nacl_irt_syscall_ring_register(
+    struct NaClAbiSyscallRingHeader *sq,
+    struct NaClAbiSyscallRingHeader *cq,
+    unsigned int entries) {
+  return -NACL_SYSCALL(syscall_ring_register)(sq, cq, entries);
+}
+
+static int nacl_irt_syscall_ring_enter(unsigned int to_submit,
+                                       unsigned int *submitted) {
+  int ret = NACL_SYSCALL(syscall_ring_enter)(to_submit);
+  if (ret < 0) {
+    return -ret;
+  }
+  *submitted = ret;
+  return 0;
+}
+
+const struct nacl_irt_dev_syscall_ring nacl_irt_dev_syscall_ring = {
+  nacl_irt_syscall_ring_register,
+  nacl_irt_syscall_ring_enter,
+};
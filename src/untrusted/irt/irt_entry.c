@@ -12,6 +12,7 @@
 #include "native_client/src/shared/platform/nacl_log.h"
 #include "native_client/src/shared/srpc/nacl_srpc.h"
 #include "native_client/src/untrusted/irt/irt_interfaces.h"
+#include "native_client/src/untrusted/irt/irt_private.h"
 #include "native_client/src/untrusted/nacl/nacl_irt.h"
 #include "native_client/src/untrusted/nacl/nacl_startup.h"
 #include "native_client/src/untrusted/nacl/tls.h"
@@ -57,7 +58,9 @@ void _start(uint32_t *info) {
   for (Elf32_auxv_t *av = auxv; av->a_type != AT_NULL; ++av) {
     if (av->a_type == AT_ENTRY) {
       entry = av;
-      break;
+    } else if (av->a_type == AT_NACL_TIME_PAGE) {
+      g_irt_time_page =
+          (const volatile struct NaClTimePage *) av->a_un.a_val;
     }
   }
   if (entry == NULL) {
@@ -64,6 +64,57 @@ static int nacl_irt_getdents(int fd, struct dirent *buf, size_t count,
   return 0;
 }
 
+static int nacl_irt_readv(int fd, const struct iovec *iov, int iovcnt,
+                          size_t *nread) {
+  int rv = NACL_GC_WRAP_SYSCALL(NACL_SYSCALL(readv)(fd, iov, iovcnt));
+  if (rv < 0)
+    return -rv;
+  *nread = rv;
+  return 0;
+}
+
+static int nacl_irt_writev(int fd, const struct iovec *iov, int iovcnt,
+                           size_t *nwrote) {
+  int rv = NACL_GC_WRAP_SYSCALL(NACL_SYSCALL(writev)(fd, iov, iovcnt));
+  if (rv < 0)
+    return -rv;
+  *nwrote = rv;
+  return 0;
+}
+
+static int nacl_irt_preadv(int fd, const struct iovec *iov, int iovcnt,
+                           off_t offset, size_t *nread) {
+  int rv = NACL_GC_WRAP_SYSCALL(NACL_SYSCALL(preadv)(fd, iov, iovcnt,
+                                                     &offset));
+  if (rv < 0)
+    return -rv;
+  *nread = rv;
+  return 0;
+}
+
+static int nacl_irt_pwritev(int fd, const struct iovec *iov, int iovcnt,
+                            off_t offset, size_t *nwrote) {
+  int rv = NACL_GC_WRAP_SYSCALL(NACL_SYSCALL(pwritev)(fd, iov, iovcnt,
+                                                      &offset));
+  if (rv < 0)
+    return -rv;
+  *nwrote = rv;
+  return 0;
+}
+
+static int nacl_irt_sendfile(int out_fd, int in_fd, off_t *offset,
+                             size_t count, size_t *nsent) {
+  int rv = NACL_GC_WRAP_SYSCALL(NACL_SYSCALL(sendfile)(out_fd, in_fd, offset,
+                                                       count));
+  if (rv < 0)
+    return -rv;
+  *nsent = rv;
+  return 0;
+}
+
+/*
+ * Version 0.1 of the interface is a prefix of this table.
+ */
 const struct nacl_irt_fdio nacl_irt_fdio = {
   nacl_irt_close,
   nacl_irt_dup,
@@ -73,4 +124,9 @@ const struct nacl_irt_fdio nacl_irt_fdio = {
   nacl_irt_seek,
   nacl_irt_fstat,
   nacl_irt_getdents,
+  nacl_irt_readv,
+  nacl_irt_writev,
+  nacl_irt_preadv,
+  nacl_irt_pwritev,
+  nacl_irt_sendfile,
 };
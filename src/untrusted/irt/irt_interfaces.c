@@ -41,8 +41,11 @@ static int list_mappings_filter(void) {
 
 static const struct nacl_interface_table irt_interfaces[] = {
   { NACL_IRT_BASIC_v0_1, &nacl_irt_basic, sizeof(nacl_irt_basic), NULL },
-  { NACL_IRT_FDIO_v0_1, &nacl_irt_fdio, sizeof(nacl_irt_fdio), NULL },
-  { NACL_IRT_DEV_FDIO_v0_1, &nacl_irt_fdio, sizeof(nacl_irt_fdio), NULL },
+  { NACL_IRT_FDIO_v0_1, &nacl_irt_fdio, sizeof(struct nacl_irt_fdio_v0_1),
+    NULL },
+  { NACL_IRT_DEV_FDIO_v0_1, &nacl_irt_fdio, sizeof(struct nacl_irt_fdio_v0_1),
+    NULL },
+  { NACL_IRT_FDIO_v0_2, &nacl_irt_fdio, sizeof(nacl_irt_fdio), NULL },
   { NACL_IRT_FILENAME_v0_1, &nacl_irt_filename, sizeof(nacl_irt_filename),
     NULL },
   { NACL_IRT_DEV_FILENAME_v0_2, &nacl_irt_dev_filename,
@@ -75,6 +78,10 @@ static const struct nacl_interface_table irt_interfaces[] = {
     sizeof(nacl_irt_exception_handling), NULL },
   { NACL_IRT_DEV_LIST_MAPPINGS_v0_1, &nacl_irt_dev_list_mappings,
     sizeof(nacl_irt_dev_list_mappings), list_mappings_filter },
+  { NACL_IRT_DEV_THREAD_SCHED_v0_1, &nacl_irt_dev_thread_sched,
+    sizeof(nacl_irt_dev_thread_sched), NULL },
+  { NACL_IRT_DEV_SYSCALL_RING_v0_1, &nacl_irt_dev_syscall_ring,
+    sizeof(nacl_irt_dev_syscall_ring), NULL },
 };
 
 size_t nacl_irt_interface(const char *interface_ident,
@@ -33,5 +33,7 @@ extern const struct nacl_irt_clock nacl_irt_clock;
 extern const struct nacl_irt_dev_getpid nacl_irt_dev_getpid;
 extern const struct nacl_irt_exception_handling nacl_irt_exception_handling;
 extern const struct nacl_irt_dev_list_mappings nacl_irt_dev_list_mappings;
+extern const struct nacl_irt_dev_thread_sched nacl_irt_dev_thread_sched;
+extern const struct nacl_irt_dev_syscall_ring nacl_irt_dev_syscall_ring;
 
 #endif  /* NATIVE_CLIENT_SRC_UNTRUSTED_IRT_IRT_INTERFACES_H_ */
@@ -11,4 +11,19 @@ extern __thread int g_is_irt_internal_thread;
 
 int irt_nameservice_lookup(const char *name, int oflag, int *out_fd);
 
+struct NaClTimePage;
+struct timespec;
+struct timeval;
+
+/* Set from the auxv by _start; NULL if there is no time page. */
+extern const volatile struct NaClTimePage *g_irt_time_page;
+
+/*
+ * Read the clock from the time page without a syscall.  These return
+ * 0 on success, or -1 if the caller must make the syscall instead.
+ * irt_time_page_gettime takes NaCl ABI clock ids.
+ */
+int irt_time_page_gettime(int nacl_clk_id, struct timespec *tp);
+int irt_time_page_gettod(struct timeval *tv);
+
 #endif  /* NATIVE_CLIENT_SRC_UNTRUSTED_IRT_IRT_PRIVATE_H_ */
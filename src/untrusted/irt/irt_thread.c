@@ -10,6 +10,7 @@
 #include <string.h>
 
 #include "native_client/src/untrusted/irt/irt.h"
+#include "native_client/src/untrusted/irt/irt_dev.h"
 #include "native_client/src/untrusted/irt/irt_private.h"
 #include "native_client/src/untrusted/nacl/syscall_bindings_trampoline.h"
 #include "native_client/src/untrusted/nacl/tls.h"
@@ -149,3 +150,13 @@ const struct nacl_irt_thread nacl_irt_thread = {
   nacl_irt_thread_exit,
   nacl_irt_thread_nice,
 };
+
+static int nacl_irt_thread_sched_set(const void *cpu_mask, size_t mask_size,
+                                     int policy, int priority) {
+  return -NACL_SYSCALL(thread_sched_set)(cpu_mask, mask_size, policy,
+                                         priority);
+}
+
+const struct nacl_irt_dev_thread_sched nacl_irt_dev_thread_sched = {
+  nacl_irt_thread_sched_set,
+};
@@ -43,6 +43,31 @@ static int stub_getdents(int fd, struct dirent *dirent, size_t count,
   return ENOSYS;
 }
 
+static int stub_readv(int fd, const struct iovec *iov, int iovcnt,
+                      size_t *nread) {
+  return ENOSYS;
+}
+
+static int stub_writev(int fd, const struct iovec *iov, int iovcnt,
+                       size_t *nwrote) {
+  return ENOSYS;
+}
+
+static int stub_preadv(int fd, const struct iovec *iov, int iovcnt,
+                       off_t offset, size_t *nread) {
+  return ENOSYS;
+}
+
+static int stub_pwritev(int fd, const struct iovec *iov, int iovcnt,
+                        off_t offset, size_t *nwrote) {
+  return ENOSYS;
+}
+
+static int stub_sendfile(int out_fd, int in_fd, off_t *offset, size_t count,
+                         size_t *nsent) {
+  return ENOSYS;
+}
+
 struct nacl_irt_basic __libnacl_irt_basic;
 struct nacl_irt_memory __libnacl_irt_memory;
 struct nacl_irt_tls __libnacl_irt_tls;
@@ -61,6 +86,11 @@ struct nacl_irt_fdio __libnacl_irt_fdio = {
   stub_seek,
   stub_fstat,
   stub_getdents,
+  stub_readv,
+  stub_writev,
+  stub_preadv,
+  stub_pwritev,
+  stub_sendfile,
 };
 
 TYPE_nacl_irt_query __nacl_irt_query;
@@ -17,10 +17,10 @@ void __libnacl_irt_dev_fdio_init(void) {
      */
     if (!__libnacl_irt_query(NACL_IRT_FDIO_v0_1,
                              &__libnacl_irt_dev_fdio,
-                             sizeof(struct nacl_irt_fdio))) {
+                             sizeof(struct nacl_irt_fdio_v0_1))) {
       __libnacl_irt_query(NACL_IRT_DEV_FDIO_v0_1,
                           &__libnacl_irt_dev_fdio,
-                          sizeof(struct nacl_irt_fdio));
+                          sizeof(struct nacl_irt_fdio_v0_1));
     }
   }
 }
@@ -23,7 +23,9 @@ extern "C" {
 
 struct NaClExceptionContext;
 struct NaClAbiNaClImcMsgHdr;
+struct NaClAbiSyscallRingHeader;
 struct NaClMemMappingInfo;
+struct iovec;
 struct stat;
 struct timespec;
 struct timeval;
@@ -82,6 +84,25 @@ typedef int (*TYPE_nacl_pwrite) (int fd,
                                  const void *buf, size_t count,
                                  off_t *offset);
 
+typedef int (*TYPE_nacl_readv) (int fd, const struct iovec *iov, int iovcnt);
+
+typedef int (*TYPE_nacl_writev) (int fd, const struct iovec *iov, int iovcnt);
+
+typedef int (*TYPE_nacl_preadv) (int fd, const struct iovec *iov, int iovcnt,
+                                 off_t *offset);
+
+typedef int (*TYPE_nacl_pwritev) (int fd, const struct iovec *iov, int iovcnt,
+                                  off_t *offset);
+
+typedef int (*TYPE_nacl_sendfile) (int out_fd, int in_fd, off_t *offset,
+                                   size_t count);
+
+typedef int (*TYPE_nacl_syscall_ring_register) (
+    struct NaClAbiSyscallRingHeader *sq,
+    struct NaClAbiSyscallRingHeader *cq,
+    unsigned int entries);
+typedef int (*TYPE_nacl_syscall_ring_enter) (unsigned int to_submit);
+
 /* ============================================================ */
 /* imc */
 /* ============================================================ */
@@ -131,6 +152,10 @@ typedef int (*TYPE_nacl_thread_create) (void *start_user_address,
                                         void *second_thread_ptr);
 typedef int (*TYPE_nacl_thread_nice) (const int nice);
 
+typedef int (*TYPE_nacl_thread_sched_set) (const void *cpu_mask,
+                                           size_t mask_size,
+                                           int policy, int priority);
+
 /* ============================================================ */
 /* mutex */
 /* ============================================================ */
@@ -62,11 +62,59 @@ enum MutexState {
   LOCKED_WITH_WAITERS = 2
 };
 
+/*
+ * Before sleeping on a contended mutex, we spin for a while in case
+ * the owner releases it soon, since critical sections are often much
+ * shorter than a futex_wait/futex_wake round trip.  As in glibc's
+ * adaptive mutexes, the spin limit is twice the mutex's spin_count
+ * plus a little, and spin_count tracks a moving average of how many
+ * spins each contended acquisition has taken, so the limit follows
+ * how long the mutex is typically held.  kMaxSpins bounds the time
+ * wasted on a mutex that is held for long periods.
+ */
+static const int kMinSpins = 10;
+static const int kMaxSpins = 100;
+
+/*
+ * Spins waiting for the mutex to become free, and claims it if it
+ * does.  Returns whether the mutex was claimed.
+ */
+static int mutex_spin(pthread_mutex_t *mutex) {
+  int spin_count = mutex->spin_count;
+  int max_spins;
+  int spins;
+
+  /* Also handles the NC_INVALID_HANDLE set by the static initializers. */
+  if (spin_count < 0 || spin_count > kMaxSpins) {
+    spin_count = 0;
+  }
+  max_spins = spin_count * 2 + kMinSpins;
+  if (max_spins > kMaxSpins) {
+    max_spins = kMaxSpins;
+  }
+  for (spins = 0; spins < max_spins; spins++) {
+    /*
+     * Only read mutex_state until the mutex looks free, so that
+     * spinning threads do not keep taking the cache line away from
+     * the owner.
+     */
+    if (mutex->mutex_state == UNLOCKED &&
+        __sync_bool_compare_and_swap(&mutex->mutex_state, UNLOCKED,
+                                     LOCKED_WITHOUT_WAITERS)) {
+      mutex->spin_count = spin_count + (spins - spin_count) / 8;
+      return 1;
+    }
+  }
+  mutex->spin_count = spin_count + (max_spins - spin_count) / 8;
+  return 0;
+}
+
 int pthread_mutex_init(pthread_mutex_t *mutex,
                        const pthread_mutexattr_t *mutex_attr) {
   mutex->mutex_state = UNLOCKED;
   mutex->owner_thread_id = NACL_PTHREAD_ILLEGAL_THREAD_ID;
   mutex->recursion_counter = 0;
+  mutex->spin_count = 0;
   if (mutex_attr != NULL) {
     mutex->mutex_type = mutex_attr->kind;
   } else {
@@ -104,6 +152,10 @@ static int mutex_lock_nonrecursive(pthread_mutex_t *mutex, int try_only,
         (abstime->tv_nsec < 0 || 1000000000 <= abstime->tv_nsec)) {
       return EINVAL;
     }
+    if (mutex_spin(mutex)) {
+      return 0;
+    }
+    old_state = mutex->mutex_state;
     do {
       /*
        * If the state shows there are already waiters, or we can
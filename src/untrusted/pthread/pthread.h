@@ -86,11 +86,14 @@ typedef struct {
   uint32_t recursion_counter;
 
   /*
-   * Padding is for compatibility with libraries (newlib etc.) that
-   * were built before libpthread switched to using futexes, and to
-   * match _LOCK_T in newlib's newlib/libc/include/sys/lock.h.
+   * Running estimate of how long to spin before sleeping when the
+   * mutex is contended.  This field used to be padding, kept for
+   * compatibility with libraries (newlib etc.) that were built before
+   * libpthread switched to using futexes, and to match _LOCK_T in
+   * newlib's newlib/libc/include/sys/lock.h.  The static initializers
+   * still set it to NC_INVALID_HANDLE, which is treated as 0.
    */
-  int unused_padding;
+  volatile int spin_count;
 } pthread_mutex_t;
 
 /**
@@ -0,0 +1,250 @@
+/*
+ * Copyright (c) 2013 The Native Client Authors. All rights reserved.
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+/*
+ * Checks that the IRT's clock_gettime, which reads the time page
+ * without a syscall when it can, agrees with the clock_gettime syscall
+ * and never makes CLOCK_MONOTONIC go backwards when the two are mixed,
+ * and that it really reads the page rather than making the syscall.
+ * Then measures calls per second through both paths.
+ */
+
+#include <inttypes.h>
+#include <stdio.h>
+#include <sys/time.h>
+#include <time.h>
+
+#include "native_client/src/include/elf32.h"
+#include "native_client/src/include/elf_auxv.h"
+#include "native_client/src/trusted/service_runtime/include/sys/nacl_time_page.h"
+#include "native_client/src/untrusted/irt/irt.h"
+#include "native_client/src/untrusted/nacl/syscall_bindings_trampoline.h"
+
+/* NaCl ABI clock ids; see the comment in clock_irt_test.c. */
+#define NACL_ABI_CLOCK_REALTIME   0
+#define NACL_ABI_CLOCK_MONOTONIC  1
+
+#define kCheckIterations 1000000
+#define kBenchmarkIterations 1000000
+/* Short enough to finish well within the refresh interval. */
+#define kPagePathIterations 10000
+/* Larger than the service runtime's refresh interval of one second. */
+#define kRefreshSleepNanos 1100000000
+
+static struct nacl_irt_basic basic;
+static struct nacl_irt_clock clock_if;
+
+static int64_t TimespecToNanos(const struct timespec *ts) {
+  return (int64_t) ts->tv_sec * 1000000000 + ts->tv_nsec;
+}
+
+static int64_t IrtMonotonic(void) {
+  struct timespec ts;
+  if (0 != clock_if.clock_gettime(NACL_ABI_CLOCK_MONOTONIC, &ts)) {
+    fprintf(stderr, "IRT clock_gettime failed\n");
+    return -1;
+  }
+  return TimespecToNanos(&ts);
+}
+
+static int64_t SyscallMonotonic(void) {
+  struct timespec ts;
+  if (0 != NACL_SYSCALL(clock_gettime)(NACL_ABI_CLOCK_MONOTONIC, &ts)) {
+    fprintf(stderr, "clock_gettime syscall failed\n");
+    return -1;
+  }
+  return TimespecToNanos(&ts);
+}
+
+/*
+ * Alternates between the two paths, sleeping past the refresh
+ * interval now and again so that the page is refreshed in between.
+ */
+static int TestMonotonic(void) {
+  int64_t prev = 0;
+  int64_t now;
+  int i;
+  struct timespec nap_time;
+
+  for (i = 0; i < kCheckIterations; ++i) {
+    now = (i & 1) ? SyscallMonotonic() : IrtMonotonic();
+    if (now < prev) {
+      fprintf(stderr, "CLOCK_MONOTONIC went backwards by %lld ns at %d\n",
+              (long long) (prev - now), i);
+      return 1;
+    }
+    prev = now;
+    if (0 == i % (kCheckIterations / 4)) {
+      nap_time.tv_sec = kRefreshSleepNanos / 1000000000;
+      nap_time.tv_nsec = kRefreshSleepNanos % 1000000000;
+      basic.nanosleep(&nap_time, NULL);
+    }
+  }
+  printf("TestMonotonic passed\n");
+  return 0;
+}
+
+/* The realtime clocks of both paths should agree to within a second. */
+static int TestRealtime(void) {
+  struct timespec irt_ts;
+  struct timespec sys_ts;
+  struct timeval tv;
+  int64_t diff;
+
+  if (0 != clock_if.clock_gettime(NACL_ABI_CLOCK_REALTIME, &irt_ts) ||
+      0 != NACL_SYSCALL(clock_gettime)(NACL_ABI_CLOCK_REALTIME, &sys_ts) ||
+      0 != basic.gettod(&tv)) {
+    fprintf(stderr, "reading CLOCK_REALTIME failed\n");
+    return 1;
+  }
+  diff = TimespecToNanos(&sys_ts) - TimespecToNanos(&irt_ts);
+  if (diff < 0 || diff > 1000000000) {
+    fprintf(stderr, "IRT and syscall CLOCK_REALTIME differ by %lld ns\n",
+            (long long) diff);
+    return 1;
+  }
+  if (tv.tv_sec < irt_ts.tv_sec || tv.tv_sec > sys_ts.tv_sec + 1) {
+    fprintf(stderr, "gettimeofday disagrees with CLOCK_REALTIME\n");
+    return 1;
+  }
+  printf("TestRealtime passed\n");
+  return 0;
+}
+
+/* The auxv follows the NULL that terminates the environment. */
+static const volatile struct NaClTimePage *FindTimePage(char **envp) {
+  const Elf32_auxv_t *av;
+
+  while (NULL != *envp) {
+    ++envp;
+  }
+  for (av = (const Elf32_auxv_t *) (envp + 1); AT_NULL != av->a_type; ++av) {
+    if (AT_NACL_TIME_PAGE == av->a_type) {
+      return (const volatile struct NaClTimePage *) (uintptr_t) av->a_un.a_val;
+    }
+  }
+  return NULL;
+}
+
+#if defined(__i386__) || defined(__x86_64__)
+static uint64_t ReadTsc(void) {
+  uint32_t lo;
+  uint32_t hi;
+
+  __asm__ __volatile__("rdtsc" : "=a"(lo), "=d"(hi));
+  return ((uint64_t) hi << 32) | lo;
+}
+
+/* The fewest TSC ticks that one call of func took. */
+static uint64_t MinTicks(int64_t (*func)(void)) {
+  uint64_t best = UINT64_MAX;
+  uint64_t start;
+  uint64_t ticks;
+  int i;
+
+  for (i = 0; i < kPagePathIterations; ++i) {
+    start = ReadTsc();
+    (*func)();
+    ticks = ReadTsc() - start;
+    if (ticks < best) {
+      best = ticks;
+    }
+  }
+  return best;
+}
+#endif
+
+/*
+ * Checks that the IRT computes the time from the page.  The page only
+ * changes when a syscall refreshes it, so right after a refresh, a
+ * burst of IRT calls must leave seq alone; and the fastest IRT call
+ * must beat the fastest syscall, which reads the same page but has to
+ * leave the sandbox to do it.
+ */
+static int TestPagePath(char **envp) {
+  const volatile struct NaClTimePage *page = FindTimePage(envp);
+  uint32_t seq;
+  int i;
+
+  if (NULL == page) {
+    printf("TestPagePath skipped: no time page (no invariant TSC?)\n");
+    return 0;
+  }
+  if (NACL_TIME_PAGE_VERSION != page->version) {
+    fprintf(stderr, "unexpected time page version %u\n",
+            (unsigned) page->version);
+    return 1;
+  }
+  /* The first syscall may only start the TSC rate measurement. */
+  for (i = 0; i < 100 && 0 == (page->flags & NACL_TIME_PAGE_TSC_VALID); ++i) {
+    struct timespec nap_time = { 0, 10000000 };
+    basic.nanosleep(&nap_time, NULL);
+    SyscallMonotonic();
+  }
+  if (0 == (page->flags & NACL_TIME_PAGE_TSC_VALID)) {
+    fprintf(stderr, "time page never became valid\n");
+    return 1;
+  }
+
+  SyscallMonotonic();
+  seq = page->seq;
+  for (i = 0; i < kPagePathIterations; ++i) {
+    IrtMonotonic();
+  }
+  if (seq != page->seq) {
+    fprintf(stderr, "IRT clock_gettime refreshed the time page"
+            " (seq %u -> %u)\n", (unsigned) seq, (unsigned) page->seq);
+    return 1;
+  }
+
+#if defined(__i386__) || defined(__x86_64__)
+  {
+    uint64_t irt_ticks = MinTicks(IrtMonotonic);
+    uint64_t sys_ticks = MinTicks(SyscallMonotonic);
+
+    printf("fastest call: IRT %"PRIu64" ticks, syscall %"PRIu64" ticks\n",
+           irt_ticks, sys_ticks);
+    if (irt_ticks >= sys_ticks) {
+      fprintf(stderr, "IRT clock_gettime is no faster than the syscall\n");
+      return 1;
+    }
+  }
+#endif
+  printf("TestPagePath passed\n");
+  return 0;
+}
+
+static void Benchmark(const char *name, int64_t (*func)(void)) {
+  int64_t start = SyscallMonotonic();
+  int64_t elapsed;
+  int i;
+
+  for (i = 0; i < kBenchmarkIterations; ++i) {
+    (*func)();
+  }
+  elapsed = SyscallMonotonic() - start;
+  printf("%-24s %12.0f calls/sec\n", name,
+         kBenchmarkIterations * 1e9 / (double) elapsed);
+}
+
+int main(int argc, char **argv, char **envp) {
+  int errs = 0;
+
+  if (0 == nacl_interface_query(NACL_IRT_BASIC_v0_1, &basic, sizeof basic) ||
+      0 == nacl_interface_query(NACL_IRT_CLOCK_v0_1, &clock_if,
+                                sizeof clock_if)) {
+    fprintf(stderr, "IRT hook is not available\n");
+    return 1;
+  }
+
+  errs += TestMonotonic();
+  errs += TestRealtime();
+  errs += TestPagePath(envp);
+
+  Benchmark("IRT clock_gettime", IrtMonotonic);
+  Benchmark("clock_gettime syscall", SyscallMonotonic);
+  return errs;
+}
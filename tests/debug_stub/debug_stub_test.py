@@ -2,10 +2,13 @@
 # Use of this source code is governed by a BSD-style license that can be
 # found in the LICENSE file.
 
+import array
+import binascii
 import re
 import struct
 import subprocess
 import sys
+import time
 import unittest
 import xml.etree.ElementTree
 
@@ -44,6 +47,17 @@ def EncodeHex(data):
   return ''.join('%02x' % ord(byte) for byte in data)
 
 
+def EncodeEscaped(data):
+  # Escape the characters that are special in RSP packets, as GDB does
+  # for binary data.
+  return re.sub('[#$}*]', lambda match: '}' + chr(ord(match.group(0)) ^ 0x20),
+                data)
+
+
+def DecodeEscaped(data):
+  return re.sub('}(.)', lambda match: chr(ord(match.group(1)) ^ 0x20), data)
+
+
 X86_32_REG_DEFS = [
     ('eax', 'I'),
     ('ecx', 'I'),
@@ -254,11 +268,18 @@ def GetSymbols():
 
 
 def ParseThreadStopReply(reply):
-  match = re.match('T([0-9a-f]{2})thread:([0-9a-f]+);$', reply)
+  match = re.match('T([0-9a-f]{2})thread:([0-9a-f]+);'
+                   '((?:[0-9a-f]+:[0-9a-f]+;)*)$', reply)
   if match is None:
     raise AssertionError('Bad thread stop reply: %r' % reply)
+  # The stop reply includes the thread's registers, as 'nn:xx..xx;'.
+  registers = {}
+  for pair in match.group(3).split(';')[:-1]:
+    regno, value = pair.split(':')
+    registers[int(regno, 16)] = value
   return {'signal': int(match.group(1), 16),
-          'thread_id': int(match.group(2), 16)}
+          'thread_id': int(match.group(2), 16),
+          'registers': registers}
 
 
 def AssertReplySignal(reply, signal):
@@ -275,6 +296,24 @@ def ReadUint32(connection, address):
   return struct.unpack('I', ReadMemory(connection, address, 4))[0]
 
 
+def GetPacketSize(connection):
+  for feature in connection.RspRequest('qSupported').split(';'):
+    if feature.startswith('PacketSize='):
+      return int(feature[len('PacketSize='):], 16)
+  raise AssertionError('No PacketSize in qSupported reply')
+
+
+def ReadXferObject(connection, request):
+  # Read the object in small chunks to check the offset handling.
+  data = ''
+  while True:
+    reply = connection.RspRequest('%s:%x,%x' % (request, len(data), 0x100))
+    assert reply[0] in 'ml', reply
+    data += DecodeEscaped(reply[1:])
+    if reply[0] == 'l':
+      return data
+
+
 def SingleSteppingWorks():
   # Single-stepping is not yet supported on ARM and MIPS.
   # TODO(eaeltsin):
@@ -297,6 +336,14 @@ class DebugStubTest(unittest.TestCase):
     # Just check that we are given parsable XML.
     xml.etree.ElementTree.fromstring(reply[1:])
 
+  # Test that the registers sent with a stop reply match those read
+  # with 'g', so that GDB need not ask for them.
+  def CheckStopReplyRegisters(self, connection, stop_reply):
+    registers = ParseThreadStopReply(stop_reply)['registers']
+    AssertEquals(sorted(registers.keys()), range(len(REG_DEFS[ARCH])))
+    AssertEquals(''.join(registers[regno] for regno in sorted(registers)),
+                 connection.RspRequest('g'))
+
   # Test that we can fetch register values.
   # This check corresponds to the last instruction of debugger_test.c
   def CheckReadRegisters(self, connection):
@@ -474,6 +521,7 @@ class DebugStubTest(unittest.TestCase):
         AssertReplySignal(reply, NACL_SIGSEGV)
 
       self.CheckTargetXml(connection)
+      self.CheckStopReplyRegisters(connection, reply)
       self.CheckReadRegisters(connection)
       self.CheckWriteRegisters(connection)
       self.CheckReadOnlyRegisters(connection)
@@ -524,6 +572,15 @@ class DebugStubTest(unittest.TestCase):
       reply = connection.RspRequest('m%x,%x' % (mem_addr, len(new_data)))
       self.assertEquals(DecodeHex(reply), new_data)
 
+      # Check writing binary data, including characters that need
+      # escaping.
+      new_data = 'bin\0#$}*ary'
+      reply = connection.RspRequest('X%x,%x:%s' % (mem_addr, len(new_data),
+                                                   EncodeEscaped(new_data)))
+      self.assertEquals(reply, 'OK')
+      reply = connection.RspRequest('m%x,%x' % (mem_addr, len(new_data)))
+      self.assertEquals(DecodeHex(reply), new_data)
+
       self.CheckReadMemoryAtInvalidAddr(connection)
 
   def test_exit_code(self):
@@ -642,6 +699,64 @@ class DebugStubTest(unittest.TestCase):
       write_command = 'M%x,%x:%s' % (func_addr, len(data), EncodeHex(data))
       reply = connection.RspRequest(write_command)
       self.assertEquals(reply, 'E03')
+      write_command = 'X%x,%x:%s' % (func_addr, len(data), data)
+      reply = connection.RspRequest(write_command)
+      self.assertEquals(reply, 'E03')
+
+  def test_memory_map(self):
+    with LaunchDebugStub('test_getting_registers') as connection:
+      self.assertTrue('qXfer:memory-map:read+' in
+                      connection.RspRequest('qSupported').split(';'))
+      memory_map = xml.etree.ElementTree.fromstring(
+          ReadXferObject(connection, 'qXfer:memory-map:read:'))
+      regions = [(int(region.get('start'), 16), int(region.get('length'), 16))
+                 for region in memory_map.findall('memory')]
+      # Untrusted addresses, and on x86-64 the same addresses with the
+      # sandbox base added, should be covered.
+      mem_addr = GetSymbols()['g_example_var']
+      addrs = [mem_addr]
+      if ARCH == 'x86-64':
+        addrs.append(DecodeRegs(connection.RspRequest('g'))['r15'] + mem_addr)
+      for addr in addrs:
+        self.assertTrue(any(start <= addr < start + length
+                            for start, length in regions), addr)
+
+  def test_libraries(self):
+    with LaunchDebugStub('test_getting_registers') as connection:
+      library_list = xml.etree.ElementTree.fromstring(
+          ReadXferObject(connection, 'qXfer:libraries:read:'))
+      self.assertEquals(library_list.tag, 'library-list')
+      # The test is run without an IRT, so no libraries are listed.
+      if '-B' not in SEL_LDR_COMMAND:
+        self.assertEquals(library_list.findall('library'), [])
+      for library in library_list.findall('library'):
+        self.assertEquals(len(library.findall('segment')), 1)
+
+  # Test the speed of reading a large block of memory in packets of
+  # the negotiated size.
+  def test_reading_large_memory(self):
+    if UsingQemu():
+      # This test is too slow under qemu-arm.
+      return
+    with LaunchDebugStub('test_reading_large_memory') as connection:
+      # Continue from the initial breakpoint to the one in
+      # test_reading_large_memory(), after the buffer is filled in.
+      ParseThreadStopReply(connection.RspRequest('c'))
+      buffer_addr = ReadUint32(connection, GetSymbols()['g_large_buffer'])
+      buffer_size = 64 << 20
+      # A reply takes two characters per byte.
+      chunk_size = GetPacketSize(connection) / 2
+      start_time = time.time()
+      for offset in xrange(0, buffer_size, chunk_size):
+        size = min(chunk_size, buffer_size - offset)
+        reply = connection.RspRequest('m%x,%x' % (buffer_addr + offset, size))
+        expected = array.array('I', xrange(offset / 4, (offset + size) / 4))
+        if binascii.unhexlify(reply) != expected.tostring():
+          raise AssertionError('Bad data read at offset %x' % offset)
+      elapsed = time.time() - start_time
+      sys.stderr.write('Read %d MB in %.2f seconds (%.1f MB/s)\n'
+                       % (buffer_size >> 20, elapsed,
+                          (buffer_size >> 20) / max(elapsed, 1e-6)))
 
   def test_kill(self):
     sel_ldr = PopenDebugStub('test_exit_code')
@@ -21,6 +21,10 @@ char g_example_var[] = "some_debug_stub_test_data";
 volatile uint32_t g_main_thread_var = 0;
 volatile uint32_t g_child_thread_var = 0;
 
+/* This is used for testing the speed of large memory reads. */
+#define LARGE_BUFFER_SIZE (64 << 20)
+uint32_t *g_large_buffer = NULL;
+
 
 /*
  * Inline assembly is not allowed to define symbols (in case it gets
@@ -241,6 +245,16 @@ void *child_thread_func(void *thread_arg) {
   return NULL;
 }
 
+void test_reading_large_memory(void) {
+  uint32_t index;
+  g_large_buffer = malloc(LARGE_BUFFER_SIZE);
+  ASSERT_NE(g_large_buffer, NULL);
+  for (index = 0; index < LARGE_BUFFER_SIZE / sizeof(uint32_t); index++) {
+    g_large_buffer[index] = index;
+  }
+  breakpoint();
+}
+
 void test_suspending_threads(void) {
   pthread_t tid;
   ASSERT_EQ(pthread_create(&tid, NULL, child_thread_func, NULL), 0);
@@ -288,5 +302,9 @@ int main(int argc, char **argv) {
     test_suspending_threads();
     return 0;
   }
+  if (strcmp(argv[1], "test_reading_large_memory") == 0) {
+    test_reading_large_memory();
+    return 0;
+  }
   return 1;
 }
@@ -24,10 +24,7 @@ def EnsurePortIsAvailable(addr=SEL_LDR_RSP_SOCKET_ADDR):
 
 
 def RspChecksum(data):
-  checksum = 0
-  for char in data:
-    checksum = (checksum + ord(char)) % 0x100
-  return checksum
+  return sum(bytearray(data)) % 0x100
 
 
 class GdbRspConnection(object):
@@ -63,12 +60,14 @@ class GdbRspConnection(object):
   def _GetReply(self):
     reply = ''
     while True:
-      data = self._socket.recv(1024)
+      data = self._socket.recv(0x10000)
       if len(data) == 0:
         raise AssertionError('EOF on socket reached with '
                              'incomplete reply message: %r' % reply)
       reply += data
-      if '#' in data:
+      # The reply ends with '#' and a two digit checksum, which may
+      # arrive separately from the body.
+      if len(reply) >= 3 and reply[-3] == '#':
         break
     match = re.match('\+\$([^#]*)#([0-9a-fA-F]{2})$', reply)
     if match is None:
@@ -86,7 +85,7 @@ class GdbRspConnection(object):
   # Send an rsp message, but don't wait for or expect a reply.
   def RspSendOnly(self, data):
     msg = '$%s#%02x' % (data, RspChecksum(data))
-    return self._socket.send(msg)
+    return self._socket.sendall(msg)
 
   def RspRequest(self, data):
     self.RspSendOnly(data)
@@ -34,7 +34,7 @@ static const struct nacl_interface_table irt_interfaces[] = {
    * presence is necessary for hello_world to produce output and so
    * for the hello_world test to pass.
    */
-  { NACL_IRT_FDIO_v0_1, &nacl_irt_fdio, sizeof(nacl_irt_fdio) },
+  { NACL_IRT_FDIO_v0_1, &nacl_irt_fdio, sizeof(struct nacl_irt_fdio_v0_1) },
 };
 
 size_t nacl_irt_interface(const char *interface_ident,
@@ -0,0 +1,198 @@
+/*
+ * Copyright (c) 2012 The Native Client Authors. All rights reserved.
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+/*
+ * Counts the heap allocations made per message by NaClImcSendTypedMessage
+ * and NaClImcRecvTypedMessage, and checks that steady-state messaging
+ * without descriptors does not allocate.  Allocations are counted by
+ * interposing on the glibc allocator, so this test is Linux-only.
+ * Also checks that the idle transfer buffers pooled across many
+ * sockets stay within NACL_DESC_IMC_XFER_BUFFER_GLOBAL_MAX.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "native_client/src/include/nacl_macros.h"
+#include "native_client/src/include/portability.h"
+#include "native_client/src/public/imc_types.h"
+#include "native_client/src/shared/imc/nacl_imc_c.h"
+#include "native_client/src/shared/platform/nacl_check.h"
+#include "native_client/src/shared/platform/nacl_log.h"
+#include "native_client/src/trusted/desc/nacl_desc_base.h"
+#include "native_client/src/trusted/desc/nacl_desc_imc.h"
+#include "native_client/src/trusted/desc/nrd_all_modules.h"
+#include "native_client/src/trusted/desc/nrd_xfer.h"
+
+#define kNumMessages 1000
+
+static int counting = 0;
+static size_t num_allocs = 0;
+
+extern void *__libc_malloc(size_t size);
+extern void *__libc_calloc(size_t nmemb, size_t size);
+extern void *__libc_realloc(void *ptr, size_t size);
+extern void __libc_free(void *ptr);
+
+void *malloc(size_t size) {
+  num_allocs += counting;
+  return __libc_malloc(size);
+}
+
+void *calloc(size_t nmemb, size_t size) {
+  num_allocs += counting;
+  return __libc_calloc(nmemb, size);
+}
+
+void *realloc(void *ptr, size_t size) {
+  num_allocs += counting;
+  return __libc_realloc(ptr, size);
+}
+
+void free(void *ptr) {
+  __libc_free(ptr);
+}
+
+static void SendAndReceive(struct NaClDesc *sender,
+                           struct NaClDesc *receiver,
+                           struct NaClDesc *xfer_desc) {
+  char send_data[64];
+  char recv_data[64];
+  struct NaClImcMsgIoVec send_iov;
+  struct NaClImcMsgIoVec recv_iov;
+  struct NaClDesc *send_descs[1];
+  struct NaClDesc *recv_descs[NACL_ABI_IMC_USER_DESC_MAX];
+  struct NaClImcTypedMsgHdr send_hdr;
+  struct NaClImcTypedMsgHdr recv_hdr;
+  ssize_t rv;
+  size_t i;
+
+  memset(send_data, 'x', sizeof send_data);
+  send_iov.base = send_data;
+  send_iov.length = sizeof send_data;
+  send_descs[0] = xfer_desc;
+  send_hdr.iov = &send_iov;
+  send_hdr.iov_length = 1;
+  send_hdr.ndescv = send_descs;
+  send_hdr.ndesc_length = (NULL == xfer_desc) ? 0 : 1;
+  send_hdr.flags = 0;
+
+  rv = NaClImcSendTypedMessage(sender, &send_hdr, 0);
+  CHECK(sizeof send_data == rv);
+
+  recv_iov.base = recv_data;
+  recv_iov.length = sizeof recv_data;
+  recv_hdr.iov = &recv_iov;
+  recv_hdr.iov_length = 1;
+  recv_hdr.ndescv = recv_descs;
+  recv_hdr.ndesc_length = NACL_ARRAY_SIZE(recv_descs);
+  recv_hdr.flags = 0;
+
+  rv = NaClImcRecvTypedMessage(receiver, &recv_hdr, 0, NULL);
+  CHECK(sizeof recv_data == rv);
+  CHECK(0 == memcmp(send_data, recv_data, sizeof recv_data));
+  CHECK(send_hdr.ndesc_length == recv_hdr.ndesc_length);
+  for (i = 0; i < recv_hdr.ndesc_length; ++i) {
+    NaClDescUnref(recv_hdr.ndescv[i]);
+  }
+}
+
+/*
+ * Returns the average number of allocations per message, after one
+ * warm-up message to let any buffer pools fill.
+ */
+static double MeasureAllocs(struct NaClDesc *sender,
+                            struct NaClDesc *receiver,
+                            struct NaClDesc *xfer_desc) {
+  int i;
+
+  SendAndReceive(sender, receiver, xfer_desc);
+  num_allocs = 0;
+  counting = 1;
+  for (i = 0; i < kNumMessages; ++i) {
+    SendAndReceive(sender, receiver, xfer_desc);
+  }
+  counting = 0;
+  return (double) num_allocs / kNumMessages;
+}
+
+static struct NaClDesc *MakeImcDesc(NaClHandle h) {
+  struct NaClDescImcDesc *desc = malloc(sizeof *desc);
+
+  CHECK(NULL != desc);
+  CHECK(NaClDescImcDescCtor(desc, h));
+  return (struct NaClDesc *) desc;
+}
+
+/*
+ * Gives more sockets than the global limit allows a full pool each,
+ * then checks the limit held and that closing them releases the pool.
+ */
+static void TestGlobalPoolLimit(void) {
+  enum { kNumPairs = NACL_DESC_IMC_XFER_BUFFER_GLOBAL_MAX };
+  struct NaClDesc *pairs[kNumPairs][2];
+  NaClHandle pair[2];
+  size_t before = NaClDescImcPooledXferBufferCount();
+  int i;
+
+  for (i = 0; i < kNumPairs; ++i) {
+    CHECK(0 == NaClSocketPair(pair));
+    pairs[i][0] = MakeImcDesc(pair[0]);
+    pairs[i][1] = MakeImcDesc(pair[1]);
+    SendAndReceive(pairs[i][0], pairs[i][1], NULL);
+    SendAndReceive(pairs[i][1], pairs[i][0], NULL);
+  }
+  printf("Idle transfer buffers pooled:     %u (limit %u)\n",
+         (unsigned) NaClDescImcPooledXferBufferCount(),
+         (unsigned) NACL_DESC_IMC_XFER_BUFFER_GLOBAL_MAX);
+  CHECK(NaClDescImcPooledXferBufferCount() ==
+        NACL_DESC_IMC_XFER_BUFFER_GLOBAL_MAX);
+
+  for (i = 0; i < kNumPairs; ++i) {
+    NaClDescUnref(pairs[i][0]);
+    NaClDescUnref(pairs[i][1]);
+  }
+  CHECK(NaClDescImcPooledXferBufferCount() <= before);
+}
+
+int main(void) {
+  NaClHandle pair[2];
+  struct NaClDesc *imc[2];
+  struct NaClDesc *data_only[2];
+  double allocs;
+
+  NaClNrdAllModulesInit();
+
+  CHECK(0 == NaClSocketPair(pair));
+  imc[0] = MakeImcDesc(pair[0]);
+  imc[1] = MakeImcDesc(pair[1]);
+  CHECK(0 == NaClCommonDescSocketPair(data_only));
+
+  allocs = MeasureAllocs(imc[0], imc[1], NULL);
+  printf("IMC socket, no descriptors:       %.2f allocs/message\n", allocs);
+  CHECK(0 == allocs);
+
+  allocs = MeasureAllocs(data_only[0], data_only[1], NULL);
+  printf("Data only socket, no descriptors: %.2f allocs/message\n", allocs);
+  CHECK(0 == allocs);
+
+  /* Receiving a descriptor must construct a new NaClDesc for it. */
+  allocs = MeasureAllocs(imc[0], imc[1], data_only[0]);
+  printf("IMC socket, one descriptor:       %.2f allocs/message\n", allocs);
+
+  NaClDescUnref(data_only[0]);
+  NaClDescUnref(data_only[1]);
+  NaClDescUnref(imc[0]);
+  NaClDescUnref(imc[1]);
+
+  TestGlobalPoolLimit();
+  CHECK(0 == NaClDescImcPooledXferBufferCount());
+
+  NaClNrdAllModulesFini();
+  printf("PASSED\n");
+  return 0;
+}
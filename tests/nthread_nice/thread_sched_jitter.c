@@ -0,0 +1,125 @@
+/*
+ * Copyright (c) 2013 The Native Client Authors. All rights reserved.
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+/*
+ * Measures wakeup jitter -- how late a short sleep returns -- with and
+ * without pinning the thread to one CPU through thread_sched_set, and
+ * prints the median, p99 and maximum.  Run sel_ldr with -P to allow
+ * pinning; without it only the unpinned numbers are printed.
+ *
+ * Also checks that requests outside the limits are refused.
+ */
+
+#include <errno.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include "native_client/src/trusted/service_runtime/include/sys/nacl_nice.h"
+#include "native_client/src/untrusted/nacl/syscall_bindings_trampoline.h"
+
+/* NaCl ABI clock id; see the comment in tests/clock/clock_irt_test.c. */
+#define NACL_ABI_CLOCK_MONOTONIC  1
+
+#define kSamples 5000
+#define kSleepNanos 100000
+
+static int64_t g_lateness[kSamples];
+
+static int64_t NowNanos(void) {
+  struct timespec ts;
+  NACL_SYSCALL(clock_gettime)(NACL_ABI_CLOCK_MONOTONIC, &ts);
+  return (int64_t) ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+
+static int CompareInt64(const void *a, const void *b) {
+  int64_t x = *(const int64_t *) a;
+  int64_t y = *(const int64_t *) b;
+  return x < y ? -1 : x > y;
+}
+
+static void MeasureJitter(const char *name) {
+  struct timespec req;
+  int64_t start;
+  int i;
+
+  req.tv_sec = 0;
+  req.tv_nsec = kSleepNanos;
+  for (i = 0; i < kSamples; ++i) {
+    start = NowNanos();
+    NACL_SYSCALL(nanosleep)(&req, NULL);
+    g_lateness[i] = NowNanos() - start - kSleepNanos;
+  }
+  qsort(g_lateness, kSamples, sizeof g_lateness[0], CompareInt64);
+  printf("%-10s lateness: p50 %8lld ns  p99 %8lld ns  max %8lld ns\n",
+         name,
+         (long long) g_lateness[kSamples / 2],
+         (long long) g_lateness[kSamples * 99 / 100],
+         (long long) g_lateness[kSamples - 1]);
+}
+
+/* Returns the highest CPU the thread may pin itself to, or -1. */
+static int PinToAllowedCpu(void) {
+  uint64_t mask;
+  int cpu;
+
+  for (cpu = NACL_ABI_SCHED_MAX_CPUS - 1; cpu >= 0; --cpu) {
+    mask = (uint64_t) 1 << cpu;
+    if (0 == NACL_SYSCALL(thread_sched_set)(&mask, sizeof mask,
+                                            NACL_ABI_SCHED_KEEP, 0)) {
+      return cpu;
+    }
+  }
+  return -1;
+}
+
+static int TestLimits(void) {
+  int errs = 0;
+  uint64_t mask = 0;
+  int rc;
+
+  /* Realtime policies are not allowed unless the embedder says so. */
+  rc = NACL_SYSCALL(thread_sched_set)(NULL, 0, NACL_ABI_SCHED_FIFO, 1);
+  if (-EPERM != rc) {
+    fprintf(stderr, "SCHED_FIFO: expected EPERM, got %d\n", rc);
+    ++errs;
+  }
+  rc = NACL_SYSCALL(thread_sched_set)(NULL, 0, NACL_ABI_SCHED_OTHER, 1);
+  if (-EINVAL != rc) {
+    fprintf(stderr, "SCHED_OTHER with a priority: expected EINVAL, got %d\n",
+            rc);
+    ++errs;
+  }
+  rc = NACL_SYSCALL(thread_sched_set)(&mask, sizeof mask,
+                                      NACL_ABI_SCHED_KEEP, 0);
+  if (-EINVAL != rc) {
+    fprintf(stderr, "empty CPU mask: expected EINVAL, got %d\n", rc);
+    ++errs;
+  }
+  rc = NACL_SYSCALL(thread_sched_set)(NULL, 0, NACL_ABI_SCHED_OTHER, 0);
+  if (0 != rc) {
+    fprintf(stderr, "SCHED_OTHER: expected success, got %d\n", rc);
+    ++errs;
+  }
+  return errs;
+}
+
+int main(void) {
+  int errs = TestLimits();
+  int cpu;
+
+  MeasureJitter("unpinned");
+  cpu = PinToAllowedCpu();
+  if (cpu < 0) {
+    printf("pinning is not allowed; run sel_ldr with -P to compare\n");
+  } else {
+    char name[16];
+    snprintf(name, sizeof name, "cpu %d", cpu);
+    MeasureJitter(name);
+  }
+  return errs;
+}
@@ -198,8 +198,13 @@ int main(int argc, char **argv) {
   RUN_TEST(TestMmapAnonymous);
   RUN_TEST(TestAtomicIncrement);
   RUN_TEST(TestUncontendedMutexLock);
+  RUN_TEST(TestContendedMutex2Threads);
+  RUN_TEST(TestContendedMutex4Threads);
+  RUN_TEST(TestContendedMutex8Threads);
+  RUN_TEST(TestContendedMutex16Threads);
   RUN_TEST(TestCondvarSignalNoOp);
   RUN_TEST(TestThreadCreateAndJoin);
+  RUN_TEST(TestThreadCreateAndJoinBatch);
   RUN_TEST(TestThreadWakeup);
 
 #if defined(__native_client__)
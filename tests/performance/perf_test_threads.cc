@@ -86,6 +86,28 @@ class TestThreadCreateAndJoin : public PerfTest {
 };
 PERF_TEST_DECLARE(TestThreadCreateAndJoin)
 
+// Create and join several threads at a time, so that more than one
+// exited host thread is available for reuse by the service runtime.
+class TestThreadCreateAndJoinBatch : public PerfTest {
+ public:
+  virtual void run() {
+    pthread_t tids[kBatchSize];
+    for (int i = 0; i < kBatchSize; i++)
+      ASSERT_EQ(pthread_create(&tids[i], NULL, EmptyThread, NULL), 0);
+    for (int i = 0; i < kBatchSize; i++)
+      ASSERT_EQ(pthread_join(tids[i], NULL), 0);
+  }
+
+ private:
+  static const int kBatchSize = 4;
+
+  static void *EmptyThread(void *thread_arg) {
+    UNREFERENCED_PARAMETER(thread_arg);
+    return NULL;
+  }
+};
+PERF_TEST_DECLARE(TestThreadCreateAndJoinBatch)
+
 class TestThreadWakeup : public PerfTest {
  public:
   TestThreadWakeup() {
@@ -147,3 +169,63 @@ class TestThreadWakeup : public PerfTest {
   enum { WAIT, WAKE_CHILD, REPLY_TO_PARENT, EXIT } state_;
 };
 PERF_TEST_DECLARE(TestThreadWakeup)
+
+// Measure the throughput of a mutex that several threads contend for,
+// with a short critical section.  Each iteration starts the threads,
+// which each take the mutex kLocksPerThread times, and joins them.
+class TestContendedMutex : public PerfTest {
+ public:
+  explicit TestContendedMutex(int thread_count)
+      : thread_count_(thread_count), counter_(0) {
+    ASSERT_LE(thread_count_, kMaxThreads);
+    ASSERT_EQ(pthread_mutex_init(&mutex_, NULL), 0);
+  }
+
+  ~TestContendedMutex() {
+    ASSERT_EQ(pthread_mutex_destroy(&mutex_), 0);
+  }
+
+  virtual void run() {
+    pthread_t tids[kMaxThreads];
+    for (int i = 0; i < thread_count_; i++)
+      ASSERT_EQ(pthread_create(&tids[i], NULL, Thread, this), 0);
+    for (int i = 0; i < thread_count_; i++)
+      ASSERT_EQ(pthread_join(tids[i], NULL), 0);
+  }
+
+ private:
+  static const int kMaxThreads = 16;
+  static const int kLocksPerThread = 1000;
+
+  static void *Thread(void *thread_arg) {
+    TestContendedMutex *obj = (TestContendedMutex *) thread_arg;
+    for (int i = 0; i < kLocksPerThread; i++) {
+      ASSERT_EQ(pthread_mutex_lock(&obj->mutex_), 0);
+      // A critical section of a few hundred cycles.
+      for (int j = 0; j < 50; j++)
+        obj->counter_++;
+      ASSERT_EQ(pthread_mutex_unlock(&obj->mutex_), 0);
+    }
+    return NULL;
+  }
+
+  int thread_count_;
+  pthread_mutex_t mutex_;
+  volatile int counter_;
+};
+
+#define DECLARE_CONTENDED_MUTEX_TEST(thread_count) \
+    class TestContendedMutex##thread_count##Threads \
+        : public TestContendedMutex { \
+     public: \
+      TestContendedMutex##thread_count##Threads() \
+          : TestContendedMutex(thread_count) {} \
+    }; \
+    PERF_TEST_DECLARE(TestContendedMutex##thread_count##Threads)
+
+DECLARE_CONTENDED_MUTEX_TEST(2)
+DECLARE_CONTENDED_MUTEX_TEST(4)
+DECLARE_CONTENDED_MUTEX_TEST(8)
+DECLARE_CONTENDED_MUTEX_TEST(16)
+
+#undef DECLARE_CONTENDED_MUTEX_TEST
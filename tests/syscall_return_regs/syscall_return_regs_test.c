@@ -146,6 +146,21 @@ void TestSyscall(uintptr_t syscall_addr) {
         "push $ContinueAfterSyscall\n"  /* Push return address */
         "nacljmp %%eax, %%r15\n");
 #elif defined(__arm__)
+    /*
+     * The tls_get and second_tls_get trampolines do not enter the
+     * service runtime, so they leave the other registers and the flags
+     * as they were.  lr still holds the return address.
+     */
+    if (syscall_addr == (uintptr_t) NACL_SYSCALL(tls_get) ||
+        syscall_addr == (uintptr_t) NACL_SYSCALL(second_tls_get)) {
+      g_expected_regs.r1 = syscall_addr;
+      g_expected_regs.r2 = call_regs.r2;
+      g_expected_regs.r3 = call_regs.r3;
+      g_expected_regs.r12 = call_regs.r12;
+      g_expected_regs.lr = (uintptr_t) ContinueAfterSyscall;
+      g_expected_regs.cpsr = call_regs.cpsr;
+    }
+
     call_regs.r1 = syscall_addr;  /* Scratch register */
     call_regs.lr = (uintptr_t) ContinueAfterSyscall;  /* Return address */
     ASM_WITH_REGS(
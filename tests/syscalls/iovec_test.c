@@ -0,0 +1,217 @@
+/*
+ * Copyright (c) 2013 The Native Client Authors. All rights reserved.
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+/*
+ * Exercises the readv, writev, preadv and pwritev syscalls on a file
+ * created in the directory named by the first argument, including
+ * their handling of bad iovecs.
+ */
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "native_client/src/untrusted/nacl/syscall_bindings_trampoline.h"
+
+/* Matches NACL_SYS_IOV_MAX in the service runtime's sys_fdio.h. */
+#define kIovMax 1024
+/* Above the number of elements the service runtime keeps on its stack. */
+#define kManyElements 100
+
+/*
+ * The syscalls take the same layout as struct iovec, which newlib
+ * does not define.
+ */
+struct TestIoVec {
+  void    *base;
+  size_t  length;
+};
+
+static struct TestIoVec g_iov[kIovMax + 1];
+static char g_bytes[kIovMax];
+
+#define IOV(iov) ((const struct iovec *) (iov))
+
+static int g_errs = 0;
+
+static void Check(int cond, char const *what) {
+  if (!cond) {
+    fprintf(stderr, "FAILED: %s\n", what);
+    ++g_errs;
+  }
+}
+
+static void TestWritevReadv(int fd) {
+  char part1[] = "abc";
+  char part2[] = "defgh";
+  char in1[3];
+  char in2[10];
+  struct TestIoVec iov[3];
+  int rc;
+
+  iov[0].base = part1;
+  iov[0].length = 3;
+  iov[1].base = part2;
+  iov[1].length = 0;
+  iov[2].base = part2;
+  iov[2].length = 5;
+  rc = NACL_SYSCALL(writev)(fd, IOV(iov), 3);
+  Check(8 == rc, "writev of 3 elements returns 8");
+  Check(8 == lseek(fd, 0, SEEK_CUR), "writev advances the file position");
+
+  Check(0 == lseek(fd, 0, SEEK_SET), "lseek to 0");
+  memset(in2, 0, sizeof in2);
+  iov[0].base = in1;
+  iov[0].length = sizeof in1;
+  iov[1].base = in2;
+  iov[1].length = sizeof in2;
+  rc = NACL_SYSCALL(readv)(fd, IOV(iov), 2);
+  Check(8 == rc, "readv past EOF returns the bytes that are there");
+  Check(0 == memcmp(in1, "abc", 3), "readv fills the first element");
+  Check(0 == memcmp(in2, "defgh", 5), "readv fills the second element");
+
+  rc = NACL_SYSCALL(readv)(fd, IOV(iov), 0);
+  Check(0 == rc, "readv of no elements returns 0");
+
+  printf("TestWritevReadv done\n");
+}
+
+static void TestPwritevPreadv(int fd) {
+  char out[] = "0123456789";
+  char in[10];
+  struct TestIoVec iov[2];
+  off_t offset = 100;
+  off_t pos;
+  int rc;
+
+  pos = lseek(fd, 0, SEEK_CUR);
+  iov[0].base = out;
+  iov[0].length = 4;
+  iov[1].base = out + 4;
+  iov[1].length = 6;
+  rc = NACL_SYSCALL(pwritev)(fd, IOV(iov), 2, &offset);
+  Check(10 == rc, "pwritev of 2 elements returns 10");
+  Check(100 == offset, "pwritev leaves the offset argument alone");
+  Check(pos == lseek(fd, 0, SEEK_CUR), "pwritev keeps the file position");
+
+  memset(in, 0, sizeof in);
+  iov[0].base = in + 6;
+  iov[0].length = 4;
+  iov[1].base = in;
+  iov[1].length = 6;
+  rc = NACL_SYSCALL(preadv)(fd, IOV(iov), 2, &offset);
+  Check(10 == rc, "preadv of 2 elements returns 10");
+  Check(0 == memcmp(in + 6, "0123", 4), "preadv fills the first element");
+  Check(0 == memcmp(in, "456789", 6), "preadv fills the second element");
+  Check(pos == lseek(fd, 0, SEEK_CUR), "preadv keeps the file position");
+
+  printf("TestPwritevPreadv done\n");
+}
+
+/* More elements than fit on the service runtime's stack. */
+static void TestManyElements(int fd) {
+  off_t offset = 1000;
+  int i;
+  int rc;
+
+  for (i = 0; i < kManyElements; ++i) {
+    g_bytes[i] = (char) i;
+    g_iov[i].base = &g_bytes[i];
+    g_iov[i].length = 1;
+  }
+  rc = NACL_SYSCALL(pwritev)(fd, IOV(g_iov), kManyElements, &offset);
+  Check(kManyElements == rc, "pwritev of many elements");
+
+  memset(g_bytes, 0xff, kManyElements);
+  rc = NACL_SYSCALL(preadv)(fd, IOV(g_iov), kManyElements, &offset);
+  Check(kManyElements == rc, "preadv of many elements");
+  for (i = 0; i < kManyElements; ++i) {
+    if ((char) i != g_bytes[i]) {
+      Check(0, "preadv of many elements reads back what was written");
+      break;
+    }
+  }
+
+  printf("TestManyElements done\n");
+}
+
+static void TestBadIovecs(int fd) {
+  char buf[16];
+  struct TestIoVec iov[2];
+  off_t offset = 0;
+  int i;
+  int rc;
+
+  /* An iovec array that runs off the end of the address space. */
+  rc = NACL_SYSCALL(readv)(fd, (const struct iovec *) 0xfffffff8, 2);
+  Check(-EFAULT == rc, "readv of an unaddressable iovec gives EFAULT");
+  rc = NACL_SYSCALL(writev)(fd, (const struct iovec *) 0xfffffff8, 2);
+  Check(-EFAULT == rc, "writev of an unaddressable iovec gives EFAULT");
+
+  /* A good element followed by one that runs off the end. */
+  iov[0].base = buf;
+  iov[0].length = sizeof buf;
+  iov[1].base = (void *) 0xfffffff8;
+  iov[1].length = 16;
+  rc = NACL_SYSCALL(readv)(fd, IOV(iov), 2);
+  Check(-EFAULT == rc, "readv into an unaddressable buffer gives EFAULT");
+  rc = NACL_SYSCALL(pwritev)(fd, IOV(iov), 2, &offset);
+  Check(-EFAULT == rc, "pwritev from an unaddressable buffer gives EFAULT");
+
+  /* An unaddressable offset. */
+  iov[1].base = buf;
+  rc = NACL_SYSCALL(preadv)(fd, IOV(iov), 2, (off_t *) 0xfffffffc);
+  Check(-EFAULT == rc, "preadv with an unaddressable offset gives EFAULT");
+
+  /* One element too many, even though all of them are valid. */
+  for (i = 0; i <= kIovMax; ++i) {
+    g_iov[i].base = buf;
+    g_iov[i].length = 0;
+  }
+  rc = NACL_SYSCALL(readv)(fd, IOV(g_iov), kIovMax + 1);
+  Check(-EINVAL == rc, "readv of more than 1024 elements gives EINVAL");
+  rc = NACL_SYSCALL(pwritev)(fd, IOV(g_iov), kIovMax + 1, &offset);
+  Check(-EINVAL == rc, "pwritev of more than 1024 elements gives EINVAL");
+  rc = NACL_SYSCALL(writev)(fd, IOV(g_iov), kIovMax);
+  Check(0 == rc, "writev of 1024 elements is allowed");
+
+  rc = NACL_SYSCALL(readv)(-1, IOV(iov), 1);
+  Check(-EBADF == rc, "readv of a bad descriptor gives EBADF");
+
+  printf("TestBadIovecs done\n");
+}
+
+int main(int argc, char **argv) {
+  char path[256];
+  int fd;
+
+  if (argc != 2) {
+    fprintf(stderr, "Usage: iovec_test <temp dir>\n");
+    return 1;
+  }
+  snprintf(path, sizeof path, "%s/iovec_test.dat", argv[1]);
+  fd = open(path, O_RDWR | O_CREAT | O_TRUNC, 0600);
+  if (fd < 0) {
+    fprintf(stderr, "could not create %s, errno %d\n", path, errno);
+    return 1;
+  }
+
+  TestWritevReadv(fd);
+  TestPwritevPreadv(fd);
+  TestManyElements(fd);
+  TestBadIovecs(fd);
+
+  close(fd);
+  if (0 != g_errs) {
+    fprintf(stderr, "%d checks failed\n", g_errs);
+    return 1;
+  }
+  printf("PASSED\n");
+  return 0;
+}
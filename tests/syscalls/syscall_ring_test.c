@@ -0,0 +1,191 @@
+/*
+ * Copyright (c) 2013 The Native Client Authors. All rights reserved.
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+/*
+ * Reads a file in small chunks, first with one pread syscall per chunk
+ * and then with the same preads batched through the syscall ring,
+ * checks that both give the same bytes, and prints the cost per chunk
+ * of each.
+ */
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+#include "native_client/src/trusted/service_runtime/include/sys/nacl_syscall_ring.h"
+#include "native_client/src/untrusted/nacl/syscall_bindings_trampoline.h"
+
+/* NaCl ABI clock id; see the comment in tests/clock/clock_irt_test.c. */
+#define NACL_ABI_CLOCK_MONOTONIC  1
+
+#define kEntries 64
+#define kChunk 16
+#define kMaxChunks 256
+#define kRounds 2000
+
+struct SubmissionQueue {
+  struct NaClAbiSyscallRingHeader header;
+  struct NaClAbiSyscallRingSqe entries[kEntries];
+};
+
+struct CompletionQueue {
+  struct NaClAbiSyscallRingHeader header;
+  struct NaClAbiSyscallRingCqe entries[kEntries];
+};
+
+static struct SubmissionQueue g_sq __attribute__((aligned(8)));
+static struct CompletionQueue g_cq __attribute__((aligned(8)));
+
+static char g_single[kMaxChunks * kChunk];
+static char g_batched[kMaxChunks * kChunk];
+
+static int64_t NowNanos(void) {
+  struct timespec ts;
+  NACL_SYSCALL(clock_gettime)(NACL_ABI_CLOCK_MONOTONIC, &ts);
+  return (int64_t) ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+
+/* Returns the number of bytes read, or -1. */
+static int ReadSingle(int fd, int chunks) {
+  int total = 0;
+  int i;
+
+  for (i = 0; i < chunks; ++i) {
+    off_t offset = (off_t) i * kChunk;
+    int rc = NACL_SYSCALL(pread)(fd, g_single + i * kChunk, kChunk, &offset);
+    if (rc < 0) {
+      fprintf(stderr, "pread failed: %d\n", rc);
+      return -1;
+    }
+    total += rc;
+  }
+  return total;
+}
+
+/* Returns the number of bytes read, or -1. */
+static int ReadBatched(int fd, int chunks) {
+  int total = 0;
+  int next = 0;
+  int rc;
+
+  while (next < chunks) {
+    uint32_t tail = g_sq.header.tail;
+    int batch = chunks - next;
+
+    if (batch > kEntries) {
+      batch = kEntries;
+    }
+    for (; batch > 0; --batch, ++next, ++tail) {
+      struct NaClAbiSyscallRingSqe *sqe = &g_sq.entries[tail % kEntries];
+      sqe->opcode = NACL_ABI_SYSCALL_RING_PREAD;
+      sqe->d = fd;
+      sqe->addr = (uint32_t) (uintptr_t) (g_batched + next * kChunk);
+      sqe->count = kChunk;
+      sqe->offset = (int64_t) next * kChunk;
+      sqe->user_data = next;
+    }
+    g_sq.header.tail = tail;
+    rc = NACL_SYSCALL(syscall_ring_enter)(kEntries);
+    if (rc < 0) {
+      fprintf(stderr, "syscall_ring_enter failed: %d\n", rc);
+      return -1;
+    }
+    while (g_cq.header.head != g_cq.header.tail) {
+      struct NaClAbiSyscallRingCqe *cqe =
+          &g_cq.entries[g_cq.header.head % kEntries];
+      if (cqe->result < 0) {
+        fprintf(stderr, "pread of chunk %d failed: %d\n",
+                (int) cqe->user_data, (int) cqe->result);
+        return -1;
+      }
+      total += cqe->result;
+      ++g_cq.header.head;
+    }
+  }
+  return total;
+}
+
+static int TestBadArgs(void) {
+  int errs = 0;
+  int rc;
+
+  rc = NACL_SYSCALL(syscall_ring_register)(&g_sq.header, &g_cq.header, 3);
+  if (-EINVAL != rc) {
+    fprintf(stderr, "non-power-of-two size: expected EINVAL, got %d\n", rc);
+    ++errs;
+  }
+  rc = NACL_SYSCALL(syscall_ring_enter)(1);
+  if (-EINVAL != rc) {
+    fprintf(stderr, "enter without a ring: expected EINVAL, got %d\n", rc);
+    ++errs;
+  }
+  return errs;
+}
+
+int main(int argc, char **argv) {
+  int errs = TestBadArgs();
+  int64_t single_ns;
+  int64_t batched_ns;
+  int64_t start;
+  int chunks;
+  int size;
+  int fd;
+  int rc;
+  int i;
+
+  if (argc != 2) {
+    fprintf(stderr, "usage: %s <file>\n", argv[0]);
+    return 1;
+  }
+  fd = NACL_SYSCALL(open)(argv[1], O_RDONLY, 0);
+  if (fd < 0) {
+    fprintf(stderr, "open of %s failed: %d\n", argv[1], fd);
+    return 1;
+  }
+  rc = NACL_SYSCALL(syscall_ring_register)(&g_sq.header, &g_cq.header,
+                                           kEntries);
+  if (0 != rc) {
+    fprintf(stderr, "syscall_ring_register failed: %d\n", rc);
+    return 1;
+  }
+
+  size = ReadSingle(fd, kMaxChunks);
+  if (size <= 0) {
+    return 1;
+  }
+  chunks = (size + kChunk - 1) / kChunk;
+  if (ReadBatched(fd, chunks) != size ||
+      0 != memcmp(g_single, g_batched, size)) {
+    fprintf(stderr, "batched reads do not match single reads\n");
+    ++errs;
+  }
+
+  start = NowNanos();
+  for (i = 0; i < kRounds; ++i) {
+    ReadSingle(fd, chunks);
+  }
+  single_ns = NowNanos() - start;
+  start = NowNanos();
+  for (i = 0; i < kRounds; ++i) {
+    ReadBatched(fd, chunks);
+  }
+  batched_ns = NowNanos() - start;
+  printf("%d-byte preads: %lld ns each, %lld ns each through the ring\n",
+         kChunk,
+         (long long) (single_ns / ((int64_t) kRounds * chunks)),
+         (long long) (batched_ns / ((int64_t) kRounds * chunks)));
+
+  rc = NACL_SYSCALL(syscall_ring_register)(NULL, NULL, 0);
+  if (0 != rc) {
+    fprintf(stderr, "unregistering failed: %d\n", rc);
+    ++errs;
+  }
+  NACL_SYSCALL(close)(fd);
+  return errs;
+}
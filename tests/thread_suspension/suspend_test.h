@@ -11,6 +11,9 @@
 #include "native_client/src/include/portability.h"
 #include "native_client/src/trusted/service_runtime/nacl_signal.h"
 
+/* The largest thread_count that the MultiMutatorThread test accepts. */
+#define kMaxMutatorThreads 32
+
 /*
  * This is used by both untrusted and trusted code so we use
  * explicitly-sized types for the fields.
@@ -19,6 +22,9 @@ struct SuspendTestShm {
   volatile uint32_t var;
   volatile uint32_t should_exit;  /* Boolean */
   uint32_t continue_after_suspension_func;
+  /* Used by the MultiMutatorThread test. */
+  volatile uint32_t thread_count;
+  volatile uint32_t running_threads;
   struct NaClSignalContext expected_regs;
 };
 
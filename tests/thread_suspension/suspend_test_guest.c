@@ -7,6 +7,7 @@
 #include "native_client/tests/thread_suspension/suspend_test.h"
 
 #include <assert.h>
+#include <pthread.h>
 #include <setjmp.h>
 #include <stddef.h>
 #include <stdint.h>
@@ -32,6 +33,37 @@ static void MutatorThread(struct SuspendTestShm *test_shm) {
   }
 }
 
+static void *MultiMutatorThreadFunc(void *arg) {
+  struct SuspendTestShm *test_shm = (struct SuspendTestShm *) arg;
+  __sync_fetch_and_add(&test_shm->running_threads, 1);
+  MutatorThread(test_shm);
+  return NULL;
+}
+
+/*
+ * Runs test_shm->thread_count copies of MutatorThread(), including
+ * the main thread.  The host sets thread_count after starting us.
+ */
+static void MultiMutatorThread(struct SuspendTestShm *test_shm) {
+  pthread_t tids[kMaxMutatorThreads];
+  uint32_t count;
+  uint32_t index;
+
+  while (test_shm->thread_count == 0) { /* do nothing */ }
+  count = test_shm->thread_count;
+  assert(count <= kMaxMutatorThreads);
+  for (index = 1; index < count; index++) {
+    int rc = pthread_create(&tids[index], NULL, MultiMutatorThreadFunc,
+                            test_shm);
+    assert(rc == 0);
+  }
+  MultiMutatorThreadFunc(test_shm);
+  for (index = 1; index < count; index++) {
+    int rc = pthread_join(tids[index], NULL);
+    assert(rc == 0);
+  }
+}
+
 static void SyscallReturnThread(struct SuspendTestShm *test_shm) {
   int rc = NACL_SYSCALL(test_syscall_1)(test_shm);
   assert(rc == 0);
@@ -275,6 +307,8 @@ int main(int argc, char **argv) {
 
   if (strcmp(test_type, "MutatorThread") == 0) {
     MutatorThread(test_shm);
+  } else if (strcmp(test_type, "MultiMutatorThread") == 0) {
+    MultiMutatorThread(test_shm);
   } else if (strcmp(test_type, "SyscallReturnThread") == 0) {
     SyscallReturnThread(test_shm);
   } else if (strcmp(test_type, "SyscallInvokerThread") == 0) {
@@ -12,6 +12,7 @@
 #include "native_client/src/shared/platform/nacl_exit.h"
 #include "native_client/src/shared/platform/nacl_log.h"
 #include "native_client/src/shared/platform/nacl_sync_checked.h"
+#include "native_client/src/shared/platform/nacl_time.h"
 #include "native_client/src/trusted/service_runtime/include/bits/mman.h"
 #include "native_client/src/trusted/service_runtime/include/bits/nacl_syscalls.h"
 #include "native_client/src/trusted/service_runtime/load_file.h"
@@ -137,6 +138,43 @@ static void TrySuspendingMutatorThread(struct NaClApp *nap) {
   CHECK(NaClWaitForMainThreadToExit(nap) == 0);
 }
 
+/*
+ * This measures how long NaClUntrustedThreadsSuspendAll() takes to
+ * suspend a varying number of threads that are running untrusted
+ * code.  Signalling all threads before waiting for any of them should
+ * keep the pause roughly flat as the thread count grows, rather than
+ * linear in it.
+ */
+static void BenchmarkSuspendAll(struct NaClApp *nap) {
+  const int kIterations = 1000;
+  uint32_t thread_count;
+
+  for (thread_count = 1; thread_count <= kMaxMutatorThreads;
+       thread_count *= 2) {
+    struct SuspendTestShm *test_shm;
+    int64_t start_us;
+    int64_t elapsed_us;
+    int iteration;
+
+    test_shm = StartGuestWithSharedMemory(nap, "MultiMutatorThread");
+    test_shm->thread_count = thread_count;
+    /* Wait for all the threads to start writing. */
+    while (test_shm->running_threads != thread_count) { /* do nothing */ }
+
+    start_us = NaClGetTimeOfDayMicroseconds();
+    for (iteration = 0; iteration < kIterations; iteration++) {
+      NaClUntrustedThreadsSuspendAll(nap, /* save_registers= */ 0);
+      NaClUntrustedThreadsResumeAll(nap);
+    }
+    elapsed_us = NaClGetTimeOfDayMicroseconds() - start_us;
+    printf("  %2u threads: %8.2f us per suspend/resume\n",
+           (unsigned) thread_count, (double) elapsed_us / kIterations);
+
+    test_shm->should_exit = 1;
+    CHECK(NaClWaitForMainThreadToExit(nap) == 0);
+  }
+}
+
 /*
  * This implements a NaCl syscall.  This syscall will spin until told
  * by the (trusted) test code to return.  This is used for testing
@@ -530,6 +568,9 @@ int main(int argc, char **argv) {
   printf("Running TestGettingRegisterSnapshotInSyscallContextSwitch...\n");
   TestGettingRegisterSnapshotInSyscallContextSwitch(&app);
 
+  printf("Running BenchmarkSuspendAll...\n");
+  BenchmarkSuspendAll(&app);
+
   /*
    * Avoid calling exit() because it runs process-global destructors
    * which might break code that is running in our unjoined threads.
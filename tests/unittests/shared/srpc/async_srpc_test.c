@@ -0,0 +1,419 @@
+/*
+ * Copyright (c) 2012 The Native Client Authors. All rights reserved.
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+/*
+ * Tests asynchronous SRPC invocation against a server that dispatches
+ * requests to a worker pool, and measures throughput as a function of
+ * the number of outstanding calls.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "native_client/src/shared/imc/nacl_imc_c.h"
+#include "native_client/src/shared/srpc/nacl_srpc.h"
+#include "native_client/src/shared/platform/nacl_threads.h"
+
+#if defined(__native_client__)
+#include <sys/time.h>
+#include <time.h>
+#else
+#include "native_client/src/shared/platform/nacl_time.h"
+#include "native_client/src/trusted/desc/nacl_desc_imc.h"
+#include "native_client/src/trusted/desc/nrd_all_modules.h"
+#include "native_client/src/trusted/service_runtime/include/sys/time.h"
+#endif
+
+
+#define kNumWorkers 16
+#define kMaxOutstanding 64
+/* Simulated per-call server latency for the throughput measurement. */
+#define kDelayMicroseconds 1000
+
+static void failWithErrno(const char* message) {
+  char buffer[256];
+
+  if (0 == NaClGetLastErrorString(buffer, sizeof(buffer))) {
+    fprintf(stderr, "%s: %s", message, buffer);
+  }
+  exit(EXIT_FAILURE);
+}
+
+static void fail(const char* message) {
+  fprintf(stderr, "FAIL: %s\n", message);
+  exit(EXIT_FAILURE);
+}
+
+static void SleepMicroseconds(int usec) {
+#if defined(__native_client__)
+  struct timespec req;
+  req.tv_sec = usec / 1000000;
+  req.tv_nsec = (usec % 1000000) * 1000;
+  nanosleep(&req, NULL);
+#else
+  struct nacl_abi_timespec req;
+  req.tv_sec = usec / 1000000;
+  req.tv_nsec = (usec % 1000000) * 1000;
+  NaClNanosleep(&req, NULL);
+#endif
+}
+
+static double NowSeconds(void) {
+#if defined(__native_client__)
+  struct timeval tv;
+  gettimeofday(&tv, NULL);
+  return tv.tv_sec + tv.tv_usec / 1e6;
+#else
+  return NaClGetTimeOfDayMicroseconds() / 1e6;
+#endif
+}
+
+/* Returns its argument, after sleeping for the requested time. */
+static void handleDelayEcho(NaClSrpcRpc* rpc,
+                            NaClSrpcArg** ins,
+                            NaClSrpcArg** outs,
+                            NaClSrpcClosure* done) {
+  if (ins[0]->u.ival > 0) {
+    SleepMicroseconds(ins[0]->u.ival);
+  }
+  outs[0]->u.ival = ins[1]->u.ival;
+  rpc->result = NACL_SRPC_RESULT_OK;
+  done->Run(done);
+}
+
+static void WINAPI serviceThread(void* arg) {
+  NaClSrpcImcDescType desc = (NaClSrpcImcDescType) arg;
+  NaClSrpcHandlerDesc handlers[] = {
+    { "delayEcho:ii:i", handleDelayEcho },
+    { NULL, NULL }
+  };
+
+  if (!NaClSrpcServerLoopConcurrent(desc, handlers, 0, kNumWorkers)) {
+    failWithErrno("NaClSrpcServerLoopConcurrent");
+  }
+#ifdef __native_client__
+  close(desc);
+#else
+  NaClDescUnref(desc);
+#endif
+  NaClThreadExit();
+}
+
+/*
+ * Per-call argument storage.  The rets must stay valid until the call is
+ * reaped, so each outstanding call gets its own slot.
+ */
+struct CallSlot {
+  NaClSrpcArg in_delay;
+  NaClSrpcArg in_value;
+  NaClSrpcArg out_value;
+  NaClSrpcArg* ins[3];
+  NaClSrpcArg* outs[2];
+};
+
+static struct CallSlot slots[kMaxOutstanding];
+
+static NaClSrpcError StartCall(NaClSrpcChannel* channel,
+                               uint32_t rpc_num,
+                               int slot,
+                               int delay,
+                               int value,
+                               NaClSrpcAsyncCallback callback,
+                               NaClSrpcAsyncRpc** handle) {
+  struct CallSlot* s = &slots[slot];
+
+  NaClSrpcArgCtor(&s->in_delay);
+  NaClSrpcArgCtor(&s->in_value);
+  NaClSrpcArgCtor(&s->out_value);
+  s->in_delay.tag = NACL_SRPC_ARG_TYPE_INT;
+  s->in_delay.u.ival = delay;
+  s->in_value.tag = NACL_SRPC_ARG_TYPE_INT;
+  s->in_value.u.ival = value;
+  s->out_value.tag = NACL_SRPC_ARG_TYPE_INT;
+  s->out_value.u.ival = -1;
+  s->ins[0] = &s->in_delay;
+  s->ins[1] = &s->in_value;
+  s->ins[2] = NULL;
+  s->outs[0] = &s->out_value;
+  s->outs[1] = NULL;
+  return NaClSrpcInvokeAsyncV(channel, rpc_num, s->ins, s->outs,
+                              callback, (void*) (intptr_t) slot, handle);
+}
+
+static void TestWaitAny(NaClSrpcChannel* channel, uint32_t rpc_num) {
+  int seen[kMaxOutstanding];
+  void* tag;
+  NaClSrpcError result;
+  int i;
+
+  memset(seen, 0, sizeof seen);
+  for (i = 0; i < kMaxOutstanding; ++i) {
+    /* Later calls finish sooner, so responses arrive out of order. */
+    if (NACL_SRPC_RESULT_OK != StartCall(channel, rpc_num, i,
+                                         (kMaxOutstanding - i) * 100,
+                                         1000 + i, NULL, NULL)) {
+      fail("TestWaitAny: StartCall");
+    }
+  }
+  for (i = 0; i < kMaxOutstanding; ++i) {
+    int slot;
+    if (!NaClSrpcAsyncWaitAny(channel, &tag, &result)) {
+      fail("TestWaitAny: too few completions");
+    }
+    slot = (int) (intptr_t) tag;
+    if (NACL_SRPC_RESULT_OK != result) {
+      fail("TestWaitAny: bad result");
+    }
+    if (slot < 0 || slot >= kMaxOutstanding || seen[slot]) {
+      fail("TestWaitAny: bad or duplicate tag");
+    }
+    if (slots[slot].out_value.u.ival != 1000 + slot) {
+      fail("TestWaitAny: response matched to the wrong request");
+    }
+    seen[slot] = 1;
+  }
+  if (NaClSrpcAsyncWaitAny(channel, &tag, &result)) {
+    fail("TestWaitAny: too many completions");
+  }
+  printf("TestWaitAny passed\n");
+}
+
+static void TestWaitHandles(NaClSrpcChannel* channel, uint32_t rpc_num) {
+  NaClSrpcAsyncRpc* handles[kMaxOutstanding];
+  int i;
+
+  for (i = 0; i < kMaxOutstanding; ++i) {
+    if (NACL_SRPC_RESULT_OK != StartCall(channel, rpc_num, i, 0, 2000 + i,
+                                         NULL, &handles[i])) {
+      fail("TestWaitHandles: StartCall");
+    }
+  }
+  /* Wait in the reverse order of issue. */
+  for (i = kMaxOutstanding - 1; i >= 0; --i) {
+    if (NACL_SRPC_RESULT_OK != NaClSrpcAsyncWait(channel, handles[i])) {
+      fail("TestWaitHandles: bad result");
+    }
+    if (slots[i].out_value.u.ival != 2000 + i) {
+      fail("TestWaitHandles: response matched to the wrong request");
+    }
+  }
+  printf("TestWaitHandles passed\n");
+}
+
+static int callbacks_run;
+
+static void CountingCallback(NaClSrpcError result, void* tag) {
+  int slot = (int) (intptr_t) tag;
+  if (NACL_SRPC_RESULT_OK != result ||
+      slots[slot].out_value.u.ival != 3000 + slot) {
+    fail("CountingCallback: bad response");
+  }
+  ++callbacks_run;
+}
+
+static void TestCallbacks(NaClSrpcChannel* channel, uint32_t rpc_num) {
+  void* tag;
+  NaClSrpcError result;
+  int i;
+
+  callbacks_run = 0;
+  for (i = 0; i < kMaxOutstanding; ++i) {
+    if (NACL_SRPC_RESULT_OK != StartCall(channel, rpc_num, i, 0, 3000 + i,
+                                         CountingCallback, NULL)) {
+      fail("TestCallbacks: StartCall");
+    }
+  }
+  /* Callback-mode calls are never returned by WaitAny; it just drains. */
+  if (NaClSrpcAsyncWaitAny(channel, &tag, &result)) {
+    fail("TestCallbacks: WaitAny returned a callback-mode call");
+  }
+  if (kMaxOutstanding != callbacks_run) {
+    fail("TestCallbacks: wrong number of callbacks");
+  }
+  printf("TestCallbacks passed\n");
+}
+
+#define kNumSyncCalls 32
+
+static NaClSrpcChannel* sync_channel;
+static int sync_failures;
+
+static void WINAPI SyncCallerThread(void* arg) {
+  int i;
+  int value;
+
+  UNREFERENCED_PARAMETER(arg);
+  for (i = 0; i < kNumSyncCalls; ++i) {
+    if (NACL_SRPC_RESULT_OK !=
+        NaClSrpcInvokeBySignature(sync_channel, "delayEcho:ii:i",
+                                  100, 5000 + i, &value) ||
+        5000 + i != value) {
+      ++sync_failures;
+    }
+  }
+}
+
+/*
+ * Synchronous calls on one thread must not steal responses from async
+ * waiters on another, or vice versa.
+ */
+static void TestSyncWithAsync(NaClSrpcChannel* channel, uint32_t rpc_num) {
+  NaClSrpcAsyncRpc* handles[kMaxOutstanding];
+  struct NaClThread thr;
+  int i;
+
+  sync_channel = channel;
+  sync_failures = 0;
+  for (i = 0; i < kMaxOutstanding; ++i) {
+    if (NACL_SRPC_RESULT_OK != StartCall(channel, rpc_num, i, 200, 4000 + i,
+                                         NULL, &handles[i])) {
+      fail("TestSyncWithAsync: StartCall");
+    }
+  }
+  if (!NaClThreadCreateJoinable(&thr, SyncCallerThread, NULL, 128*1024)) {
+    failWithErrno("NaClThreadCtor");
+  }
+  for (i = 0; i < kMaxOutstanding; ++i) {
+    if (NACL_SRPC_RESULT_OK != NaClSrpcAsyncWait(channel, handles[i])) {
+      fail("TestSyncWithAsync: bad result");
+    }
+    if (slots[i].out_value.u.ival != 4000 + i) {
+      fail("TestSyncWithAsync: response matched to the wrong request");
+    }
+  }
+  NaClThreadJoin(&thr);
+  if (0 != sync_failures) {
+    fail("TestSyncWithAsync: synchronous call failed");
+  }
+  printf("TestSyncWithAsync passed\n");
+}
+
+/*
+ * Issues num_calls calls, keeping up to depth of them outstanding, and
+ * reports the achieved call rate.
+ */
+static void MeasureThroughput(NaClSrpcChannel* channel,
+                              uint32_t rpc_num,
+                              int depth,
+                              int num_calls) {
+  int issued = 0;
+  int reaped = 0;
+  double start;
+  double elapsed;
+  void* tag;
+  NaClSrpcError result;
+
+  start = NowSeconds();
+  while (issued < depth && issued < num_calls) {
+    if (NACL_SRPC_RESULT_OK != StartCall(channel, rpc_num, issued,
+                                         kDelayMicroseconds, issued,
+                                         NULL, NULL)) {
+      fail("MeasureThroughput: StartCall");
+    }
+    ++issued;
+  }
+  while (reaped < num_calls) {
+    if (!NaClSrpcAsyncWaitAny(channel, &tag, &result) ||
+        NACL_SRPC_RESULT_OK != result) {
+      fail("MeasureThroughput: WaitAny");
+    }
+    ++reaped;
+    if (issued < num_calls) {
+      /* Reuse the slot of the call that just completed. */
+      if (NACL_SRPC_RESULT_OK != StartCall(channel, rpc_num,
+                                           (int) (intptr_t) tag,
+                                           kDelayMicroseconds, issued,
+                                           NULL, NULL)) {
+        fail("MeasureThroughput: StartCall");
+      }
+      ++issued;
+    }
+  }
+  elapsed = NowSeconds() - start;
+  printf("outstanding=%2d: %d calls in %.3f sec, %.0f calls/sec\n",
+         depth, num_calls, elapsed, num_calls / elapsed);
+}
+
+int main(int argc, char* argv[]) {
+  NaClHandle pair[2];
+#ifdef __native_client__
+  int imc_desc[2];
+#else
+  struct NaClDescImcDesc* imc_desc[2];
+#endif
+  struct NaClThread thr;
+  NaClSrpcChannel channel;
+  uint32_t rpc_num;
+  int depth;
+
+  UNREFERENCED_PARAMETER(argc);
+  UNREFERENCED_PARAMETER(argv);
+
+  NaClSrpcModuleInit();
+
+  if (0 != NaClSocketPair(pair)) {
+    failWithErrno("SocketPair");
+  }
+
+#ifdef __native_client__
+  imc_desc[0] = pair[0];
+  imc_desc[1] = pair[1];
+#else
+  NaClNrdAllModulesInit();
+
+  imc_desc[0] = (struct NaClDescImcDesc*) calloc(1, sizeof(*imc_desc[0]));
+  if (0 == imc_desc[0]) {
+    failWithErrno("calloc");
+  }
+  imc_desc[1] = (struct NaClDescImcDesc*) calloc(1, sizeof(*imc_desc[1]));
+  if (0 == imc_desc[1]) {
+    failWithErrno("calloc");
+  }
+
+  if (!NaClDescImcDescCtor(imc_desc[0], pair[0])) {
+    failWithErrno("NaClDescImcDescCtor");
+  }
+
+  if (!NaClDescImcDescCtor(imc_desc[1], pair[1])) {
+    failWithErrno("NaClDescImcDescCtor");
+  }
+#endif
+
+  if (!NaClThreadCreateJoinable(&thr, serviceThread,
+                                (void*) imc_desc[0], 128*1024)) {
+    failWithErrno("NaClThreadCtor");
+  }
+
+  if (!NaClSrpcClientCtor(&channel, (NaClSrpcImcDescType) imc_desc[1])) {
+    failWithErrno("NaClSrpcClientCtor");
+  }
+  rpc_num = NaClSrpcServiceMethodIndex(channel.client, "delayEcho:ii:i");
+  if (kNaClSrpcInvalidMethodIndex == rpc_num) {
+    fail("delayEcho:ii:i not found");
+  }
+
+  TestWaitAny(&channel, rpc_num);
+  TestWaitHandles(&channel, rpc_num);
+  TestCallbacks(&channel, rpc_num);
+  TestSyncWithAsync(&channel, rpc_num);
+
+  for (depth = 1; depth <= kNumWorkers; depth *= 2) {
+    MeasureThroughput(&channel, rpc_num, depth, 16 * kNumWorkers);
+  }
+
+  NaClSrpcDtor(&channel);
+#ifdef __native_client__
+  close(imc_desc[1]);
+#else
+  NaClDescUnref((NaClSrpcImcDescType)imc_desc[1]);
+#endif
+
+  NaClThreadJoin(&thr);
+
+  NaClSrpcModuleFini();
+  return 0;
+}
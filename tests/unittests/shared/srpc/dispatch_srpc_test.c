@@ -0,0 +1,305 @@
+/*
+ * Copyright (c) 2012 The Native Client Authors. All rights reserved.
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+/*
+ * Tests hashed method lookup on a service with many methods, and measures
+ * the overhead of dispatch, both for the lookup alone and for a complete
+ * NaClSrpcInvokeBySignature round trip.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "native_client/src/shared/imc/nacl_imc_c.h"
+#include "native_client/src/shared/srpc/nacl_srpc.h"
+#include "native_client/src/shared/srpc/nacl_srpc_internal.h"
+#include "native_client/src/shared/platform/nacl_threads.h"
+
+#if defined(__native_client__)
+#include <sys/time.h>
+#else
+#include "native_client/src/shared/platform/nacl_time.h"
+#include "native_client/src/trusted/desc/nacl_desc_imc.h"
+#include "native_client/src/trusted/desc/nrd_all_modules.h"
+#endif
+
+
+#define kNumMethods 256
+#define kSignatureLength 16
+#define kLookupIterations 1000000
+#define kRoundTripIterations 10000
+
+static char signatures[kNumMethods][kSignatureLength];
+static NaClSrpcHandlerDesc handlers[kNumMethods + 1];
+
+static void failWithErrno(const char* message) {
+  char buffer[256];
+
+  if (0 == NaClGetLastErrorString(buffer, sizeof(buffer))) {
+    fprintf(stderr, "%s: %s", message, buffer);
+  }
+  exit(EXIT_FAILURE);
+}
+
+static void fail(const char* message) {
+  fprintf(stderr, "FAIL: %s\n", message);
+  exit(EXIT_FAILURE);
+}
+
+static double NowSeconds(void) {
+#if defined(__native_client__)
+  struct timeval tv;
+  gettimeofday(&tv, NULL);
+  return tv.tv_sec + tv.tv_usec / 1e6;
+#else
+  return NaClGetTimeOfDayMicroseconds() / 1e6;
+#endif
+}
+
+static void handleEcho(NaClSrpcRpc* rpc,
+                       NaClSrpcArg** ins,
+                       NaClSrpcArg** outs,
+                       NaClSrpcClosure* done) {
+  outs[0]->u.ival = ins[0]->u.ival;
+  rpc->result = NACL_SRPC_RESULT_OK;
+  done->Run(done);
+}
+
+/* Every method shares a handler, but each has a distinct signature. */
+static void BuildHandlers(void) {
+  int i;
+
+  for (i = 0; i < kNumMethods; ++i) {
+    snprintf(signatures[i], sizeof signatures[i], "echo%03d:i:i", i);
+    handlers[i].entry_fmt = signatures[i];
+    handlers[i].handler = handleEcho;
+  }
+  handlers[kNumMethods].entry_fmt = NULL;
+  handlers[kNumMethods].handler = NULL;
+}
+
+/* The linear search used before signatures were hashed, for comparison. */
+static uint32_t LinearMethodIndex(const char* signature) {
+  uint32_t i;
+
+  for (i = 0; i < kNumMethods; ++i) {
+    if (0 == strcmp(signatures[i], signature)) {
+      return i;
+    }
+  }
+  return kNaClSrpcInvalidMethodIndex;
+}
+
+static void TestLookup(const NaClSrpcService* service) {
+  int i;
+  const char* name;
+  const char* input_types;
+  const char* output_types;
+  static const char* const kMissing[] = {
+    "echo000:i:", "echo000:ii:i", "echo999:i:i", "echo:i:i", "", NULL
+  };
+
+  if (NULL == service->rpc_descr[0].hash_table) {
+    fail("TestLookup: no perfect hash was found");
+  }
+  for (i = 0; i < kNumMethods; ++i) {
+    uint32_t rpc_num = NaClSrpcServiceMethodIndex(service, signatures[i]);
+    if (kNaClSrpcInvalidMethodIndex == rpc_num ||
+        !NaClSrpcServiceMethodNameAndTypes(service, rpc_num, &name,
+                                           &input_types, &output_types)) {
+      fail("TestLookup: signature not found");
+    }
+    if (0 != strncmp(name, signatures[i], strlen(name)) ||
+        0 != strcmp(input_types, "i") ||
+        0 != strcmp(output_types, "i")) {
+      fail("TestLookup: signature found at the wrong index");
+    }
+  }
+  for (i = 0; NULL != kMissing[i]; ++i) {
+    if (kNaClSrpcInvalidMethodIndex !=
+        NaClSrpcServiceMethodIndex(service, kMissing[i])) {
+      fail("TestLookup: found a signature that is not in the service");
+    }
+  }
+  printf("TestLookup passed\n");
+}
+
+/*
+ * A peer's service string may describe methods with more types than may be
+ * sent.  They are kept, but cannot be invoked, and do not stop the rest of
+ * the service from being used.
+ */
+static void TestOversizedSignature(void) {
+  NaClSrpcService service;
+  char* str;
+  char* p;
+  uint32_t rpc_num;
+  const NaClSrpcMethodDesc* method_desc;
+  int i;
+
+  str = (char*) malloc(NACL_SRPC_MAX_ARGS + 64);
+  if (NULL == str) {
+    fail("TestOversizedSignature: malloc");
+  }
+  p = str + sprintf(str, "echo:i:i\nhuge:");
+  for (i = 0; i <= NACL_SRPC_MAX_ARGS; ++i) {
+    *p++ = 'i';
+  }
+  strcpy(p, ":\n");
+  if (!NaClSrpcServiceStringCtor(&service, str)) {
+    fail("TestOversizedSignature: construction failed");
+  }
+  if (0 != NaClSrpcServiceMethodIndex(&service, "echo:i:i")) {
+    fail("TestOversizedSignature: echo:i:i not found");
+  }
+  /* Drop the final newline to look up the oversized signature. */
+  p[1] = '\0';
+  rpc_num = NaClSrpcServiceMethodIndex(&service, str + strlen("echo:i:i\n"));
+  method_desc = NaClSrpcServiceMethodDesc(&service, rpc_num);
+  if (NULL == method_desc || method_desc->input_types_valid) {
+    fail("TestOversizedSignature: oversized method is invocable");
+  }
+  NaClSrpcServiceDtor(&service);
+  free(str);
+  printf("TestOversizedSignature passed\n");
+}
+
+static void MeasureLookup(const NaClSrpcService* service) {
+  double start;
+  double hashed;
+  double linear;
+  uint32_t sum = 0;
+  int i;
+
+  start = NowSeconds();
+  for (i = 0; i < kLookupIterations; ++i) {
+    sum += NaClSrpcServiceMethodIndex(service, signatures[i % kNumMethods]);
+  }
+  hashed = NowSeconds() - start;
+  start = NowSeconds();
+  for (i = 0; i < kLookupIterations; ++i) {
+    sum += LinearMethodIndex(signatures[i % kNumMethods]);
+  }
+  linear = NowSeconds() - start;
+  printf("lookup, %d methods: hashed %.1f ns, linear %.1f ns (%u)\n",
+         kNumMethods,
+         hashed * 1e9 / kLookupIterations,
+         linear * 1e9 / kLookupIterations,
+         (unsigned) sum);
+}
+
+static void MeasureRoundTrip(NaClSrpcChannel* channel) {
+  double start;
+  double elapsed;
+  int value;
+  int i;
+
+  start = NowSeconds();
+  for (i = 0; i < kRoundTripIterations; ++i) {
+    if (NACL_SRPC_RESULT_OK !=
+        NaClSrpcInvokeBySignature(channel, signatures[kNumMethods - 1],
+                                  i, &value) ||
+        value != i) {
+      fail("MeasureRoundTrip: bad response");
+    }
+  }
+  elapsed = NowSeconds() - start;
+  printf("InvokeBySignature round trip: %.2f us\n",
+         elapsed * 1e6 / kRoundTripIterations);
+}
+
+static void WINAPI serviceThread(void* arg) {
+  NaClSrpcImcDescType desc = (NaClSrpcImcDescType) arg;
+
+  if (!NaClSrpcServerLoop(desc, handlers, 0)) {
+    failWithErrno("NaClSrpcServerLoop");
+  }
+#ifdef __native_client__
+  close(desc);
+#else
+  NaClDescUnref(desc);
+#endif
+  NaClThreadExit();
+}
+
+int main(int argc, char* argv[]) {
+  NaClHandle pair[2];
+#ifdef __native_client__
+  int imc_desc[2];
+#else
+  struct NaClDescImcDesc* imc_desc[2];
+#endif
+  struct NaClThread thr;
+  NaClSrpcService service;
+  NaClSrpcChannel channel;
+
+  UNREFERENCED_PARAMETER(argc);
+  UNREFERENCED_PARAMETER(argv);
+
+  NaClSrpcModuleInit();
+  BuildHandlers();
+
+  if (!NaClSrpcServiceHandlerCtor(&service, handlers)) {
+    fail("NaClSrpcServiceHandlerCtor");
+  }
+  TestLookup(&service);
+  MeasureLookup(&service);
+  NaClSrpcServiceDtor(&service);
+  TestOversizedSignature();
+
+  if (0 != NaClSocketPair(pair)) {
+    failWithErrno("SocketPair");
+  }
+
+#ifdef __native_client__
+  imc_desc[0] = pair[0];
+  imc_desc[1] = pair[1];
+#else
+  NaClNrdAllModulesInit();
+
+  imc_desc[0] = (struct NaClDescImcDesc*) calloc(1, sizeof(*imc_desc[0]));
+  if (0 == imc_desc[0]) {
+    failWithErrno("calloc");
+  }
+  imc_desc[1] = (struct NaClDescImcDesc*) calloc(1, sizeof(*imc_desc[1]));
+  if (0 == imc_desc[1]) {
+    failWithErrno("calloc");
+  }
+
+  if (!NaClDescImcDescCtor(imc_desc[0], pair[0])) {
+    failWithErrno("NaClDescImcDescCtor");
+  }
+
+  if (!NaClDescImcDescCtor(imc_desc[1], pair[1])) {
+    failWithErrno("NaClDescImcDescCtor");
+  }
+#endif
+
+  if (!NaClThreadCreateJoinable(&thr, serviceThread,
+                                (void*) imc_desc[0], 128*1024)) {
+    failWithErrno("NaClThreadCtor");
+  }
+
+  if (!NaClSrpcClientCtor(&channel, (NaClSrpcImcDescType) imc_desc[1])) {
+    failWithErrno("NaClSrpcClientCtor");
+  }
+  /* The client learns the service by discovery, so it is hashed too. */
+  TestLookup(channel.client);
+  MeasureRoundTrip(&channel);
+
+  NaClSrpcDtor(&channel);
+#ifdef __native_client__
+  close(imc_desc[1]);
+#else
+  NaClDescUnref((NaClSrpcImcDescType)imc_desc[1]);
+#endif
+
+  NaClThreadJoin(&thr);
+
+  NaClSrpcModuleFini();
+  return 0;
+}